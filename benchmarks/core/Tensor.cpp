@@ -0,0 +1,94 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/core/Tensor.h"
+
+#include <benchmark/benchmark.h>
+
+namespace u3d::benchmarks {
+
+// Element counts from a single 3-vector up to a mid-sized tensor, where the
+// per-op dispatch cost dominates or is amortized respectively.
+static void SmallSizes(benchmark::internal::Benchmark* b) {
+    for (int64_t n : {1, 3, 16, 256, 4096, 65536}) {
+        b->Arg(n);
+    }
+}
+
+static void BinaryEWAdd(benchmark::State& state) {
+    core::Tensor lhs = core::Tensor::Ones({state.range(0)}, core::Float32);
+    core::Tensor rhs = core::Tensor::Ones({state.range(0)}, core::Float32);
+    for (auto _ : state) {
+        core::Tensor dst = lhs + rhs;
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BinaryEWAddInplace(benchmark::State& state) {
+    core::Tensor lhs = core::Tensor::Ones({state.range(0)}, core::Float32);
+    core::Tensor rhs = core::Tensor::Ones({state.range(0)}, core::Float32);
+    for (auto _ : state) {
+        lhs.Add_(rhs);
+        benchmark::DoNotOptimize(lhs);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BinaryEWAddBroadcast(benchmark::State& state) {
+    core::Tensor lhs = core::Tensor::Ones({state.range(0), 3}, core::Float32);
+    core::Tensor rhs = core::Tensor::Ones({3}, core::Float32);
+    for (auto _ : state) {
+        core::Tensor dst = lhs + rhs;
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * 3);
+}
+
+static void UnaryEWSqrt(benchmark::State& state) {
+    core::Tensor src = core::Tensor::Ones({state.range(0)}, core::Float32);
+    for (auto _ : state) {
+        core::Tensor dst = src.Sqrt();
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void CopyToDtype(benchmark::State& state) {
+    core::Tensor src = core::Tensor::Ones({state.range(0)}, core::Int32);
+    for (auto _ : state) {
+        core::Tensor dst = src.To(core::Float32);
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void MulMixedDtype(benchmark::State& state) {
+    core::Tensor depth = core::Tensor::Ones({state.range(0)}, core::UInt16);
+    core::Tensor scale = core::Tensor::Ones({state.range(0)}, core::Float32);
+    for (auto _ : state) {
+        core::Tensor dst = scale * depth;
+        benchmark::DoNotOptimize(dst);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void IsContiguous(benchmark::State& state) {
+    core::Tensor t = core::Tensor::Ones({4, 4, 4, 4}, core::Float32);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(t.IsContiguous());
+    }
+}
+
+BENCHMARK(BinaryEWAdd)->Apply(SmallSizes);
+BENCHMARK(BinaryEWAddInplace)->Apply(SmallSizes);
+BENCHMARK(BinaryEWAddBroadcast)->Apply(SmallSizes);
+BENCHMARK(UnaryEWSqrt)->Apply(SmallSizes);
+BENCHMARK(CopyToDtype)->Apply(SmallSizes);
+BENCHMARK(MulMixedDtype)->Apply(SmallSizes);
+BENCHMARK(IsContiguous);
+
+}  // namespace u3d::benchmarks
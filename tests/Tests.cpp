@@ -6,6 +6,8 @@
 
 #include "tests/Tests.h"
 
+#include "unified3d/core/Parallel.h"
+
 namespace u3d::tests {
 
 void NotImplemented() {
@@ -19,4 +21,13 @@ void NotImplemented() {
     GTEST_NONFATAL_FAILURE_("Not implemented");
 }
 
+ScopedMaxNumberOfThreads::ScopedMaxNumberOfThreads(unsigned int num_threads)
+    : previous_(core::maxNumberOfThreads()) {
+    core::setMaxNumberOfThreads(num_threads);
+}
+
+ScopedMaxNumberOfThreads::~ScopedMaxNumberOfThreads() {
+    core::setMaxNumberOfThreads(previous_);
+}
+
 }  // namespace u3d::tests
@@ -32,4 +32,36 @@ const Eigen::Vector2i Zero2i = Eigen::Vector2i::Zero();
 // Mechanism for reporting unit tests for which there is no implementation yet.
 void NotImplemented();
 
+/// \brief Sets the maximum number of threads of the parallel algorithms, and
+/// restores the previous maximum when destroyed.
+///
+/// The maximum is process-wide, so the guard also restores it when a fatal
+/// assertion returns from a test early.
+class ScopedMaxNumberOfThreads {
+public:
+    explicit ScopedMaxNumberOfThreads(unsigned int num_threads);
+    ~ScopedMaxNumberOfThreads();
+
+    ScopedMaxNumberOfThreads(const ScopedMaxNumberOfThreads&) = delete;
+    ScopedMaxNumberOfThreads& operator=(const ScopedMaxNumberOfThreads&) =
+            delete;
+
+private:
+    unsigned int previous_;
+};
+
+/// \brief Calls \p fn once per thread count of the thread-count independence
+/// tests, with the maximum number of threads set accordingly.
+///
+/// The tests compute a reference under ScopedMaxNumberOfThreads(1) and expect
+/// each call of \p fn to reproduce it bitwise, not only closely.
+template <typename Fn>
+void ForEachThreadCount(Fn&& fn) {
+    for (unsigned int num_threads : {2u, 3u, 8u}) {
+        SCOPED_TRACE(::testing::Message() << "num_threads = " << num_threads);
+        ScopedMaxNumberOfThreads threads(num_threads);
+        fn();
+    }
+}
+
 }  // namespace u3d::tests
@@ -0,0 +1,135 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/core/EigenConverter.h"
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "tests/core/CoreTest.h"
+
+namespace u3d::tests {
+
+class EigenConverterPermuteDevices : public PermuteDevices {};
+INSTANTIATE_TEST_SUITE_P(EigenConverter,
+                         EigenConverterPermuteDevices,
+                         testing::ValuesIn(PermuteDevices::TestCases()));
+
+TEST(EigenConverter, EigenVectorVectorToTensorView) {
+    using Vector3fPages = std::vector<
+            Eigen::Vector3f,
+            core::eigen_converter::PageAlignedAllocator<Eigen::Vector3f>>;
+    auto points = std::make_shared<Vector3fPages>(
+            Vector3fPages{{0, 1, 2}, {3, 4, 5}});
+    core::Tensor t =
+            core::eigen_converter::EigenVectorVectorToTensorView(points);
+    EXPECT_EQ(t.GetShape(), core::SizeVector({2, 3}));
+    EXPECT_EQ(t.GetDtype(), core::Float32);
+    EXPECT_EQ(t.GetDataView().CpuAddress(), points->data());
+    EXPECT_EQ(t.ToFlatVector<float>(), std::vector<float>({0, 1, 2, 3, 4, 5}));
+
+    // Writes are shared both ways.
+    t[1][2] = 50.f;
+    EXPECT_EQ((*points)[1](2), 50.f);
+    (*points)[0](0) = 10.f;
+    EXPECT_EQ(t[0][0].Item<float>(), 10.f);
+
+    // The tensor keeps the vector alive.
+    std::weak_ptr<Vector3fPages> weak_points = points;
+    points.reset();
+    EXPECT_FALSE(weak_points.expired());
+    EXPECT_EQ(t[1][2].Item<float>(), 50.f);
+    t = core::Tensor();
+    EXPECT_TRUE(weak_points.expired());
+}
+
+TEST(EigenConverter, EigenVectorVectorToTensorViewMultiplePages) {
+    // Several pages, the last one partially used.
+    using Vector3iPages = std::vector<
+            Eigen::Vector3i,
+            core::eigen_converter::PageAlignedAllocator<Eigen::Vector3i>>;
+    auto triangles = std::make_shared<Vector3iPages>(3001);
+    for (int i = 0; i < 3001; i++) {
+        (*triangles)[i] = Eigen::Vector3i(i, i + 1, i + 2);
+    }
+    core::Tensor t =
+            core::eigen_converter::EigenVectorVectorToTensorView(triangles);
+    EXPECT_EQ(t.GetDataView().CpuAddress(), triangles->data());
+    EXPECT_EQ(t[3000][2].Item<int32_t>(), 3002);
+    t[3000][0] = -1;
+    EXPECT_EQ((*triangles)[3000](0), -1);
+}
+
+TEST(EigenConverter, HostMemoryToTensorViewRejectsCopies) {
+    // Heap storage from the default allocator may share its pages with other
+    // allocations and cannot be aliased. Copying it would silently drop the
+    // writes through the tensor, so it is an error. Such vectors do not
+    // compile with EigenVectorVectorToTensorView().
+    std::vector<Eigen::Vector3i> triangles{{0, 1, 2}, {2, 1, 3}};
+    EXPECT_ANY_THROW(core::eigen_converter::HostMemoryToTensorView(
+            triangles.data(), {2, 3}, core::Int32, nullptr, false));
+
+    // Page-allocated memory must also start on a page.
+    using Vector3iPages = std::vector<
+            Eigen::Vector3i,
+            core::eigen_converter::PageAlignedAllocator<Eigen::Vector3i>>;
+    Vector3iPages pages(4);
+    EXPECT_ANY_THROW(core::eigen_converter::HostMemoryToTensorView(
+            pages.data() + 1, {3, 3}, core::Int32, nullptr, true));
+    core::Tensor t = core::eigen_converter::HostMemoryToTensorView(
+            pages.data(), {4, 3}, core::Int32, nullptr, true);
+    EXPECT_EQ(t.GetDataView().CpuAddress(), pages.data());
+}
+
+TEST_P(EigenConverterPermuteDevices, TensorToEigenMap) {
+    core::Device device = GetParam();
+    core::Tensor t = core::Tensor::Init<float>({{0, 1, 2}, {3, 4, 5}}, device);
+
+    auto map = core::eigen_converter::TensorToEigenMap<float, 3>(t);
+    EXPECT_EQ(map.rows(), 2);
+    EXPECT_EQ(map(1, 0), 3.f);
+    map.row(0) *= 2.f;
+    EXPECT_EQ(t.ToFlatVector<float>(), std::vector<float>({0, 2, 4, 3, 4, 5}));
+
+    const core::Tensor& t_const = t;
+    auto map_dynamic =
+            core::eigen_converter::TensorToEigenMap<float, Eigen::Dynamic>(
+                    t_const);
+    EXPECT_EQ(map_dynamic.cols(), 3);
+    EXPECT_EQ(map_dynamic.sum(), 18.f);
+
+    // Wrong column count, dtype or layout.
+    EXPECT_ANY_THROW((core::eigen_converter::TensorToEigenMap<float, 2>(t)));
+    EXPECT_ANY_THROW((core::eigen_converter::TensorToEigenMap<int32_t, 3>(t)));
+    EXPECT_ANY_THROW((core::eigen_converter::TensorToEigenMap<float, 2>(
+            t.T())));
+}
+
+TEST_P(EigenConverterPermuteDevices, EigenVector3dVector) {
+    core::Device device = GetParam();
+    std::vector<Eigen::Vector3d> values{{0, 1, 2}, {3.5, 4, 5}};
+    core::Tensor t = core::eigen_converter::EigenVector3dVectorToTensorCopy(
+            values, core::Float32, device);
+    EXPECT_EQ(t.GetShape(), core::SizeVector({2, 3}));
+    EXPECT_EQ(t.ToFlatVector<float>(),
+              std::vector<float>({0, 1, 2, 3.5, 4, 5}));
+    EXPECT_EQ(core::eigen_converter::TensorToEigenVector3dVector(t), values);
+
+    // The tensor owns a copy.
+    t[0][0] = 10.f;
+    EXPECT_EQ(values[0](0), 0.0);
+
+    // Strided input.
+    std::vector<Eigen::Vector3d> values_t =
+            core::eigen_converter::TensorToEigenVector3dVector(
+                    core::Tensor::Init<float>({{0, 1}, {2, 3}, {4, 5}}, device)
+                            .T());
+    EXPECT_EQ(values_t, std::vector<Eigen::Vector3d>({{0, 2, 4}, {1, 3, 5}}));
+}
+
+}  // namespace u3d::tests
@@ -1618,6 +1618,39 @@ TEST_P(TensorPermuteDevices, Add_) {
               std::vector<float>({10, 12, 14, 16, 18, 20}));
 }
 
+TEST_P(TensorPermuteDevices, AddNonContiguous) {
+    core::Device device = GetParam();
+    // Transposed operands have the same shape but are not contiguous, so they
+    // must not take the flat element-wise path.
+    core::Tensor a = core::Tensor::Init<float>({{0, 1, 2}, {3, 4, 5}}, device);
+    core::Tensor b = core::Tensor::Init<float>({{0, 10}, {20, 30}, {40, 50}},
+                                               device);
+    core::Tensor a_t = a.T();
+    EXPECT_FALSE(a_t.IsContiguous());
+    core::Tensor c = a_t + b;
+    EXPECT_TRUE(c.IsContiguous());
+    EXPECT_EQ(c.ToFlatVector<float>(),
+              std::vector<float>({0, 13, 21, 34, 42, 55}));
+
+    // Contiguous lhs with non-contiguous rhs.
+    core::Tensor d = b + a_t;
+    EXPECT_EQ(d.ToFlatVector<float>(), c.ToFlatVector<float>());
+}
+
+TEST_P(TensorPermuteDevices, AddLarge) {
+    core::Device device = GetParam();
+    // Large enough to be split across threads.
+    int64_t n = 100000;
+    core::Tensor a = core::Tensor::Arange(0, n, 1, core::Int64, device);
+    core::Tensor b = core::Tensor::Full({n}, 2, core::Int64, device);
+    core::Tensor c = a + b;
+    std::vector<int64_t> c_vals = c.ToFlatVector<int64_t>();
+    for (int64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(c_vals[i], i + 2);
+    }
+    EXPECT_TRUE(c.Sub(b).AllEqual(a));
+}
+
 TEST_P(TensorPermuteDevices, Add_BroadcastException) {
     // A.shape = (   3, 4)
     // B.shape = (2, 3, 4)
@@ -3528,4 +3561,213 @@ TEST_P(TensorPermuteDevices, ConstIterator) {
     }
 }
 
+TEST_P(TensorPermuteDevices, ContiguousPermuted) {
+    core::Device device = GetParam();
+
+    // (N, 3) <-> (3, N), with N spanning several tiles.
+    int64_t n = 1000;
+    core::Tensor t = core::Tensor::Arange(0, n * 3, 1, core::Int64, device)
+                             .Reshape({n, 3});
+    core::Tensor t_t = t.T().Contiguous();
+    EXPECT_TRUE(t_t.IsContiguous());
+    EXPECT_EQ(t_t.GetShape(), core::SizeVector({3, n}));
+    std::vector<int64_t> t_t_vals = t_t.ToFlatVector<int64_t>();
+    for (int64_t r = 0; r < 3; ++r) {
+        for (int64_t c = 0; c < n; ++c) {
+            EXPECT_EQ(t_t_vals[r * n + c], c * 3 + r);
+        }
+    }
+    EXPECT_TRUE(t_t.T().Contiguous().AllEqual(t));
+
+    // 3D permutation of a 1-byte dtype.
+    core::Tensor u = core::Tensor::Arange(0, 2 * 33 * 40, 1, core::Int64,
+                                          device)
+                             .Reshape({2, 33, 40});
+    core::Tensor u_p = u.To(core::UInt8).Permute({2, 0, 1}).Contiguous();
+    std::vector<uint8_t> u_p_vals = u_p.ToFlatVector<uint8_t>();
+    for (int64_t i = 0; i < 40; ++i) {
+        for (int64_t j = 0; j < 2; ++j) {
+            for (int64_t k = 0; k < 33; ++k) {
+                EXPECT_EQ(u_p_vals[(i * 2 + j) * 33 + k],
+                          static_cast<uint8_t>(j * 33 * 40 + k * 40 + i));
+            }
+        }
+    }
+
+    // Strided slice of rows is copied in runs.
+    core::Tensor v = u.Slice(1, 0, 33, 2);
+    EXPECT_FALSE(v.IsContiguous());
+    core::Tensor v_c = v.Contiguous();
+    EXPECT_EQ(v_c.GetShape(), core::SizeVector({2, 17, 40}));
+    EXPECT_EQ(v_c[1][3][5].Item<int64_t>(), 1 * 33 * 40 + 6 * 40 + 5);
+}
+
+TEST_P(TensorPermuteDevices, MixedDtypeArithmetic) {
+    core::Device device = GetParam();
+    // Depth-style uint16 input, converted inside the kernel.
+    int64_t n = 3000;
+    core::Tensor depth =
+            core::Tensor::Arange(0, n, 1, core::Int64, device).To(core::UInt16);
+    core::Tensor scale = core::Tensor::Full({n}, 0.5f, core::Float32, device);
+    core::Tensor depth_f = scale.Mul(depth);
+    EXPECT_EQ(depth_f.GetDtype(), core::Float32);
+    std::vector<float> depth_f_vals = depth_f.ToFlatVector<float>();
+    for (int64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(depth_f_vals[i], 0.5f * i);
+    }
+
+    // The integer operand may be on either side, and a fractional scale is
+    // not truncated.
+    core::Tensor depth_scale =
+            core::Tensor::Full({n}, 0.001f, core::Float32, device);
+    core::Tensor depth_m = depth.Mul(depth_scale);
+    EXPECT_EQ(depth_m.GetDtype(), core::Float32);
+    std::vector<float> depth_m_vals = depth_m.ToFlatVector<float>();
+    for (int64_t i = 0; i < n; ++i) {
+        EXPECT_EQ(depth_m_vals[i], static_cast<float>(i) * 0.001f);
+    }
+
+    // Division by a float below 1 is computed in float.
+    core::Tensor u16 = core::Tensor::Init<uint16_t>({0, 3, 1000}, device);
+    core::Tensor half = core::Tensor::Init<float>({0.5f, 0.25f, 0.5f}, device);
+    core::Tensor quotient = u16.Div(half);
+    EXPECT_EQ(quotient.GetDtype(), core::Float32);
+    EXPECT_EQ(quotient.ToFlatVector<float>(),
+              std::vector<float>({0, 12, 2000}));
+
+    // In-place ops cannot change the dtype of the tensor, so an operand that
+    // promotes it is rejected instead of truncating the result.
+    core::Tensor u16_inplace = u16.Clone();
+    EXPECT_ANY_THROW(u16_inplace.Div_(half));
+    EXPECT_ANY_THROW(u16_inplace.Mul_(half));
+    EXPECT_ANY_THROW(u16_inplace.Add_(half));
+    EXPECT_ANY_THROW(u16_inplace.Sub_(half));
+    EXPECT_ANY_THROW(u16_inplace += half);
+    EXPECT_EQ(u16_inplace.ToFlatVector<uint16_t>(),
+              std::vector<uint16_t>({0, 3, 1000}));
+    core::Tensor i32 = core::Tensor::Init<int32_t>({1, 2, 3}, device);
+    EXPECT_ANY_THROW(i32 += core::Tensor::Init<float>({1, 1, 1}, device));
+    core::Tensor u8_inplace = core::Tensor::Init<uint8_t>({1, 2, 3}, device);
+    EXPECT_ANY_THROW(
+            u8_inplace.Add_(core::Tensor::Init<int8_t>({1, 1, 1}, device)));
+    // An operand of a narrower dtype does not promote.
+    i32.Add_(core::Tensor::Init<uint8_t>({10, 20, 30}, device));
+    EXPECT_EQ(i32.GetDtype(), core::Int32);
+    EXPECT_EQ(i32.ToFlatVector<int32_t>(), std::vector<int32_t>({11, 22, 33}));
+    i32.Mul_(core::Tensor::Init<bool>({true, false, true}, device));
+    EXPECT_EQ(i32.ToFlatVector<int32_t>(), std::vector<int32_t>({11, 0, 33}));
+
+    // In-place, and with a broadcasted operand of another dtype.
+    core::Tensor a = core::Tensor::Init<float>({{1, 2, 3}, {4, 5, 6}}, device);
+    a.Add_(core::Tensor::Init<int32_t>({{1, 1, 1}, {2, 2, 2}}, device));
+    EXPECT_EQ(a.ToFlatVector<float>(), std::vector<float>({2, 3, 4, 6, 7, 8}));
+    a.Sub_(core::Tensor::Init<uint8_t>({1, 2, 3}, device));
+    EXPECT_EQ(a.ToFlatVector<float>(), std::vector<float>({1, 1, 1, 5, 5, 5}));
+    core::Tensor u8 = core::Tensor::Init<uint8_t>({{2, 4, 6}, {8, 10, 12}},
+                                                  device);
+    core::Tensor u8_half =
+            u8.Mul(core::Tensor::Init<float>({0.5f, 0.25f, 0.5f}, device));
+    EXPECT_EQ(u8_half.GetDtype(), core::Float32);
+    EXPECT_EQ(u8_half.ToFlatVector<float>(),
+              std::vector<float>({1, 1, 3, 4, 2.5, 6}));
+
+    // A broadcasted float operand promotes the out-of-place Add.
+    core::Tensor e = core::Tensor::Init<int32_t>({{1, 2}, {3, 4}}, device)
+                             .Add(core::Tensor::Init<float>({0.5f, 0.25f},
+                                                            device));
+    EXPECT_EQ(e.GetDtype(), core::Float32);
+    EXPECT_EQ(e.ToFlatVector<float>(),
+              std::vector<float>({1.5, 2.25, 3.5, 4.25}));
+
+    // Integer operands are promoted to a dtype holding both ranges.
+    core::Tensor b = core::Tensor::Init<int32_t>({7, 8}, device);
+    core::Tensor c = b.Div(core::Tensor::Init<float>({2.f, 2.f}, device));
+    EXPECT_EQ(c.GetDtype(), core::Float32);
+    EXPECT_EQ(c.ToFlatVector<float>(), std::vector<float>({3.5, 4}));
+    core::Tensor d = core::Tensor::Init<uint8_t>({200, 255}, device)
+                             .Sub(core::Tensor::Init<int8_t>({-100, 1},
+                                                             device));
+    EXPECT_EQ(d.GetDtype(), core::Int16);
+    EXPECT_EQ(d.ToFlatVector<int16_t>(), std::vector<int16_t>({300, 254}));
+}
+
+TEST(Tensor, PromoteDtypes) {
+    EXPECT_EQ(core::PromoteDtypes(core::UInt16, core::Float32),
+              core::Float32);
+    EXPECT_EQ(core::PromoteDtypes(core::Float32, core::Int64), core::Float32);
+    EXPECT_EQ(core::PromoteDtypes(core::Bool, core::UInt8), core::UInt8);
+    EXPECT_EQ(core::PromoteDtypes(core::Int8, core::Int32), core::Int32);
+    EXPECT_EQ(core::PromoteDtypes(core::UInt8, core::UInt16), core::UInt16);
+    EXPECT_EQ(core::PromoteDtypes(core::UInt8, core::Int8), core::Int16);
+    EXPECT_EQ(core::PromoteDtypes(core::Int32, core::UInt16), core::Int32);
+    EXPECT_EQ(core::PromoteDtypes(core::UInt32, core::Int32), core::Int64);
+    EXPECT_EQ(core::PromoteDtypes(core::UInt64, core::Int8), core::Int64);
+}
+
+TEST_P(TensorPermuteDevices, ToConvert) {
+    core::Device device = GetParam();
+    core::Tensor u16 =
+            core::Tensor::Init<uint16_t>({0, 1, 1000, 65535}, device);
+    EXPECT_EQ(u16.To(core::Float32).ToFlatVector<float>(),
+              std::vector<float>({0, 1, 1000, 65535}));
+    core::Tensor u8 = core::Tensor::Init<uint8_t>({0, 128, 255}, device);
+    EXPECT_EQ(u8.To(core::Float32).ToFlatVector<float>(),
+              std::vector<float>({0, 128, 255}));
+    core::Tensor f = core::Tensor::Init<float>({-2.5f, 0.f, 3.75f}, device);
+    EXPECT_EQ(f.To(core::Int32).ToFlatVector<int32_t>(),
+              std::vector<int32_t>({-2, 0, 3}));
+    EXPECT_EQ(f.To(core::Int32).To(core::Float32).ToFlatVector<float>(),
+              std::vector<float>({-2, 0, 3}));
+}
+
+TEST_P(TensorPermuteDevices, Accessor) {
+    core::Device device = GetParam();
+    core::Tensor t = core::Tensor::Init<float>({{0, 1, 2}, {3, 4, 5}}, device);
+
+    auto acc = t.GetAccessor<float, 2>();
+    EXPECT_EQ(acc.Size(0), 2);
+    EXPECT_EQ(acc.Size(1), 3);
+    EXPECT_EQ(acc(1, 2), 5);
+    acc(0, 1) = 10;
+    EXPECT_EQ(t.ToFlatVector<float>(), std::vector<float>({0, 10, 2, 3, 4, 5}));
+
+    // Strided views are indexed with their own strides.
+    core::Tensor t_t = t.T();
+    auto acc_t = AsConst(t_t).GetAccessor<float, 2>();
+    EXPECT_EQ(acc_t.Size(0), 3);
+    EXPECT_EQ(acc_t(2, 1), 5);
+    EXPECT_EQ(acc_t(1, 0), 10);
+
+    // Dtype and rank must match.
+    EXPECT_ANY_THROW((void)(t.GetAccessor<int32_t, 2>()));
+    EXPECT_ANY_THROW((void)(t.GetAccessor<float, 3>()));
+#if UNIFIED3D_TENSOR_ACCESSOR_CHECKS
+    EXPECT_ANY_THROW(acc(2, 0));
+    EXPECT_ANY_THROW(acc(0, -1));
+#endif
+}
+
+TEST_P(TensorPermuteDevices, Span) {
+    core::Device device = GetParam();
+    core::Tensor t =
+            core::Tensor::Init<int32_t>({{0, 1, 2}, {3, 4, 5}}, device);
+
+    auto span = t.GetSpan<int32_t>();
+    EXPECT_EQ(span.size(), 6);
+    int32_t sum = 0;
+    for (int32_t v : span) {
+        sum += v;
+    }
+    EXPECT_EQ(sum, 15);
+    span[3] = 30;
+    EXPECT_EQ(AsConst(t).GetSpan<int32_t>()[3], 30);
+
+    // Spans require contiguous memory.
+    EXPECT_ANY_THROW((void)t.T().GetSpan<int32_t>());
+    EXPECT_ANY_THROW((void)t.GetSpan<float>());
+#if UNIFIED3D_TENSOR_ACCESSOR_CHECKS
+    EXPECT_ANY_THROW(span[6]);
+#endif
+}
+
 }  // namespace u3d::tests
@@ -0,0 +1,146 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/CompactPointCloud.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// Angle in degrees between two unit vectors.
+double AngleDegrees(const Eigen::Vector3d &a, const Eigen::Vector3d &b) {
+    return std::atan2(a.cross(b).norm(), a.dot(b)) * 180.0 / M_PI;
+}
+
+}  // unnamed namespace
+
+TEST(CompactPointCloud, NormalRoundTrip) {
+    using geometry::CompactPointCloud;
+    std::vector<Eigen::Vector3d> normals(1000);
+    Rand(normals, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1), 0);
+    // Axes and octahedron edges, where the folding changes sign.
+    for (int c = 0; c < 3; ++c) {
+        normals.push_back(Eigen::Vector3d::Unit(c));
+        normals.push_back(-Eigen::Vector3d::Unit(c));
+    }
+    normals.emplace_back(1, -1, 0);
+    normals.emplace_back(-1, 0, -1);
+    normals.emplace_back(0, 1e-30, -1);
+    for (const Eigen::Vector3d &normal : normals) {
+        const Eigen::Vector3d decoded = CompactPointCloud::DecodeNormal(
+                CompactPointCloud::EncodeNormal(normal));
+        EXPECT_NEAR(decoded.norm(), 1.0, 1e-6);
+        EXPECT_LT(AngleDegrees(decoded, normal.normalized()), 0.03);
+    }
+}
+
+TEST(CompactPointCloud, ZeroNormal) {
+    using geometry::CompactPointCloud;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    for (const Eigen::Vector3d &normal :
+         {Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(nan, 0, 1),
+          Eigen::Vector3d(inf, 0, 0)}) {
+        const uint32_t code = CompactPointCloud::EncodeNormal(normal);
+        EXPECT_NE(code, CompactPointCloud::EncodeNormal({0, 0, 1}));
+        EXPECT_EQ(CompactPointCloud::DecodeNormal(code),
+                  Eigen::Vector3d::Zero());
+    }
+
+    // Zero normals stay zero through conversion and rotation.
+    geometry::PointCloud cloud;
+    cloud.points_ = {{0, 0, 0}, {1, 0, 0}};
+    cloud.normals_ = {{0, 0, 0}, {0, 0, 1}};
+    auto compact = CompactPointCloud::CreateFromPointCloud(cloud);
+    compact->Rotate(Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitX())
+                            .toRotationMatrix(),
+                    Eigen::Vector3d::Zero());
+    auto converted = compact->ToPointCloud();
+    EXPECT_EQ(converted->normals_[0], Eigen::Vector3d::Zero());
+    EXPECT_NEAR(converted->normals_[1].norm(), 1.0, 1e-6);
+}
+
+TEST(CompactPointCloud, ColorRoundTrip) {
+    using geometry::CompactPointCloud;
+    std::vector<Eigen::Vector3d> colors(1000);
+    Rand(colors, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 1);
+    for (const Eigen::Vector3d &color : colors) {
+        const Eigen::Vector3d decoded = CompactPointCloud::DecodeColor(
+                CompactPointCloud::EncodeColor(color));
+        EXPECT_LE((decoded - color).cwiseAbs().maxCoeff(), 0.5 / 255 + 1e-12);
+        // Quantized colors are encoded exactly.
+        EXPECT_EQ(CompactPointCloud::EncodeColor(decoded),
+                  CompactPointCloud::EncodeColor(color));
+    }
+    // Out-of-range channels are clamped.
+    EXPECT_EQ(CompactPointCloud::DecodeColor(
+                      CompactPointCloud::EncodeColor({-0.5, 1.5, 1})),
+              Eigen::Vector3d(0, 1, 1));
+}
+
+TEST(CompactPointCloud, PointCloudRoundTrip) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(500);
+    Rand(cloud.points_, Eigen::Vector3d(-10, -10, -10),
+         Eigen::Vector3d(10, 10, 10), 2);
+    cloud.normals_.resize(500);
+    Rand(cloud.normals_, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1),
+         3);
+    for (auto &normal : cloud.normals_) {
+        normal.normalize();
+    }
+    cloud.colors_.resize(500);
+    Rand(cloud.colors_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 4);
+    cloud.covariances_.resize(500);
+    for (size_t i = 0; i < cloud.covariances_.size(); ++i) {
+        const Eigen::Matrix3d a = Eigen::Matrix3d::Random();
+        cloud.covariances_[i] = a * a.transpose();
+    }
+
+    auto compact = geometry::CompactPointCloud::CreateFromPointCloud(cloud);
+    ASSERT_EQ(compact->NumPoints(), cloud.points_.size());
+    EXPECT_TRUE(compact->HasNormals());
+    EXPECT_TRUE(compact->HasColors());
+    EXPECT_TRUE(compact->HasCovariances());
+
+    auto converted = compact->ToPointCloud();
+    ASSERT_EQ(converted->points_.size(), cloud.points_.size());
+    ASSERT_EQ(converted->normals_.size(), cloud.normals_.size());
+    ASSERT_EQ(converted->colors_.size(), cloud.colors_.size());
+    ASSERT_EQ(converted->covariances_.size(), cloud.covariances_.size());
+    for (size_t i = 0; i < cloud.points_.size(); ++i) {
+        EXPECT_EQ(converted->points_[i], cloud.points_[i].cast<float>()
+                                                 .cast<double>()
+                                                 .eval());
+        EXPECT_LT(AngleDegrees(converted->normals_[i], cloud.normals_[i]),
+                  0.03);
+        EXPECT_LE((converted->colors_[i] - cloud.colors_[i])
+                          .cwiseAbs()
+                          .maxCoeff(),
+                  0.5 / 255 + 1e-12);
+        ExpectEQ(converted->covariances_[i], cloud.covariances_[i], 1e-5);
+        EXPECT_EQ(converted->covariances_[i],
+                  converted->covariances_[i].transpose());
+    }
+
+    // Converting the decoded cloud again gives the same compact cloud.
+    auto compact_again =
+            geometry::CompactPointCloud::CreateFromPointCloud(*converted);
+    EXPECT_EQ(compact_again->points_, compact->points_);
+    EXPECT_EQ(compact_again->colors_, compact->colors_);
+    EXPECT_EQ(compact_again->covariances_, compact->covariances_);
+}
+
+}  // namespace u3d::tests
@@ -0,0 +1,168 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/DuplicatedPoints.h"
+
+#include <Eigen/Core>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/geometry/TetraMesh.h"
+#include "unified3d/geometry/TriangleMesh.h"
+
+namespace u3d::tests {
+
+namespace {
+
+const double kNaN = std::numeric_limits<double>::quiet_NaN();
+const double kInf = std::numeric_limits<double>::infinity();
+
+/// Vertices with exact duplicates, a negative zero, NaN and infinite points.
+/// The expected old-to-new map and kept indices are given below.
+const std::vector<Eigen::Vector3d> kVertices = {
+        {0, 0, 0},    {1, 2, 3},    {0, 0, 0},    {kNaN, 0, 0},
+        {kNaN, 0, 0}, {1, 2, 3},    {-0.0, 0, 0}, {kInf, 0, 0},
+        {kInf, 0, 0}, {1, 2, 3.5}};
+const std::vector<size_t> kOldToNew = {0, 1, 0, 2, 3, 1, 0, 4, 4, 5};
+const std::vector<size_t> kKept = {0, 1, 3, 4, 7, 9};
+
+/// Distinct attributes per vertex, so that the remapping can be checked.
+std::vector<Eigen::Vector3d> IndexAttributes(size_t n, double scale) {
+    std::vector<Eigen::Vector3d> attributes;
+    for (size_t i = 0; i < n; ++i) {
+        attributes.emplace_back(scale * double(i), 0, 1);
+    }
+    return attributes;
+}
+
+/// Expects \p values to hold the entries of \p expected at \p kept.
+void ExpectKept(const std::vector<Eigen::Vector3d> &values,
+                const std::vector<Eigen::Vector3d> &expected,
+                const std::vector<size_t> &kept) {
+    ASSERT_EQ(values.size(), kept.size());
+    for (size_t i = 0; i < kept.size(); ++i) {
+        const Eigen::Vector3d &value = expected[kept[i]];
+        // NaN points are compared by position of the NaN.
+        EXPECT_EQ(values[i].array().isNaN().matrix(),
+                  value.array().isNaN().matrix());
+        EXPECT_TRUE((values[i].array() == value.array() ||
+                     value.array().isNaN())
+                            .all());
+    }
+}
+
+}  // unnamed namespace
+
+TEST(DuplicatedPoints, ExactDuplicates) {
+    const auto [old_to_new, kept] = geometry::FindDuplicatedPoints(kVertices);
+    EXPECT_EQ(old_to_new, kOldToNew);
+    EXPECT_EQ(kept, kKept);
+
+    const auto [empty_old_to_new, empty_kept] =
+            geometry::FindDuplicatedPoints({});
+    EXPECT_TRUE(empty_old_to_new.empty());
+    EXPECT_TRUE(empty_kept.empty());
+}
+
+TEST(DuplicatedPoints, Epsilon) {
+    // With a positive epsilon, points in the same cell are duplicates and no
+    // non-finite point is.
+    const std::vector<Eigen::Vector3d> points = {
+            {0.1, 0.1, 0.1}, {0.6, 0, 0},  {0.4, 0.2, 0.3}, {kInf, 0, 0},
+            {kInf, 0, 0},    {-0.1, 0, 0}, {kNaN, 0, 0},    {0.5, 0, 0}};
+    const auto [old_to_new, kept] = geometry::FindDuplicatedPoints(points, 0.5);
+    EXPECT_EQ(old_to_new, std::vector<size_t>({0, 1, 0, 2, 3, 4, 5, 1}));
+    EXPECT_EQ(kept, std::vector<size_t>({0, 1, 3, 4, 5, 6}));
+
+    EXPECT_ANY_THROW(geometry::FindDuplicatedPoints(points, -1.0));
+}
+
+TEST(DuplicatedPoints, MatchesFirstOccurrence) {
+    // Many points on a small integer grid, so that most are duplicates.
+    std::vector<Eigen::Vector3d> points(5000);
+    Rand(points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(6, 6, 6), 0);
+    for (auto &point : points) {
+        point = point.array().floor();
+    }
+
+    std::map<std::tuple<double, double, double>, size_t> first_new_index;
+    std::vector<size_t> old_to_new_ref, kept_ref;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const auto key = std::make_tuple(points[i](0), points[i](1),
+                                         points[i](2));
+        const auto it = first_new_index.emplace(key, kept_ref.size()).first;
+        if (it->second == kept_ref.size()) {
+            kept_ref.push_back(i);
+        }
+        old_to_new_ref.push_back(it->second);
+    }
+
+    const auto [old_to_new, kept] = geometry::FindDuplicatedPoints(points);
+    EXPECT_EQ(old_to_new, old_to_new_ref);
+    EXPECT_EQ(kept, kept_ref);
+}
+
+TEST(DuplicatedPoints, PointCloud) {
+    geometry::PointCloud cloud;
+    cloud.points_ = kVertices;
+    cloud.normals_ = IndexAttributes(kVertices.size(), 1.0);
+    cloud.colors_ = IndexAttributes(kVertices.size(), 0.1);
+    geometry::PointCloud original = cloud;
+
+    EXPECT_EQ(cloud.RemoveDuplicatedPointsAndTrace(), kOldToNew);
+    ExpectKept(cloud.points_, original.points_, kKept);
+    ExpectKept(cloud.normals_, original.normals_, kKept);
+    ExpectKept(cloud.colors_, original.colors_, kKept);
+}
+
+TEST(DuplicatedPoints, TriangleMesh) {
+    geometry::TriangleMesh mesh;
+    mesh.vertices_ = kVertices;
+    mesh.vertex_normals_ = IndexAttributes(kVertices.size(), 1.0);
+    mesh.vertex_colors_ = IndexAttributes(kVertices.size(), 0.1);
+    mesh.triangles_ = {{0, 1, 9}, {2, 5, 9}, {6, 3, 4}, {7, 8, 1}};
+    geometry::TriangleMesh original = mesh;
+
+    mesh.RemoveDuplicatedVertices();
+    ExpectKept(mesh.vertices_, original.vertices_, kKept);
+    ExpectKept(mesh.vertex_normals_, original.vertex_normals_, kKept);
+    ExpectKept(mesh.vertex_colors_, original.vertex_colors_, kKept);
+    ASSERT_EQ(mesh.triangles_.size(), original.triangles_.size());
+    for (size_t i = 0; i < mesh.triangles_.size(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            EXPECT_EQ(size_t(mesh.triangles_[i](j)),
+                      kOldToNew[original.triangles_[i](j)]);
+        }
+    }
+}
+
+TEST(DuplicatedPoints, TetraMesh) {
+    geometry::TetraMesh mesh;
+    mesh.vertices_ = kVertices;
+    mesh.vertex_normals_ = IndexAttributes(kVertices.size(), 1.0);
+    mesh.vertex_colors_ = IndexAttributes(kVertices.size(), 0.1);
+    mesh.tetras_ = {{0, 1, 9, 3}, {2, 5, 9, 4}, {6, 7, 8, 1}};
+    geometry::TetraMesh original = mesh;
+
+    mesh.RemoveDuplicatedVertices();
+    ExpectKept(mesh.vertices_, original.vertices_, kKept);
+    ExpectKept(mesh.vertex_normals_, original.vertex_normals_, kKept);
+    ExpectKept(mesh.vertex_colors_, original.vertex_colors_, kKept);
+    ASSERT_EQ(mesh.tetras_.size(), original.tetras_.size());
+    for (size_t i = 0; i < mesh.tetras_.size(); ++i) {
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_EQ(size_t(mesh.tetras_[i](j)),
+                      kOldToNew[original.tetras_[i](j)]);
+        }
+    }
+}
+
+}  // namespace u3d::tests
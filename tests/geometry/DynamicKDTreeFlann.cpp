@@ -0,0 +1,174 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/DynamicKDTreeFlann.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <vector>
+
+#include "tests/Tests.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// Brute-force search over the points that have not been removed, sorted by
+/// distance.
+std::vector<std::pair<double, int>> BruteForceNeighbors(
+        const std::vector<Eigen::Vector3d> &points,
+        const std::vector<bool> &removed,
+        const Eigen::Vector3d &query) {
+    std::vector<std::pair<double, int>> neighbors;
+    for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+        if (!removed[i]) {
+            neighbors.emplace_back((points[i] - query).squaredNorm(), i);
+        }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    return neighbors;
+}
+
+/// Compares KNN, radius and hybrid searches of \p tree with brute force.
+void ExpectMatchesBruteForce(const geometry::DynamicKDTreeFlann &tree,
+                             const std::vector<Eigen::Vector3d> &points,
+                             const std::vector<bool> &removed,
+                             const std::vector<Eigen::Vector3d> &queries) {
+    const auto num_live = static_cast<size_t>(
+            std::count(removed.begin(), removed.end(), false));
+    EXPECT_EQ(tree.NumPoints(), num_live);
+
+    const int knn = 7;
+    const double radius = 0.2;
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    for (const Eigen::Vector3d &query : queries) {
+        const auto neighbors = BruteForceNeighbors(points, removed, query);
+
+        const int k = tree.SearchKNN(query, knn, indices, distance2);
+        ASSERT_EQ(k, std::min(knn, static_cast<int>(neighbors.size())));
+        for (int i = 0; i < k; ++i) {
+            EXPECT_EQ(indices[i], neighbors[i].second);
+            EXPECT_EQ(distance2[i], neighbors[i].first);
+        }
+
+        int k_radius = 0;
+        while (k_radius < static_cast<int>(neighbors.size()) &&
+               neighbors[k_radius].first < radius * radius) {
+            ++k_radius;
+        }
+        ASSERT_EQ(tree.SearchRadius(query, radius, indices, distance2),
+                  k_radius);
+        for (int i = 0; i < k_radius; ++i) {
+            EXPECT_EQ(indices[i], neighbors[i].second);
+            EXPECT_EQ(distance2[i], neighbors[i].first);
+        }
+
+        ASSERT_EQ(tree.SearchHybrid(query, radius, knn, indices, distance2),
+                  std::min(k_radius, knn));
+        for (int i = 0; i < std::min(k_radius, knn); ++i) {
+            EXPECT_EQ(indices[i], neighbors[i].second);
+        }
+
+        EXPECT_EQ(tree.Search(query, geometry::KDTreeSearchParamKNN(knn),
+                              indices, distance2),
+                  k);
+    }
+}
+
+}  // unnamed namespace
+
+TEST(DynamicKDTreeFlann, Insert) {
+    std::vector<Eigen::Vector3d> points;
+    std::vector<bool> removed;
+    std::vector<Eigen::Vector3d> queries(50);
+    Rand(queries, Eigen::Vector3d(-0.1, -0.1, -0.1),
+         Eigen::Vector3d(1.1, 1.1, 1.1), 0);
+
+    geometry::DynamicKDTreeFlann tree;
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    EXPECT_EQ(tree.SearchKNN(queries[0], 1, indices, distance2), -1);
+    EXPECT_EQ(tree.Insert({}), 0);
+
+    // Batches of varying size so that trees are both kept and merged.
+    for (int batch = 0; batch < 12; ++batch) {
+        std::vector<Eigen::Vector3d> new_points(10 + 37 * (batch % 4));
+        Rand(new_points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1),
+             batch + 1);
+        EXPECT_EQ(tree.Insert(new_points), static_cast<int>(points.size()));
+        points.insert(points.end(), new_points.begin(), new_points.end());
+        removed.resize(points.size(), false);
+        ExpectMatchesBruteForce(tree, points, removed, queries);
+    }
+    EXPECT_GT(tree.NumTrees(), size_t(1));
+    EXPECT_LT(tree.NumTrees(), size_t(12));
+}
+
+TEST(DynamicKDTreeFlann, Remove) {
+    std::vector<Eigen::Vector3d> points(400);
+    Rand(points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 0);
+    std::vector<bool> removed(points.size(), false);
+    std::vector<Eigen::Vector3d> queries(50);
+    Rand(queries, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 1);
+
+    geometry::DynamicKDTreeFlann tree(points);
+    std::vector<Eigen::Vector3d> more_points(150);
+    Rand(more_points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 2);
+    EXPECT_EQ(tree.Insert(more_points), 400);
+    points.insert(points.end(), more_points.begin(), more_points.end());
+    removed.resize(points.size(), false);
+    EXPECT_EQ(tree.NumTrees(), size_t(2));
+
+    // Single removals, including invalid and repeated indices.
+    EXPECT_FALSE(tree.Remove(-1));
+    EXPECT_FALSE(tree.Remove(static_cast<int>(points.size())));
+    for (int i = 0; i < static_cast<int>(points.size()); i += 5) {
+        EXPECT_TRUE(tree.Remove(i));
+        removed[i] = true;
+    }
+    EXPECT_FALSE(tree.Remove(0));
+    ExpectMatchesBruteForce(tree, points, removed, queries);
+
+    // Batch removal of points from both trees.
+    std::vector<int> batch = {-3, 1, 1, 2, 401, 402, 10000};
+    tree.Remove(batch);
+    removed[1] = removed[2] = removed[401] = removed[402] = true;
+    ExpectMatchesBruteForce(tree, points, removed, queries);
+
+    // Removing more than half of the points compacts the forest.
+    std::vector<int> to_remove;
+    for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+        if (i % 3 != 0 && !removed[i]) {
+            to_remove.push_back(i);
+            removed[i] = true;
+        }
+    }
+    tree.Remove(to_remove);
+    EXPECT_EQ(tree.NumTrees(), size_t(1));
+    ExpectMatchesBruteForce(tree, points, removed, queries);
+
+    // Indices are kept after compaction and new points continue from them.
+    std::vector<Eigen::Vector3d> last_points(20);
+    Rand(last_points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 3);
+    EXPECT_EQ(tree.Insert(last_points), static_cast<int>(points.size()));
+    points.insert(points.end(), last_points.begin(), last_points.end());
+    removed.resize(points.size(), false);
+    ExpectMatchesBruteForce(tree, points, removed, queries);
+
+    // Removing everything leaves an empty tree.
+    std::vector<int> all(points.size());
+    for (int i = 0; i < static_cast<int>(all.size()); ++i) {
+        all[i] = i;
+    }
+    tree.Remove(all);
+    EXPECT_EQ(tree.NumPoints(), size_t(0));
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    EXPECT_EQ(tree.SearchKNN(queries[0], 3, indices, distance2), -1);
+}
+
+}  // namespace u3d::tests
@@ -0,0 +1,157 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/HashGrid.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tests/Tests.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// Brute-force radius search with the HashGrid result order.
+void BruteForceRadius(const std::vector<Eigen::Vector3d> &points,
+                      const Eigen::Vector3d &query,
+                      double radius,
+                      std::vector<int> &indices,
+                      std::vector<double> &distance2) {
+    std::vector<std::pair<double, int>> neighbors;
+    for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+        const double d2 = (points[i] - query).squaredNorm();
+        if (d2 < radius * radius) {
+            neighbors.emplace_back(d2, i);
+        }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    indices.clear();
+    distance2.clear();
+    for (const auto &neighbor : neighbors) {
+        distance2.push_back(neighbor.first);
+        indices.push_back(neighbor.second);
+    }
+}
+
+}  // unnamed namespace
+
+TEST(HashGrid, SearchRadius) {
+    std::vector<Eigen::Vector3d> points(2000);
+    Rand(points, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1), 0);
+    std::vector<Eigen::Vector3d> queries(100);
+    Rand(queries, Eigen::Vector3d(-1.2, -1.2, -1.2),
+         Eigen::Vector3d(1.2, 1.2, 1.2), 1);
+
+    geometry::HashGrid grid(points, 0.15);
+    EXPECT_EQ(grid.GetCellSize(), 0.15);
+    EXPECT_GT(grid.NumCells(), size_t(1));
+    std::vector<int> indices, indices_ref;
+    std::vector<double> distance2, distance2_ref;
+    // Radii below, at and above the cell size.
+    for (double radius : {0.1, 0.15, 0.4}) {
+        for (const Eigen::Vector3d &query : queries) {
+            const int k = grid.SearchRadius(query, radius, indices, distance2);
+            BruteForceRadius(points, query, radius, indices_ref,
+                             distance2_ref);
+            EXPECT_EQ(k, static_cast<int>(indices_ref.size()));
+            EXPECT_EQ(indices, indices_ref);
+            EXPECT_EQ(distance2, distance2_ref);
+            EXPECT_EQ(grid.CountRadius(query, radius), k);
+            EXPECT_EQ(grid.CountRadius(query, radius, 3), std::min(k, 3));
+
+            const int k_hybrid =
+                    grid.SearchHybrid(query, radius, 5, indices, distance2);
+            EXPECT_EQ(k_hybrid, std::min(k, 5));
+            EXPECT_TRUE(std::equal(indices.begin(), indices.end(),
+                                   indices_ref.begin()));
+        }
+    }
+}
+
+TEST(HashGrid, Search) {
+    std::vector<Eigen::Vector3d> points(500);
+    Rand(points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 2);
+    geometry::HashGrid grid(points, 0.2);
+    const Eigen::Vector3d query(0.5, 0.5, 0.5);
+    std::vector<int> indices, indices_ref;
+    std::vector<double> distance2, distance2_ref;
+
+    grid.Search(query, geometry::KDTreeSearchParamRadius(0.2), indices,
+                distance2);
+    BruteForceRadius(points, query, 0.2, indices_ref, distance2_ref);
+    EXPECT_EQ(indices, indices_ref);
+    grid.Search(query, geometry::KDTreeSearchParamHybrid(0.2, 4), indices,
+                distance2);
+    EXPECT_EQ(indices, std::vector<int>(indices_ref.begin(),
+                                        indices_ref.begin() + 4));
+    EXPECT_ANY_THROW(grid.Search(query, geometry::KDTreeSearchParamKNN(4),
+                                 indices, distance2));
+}
+
+TEST(HashGrid, LargeRadius) {
+    // The sphere covers more cells than the grid has, so the non-empty cells
+    // are scanned instead.
+    std::vector<Eigen::Vector3d> points(300);
+    Rand(points, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1), 3);
+    geometry::HashGrid grid(points, 0.05);
+    std::vector<int> indices, indices_ref;
+    std::vector<double> distance2, distance2_ref;
+    const Eigen::Vector3d query(0.3, -0.2, 0.1);
+    for (double radius : {1.0, 10.0}) {
+        grid.SearchRadius(query, radius, indices, distance2);
+        BruteForceRadius(points, query, radius, indices_ref, distance2_ref);
+        EXPECT_EQ(indices, indices_ref);
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    EXPECT_EQ(grid.SearchRadius(query, inf, indices, distance2), 300);
+    EXPECT_EQ(grid.CountRadius(query, inf), 300);
+
+    // A query too far away to compute its cell.
+    const Eigen::Vector3d far_query(1e12, 0, 0);
+    EXPECT_EQ(grid.SearchRadius(far_query, 1.0, indices, distance2), 0);
+    EXPECT_EQ(grid.CountRadius(far_query, inf), 300);
+}
+
+TEST(HashGrid, NonFinitePoints) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<Eigen::Vector3d> points{{0, 0, 0},   {nan, 0, 0},
+                                        {0.1, 0, 0}, {0, inf, 0},
+                                        {0, 0, 0.1}, {-inf, nan, 1}};
+    geometry::HashGrid grid(points, 0.5);
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    EXPECT_EQ(grid.SearchRadius(Eigen::Vector3d(0, 0, 0), 1.0, indices,
+                                distance2),
+              3);
+    EXPECT_EQ(indices, std::vector<int>({0, 2, 4}));
+    EXPECT_EQ(grid.CountRadius(Eigen::Vector3d(0, 0, 0), inf), 3);
+
+    // Non-finite queries have no neighbors.
+    EXPECT_EQ(grid.SearchRadius(Eigen::Vector3d(nan, 0, 0), 1.0, indices,
+                                distance2),
+              0);
+    EXPECT_EQ(grid.CountRadius(Eigen::Vector3d(0, inf, 0), 1.0), 0);
+    EXPECT_EQ(grid.CountRadius(Eigen::Vector3d(0, 0, 0), nan), 0);
+}
+
+TEST(HashGrid, InvalidInput) {
+    std::vector<Eigen::Vector3d> points{{0, 0, 0}};
+    EXPECT_ANY_THROW(geometry::HashGrid(points, 0.0));
+    EXPECT_ANY_THROW(geometry::HashGrid(points, -1.0));
+    EXPECT_ANY_THROW(geometry::HashGrid(
+            points, std::numeric_limits<double>::quiet_NaN()));
+    // Cell coordinates would not fit in an int.
+    points.emplace_back(1e10, 0, 0);
+    EXPECT_ANY_THROW(geometry::HashGrid(points, 1e-3));
+    EXPECT_NO_THROW(geometry::HashGrid(points, 1e3));
+}
+
+}  // namespace u3d::tests
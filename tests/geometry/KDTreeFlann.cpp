@@ -0,0 +1,482 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/KDTreeFlann.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "unified3d/core/EigenConverter.h"
+#include "unified3d/core/Tensor.h"
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// Expects row \p i of \p result to hold the neighbors that Search() finds
+/// for \p query.
+template <typename T>
+void ExpectSearchRow(const geometry::KDTreeFlann &tree,
+                     const geometry::KDTreeSearchResult &result,
+                     size_t i,
+                     const T &query,
+                     const geometry::KDTreeSearchParam &param) {
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    const int k = tree.Search(query, param, indices, distance2);
+    ASSERT_EQ(result.NumNeighbors(i), k);
+    const int64_t begin = result.offsets_[i];
+    EXPECT_EQ(std::vector<int>(result.indices_.begin() + begin,
+                               result.indices_.begin() + begin + k),
+              indices);
+    EXPECT_EQ(std::vector<double>(result.distance2_.begin() + begin,
+                                  result.distance2_.begin() + begin + k),
+              distance2);
+}
+
+/// Indices of the \p knn nearest \p points to \p query, nearest first.
+std::vector<int> BruteForceKNN(const std::vector<Eigen::Vector3d> &points,
+                               const Eigen::Vector3d &query,
+                               int knn) {
+    std::vector<std::pair<double, int>> neighbors;
+    for (int i = 0; i < static_cast<int>(points.size()); ++i) {
+        neighbors.emplace_back((points[i] - query).squaredNorm(), i);
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    std::vector<int> indices;
+    for (int i = 0; i < knn && i < static_cast<int>(neighbors.size()); ++i) {
+        indices.push_back(neighbors[i].second);
+    }
+    return indices;
+}
+
+/// Expects the float32 tree neighbors \p indices and \p distance2 of
+/// \p query to match the double precision ones \p indices_ref and
+/// \p distance2_ref up to float32 rounding. Points within \p tolerance of
+/// the search radius may be found by one tree and not the other. Without a
+/// radius, only the distances are compared, as near ties may swap.
+void ExpectFloat32Neighbors(const std::vector<Eigen::Vector3d> &points,
+                            const Eigen::Vector3d &query,
+                            const std::vector<int> &indices,
+                            const std::vector<double> &distance2,
+                            const std::vector<int> &indices_ref,
+                            const std::vector<double> &distance2_ref,
+                            double radius) {
+    const double tolerance = 1e-5;
+    ASSERT_EQ(indices.size(), distance2.size());
+    EXPECT_TRUE(std::is_sorted(distance2.begin(), distance2.end()));
+    for (size_t j = 0; j < indices.size(); ++j) {
+        const double d2 = (points[indices[j]] - query).squaredNorm();
+        EXPECT_NEAR(distance2[j], d2, tolerance);
+        EXPECT_LT(d2, radius * radius + tolerance);
+    }
+    for (size_t j = 0; j < indices_ref.size(); ++j) {
+        if (std::isfinite(radius) &&
+            distance2_ref[j] < radius * radius - tolerance) {
+            EXPECT_NE(std::find(indices.begin(), indices.end(),
+                                indices_ref[j]),
+                      indices.end());
+        }
+    }
+}
+
+/// Number of \p points closer than \p radius to \p query.
+int BruteForceCount(const std::vector<Eigen::Vector3d> &points,
+                    const Eigen::Vector3d &query,
+                    double radius) {
+    int count = 0;
+    for (const Eigen::Vector3d &point : points) {
+        count += (point - query).squaredNorm() < radius * radius;
+    }
+    return count;
+}
+
+}  // unnamed namespace
+
+TEST(KDTreeFlann, SearchBatch) {
+    // More queries than one block, so that several blocks are concatenated.
+    geometry::PointCloud cloud;
+    cloud.points_.resize(2000);
+    Rand(cloud.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 0);
+    std::vector<Eigen::Vector3d> queries(700);
+    Rand(queries, Eigen::Vector3d(-0.1, -0.1, -0.1),
+         Eigen::Vector3d(1.1, 1.1, 1.1), 1);
+    const geometry::KDTreeFlann tree(cloud);
+
+    const geometry::KDTreeSearchParamKNN knn(7);
+    const geometry::KDTreeSearchParamRadius radius(0.08);
+    const geometry::KDTreeSearchParamHybrid hybrid(0.08, 5);
+    for (const geometry::KDTreeSearchParam *param :
+         std::vector<const geometry::KDTreeSearchParam *>{&knn, &radius,
+                                                          &hybrid}) {
+        const geometry::KDTreeSearchResult result =
+                tree.SearchBatch(queries, *param);
+        ASSERT_EQ(result.NumQueries(), queries.size());
+        EXPECT_EQ(result.offsets_.front(), 0);
+        EXPECT_EQ(result.offsets_.back(), int64_t(result.indices_.size()));
+        EXPECT_EQ(result.distance2_.size(), result.indices_.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            ExpectSearchRow(tree, result, i, queries[i], *param);
+        }
+    }
+    // Radius queries outside the cloud have no neighbors.
+    const geometry::KDTreeSearchResult radius_result =
+            tree.SearchBatch(queries, radius);
+    size_t num_empty = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        num_empty += radius_result.NumNeighbors(i) == 0;
+    }
+    EXPECT_GT(num_empty, size_t(0));
+
+    // Float32 tensor queries are searched at their float32 coordinates.
+    const core::Tensor queries_tensor =
+            core::eigen_converter::EigenVector3dVectorToTensorCopy(
+                    queries, core::Float32);
+    const geometry::KDTreeSearchResult tensor_result =
+            tree.SearchBatch(queries_tensor, knn);
+    ASSERT_EQ(tensor_result.NumQueries(), queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const Eigen::Vector3d query = queries[i].cast<float>().cast<double>();
+        ExpectSearchRow(tree, tensor_result, i, query, knn);
+    }
+
+    EXPECT_EQ(tree.SearchBatch(std::vector<Eigen::Vector3d>(), knn).offsets_,
+              std::vector<int64_t>({0}));
+}
+
+TEST(KDTreeFlann, SearchBatchMatrix) {
+    // Points of another dimension go through the generic tree.
+    Eigen::MatrixXd data(5, 1000);
+    Rand(data.data(), data.size(), 0.0, 1.0, 2);
+    Eigen::MatrixXd queries(5, 300);
+    Rand(queries.data(), queries.size(), 0.0, 1.0, 3);
+    const geometry::KDTreeFlann tree(data);
+
+    const geometry::KDTreeSearchParamKNN knn(4);
+    const geometry::KDTreeSearchParamRadius radius(0.3);
+    for (const geometry::KDTreeSearchParam *param :
+         std::vector<const geometry::KDTreeSearchParam *>{&knn, &radius}) {
+        const geometry::KDTreeSearchResult result =
+                tree.SearchBatch(queries, *param);
+        ASSERT_EQ(result.NumQueries(), size_t(queries.cols()));
+        for (Eigen::Index i = 0; i < queries.cols(); ++i) {
+            ExpectSearchRow(tree, result, size_t(i),
+                            Eigen::VectorXd(queries.col(i)), *param);
+        }
+    }
+}
+
+TEST(KDTreeFlann, SearchKNNBatch) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(1500);
+    Rand(cloud.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 4);
+    std::vector<Eigen::Vector3d> queries(600);
+    Rand(queries, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 5);
+    const geometry::KDTreeFlann tree(cloud);
+
+    const int knn = 6;
+    std::vector<int> indices, indices_ref;
+    std::vector<double> distance2, distance2_ref;
+    tree.SearchKNNBatch(queries, knn, indices, distance2);
+    ASSERT_EQ(indices.size(), queries.size() * knn);
+    ASSERT_EQ(distance2.size(), queries.size() * knn);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ASSERT_EQ(tree.SearchKNN(queries[i], knn, indices_ref, distance2_ref),
+                  knn);
+        EXPECT_EQ(std::vector<int>(indices.begin() + i * knn,
+                                   indices.begin() + (i + 1) * knn),
+                  indices_ref);
+        EXPECT_EQ(std::vector<double>(distance2.begin() + i * knn,
+                                      distance2.begin() + (i + 1) * knn),
+                  distance2_ref);
+    }
+
+    Eigen::MatrixXd queries_matrix(3, queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        queries_matrix.col(Eigen::Index(i)) = queries[i];
+    }
+    std::vector<int> indices_matrix;
+    std::vector<double> distance2_matrix;
+    tree.SearchKNNBatch(queries_matrix, knn, indices_matrix, distance2_matrix);
+    EXPECT_EQ(indices_matrix, indices);
+    EXPECT_EQ(distance2_matrix, distance2);
+
+    tree.SearchKNNBatch(queries, 0, indices, distance2);
+    EXPECT_TRUE(indices.empty());
+    EXPECT_TRUE(distance2.empty());
+    EXPECT_ANY_THROW(tree.SearchKNNBatch(queries, -1, indices, distance2));
+}
+
+TEST(KDTreeFlann, SearchKNNBatchPadding) {
+    // Fewer points than knn pad each row with -1 and infinity.
+    geometry::PointCloud cloud;
+    cloud.points_ = {{0, 0, 0}, {1, 0, 0}, {0, 2, 0}};
+    const geometry::KDTreeFlann tree(cloud);
+    const std::vector<Eigen::Vector3d> queries = {{0.1, 0, 0}, {0, 3, 0}};
+    const double inf = std::numeric_limits<double>::infinity();
+
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    tree.SearchKNNBatch(queries, 5, indices, distance2);
+    EXPECT_EQ(indices, std::vector<int>({0, 1, 2, -1, -1, 2, 0, 1, -1, -1}));
+    ASSERT_EQ(distance2.size(), size_t(10));
+    EXPECT_NEAR(distance2[0], 0.01, 1e-12);
+    EXPECT_NEAR(distance2[1], 0.81, 1e-12);
+    EXPECT_NEAR(distance2[2], 4.01, 1e-12);
+    EXPECT_EQ(distance2[3], inf);
+    EXPECT_EQ(distance2[4], inf);
+    EXPECT_NEAR(distance2[5], 1.0, 1e-12);
+    EXPECT_NEAR(distance2[6], 9.0, 1e-12);
+    EXPECT_NEAR(distance2[7], 10.0, 1e-12);
+    EXPECT_EQ(distance2[8], inf);
+    EXPECT_EQ(distance2[9], inf);
+}
+
+TEST(KDTreeFlann, SearchBatchFailedQuery) {
+    const std::vector<Eigen::Vector3d> queries = {{0, 0, 0}, {1, 1, 1}};
+    std::vector<int> indices;
+    std::vector<double> distance2;
+
+    // Empty tree.
+    const geometry::KDTreeFlann empty_tree;
+    EXPECT_ANY_THROW((void)empty_tree.SearchBatch(
+            queries, geometry::KDTreeSearchParamKNN(1)));
+    EXPECT_ANY_THROW(empty_tree.SearchKNNBatch(queries, 1, indices, distance2));
+
+    // Queries of the wrong dimension.
+    Eigen::MatrixXd data(3, 10);
+    Rand(data.data(), data.size(), 0.0, 1.0, 6);
+    const geometry::KDTreeFlann tree(data);
+    const Eigen::MatrixXd queries_2d = Eigen::MatrixXd::Zero(2, 4);
+    EXPECT_ANY_THROW((void)tree.SearchBatch(
+            queries_2d, geometry::KDTreeSearchParamRadius(0.5)));
+    EXPECT_ANY_THROW(tree.SearchKNNBatch(queries_2d, 2, indices, distance2));
+
+    // Invalid search parameters.
+    EXPECT_ANY_THROW((void)tree.SearchBatch(
+            queries, geometry::KDTreeSearchParamKNN(-1)));
+    EXPECT_ANY_THROW((void)tree.SearchBatch(
+            queries, geometry::KDTreeSearchParamHybrid(0.5, -1)));
+    EXPECT_NO_THROW((void)tree.SearchBatch(
+            queries, geometry::KDTreeSearchParamHybrid(0.5, 2)));
+}
+
+TEST(KDTreeFlann, Float32) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(3000);
+    Rand(cloud.points_, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1),
+         7);
+    std::vector<Eigen::Vector3d> queries(300);
+    Rand(queries, Eigen::Vector3d(-1.2, -1.2, -1.2),
+         Eigen::Vector3d(1.2, 1.2, 1.2), 8);
+    const geometry::KDTreeFlann tree(cloud);
+    const geometry::KDTreeFlann tree_f32(
+            cloud, geometry::KDTreeFlann::Precision::Float32);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    const double radius = 0.2;
+    std::vector<int> indices, indices_ref;
+    std::vector<double> distance2, distance2_ref;
+    for (const Eigen::Vector3d &query : queries) {
+        const int knn = 8;
+        ASSERT_EQ(tree_f32.SearchKNN(query, knn, indices, distance2), knn);
+        ASSERT_EQ(tree.SearchKNN(query, knn, indices_ref, distance2_ref), knn);
+        ExpectFloat32Neighbors(cloud.points_, query, indices, distance2,
+                               indices_ref, distance2_ref, inf);
+        for (int j = 0; j < knn; ++j) {
+            EXPECT_NEAR(distance2[j], distance2_ref[j], 1e-5);
+        }
+
+        tree_f32.SearchRadius(query, radius, indices, distance2);
+        tree.SearchRadius(query, radius, indices_ref, distance2_ref);
+        ExpectFloat32Neighbors(cloud.points_, query, indices, distance2,
+                               indices_ref, distance2_ref, radius);
+
+        const geometry::KDTreeSearchParamHybrid hybrid(radius, 5);
+        tree_f32.Search(query, hybrid, indices, distance2);
+        tree.Search(query, hybrid, indices_ref, distance2_ref);
+        EXPECT_LE(indices.size(), size_t(5));
+        ExpectFloat32Neighbors(cloud.points_, query, indices, distance2,
+                               indices_ref, distance2_ref, radius);
+    }
+
+    // The batch searches use the float32 tree too.
+    const geometry::KDTreeSearchResult result =
+            tree_f32.SearchBatch(queries, geometry::KDTreeSearchParamKNN(3));
+    for (size_t i = 0; i < queries.size(); ++i) {
+        ExpectSearchRow(tree_f32, result, i, queries[i],
+                        geometry::KDTreeSearchParamKNN(3));
+    }
+}
+
+TEST(KDTreeFlann, RebuildAfterModifyingGeometry) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(500);
+    Rand(cloud.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 9);
+    const std::vector<Eigen::Vector3d> original_points = cloud.points_;
+    geometry::KDTreeFlann tree(cloud);
+    const geometry::KDTreeFlann tree_f32(
+            cloud, geometry::KDTreeFlann::Precision::Float32);
+    std::vector<Eigen::Vector3d> queries(50);
+    Rand(queries, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 10);
+
+    // Move the points and add more, which reallocates the storage the
+    // double precision tree refers to.
+    for (Eigen::Vector3d &point : cloud.points_) {
+        point = Eigen::Vector3d(1, 1, 1) - point;
+    }
+    std::vector<Eigen::Vector3d> more_points(1500);
+    Rand(more_points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 11);
+    cloud.points_.insert(cloud.points_.end(), more_points.begin(),
+                         more_points.end());
+    ASSERT_TRUE(tree.SetGeometry(cloud));
+
+    std::vector<int> indices;
+    std::vector<double> distance2;
+    for (const Eigen::Vector3d &query : queries) {
+        ASSERT_EQ(tree.SearchKNN(query, 4, indices, distance2), 4);
+        EXPECT_EQ(indices, BruteForceKNN(cloud.points_, query, 4));
+        for (int j = 0; j < 4; ++j) {
+            EXPECT_NEAR(distance2[j],
+                        (cloud.points_[indices[j]] - query).squaredNorm(),
+                        1e-12);
+        }
+
+        // The float32 tree searches its copy of the original points.
+        ASSERT_EQ(tree_f32.SearchKNN(query, 1, indices, distance2), 1);
+        EXPECT_EQ(indices, BruteForceKNN(original_points, query, 1));
+    }
+
+    // Rebuilding from an emptied geometry fails and leaves an empty tree.
+    cloud.points_.clear();
+    EXPECT_FALSE(tree.SetGeometry(cloud));
+    EXPECT_EQ(tree.SearchKNN(queries[0], 1, indices, distance2), -1);
+}
+
+TEST(KDTreeFlann, CountRadius) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(2000);
+    Rand(cloud.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 12);
+    const geometry::KDTreeFlann tree(cloud);
+    const geometry::KDTreeFlann tree_f32(
+            cloud, geometry::KDTreeFlann::Precision::Float32);
+    // A matrix tree uses the generic index, not the 3D one.
+    const geometry::KDTreeFlann tree_matrix(Eigen::MatrixXd(
+            Eigen::Map<const Eigen::MatrixXd>(cloud.points_[0].data(), 3,
+                                              cloud.points_.size())));
+    std::vector<Eigen::Vector3d> queries(50);
+    Rand(queries, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 13);
+    // Points count themselves, as their distance 0 is below any radius.
+    queries.insert(queries.end(), cloud.points_.begin(),
+                   cloud.points_.begin() + 10);
+
+    for (const Eigen::Vector3d &query : queries) {
+        for (double radius : {0.01, 0.05, 0.2}) {
+            const int count = BruteForceCount(cloud.points_, query, radius);
+            EXPECT_EQ(tree.CountRadius(query, radius), count);
+            EXPECT_EQ(tree_matrix.CountRadius(Eigen::VectorXd(query), radius),
+                      count);
+            // Points within float32 rounding of the radius may be counted
+            // or not.
+            const int count_f32 = tree_f32.CountRadius(query, radius);
+            EXPECT_GE(count_f32,
+                      BruteForceCount(cloud.points_, query, radius - 1e-5));
+            EXPECT_LE(count_f32,
+                      BruteForceCount(cloud.points_, query, radius + 1e-5));
+
+            // The search stops at max_count.
+            for (int max_count : {0, 1, 3, count, count + 1}) {
+                EXPECT_EQ(tree.CountRadius(query, radius, max_count),
+                          std::min(count, max_count));
+                EXPECT_EQ(tree_matrix.CountRadius(Eigen::VectorXd(query),
+                                                  radius, max_count),
+                          std::min(count, max_count));
+            }
+
+            std::vector<int> indices;
+            std::vector<double> distance2;
+            EXPECT_EQ(tree.SearchRadius(query, radius, indices, distance2),
+                      count);
+        }
+    }
+
+    EXPECT_EQ(tree.CountRadius(cloud.points_[0], 0.0), 0);
+    EXPECT_EQ(tree_matrix.CountRadius(Eigen::VectorXd::Zero(2), 0.1), -1);
+    EXPECT_EQ(geometry::KDTreeFlann().CountRadius(queries[0], 0.1), -1);
+}
+
+TEST(KDTreeFlann, SearchNearest) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(2000);
+    Rand(cloud.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 14);
+    const geometry::KDTreeFlann tree(cloud);
+    const geometry::KDTreeFlann tree_f32(
+            cloud, geometry::KDTreeFlann::Precision::Float32);
+    const geometry::KDTreeFlann tree_matrix(Eigen::MatrixXd(
+            Eigen::Map<const Eigen::MatrixXd>(cloud.points_[0].data(), 3,
+                                              cloud.points_.size())));
+    std::vector<Eigen::Vector3d> queries(100);
+    Rand(queries, Eigen::Vector3d(-0.5, -0.5, -0.5),
+         Eigen::Vector3d(1.5, 1.5, 1.5), 15);
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    for (const Eigen::Vector3d &query : queries) {
+        const int nearest = BruteForceKNN(cloud.points_, query, 1)[0];
+        const double nearest_distance2 =
+                (cloud.points_[nearest] - query).squaredNorm();
+        const double nearest_distance = std::sqrt(nearest_distance2);
+        int index = -1;
+        double distance2 = -1.0;
+        for (double radius : {infinity, 1.01 * nearest_distance}) {
+            ASSERT_EQ(tree.SearchNearest(query, radius, index, distance2), 1);
+            EXPECT_EQ(index, nearest);
+            EXPECT_NEAR(distance2, nearest_distance2, 1e-12);
+            ASSERT_EQ(tree_matrix.SearchNearest(Eigen::VectorXd(query), radius,
+                                                index, distance2),
+                      1);
+            EXPECT_EQ(index, nearest);
+            EXPECT_NEAR(distance2, nearest_distance2, 1e-12);
+            ASSERT_EQ(tree_f32.SearchNearest(query, radius, index, distance2),
+                      1);
+            EXPECT_NEAR(distance2, nearest_distance2, 1e-5);
+            EXPECT_NEAR((cloud.points_[index] - query).squaredNorm(),
+                        nearest_distance2, 1e-5);
+        }
+
+        // Nothing is closer than the nearest point, and the outputs are left
+        // untouched.
+        index = -1;
+        distance2 = -1.0;
+        const double radius = 0.99 * nearest_distance;
+        EXPECT_EQ(tree.SearchNearest(query, radius, index, distance2), 0);
+        EXPECT_EQ(tree_matrix.SearchNearest(Eigen::VectorXd(query), radius,
+                                            index, distance2),
+                  0);
+        EXPECT_EQ(tree_f32.SearchNearest(query, radius, index, distance2), 0);
+        EXPECT_EQ(index, -1);
+        EXPECT_EQ(distance2, -1.0);
+    }
+
+    int index;
+    double distance2;
+    EXPECT_EQ(tree.SearchNearest(cloud.points_[3], 0.0, index, distance2), 0);
+    ASSERT_EQ(tree.SearchNearest(cloud.points_[3], 1e-9, index, distance2), 1);
+    EXPECT_EQ(index, 3);
+    EXPECT_EQ(distance2, 0.0);
+    EXPECT_EQ(tree_matrix.SearchNearest(Eigen::VectorXd::Zero(2), 0.1, index,
+                                        distance2),
+              -1);
+    EXPECT_EQ(geometry::KDTreeFlann().SearchNearest(queries[0], 0.1, index,
+                                                    distance2),
+              -1);
+}
+
+}  // namespace u3d::tests
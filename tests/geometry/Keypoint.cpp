@@ -0,0 +1,94 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/Keypoint.h"
+
+#include <Eigen/Core>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "tests/test_utility/HeightField.h"
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// A noisy height field, with points identified by their colors.
+geometry::PointCloud MakeSurface(int seed) {
+    geometry::PointCloud cloud =
+            SampleHeightField(6000, seed, Eigen::Vector2d(3, 3), 2.0, 0.02);
+    for (size_t i = 0; i < cloud.points_.size(); ++i) {
+        cloud.colors_.emplace_back(double(i), 0, 0);
+    }
+    return cloud;
+}
+
+}  // unnamed namespace
+
+TEST(ISSKeypoints, ReusedNeighborhoods) {
+    // With equal radii, the salient neighborhoods are reused for the non
+    // maxima suppression. A non maxima radius one ulp larger finds the same
+    // neighborhoods with a second search.
+    const geometry::PointCloud cloud = MakeSurface(50);
+    const double radius = 0.15;
+    const double searched_radius =
+            std::nextafter(radius, std::numeric_limits<double>::infinity());
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        for (int min_neighbors : {5, 20}) {
+            const auto reused = geometry::keypoint::ComputeISSKeypoints(
+                    cloud, radius, radius, 0.975, 0.975, min_neighbors,
+                    backend);
+            const auto searched = geometry::keypoint::ComputeISSKeypoints(
+                    cloud, radius, searched_radius, 0.975, 0.975,
+                    min_neighbors, backend);
+            EXPECT_GT(reused->points_.size(), size_t(0));
+            EXPECT_LT(reused->points_.size(), cloud.points_.size());
+            EXPECT_EQ(reused->colors_, searched->colors_);
+            EXPECT_EQ(reused->points_, searched->points_);
+        }
+    }
+}
+
+TEST(ISSKeypoints, ThreadCountIndependent) {
+    // More points than the grain size of both passes, so that they run in
+    // parallel.
+    const geometry::PointCloud cloud = MakeSurface(51);
+    // Computed radii, equal radii that reuse the neighborhoods, and different
+    // radii that search them again.
+    const std::vector<std::pair<double, double>> radii = {
+            {0.0, 0.0}, {0.15, 0.15}, {0.15, 0.1}};
+
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        for (const auto &radius : radii) {
+            auto compute = [&] {
+                return geometry::keypoint::ComputeISSKeypoints(
+                        cloud, radius.first, radius.second, 0.975, 0.975, 5,
+                        backend);
+            };
+            const auto serial = [&] {
+                ScopedMaxNumberOfThreads serial_threads(1);
+                return compute();
+            }();
+            EXPECT_GT(serial->points_.size(), size_t(0));
+            ForEachThreadCount([&] {
+                const auto parallel = compute();
+                EXPECT_EQ(parallel->colors_, serial->colors_);
+                EXPECT_EQ(parallel->points_, serial->points_);
+            });
+        }
+    }
+
+    EXPECT_TRUE(geometry::keypoint::ComputeISSKeypoints(geometry::PointCloud())
+                        ->IsEmpty());
+}
+
+}  // namespace u3d::tests
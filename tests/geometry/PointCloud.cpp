@@ -0,0 +1,1077 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/PointCloud.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "tests/test_utility/HeightField.h"
+#include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/HashGrid.h"
+#include "unified3d/utility/Random.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// The serial DBSCAN that grows one cluster at a time in index order.
+std::vector<int> ReferenceClusterDBSCAN(
+        const std::vector<Eigen::Vector3d> &points,
+        double eps,
+        size_t min_points) {
+    const int num_points = static_cast<int>(points.size());
+    std::vector<std::vector<int>> nbs(num_points);
+    for (int i = 0; i < num_points; ++i) {
+        for (int j = 0; j < num_points; ++j) {
+            if ((points[i] - points[j]).squaredNorm() < eps * eps) {
+                nbs[i].push_back(j);
+            }
+        }
+    }
+
+    // -2 is undefined, -1 is noise.
+    std::vector<int> labels(num_points, -2);
+    int cluster_label = 0;
+    for (int idx = 0; idx < num_points; ++idx) {
+        if (labels[idx] != -2) {
+            continue;
+        }
+        if (nbs[idx].size() < min_points) {
+            labels[idx] = -1;
+            continue;
+        }
+        std::set<int> nbs_next(nbs[idx].begin(), nbs[idx].end());
+        std::set<int> nbs_visited = {idx};
+        labels[idx] = cluster_label;
+        while (!nbs_next.empty()) {
+            const int nb = *nbs_next.begin();
+            nbs_next.erase(nbs_next.begin());
+            nbs_visited.insert(nb);
+            if (labels[nb] == -1) {
+                labels[nb] = cluster_label;
+            }
+            if (labels[nb] != -2) {
+                continue;
+            }
+            labels[nb] = cluster_label;
+            if (nbs[nb].size() >= min_points) {
+                for (int qnb : nbs[nb]) {
+                    if (nbs_visited.count(qnb) == 0) {
+                        nbs_next.insert(qnb);
+                    }
+                }
+            }
+        }
+        ++cluster_label;
+    }
+    return labels;
+}
+
+/// The serial farthest point sampling that scans all points per sample.
+std::vector<size_t> ReferenceFarthestPointSample(
+        const std::vector<Eigen::Vector3d> &points,
+        size_t num_samples,
+        size_t start_index) {
+    std::vector<size_t> selected_indices;
+    std::vector<double> distances(points.size(),
+                                  std::numeric_limits<double>::infinity());
+    size_t farthest_index = start_index;
+    for (size_t i = 0; i < num_samples; i++) {
+        selected_indices.push_back(farthest_index);
+        const Eigen::Vector3d selected = points[farthest_index];
+        double max_dist = 0;
+        for (size_t j = 0; j < points.size(); j++) {
+            distances[j] = std::min(distances[j],
+                                    (points[j] - selected).squaredNorm());
+            if (distances[j] > max_dist) {
+                max_dist = distances[j];
+                farthest_index = j;
+            }
+        }
+    }
+    return selected_indices;
+}
+
+/// Original indices of the points of each voxel, in increasing order, with
+/// the voxels ordered by their (x, y, z) voxel index.
+std::vector<std::vector<int>> ReferenceVoxelGroups(
+        const std::vector<Eigen::Vector3d> &points,
+        const Eigen::Vector3d &voxel_min_bound,
+        double voxel_size) {
+    std::map<std::tuple<int, int, int>, std::vector<int>> voxels;
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Eigen::Vector3d coord =
+                (points[i] - voxel_min_bound) / voxel_size;
+        voxels[{int(std::floor(coord(0))), int(std::floor(coord(1))),
+                int(std::floor(coord(2)))}]
+                .push_back(int(i));
+    }
+    std::vector<std::vector<int>> groups;
+    for (const auto &voxel : voxels) {
+        groups.push_back(voxel.second);
+    }
+    return groups;
+}
+
+/// Expects \p output to hold the attributes of \p cloud averaged over
+/// \p groups. With \p approximate_class the most frequent color label of
+/// each voxel is expected instead, ties going to the smallest label.
+void ExpectVoxelAverages(const geometry::PointCloud &cloud,
+                         const std::vector<std::vector<int>> &groups,
+                         const geometry::PointCloud &output,
+                         bool approximate_class = false) {
+    ASSERT_EQ(output.points_.size(), groups.size());
+    ASSERT_EQ(output.HasNormals(), cloud.HasNormals());
+    ASSERT_EQ(output.HasColors(), cloud.HasColors());
+    ASSERT_EQ(output.HasCovariances(), cloud.HasCovariances());
+    for (size_t v = 0; v < groups.size(); ++v) {
+        const auto n = double(groups[v].size());
+        Eigen::Vector3d point = Eigen::Vector3d::Zero();
+        Eigen::Vector3d normal = Eigen::Vector3d::Zero();
+        Eigen::Vector3d color = Eigen::Vector3d::Zero();
+        Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+        std::map<int, int> class_counts;
+        for (int i : groups[v]) {
+            point += cloud.points_[i];
+            if (cloud.HasNormals()) normal += cloud.normals_[i];
+            if (cloud.HasColors()) {
+                color += cloud.colors_[i];
+                ++class_counts[int(cloud.colors_[i](0))];
+            }
+            if (cloud.HasCovariances()) covariance += cloud.covariances_[i];
+        }
+        EXPECT_EQ(output.points_[v], point / n);
+        if (cloud.HasNormals()) {
+            EXPECT_EQ(output.normals_[v], normal / n);
+        }
+        if (cloud.HasColors() && approximate_class) {
+            int max_class = -1;
+            int max_count = 0;
+            for (const auto &[label, count] : class_counts) {
+                if (count > max_count) {
+                    max_count = count;
+                    max_class = label;
+                }
+            }
+            EXPECT_EQ(output.colors_[v], Eigen::Vector3d::Constant(max_class));
+        } else if (cloud.HasColors()) {
+            EXPECT_EQ(output.colors_[v], color / n);
+        }
+        if (cloud.HasCovariances()) {
+            EXPECT_EQ(output.covariances_[v], covariance / n);
+        }
+    }
+}
+
+/// Flattens \p groups into compressed sparse row offsets and indices.
+std::pair<std::vector<int64_t>, std::vector<int>> ToCSR(
+        const std::vector<std::vector<int>> &groups) {
+    std::vector<int64_t> offsets = {0};
+    std::vector<int> indices;
+    for (const auto &group : groups) {
+        indices.insert(indices.end(), group.begin(), group.end());
+        offsets.push_back(int64_t(indices.size()));
+    }
+    return {offsets, indices};
+}
+
+/// Points exactly on the plane \p plane, with every third point replaced by
+/// an outlier at least 0.1 away from it. Returns the cloud and the indices of
+/// the points on the plane.
+std::tuple<geometry::PointCloud, std::vector<size_t>> MakePlaneWithOutliers(
+        const Eigen::Vector4d &plane, size_t num_points, int seed) {
+    std::vector<Eigen::Vector3d> samples(num_points);
+    Rand(samples, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1), seed);
+    geometry::PointCloud cloud;
+    std::vector<size_t> plane_indices;
+    for (size_t i = 0; i < num_points; ++i) {
+        Eigen::Vector3d point = samples[i];
+        const double distance = plane.head<3>().dot(point) + plane(3);
+        if (i % 3 == 2) {
+            if (std::abs(distance) < 0.1) {
+                point += (distance < 0 ? -0.2 : 0.2) * plane.head<3>();
+            }
+        } else {
+            point -= distance * plane.head<3>();
+            plane_indices.push_back(i);
+        }
+        cloud.points_.push_back(point);
+    }
+    return {cloud, plane_indices};
+}
+
+/// Squared distance, summed in the same order as the search trees.
+double SquaredDistance(const Eigen::Vector3d &a, const Eigen::Vector3d &b) {
+    const Eigen::Vector3d d = a - b;
+    return d(0) * d(0) + d(1) * d(1) + d(2) * d(2);
+}
+
+/// Points with more than \p nb_points points closer than \p radius, the
+/// point itself included.
+std::vector<size_t> ReferenceRadiusInliers(
+        const std::vector<Eigen::Vector3d> &points,
+        size_t nb_points,
+        double radius) {
+    std::vector<size_t> inliers;
+    for (size_t i = 0; i < points.size(); ++i) {
+        size_t count = 0;
+        for (const Eigen::Vector3d &point : points) {
+            count += SquaredDistance(points[i], point) < radius * radius;
+        }
+        if (count > nb_points) {
+            inliers.push_back(i);
+        }
+    }
+    return inliers;
+}
+
+/// Points whose mean distance to their \p nb_neighbors nearest points, the
+/// point itself included, is positive and below the mean plus \p std_ratio
+/// standard deviations of those distances.
+std::vector<size_t> ReferenceStatisticalInliers(
+        const std::vector<Eigen::Vector3d> &points,
+        size_t nb_neighbors,
+        double std_ratio) {
+    std::vector<double> avg_distances;
+    for (const Eigen::Vector3d &query : points) {
+        std::vector<double> distance2;
+        for (const Eigen::Vector3d &point : points) {
+            distance2.push_back(SquaredDistance(query, point));
+        }
+        std::sort(distance2.begin(), distance2.end());
+        distance2.resize(std::min(nb_neighbors, distance2.size()));
+        double sum = 0.0;
+        for (double d2 : distance2) {
+            sum += std::sqrt(d2);
+        }
+        avg_distances.push_back(sum / double(distance2.size()));
+    }
+    double mean = 0.0;
+    for (double avg : avg_distances) {
+        mean += avg;
+    }
+    mean /= double(avg_distances.size());
+    double sq_sum = 0.0;
+    for (double avg : avg_distances) {
+        // Points with duplicates have a zero mean distance and are ignored.
+        if (avg > 0) {
+            sq_sum += (avg - mean) * (avg - mean);
+        }
+    }
+    const double threshold =
+            mean + std_ratio * std::sqrt(sq_sum / double(points.size() - 1));
+    std::vector<size_t> inliers;
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (avg_distances[i] > 0 && avg_distances[i] < threshold) {
+            inliers.push_back(i);
+        }
+    }
+    return inliers;
+}
+
+/// Dense blobs on a sparse background, with attributes that identify the
+/// points.
+geometry::PointCloud MakeBlobsWithOutliers(int seed) {
+    geometry::PointCloud cloud;
+    const std::vector<Eigen::Vector3d> centers = {
+            {0, 0, 0}, {1, 0, 0}, {0, 1, 1}};
+    for (size_t c = 0; c < centers.size(); ++c) {
+        std::vector<Eigen::Vector3d> blob(500);
+        Rand(blob, centers[c] - Eigen::Vector3d::Constant(0.15),
+             centers[c] + Eigen::Vector3d::Constant(0.15), seed + int(c));
+        cloud.points_.insert(cloud.points_.end(), blob.begin(), blob.end());
+    }
+    std::vector<Eigen::Vector3d> background(300);
+    Rand(background, Eigen::Vector3d(-0.5, -0.5, -0.5),
+         Eigen::Vector3d(1.5, 1.5, 1.5), seed + 10);
+    // Interleave the background with the blobs.
+    for (size_t i = 0; i < background.size(); ++i) {
+        cloud.points_.insert(cloud.points_.begin() + 5 * i, background[i]);
+    }
+    for (size_t i = 0; i < cloud.points_.size(); ++i) {
+        cloud.colors_.emplace_back(double(i), 0, 0);
+    }
+    return cloud;
+}
+
+/// Distances from each of \p points to the nearest of \p target.
+std::vector<double> ReferenceNearestDistances(
+        const std::vector<Eigen::Vector3d> &points,
+        const std::vector<Eigen::Vector3d> &target) {
+    std::vector<double> distances;
+    for (const Eigen::Vector3d &point : points) {
+        double distance2 = std::numeric_limits<double>::infinity();
+        for (const Eigen::Vector3d &other : target) {
+            distance2 = std::min(distance2, SquaredDistance(point, other));
+        }
+        distances.push_back(std::sqrt(distance2));
+    }
+    return distances;
+}
+
+/// Two overlapping point clouds of different sizes.
+std::tuple<geometry::PointCloud, geometry::PointCloud> MakeDistanceClouds() {
+    geometry::PointCloud source;
+    source.points_.resize(3000);
+    Rand(source.points_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1),
+         40);
+    geometry::PointCloud target;
+    target.points_.resize(2000);
+    Rand(target.points_, Eigen::Vector3d(0.3, 0, 0),
+         Eigen::Vector3d(1.3, 1, 0.5), 41);
+    return {source, target};
+}
+
+/// A planted plane: a square of half width 1 around \p center_, spanned by
+/// \p u_ and \p v_.
+struct PlantedPlane {
+    Eigen::Vector3d center_;
+    Eigen::Vector3d u_;
+    Eigen::Vector3d v_;
+
+    Eigen::Vector3d Normal() const { return u_.cross(v_).normalized(); }
+};
+
+/// Separate planted planes, with a different normal each.
+std::vector<PlantedPlane> MakePlantedPlanes() {
+    const Eigen::Vector3d tilted_u = Eigen::Vector3d(1, -1, 0).normalized();
+    const Eigen::Vector3d tilted_v = Eigen::Vector3d(1, 1, -2).normalized();
+    return {{{0, 0, 0}, {1, 0, 0}, {0, 1, 0}},
+            {{3, 0, 1}, {0, 1, 0}, {0, 0, 1}},
+            {{-1, -3, 2}, tilted_u, tilted_v}};
+}
+
+/// Samples \p num_points points of each plane, up to a noise of 0.005 along
+/// the normal, with estimated normals.
+geometry::PointCloud SamplePlanes(const std::vector<PlantedPlane> &planes,
+                                  size_t num_points,
+                                  int seed) {
+    geometry::PointCloud cloud;
+    for (size_t p = 0; p < planes.size(); ++p) {
+        std::vector<Eigen::Vector3d> samples(num_points);
+        Rand(samples, Eigen::Vector3d(-1, -1, -0.005),
+             Eigen::Vector3d(1, 1, 0.005), seed + int(p));
+        for (const Eigen::Vector3d &sample : samples) {
+            cloud.points_.push_back(planes[p].center_ +
+                                    sample(0) * planes[p].u_ +
+                                    sample(1) * planes[p].v_ +
+                                    sample(2) * planes[p].Normal());
+        }
+    }
+    cloud.EstimateNormals(geometry::KDTreeSearchParamKNN(30));
+    return cloud;
+}
+
+}  // unnamed namespace
+
+TEST(PointCloud, ClusterDBSCAN) {
+    // Dense blobs on a uniform background of noise.
+    geometry::PointCloud cloud;
+    const std::vector<Eigen::Vector3d> centers = {
+            {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 1}};
+    for (size_t c = 0; c < centers.size(); ++c) {
+        std::vector<Eigen::Vector3d> blob(150);
+        Rand(blob, centers[c] - Eigen::Vector3d(0.2, 0.2, 0.2),
+             centers[c] + Eigen::Vector3d(0.2, 0.2, 0.2), int(c));
+        cloud.points_.insert(cloud.points_.end(), blob.begin(), blob.end());
+    }
+    std::vector<Eigen::Vector3d> noise(200);
+    Rand(noise, Eigen::Vector3d(-0.5, -0.5, -0.5),
+         Eigen::Vector3d(1.5, 1.5, 1.5), 10);
+    // Noise first, so that some of it is reached by clusters numbered later.
+    cloud.points_.insert(cloud.points_.begin(), noise.begin(), noise.end());
+
+    const double eps = 0.1;
+    const size_t min_points = 5;
+    const std::vector<int> labels_ref =
+            ReferenceClusterDBSCAN(cloud.points_, eps, min_points);
+    const int num_clusters =
+            *std::max_element(labels_ref.begin(), labels_ref.end()) + 1;
+    EXPECT_GE(num_clusters, 4);
+    EXPECT_GT(std::count(labels_ref.begin(), labels_ref.end(), -1), 0);
+
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        EXPECT_EQ(cloud.ClusterDBSCAN(eps, min_points, false, backend),
+                  labels_ref);
+    }
+}
+
+TEST(PointCloud, ClusterDBSCANBorderPoints) {
+    // Two chains of core points 0.05 apart. The chain ends have 4 points
+    // within eps, the points around them fewer.
+    geometry::PointCloud cloud;
+    cloud.points_ = {{0.58, 0, 0}, {5, 5, 5}, {-0.1, 0, 0}};
+    for (int i = 0; i < 10; ++i) {
+        cloud.points_.emplace_back(0.05 * i, 0, 0);
+    }
+    for (int i = 0; i < 10; ++i) {
+        cloud.points_.emplace_back(0.71 + 0.05 * i, 0, 0);
+    }
+    // The first point is a border point of both chains and joins the
+    // cluster with the smallest label even though it comes first. The second
+    // point is noise and the third a border point of the first chain.
+    const double eps = 0.16;
+    const size_t min_points = 4;
+    const std::vector<int> labels_ref =
+            ReferenceClusterDBSCAN(cloud.points_, eps, min_points);
+    EXPECT_EQ(labels_ref[0], 0);
+    EXPECT_EQ(labels_ref[1], -1);
+    EXPECT_EQ(labels_ref[2], 0);
+    EXPECT_EQ(labels_ref.back(), 1);
+
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        EXPECT_EQ(cloud.ClusterDBSCAN(eps, min_points, false, backend),
+                  labels_ref);
+    }
+}
+
+TEST(PointCloud, FarthestPointDownSample) {
+    // More points than one bucket, mostly on a coarse grid so that many
+    // distances tie. The color of a point encodes its index, so comparing
+    // colors compares the selected indices.
+    geometry::PointCloud cloud;
+    std::vector<Eigen::Vector3d> points(20000);
+    Rand(points, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(10, 10, 10), 0);
+    for (size_t i = 0; i < points.size(); ++i) {
+        const Eigen::Vector3d grid_point = points[i].array().floor();
+        cloud.points_.push_back(i % 7 == 0 ? points[i] : grid_point);
+        cloud.colors_.emplace_back(double(i), 0, 0);
+    }
+
+    for (size_t start_index : {size_t(0), size_t(1234)}) {
+        for (size_t num_samples : {size_t(1), size_t(50), size_t(1500)}) {
+            const auto expected = cloud.SelectByIndex(
+                    ReferenceFarthestPointSample(cloud.points_, num_samples,
+                                                 start_index));
+            for (bool use_spatial_buckets : {false, true}) {
+                const auto sampled = cloud.FarthestPointDownSample(
+                        num_samples, start_index, use_spatial_buckets);
+                EXPECT_EQ(sampled->colors_, expected->colors_);
+            }
+        }
+    }
+
+    // More samples than distinct points repeat the last sample.
+    geometry::PointCloud duplicates;
+    duplicates.points_ = {
+            {0, 0, 0}, {1, 0, 0}, {0, 0, 0}, {1, 0, 0}, {1, 0, 0}};
+    for (size_t i = 0; i < duplicates.points_.size(); ++i) {
+        duplicates.colors_.emplace_back(double(i), 0, 0);
+    }
+    EXPECT_EQ(ReferenceFarthestPointSample(duplicates.points_, 4, 2),
+              std::vector<size_t>({2, 1, 1, 1}));
+    for (bool use_spatial_buckets : {false, true}) {
+        EXPECT_EQ(duplicates.FarthestPointDownSample(4, 2, use_spatial_buckets)
+                          ->colors_,
+                  std::vector<Eigen::Vector3d>({{1, 0, 0}, {2, 0, 0}}));
+    }
+
+    EXPECT_TRUE(cloud.FarthestPointDownSample(0, 0)->IsEmpty());
+    EXPECT_EQ(cloud.FarthestPointDownSample(cloud.points_.size(), 0)->points_,
+              cloud.points_);
+    EXPECT_ANY_THROW(
+            cloud.FarthestPointDownSample(cloud.points_.size() + 1, 0));
+    EXPECT_ANY_THROW(cloud.FarthestPointDownSample(10, cloud.points_.size()));
+    EXPECT_ANY_THROW(cloud.FarthestPointDownSample(cloud.points_.size(),
+                                                   cloud.points_.size()));
+}
+
+TEST(PointCloud, VoxelDownSample) {
+    // Points around the origin, with all attributes.
+    geometry::PointCloud cloud;
+    cloud.points_.resize(5000);
+    Rand(cloud.points_, Eigen::Vector3d(-3, -2, -1), Eigen::Vector3d(1, 2, 3),
+         0);
+    cloud.normals_.resize(cloud.points_.size());
+    Rand(cloud.normals_, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1),
+         1);
+    cloud.colors_.resize(cloud.points_.size());
+    Rand(cloud.colors_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 2);
+    for (const Eigen::Vector3d &p : cloud.points_) {
+        cloud.covariances_.push_back(p * p.transpose());
+    }
+
+    for (double voxel_size : {0.05, 0.3, 10.0}) {
+        const auto output = cloud.VoxelDownSample(voxel_size);
+        const Eigen::Vector3d voxel_min_bound =
+                cloud.GetMinBound() -
+                Eigen::Vector3d::Constant(0.5 * voxel_size);
+        ExpectVoxelAverages(
+                cloud,
+                ReferenceVoxelGroups(cloud.points_, voxel_min_bound,
+                                     voxel_size),
+                *output);
+    }
+    EXPECT_TRUE(geometry::PointCloud().VoxelDownSample(0.1)->IsEmpty());
+    EXPECT_ANY_THROW(cloud.VoxelDownSample(0.0));
+    EXPECT_ANY_THROW(cloud.VoxelDownSample(1e-12));
+}
+
+TEST(PointCloud, VoxelDownSampleWideRange) {
+    // Clusters spread over +-1e9 voxels on every axis, so that the voxel
+    // indices need more than 64 bits together and are sorted without keys.
+    geometry::PointCloud cloud;
+    std::vector<Eigen::Vector3d> centers(40);
+    Rand(centers, Eigen::Vector3d::Constant(-1e9),
+         Eigen::Vector3d::Constant(1e9), 3);
+    centers.emplace_back(-1e9, -1e9, -1e9);
+    centers.emplace_back(1e9, 1e9, 1e9);
+    std::vector<Eigen::Vector3d> offsets(10 * centers.size());
+    Rand(offsets, Eigen::Vector3d::Constant(-1.5),
+         Eigen::Vector3d::Constant(1.5), 4);
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        cloud.points_.push_back(centers[i % centers.size()].array().round() +
+                                offsets[i].array());
+    }
+
+    const double voxel_size = 1.0;
+    const auto output = cloud.VoxelDownSample(voxel_size);
+    const Eigen::Vector3d voxel_min_bound =
+            cloud.GetMinBound() - Eigen::Vector3d::Constant(0.5 * voxel_size);
+    const auto groups =
+            ReferenceVoxelGroups(cloud.points_, voxel_min_bound, voxel_size);
+    EXPECT_LT(groups.size(), cloud.points_.size());
+    ExpectVoxelAverages(cloud, groups, *output);
+}
+
+TEST(PointCloud, VoxelDownSampleAndTrace) {
+    // The bounds do not cover the points, so that voxel indices are negative
+    // as well. Colors hold few class labels, so that their counts tie.
+    geometry::PointCloud cloud;
+    cloud.points_.resize(3000);
+    Rand(cloud.points_, Eigen::Vector3d(-2, -3, -1), Eigen::Vector3d(2, 1, 3),
+         5);
+    std::vector<Eigen::Vector3d> labels(cloud.points_.size());
+    Rand(labels, Eigen::Vector3d::Zero(), Eigen::Vector3d::Constant(3.999), 6);
+    for (const Eigen::Vector3d &label : labels) {
+        cloud.colors_.push_back(label.array().floor().matrix());
+    }
+    const Eigen::Vector3d min_bound(0, 0, 0);
+    const Eigen::Vector3d max_bound(1, 1, 1);
+
+    for (double voxel_size : {0.1, 0.45}) {
+        const auto groups =
+                ReferenceVoxelGroups(cloud.points_, min_bound, voxel_size);
+        // The largest index of the points in each octant of each voxel.
+        Eigen::MatrixXi cubic_id_ref(groups.size(), 8);
+        cubic_id_ref.setConstant(-1);
+        for (size_t v = 0; v < groups.size(); ++v) {
+            for (int i : groups[v]) {
+                const Eigen::Vector3d coord =
+                        (cloud.points_[i] - min_bound) / voxel_size;
+                int octant = 0;
+                for (int c = 0; c < 3; ++c) {
+                    if (coord(c) - std::floor(coord(c)) >= 0.5) {
+                        octant += 1 << c;
+                    }
+                }
+                cubic_id_ref(v, octant) = i;
+            }
+        }
+
+        for (bool approximate_class : {false, true}) {
+            const auto [output, cubic_id, offsets, indices] =
+                    cloud.VoxelDownSampleAndTraceCSR(voxel_size, min_bound,
+                                                     max_bound,
+                                                     approximate_class);
+            ExpectVoxelAverages(cloud, groups, *output, approximate_class);
+            EXPECT_EQ(cubic_id, cubic_id_ref);
+            const auto [offsets_ref, indices_ref] = ToCSR(groups);
+            EXPECT_EQ(offsets, offsets_ref);
+            EXPECT_EQ(indices, indices_ref);
+
+            // Every input point is traced exactly once.
+            std::vector<int> sorted_indices = indices;
+            std::sort(sorted_indices.begin(), sorted_indices.end());
+            std::vector<int> all(cloud.points_.size());
+            std::iota(all.begin(), all.end(), 0);
+            EXPECT_EQ(sorted_indices, all);
+
+            const auto [output_nested, cubic_id_nested, nested] =
+                    cloud.VoxelDownSampleAndTrace(voxel_size, min_bound,
+                                                  max_bound, approximate_class);
+            EXPECT_EQ(output_nested->points_, output->points_);
+            EXPECT_EQ(output_nested->colors_, output->colors_);
+            EXPECT_EQ(cubic_id_nested, cubic_id_ref);
+            EXPECT_EQ(nested, groups);
+        }
+    }
+    EXPECT_ANY_THROW(cloud.VoxelDownSampleAndTraceCSR(0.0, min_bound,
+                                                      max_bound));
+}
+
+TEST(PointCloud, EstimateNormalsThreadCountIndependent) {
+    // More points than the grain sizes of both the neighbor searches and the
+    // normal loop, so that both run in parallel.
+    const geometry::PointCloud surface =
+            SampleHeightField(40000, 7, Eigen::Vector2d(2, 2), 2.0, 0.01);
+    const geometry::KDTreeSearchParamKNN knn(20);
+    const geometry::KDTreeSearchParamHybrid hybrid(0.05, 30);
+
+    for (const geometry::KDTreeSearchParam *param :
+         std::vector<const geometry::KDTreeSearchParam *>{&knn, &hybrid}) {
+        std::vector<Eigen::Matrix3d> covariances_serial;
+        std::vector<geometry::PointCloud> serial(2, surface);
+        geometry::PointCloud oriented_input;
+        geometry::PointCloud oriented_serial;
+        {
+            ScopedMaxNumberOfThreads serial_threads(1);
+            covariances_serial =
+                    geometry::PointCloud::EstimatePerPointCovariances(surface,
+                                                                      *param);
+            serial[0].EstimateNormals(*param, true);
+            serial[1].EstimateNormals(*param, false);
+            // Existing normals orient the estimated ones.
+            oriented_input = serial[1];
+            for (size_t i = 0; i < oriented_input.normals_.size(); i += 3) {
+                oriented_input.normals_[i] *= -1.0;
+            }
+            oriented_serial = oriented_input;
+            oriented_serial.EstimateNormals(*param, false);
+        }
+
+        ForEachThreadCount([&] {
+            EXPECT_EQ(geometry::PointCloud::EstimatePerPointCovariances(
+                              surface, *param),
+                      covariances_serial);
+            for (bool fast_normal_computation : {true, false}) {
+                geometry::PointCloud parallel = surface;
+                parallel.EstimateNormals(*param, fast_normal_computation);
+                EXPECT_EQ(parallel.normals_,
+                          serial[fast_normal_computation ? 0 : 1].normals_);
+            }
+            geometry::PointCloud oriented = oriented_input;
+            oriented.EstimateNormals(*param, false);
+            EXPECT_EQ(oriented.normals_, oriented_serial.normals_);
+        });
+    }
+
+    // The estimated normals are those of the height field.
+    geometry::PointCloud plane =
+            SampleHeightField(2000, 8, Eigen::Vector2d(2, 2), 2.0, 0.01);
+    for (Eigen::Vector3d &point : plane.points_) {
+        point(2) = 0.0;
+    }
+    plane.EstimateNormals(knn);
+    for (const Eigen::Vector3d &normal : plane.normals_) {
+        EXPECT_NEAR(std::abs(normal(2)), 1.0, 1e-9);
+    }
+}
+
+TEST(PointCloud, SpatialReorder) {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(5000);
+    Rand(cloud.points_, Eigen::Vector3d(-1, -2, -3), Eigen::Vector3d(3, 2, 1),
+         12);
+    cloud.normals_.resize(cloud.points_.size());
+    Rand(cloud.normals_, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1),
+         13);
+    cloud.colors_.resize(cloud.points_.size());
+    Rand(cloud.colors_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 14);
+    for (const Eigen::Vector3d &p : cloud.points_) {
+        cloud.covariances_.push_back(p * p.transpose());
+    }
+    // Sum of the distances between consecutive points.
+    auto path_length = [](const std::vector<Eigen::Vector3d> &points) {
+        double length = 0.0;
+        for (size_t i = 1; i < points.size(); ++i) {
+            length += (points[i] - points[i - 1]).norm();
+        }
+        return length;
+    };
+
+    for (auto curve : {geometry::SpaceFillingCurve::Morton,
+                       geometry::SpaceFillingCurve::Hilbert}) {
+        geometry::PointCloud reordered = cloud;
+        const std::vector<size_t> order = reordered.SpatialReorder(curve);
+
+        // The order is a permutation.
+        std::vector<size_t> sorted_order = order;
+        std::sort(sorted_order.begin(), sorted_order.end());
+        std::vector<size_t> all(cloud.points_.size());
+        std::iota(all.begin(), all.end(), size_t(0));
+        EXPECT_EQ(sorted_order, all);
+
+        // All attributes move with their points.
+        ASSERT_EQ(reordered.points_.size(), cloud.points_.size());
+        ASSERT_EQ(reordered.normals_.size(), cloud.normals_.size());
+        ASSERT_EQ(reordered.colors_.size(), cloud.colors_.size());
+        ASSERT_EQ(reordered.covariances_.size(), cloud.covariances_.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            EXPECT_EQ(reordered.points_[i], cloud.points_[order[i]]);
+            EXPECT_EQ(reordered.normals_[i], cloud.normals_[order[i]]);
+            EXPECT_EQ(reordered.colors_[i], cloud.colors_[order[i]]);
+            EXPECT_EQ(reordered.covariances_[i], cloud.covariances_[order[i]]);
+        }
+
+        // Consecutive points are close.
+        EXPECT_LT(path_length(reordered.points_),
+                  0.2 * path_length(cloud.points_));
+
+        // Reordering again keeps the order.
+        geometry::PointCloud twice = reordered;
+        const std::vector<size_t> order_twice = twice.SpatialReorder(curve);
+        EXPECT_EQ(order_twice, all);
+    }
+
+    // Absent attributes stay absent.
+    geometry::PointCloud points_only;
+    points_only.points_ = cloud.points_;
+    const std::vector<size_t> order = points_only.SpatialReorder();
+    EXPECT_EQ(order.size(), cloud.points_.size());
+    EXPECT_FALSE(points_only.HasNormals());
+    EXPECT_FALSE(points_only.HasColors());
+    EXPECT_FALSE(points_only.HasCovariances());
+
+    geometry::PointCloud empty;
+    EXPECT_TRUE(empty.SpatialReorder().empty());
+}
+
+TEST(PointCloud, SegmentPlane) {
+    const Eigen::Vector4d plane =
+            Eigen::Vector4d(0.2, -0.1, 1.0, 0.3) /
+            Eigen::Vector3d(0.2, -0.1, 1.0).norm();
+    const auto [cloud, plane_indices] =
+            MakePlaneWithOutliers(plane, 6000, 15);
+
+    // Without preemption, and with preemption on blocks of 100 points.
+    for (size_t preemptive_block_size : {size_t(0), size_t(100)}) {
+        utility::random::Seed(0);
+        const auto [model, inliers] =
+                cloud.SegmentPlane(0.01, 3, 200, 0.99999999,
+                                   preemptive_block_size);
+        EXPECT_EQ(inliers, plane_indices);
+        // The model is refitted to the inliers, up to its sign.
+        const double sign = model.head<3>().dot(plane.head<3>()) < 0 ? -1 : 1;
+        ExpectEQ(Eigen::Vector4d(sign * model), plane, 1e-9);
+    }
+}
+
+TEST(PointCloud, SegmentPlaneThreadCountIndependent) {
+    // Noisy plane points, so that the hypotheses score differently, and
+    // enough points for the hypotheses to be evaluated in parallel.
+    // Not structured bindings, which lambdas cannot capture in C++17.
+    geometry::PointCloud cloud;
+    std::vector<size_t> plane_indices;
+    std::tie(cloud, plane_indices) = MakePlaneWithOutliers(
+            Eigen::Vector4d(0, 0, 1, 0), 6000, 16);
+    std::vector<Eigen::Vector3d> noise(cloud.points_.size());
+    Rand(noise, Eigen::Vector3d(0, 0, -0.02), Eigen::Vector3d(0, 0, 0.02), 17);
+    for (size_t i = 0; i < cloud.points_.size(); ++i) {
+        cloud.points_[i] += noise[i];
+    }
+
+    for (size_t preemptive_block_size : {size_t(0), size_t(100)}) {
+        auto segment = [&] {
+            utility::random::Seed(1);
+            return cloud.SegmentPlane(0.01, 3, 400, 0.99999999,
+                                      preemptive_block_size);
+        };
+        const auto serial = [&] {
+            ScopedMaxNumberOfThreads serial_threads(1);
+            return segment();
+        }();
+        EXPECT_GT(std::get<1>(serial).size(), plane_indices.size() / 3);
+        ForEachThreadCount([&] {
+            const auto parallel = segment();
+            EXPECT_EQ(std::get<0>(parallel), std::get<0>(serial));
+            EXPECT_EQ(std::get<1>(parallel), std::get<1>(serial));
+        });
+    }
+}
+
+TEST(PointCloud, RemoveRadiusOutliers) {
+    const geometry::PointCloud cloud = MakeBlobsWithOutliers(20);
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        for (size_t nb_points : {size_t(1), size_t(4), size_t(16)}) {
+            for (double radius : {0.03, 0.1}) {
+                const std::vector<size_t> expected =
+                        ReferenceRadiusInliers(cloud.points_, nb_points,
+                                               radius);
+                const auto [output, indices] = cloud.RemoveRadiusOutliers(
+                        nb_points, radius, false, backend);
+                EXPECT_EQ(indices, expected);
+                EXPECT_EQ(output->colors_,
+                          cloud.SelectByIndex(expected)->colors_);
+            }
+        }
+    }
+    // Some points are removed, and some kept.
+    const auto indices = std::get<1>(cloud.RemoveRadiusOutliers(4, 0.1));
+    EXPECT_GT(indices.size(), size_t(0));
+    EXPECT_LT(indices.size(), cloud.points_.size());
+
+    EXPECT_ANY_THROW((void)cloud.RemoveRadiusOutliers(0, 0.1));
+    EXPECT_ANY_THROW((void)cloud.RemoveRadiusOutliers(4, 0.0));
+}
+
+TEST(PointCloud, RemoveRadiusOutliersCountsPointItself) {
+    // Points 0.1 apart on a line: with a radius of 0.15, the end points have
+    // one neighbor and the others two, each point itself included in its
+    // count. The last point is isolated.
+    geometry::PointCloud cloud;
+    for (int i = 0; i < 5; ++i) {
+        cloud.points_.emplace_back(0.1 * i, 0, 0);
+    }
+    cloud.points_.emplace_back(5, 5, 5);
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        auto kept = [&](size_t nb_points) {
+            return std::get<1>(
+                    cloud.RemoveRadiusOutliers(nb_points, 0.15, false,
+                                               backend));
+        };
+        EXPECT_EQ(kept(1), std::vector<size_t>({0, 1, 2, 3, 4}));
+        EXPECT_EQ(kept(2), std::vector<size_t>({1, 2, 3}));
+        EXPECT_EQ(kept(3), std::vector<size_t>());
+    }
+}
+
+TEST(PointCloud, RemoveStatisticalOutliers) {
+    // The statistical filter uses k nearest neighbor searches, which only
+    // the KD-tree supports.
+    const geometry::PointCloud cloud = MakeBlobsWithOutliers(30);
+    for (size_t nb_neighbors : {size_t(1), size_t(2), size_t(10)}) {
+        for (double std_ratio : {0.5, 2.0}) {
+            const std::vector<size_t> expected = ReferenceStatisticalInliers(
+                    cloud.points_, nb_neighbors, std_ratio);
+            const auto [output, indices] =
+                    cloud.RemoveStatisticalOutliers(nb_neighbors, std_ratio);
+            EXPECT_EQ(indices, expected);
+            EXPECT_EQ(output->colors_,
+                      cloud.SelectByIndex(expected)->colors_);
+        }
+    }
+    // With a single neighbor, the point itself, every mean distance is 0 and
+    // all points are removed.
+    EXPECT_TRUE(std::get<1>(cloud.RemoveStatisticalOutliers(1, 2.0)).empty());
+    const auto indices = std::get<1>(cloud.RemoveStatisticalOutliers(10, 2.0));
+    EXPECT_GT(indices.size(), cloud.points_.size() / 2);
+    EXPECT_LT(indices.size(), cloud.points_.size());
+
+    EXPECT_TRUE(std::get<1>(geometry::PointCloud().RemoveStatisticalOutliers(
+                                    10, 2.0))
+                        .empty());
+    EXPECT_ANY_THROW((void)cloud.RemoveStatisticalOutliers(0, 2.0));
+    EXPECT_ANY_THROW((void)cloud.RemoveStatisticalOutliers(10, 0.0));
+}
+
+TEST(PointCloud, ComputeChamferDistance) {
+    const auto [source, target] = MakeDistanceClouds();
+    const std::vector<double> source_distances =
+            ReferenceNearestDistances(source.points_, target.points_);
+    const std::vector<double> target_distances =
+            ReferenceNearestDistances(target.points_, source.points_);
+    const double expected =
+            std::accumulate(source_distances.begin(), source_distances.end(),
+                            0.0) /
+                    double(source_distances.size()) +
+            std::accumulate(target_distances.begin(), target_distances.end(),
+                            0.0) /
+                    double(target_distances.size());
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    EXPECT_NEAR(source.ComputeChamferDistance(target), expected, 1e-12);
+    EXPECT_NEAR(target.ComputeChamferDistance(source), expected, 1e-12);
+    EXPECT_EQ(source.ComputeChamferDistance(source), 0.0);
+
+    // Below the distance, the computation gives up with infinity.
+    EXPECT_NEAR(source.ComputeChamferDistance(target, 1.01 * expected),
+                expected, 1e-12);
+    EXPECT_EQ(source.ComputeChamferDistance(target, 0.99 * expected),
+              infinity);
+    EXPECT_EQ(source.ComputeChamferDistance(target, 0.1 * expected),
+              infinity);
+    EXPECT_EQ(source.ComputeChamferDistance(target, 0.0), infinity);
+
+    const geometry::PointCloud empty;
+    EXPECT_ANY_THROW((void)source.ComputeChamferDistance(empty));
+    EXPECT_ANY_THROW((void)empty.ComputeChamferDistance(target));
+    EXPECT_ANY_THROW((void)empty.ComputeChamferDistance(empty));
+}
+
+TEST(PointCloud, ComputeHausdorffDistance) {
+    const auto [source, target] = MakeDistanceClouds();
+    const std::vector<double> source_distances =
+            ReferenceNearestDistances(source.points_, target.points_);
+    const std::vector<double> target_distances =
+            ReferenceNearestDistances(target.points_, source.points_);
+    const double expected = std::max(
+            *std::max_element(source_distances.begin(),
+                              source_distances.end()),
+            *std::max_element(target_distances.begin(),
+                              target_distances.end()));
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    EXPECT_NEAR(source.ComputeHausdorffDistance(target), expected, 1e-12);
+    EXPECT_NEAR(target.ComputeHausdorffDistance(source), expected, 1e-12);
+    EXPECT_EQ(source.ComputeHausdorffDistance(source), 0.0);
+
+    // Once a point at least max_distance away is found, the result is
+    // infinity.
+    EXPECT_NEAR(source.ComputeHausdorffDistance(target, 1.01 * expected),
+                expected, 1e-12);
+    EXPECT_EQ(source.ComputeHausdorffDistance(target, 0.99 * expected),
+              infinity);
+    EXPECT_EQ(source.ComputeHausdorffDistance(target, 0.0), infinity);
+
+    const geometry::PointCloud empty;
+    EXPECT_ANY_THROW((void)source.ComputeHausdorffDistance(empty));
+    EXPECT_ANY_THROW((void)empty.ComputeHausdorffDistance(target));
+}
+
+TEST(PointCloud, ComputeDistancePercentiles) {
+    // Not structured bindings, which lambdas cannot capture in C++17.
+    geometry::PointCloud source, target;
+    std::tie(source, target) = MakeDistanceClouds();
+    std::vector<double> sorted =
+            ReferenceNearestDistances(source.points_, target.points_);
+    std::sort(sorted.begin(), sorted.end());
+    const size_t num_points = sorted.size();
+    const double infinity = std::numeric_limits<double>::infinity();
+    // The nearest-rank index among the sorted distances.
+    auto index = [num_points](double percentile) {
+        return std::max(size_t(1), size_t(std::ceil(percentile / 100.0 *
+                                                    double(num_points)))) -
+               1;
+    };
+    auto expect_percentiles = [&](const std::vector<double> &percentiles,
+                                  double max_distance, size_t num_finite) {
+        const std::vector<double> values = source.ComputeDistancePercentiles(
+                target, percentiles, max_distance);
+        ASSERT_EQ(values.size(), percentiles.size());
+        for (size_t i = 0; i < percentiles.size(); ++i) {
+            if (index(percentiles[i]) < num_finite) {
+                EXPECT_NEAR(values[i], sorted[index(percentiles[i])], 1e-12);
+            } else {
+                EXPECT_EQ(values[i], infinity);
+            }
+        }
+    };
+
+    const std::vector<double> percentiles = {0, 10, 33.3, 50, 60, 90, 100};
+    expect_percentiles(percentiles, infinity, num_points);
+    // Percentile 0 is the smallest distance and 100 the largest.
+    const std::vector<double> extremes =
+            source.ComputeDistancePercentiles(target, {0, 100});
+    EXPECT_NEAR(extremes[0], sorted.front(), 1e-12);
+    EXPECT_NEAR(extremes[1], sorted.back(), 1e-12);
+
+    // A bound halfway between two distances, so that the tree and the
+    // reference agree on which points are beyond it.
+    const size_t num_below = num_points * 3 / 4;
+    const double max_distance =
+            0.5 * (sorted[num_below - 1] + sorted[num_below]);
+    expect_percentiles(percentiles, max_distance, num_below);
+    // All the percentiles fall beyond the bound, and the search stops early.
+    expect_percentiles({80, 90, 100}, max_distance, num_below);
+    expect_percentiles({0, 100}, 0.5 * sorted.front(), 0);
+    expect_percentiles({100}, 0.0, 0);
+
+    EXPECT_TRUE(source.ComputeDistancePercentiles(target, {}).empty());
+    EXPECT_ANY_THROW((void)source.ComputeDistancePercentiles(target, {-1}));
+    EXPECT_ANY_THROW((void)source.ComputeDistancePercentiles(target, {101}));
+    EXPECT_ANY_THROW((void)source.ComputeDistancePercentiles(
+            target, {std::numeric_limits<double>::quiet_NaN()}));
+    const geometry::PointCloud empty;
+    EXPECT_ANY_THROW((void)source.ComputeDistancePercentiles(empty, {50}));
+    EXPECT_ANY_THROW((void)empty.ComputeDistancePercentiles(target, {50}));
+}
+
+TEST(PointCloud, DetectPlanarPatches) {
+    const std::vector<PlantedPlane> planes = MakePlantedPlanes();
+    const geometry::PointCloud cloud = SamplePlanes(planes, 5000, 60);
+    const geometry::KDTreeSearchParamHybrid hybrid(0.1, 30);
+
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        const auto patches = cloud.DetectPlanarPatches(60, 75, 0.75, 0.0, 0,
+                                                       hybrid, backend);
+        // Every patch lies on a planted plane, and every plane has a patch
+        // spanning most of it.
+        std::vector<bool> found(planes.size(), false);
+        for (const auto &patch : patches) {
+            const Eigen::Vector3d normal = patch->R_.col(2);
+            size_t num_matches = 0;
+            for (size_t p = 0; p < planes.size(); ++p) {
+                const Eigen::Vector3d plane_normal = planes[p].Normal();
+                if (std::abs(normal.dot(plane_normal)) > 0.99 &&
+                    std::abs(plane_normal.dot(patch->center_ -
+                                              planes[p].center_)) < 0.02) {
+                    found[p] = found[p] ||
+                               patch->extent_.head<2>().minCoeff() > 1.0;
+                    ++num_matches;
+                    EXPECT_LE((patch->center_ - planes[p].center_).norm(),
+                              1.5);
+                }
+            }
+            EXPECT_EQ(num_matches, size_t(1));
+            EXPECT_LT(patch->extent_(2), 0.05);
+        }
+        EXPECT_EQ(found, std::vector<bool>(planes.size(), true));
+    }
+
+    EXPECT_ANY_THROW((void)geometry::PointCloud().DetectPlanarPatches());
+    geometry::PointCloud no_normals = cloud;
+    no_normals.normals_.clear();
+    EXPECT_ANY_THROW((void)no_normals.DetectPlanarPatches());
+    EXPECT_ANY_THROW((void)cloud.DetectPlanarPatches(
+            60, 75, 0.75, 0.0, 0, geometry::KDTreeSearchParamKNN(),
+            geometry::NeighborSearchBackend::HashGrid));
+}
+
+TEST(PointCloud, DetectPlanarPatchesThreadCountIndependent) {
+    // Enough points and octree subtrees for the neighbor searches, the plane
+    // detection, and the growing and merging to run in parallel.
+    const geometry::PointCloud cloud =
+            SamplePlanes(MakePlantedPlanes(), 5000, 61);
+    const geometry::KDTreeSearchParamKNN knn(30);
+    const geometry::KDTreeSearchParamHybrid hybrid(0.1, 30);
+
+    for (auto backend : {geometry::NeighborSearchBackend::KDTree,
+                         geometry::NeighborSearchBackend::HashGrid}) {
+        const geometry::KDTreeSearchParam &param =
+                backend == geometry::NeighborSearchBackend::KDTree
+                        ? static_cast<const geometry::KDTreeSearchParam &>(knn)
+                        : hybrid;
+        auto detect = [&] {
+            return cloud.DetectPlanarPatches(60, 75, 0.75, 0.0, 0, param,
+                                             backend);
+        };
+        const auto serial = [&] {
+            ScopedMaxNumberOfThreads serial_threads(1);
+            return detect();
+        }();
+        EXPECT_GT(serial.size(), size_t(0));
+        ForEachThreadCount([&] {
+            const auto parallel = detect();
+            EXPECT_EQ(parallel.size(), serial.size());
+            if (parallel.size() != serial.size()) {
+                return;
+            }
+            for (size_t i = 0; i < serial.size(); ++i) {
+                EXPECT_EQ(parallel[i]->center_, serial[i]->center_);
+                EXPECT_EQ(parallel[i]->R_, serial[i]->R_);
+                EXPECT_EQ(parallel[i]->extent_, serial[i]->extent_);
+                EXPECT_EQ(parallel[i]->color_, serial[i]->color_);
+            }
+        });
+    }
+}
+
+}  // namespace u3d::tests
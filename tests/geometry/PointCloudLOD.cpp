@@ -0,0 +1,209 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/PointCloudLOD.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// A uniform background, a dense blob and repeated points, so that levels
+/// have both sparse and crowded cells and the last level is not empty.
+geometry::PointCloud MakeCloud() {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(1500);
+    Rand(cloud.points_, Eigen::Vector3d(-2, 0, 1), Eigen::Vector3d(3, 4, 2), 0);
+    std::vector<Eigen::Vector3d> blob(500);
+    Rand(blob, Eigen::Vector3d(0, 1, 1.2), Eigen::Vector3d(0.1, 1.1, 1.3), 1);
+    cloud.points_.insert(cloud.points_.end(), blob.begin(), blob.end());
+    for (int i = 0; i < 20; ++i) {
+        cloud.points_.push_back(cloud.points_[i]);
+    }
+    cloud.colors_.resize(cloud.points_.size());
+    Rand(cloud.colors_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 2);
+    return cloud;
+}
+
+/// Cell of \p point in the grid of \p level over the bounding cube of
+/// \p points.
+std::tuple<int, int, int> LevelCell(const std::vector<Eigen::Vector3d> &points,
+                                    const Eigen::Vector3d &point,
+                                    int level) {
+    const auto bbox =
+            geometry::AxisAlignedBoundingBox::CreateFromPoints(points);
+    const double scale = std::ldexp(1.0, level) / bbox.GetMaxExtent();
+    const int max_cell = (1 << level) - 1;
+    const Eigen::Vector3d p = (point - bbox.GetMinBound()) * scale;
+    return {std::clamp(int(p(0)), 0, max_cell),
+            std::clamp(int(p(1)), 0, max_cell),
+            std::clamp(int(p(2)), 0, max_cell)};
+}
+
+/// Indices of the first \p count entries of \p indices that lie in \p bbox.
+std::vector<size_t> BruteForceQuery(
+        const std::vector<Eigen::Vector3d> &points,
+        const std::vector<size_t> &indices,
+        size_t count,
+        const geometry::AxisAlignedBoundingBox &bbox) {
+    std::vector<size_t> found;
+    for (size_t i = 0; i < count; ++i) {
+        const Eigen::Vector3d &p = points[indices[i]];
+        if ((p.array() >= bbox.min_bound_.array()).all() &&
+            (p.array() <= bbox.max_bound_.array()).all()) {
+            found.push_back(indices[i]);
+        }
+    }
+    return found;
+}
+
+}  // unnamed namespace
+
+TEST(PointCloudLOD, Levels) {
+    const geometry::PointCloud cloud = MakeCloud();
+    const int max_depth = 5;
+    const geometry::PointCloudLOD lod(cloud, max_depth);
+    ASSERT_EQ(lod.NumLevels(), max_depth + 2);
+
+    // The indices are a permutation of the cloud.
+    std::vector<size_t> sorted_indices = lod.GetIndices();
+    std::sort(sorted_indices.begin(), sorted_indices.end());
+    std::vector<size_t> all(cloud.points_.size());
+    std::iota(all.begin(), all.end(), size_t(0));
+    EXPECT_EQ(sorted_indices, all);
+    EXPECT_EQ(lod.NumPointsUpToLevel(lod.NumLevels() - 1),
+              cloud.points_.size());
+    EXPECT_LT(lod.NumPointsUpToLevel(max_depth), cloud.points_.size());
+
+    for (int level = 0; level < lod.NumLevels(); ++level) {
+        const size_t count = lod.NumPointsUpToLevel(level);
+        if (level > 0) {
+            EXPECT_GE(count, lod.NumPointsUpToLevel(level - 1));
+        }
+        const auto prefix = lod.GetPointCloud(level);
+        ASSERT_EQ(prefix->points_.size(), count);
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(prefix->points_[i], cloud.points_[lod.GetIndices()[i]]);
+            EXPECT_EQ(prefix->colors_[i], cloud.colors_[lod.GetIndices()[i]]);
+        }
+        if (level > max_depth) {
+            EXPECT_EQ(lod.GetLevelSpacing(level), 0.0);
+            continue;
+        }
+
+        // One point per occupied cell of the level.
+        std::set<std::tuple<int, int, int>> occupied, picked;
+        for (const Eigen::Vector3d &p : cloud.points_) {
+            occupied.insert(LevelCell(cloud.points_, p, level));
+        }
+        for (const Eigen::Vector3d &p : prefix->points_) {
+            picked.insert(LevelCell(cloud.points_, p, level));
+        }
+        EXPECT_EQ(picked, occupied);
+        EXPECT_EQ(count, occupied.size());
+
+        // Every point is within the level error of the picked points.
+        double max_distance = 0;
+        for (const Eigen::Vector3d &p : cloud.points_) {
+            double distance2 = std::numeric_limits<double>::infinity();
+            for (const Eigen::Vector3d &q : prefix->points_) {
+                distance2 = std::min(distance2, (p - q).squaredNorm());
+            }
+            max_distance = std::max(max_distance, std::sqrt(distance2));
+        }
+        EXPECT_LE(max_distance, lod.GetLevelError(level));
+    }
+
+    EXPECT_ANY_THROW((void)lod.NumPointsUpToLevel(-1));
+    EXPECT_ANY_THROW((void)lod.GetPointCloud(lod.NumLevels()));
+    EXPECT_ANY_THROW(geometry::PointCloudLOD(cloud, 22));
+}
+
+TEST(PointCloudLOD, LevelForError) {
+    const geometry::PointCloudLOD lod(MakeCloud(), 6);
+    for (double max_error : {100.0, 1.0, 0.3, 0.01, 1e-6}) {
+        const int level = lod.GetLevelForError(max_error);
+        if (level <= 6) {
+            EXPECT_LE(lod.GetLevelError(level), max_error);
+        } else {
+            EXPECT_EQ(level, lod.NumLevels() - 1);
+        }
+        if (level > 0) {
+            EXPECT_GT(lod.GetLevelError(level - 1), max_error);
+        }
+    }
+    const double spacing = 0.2;
+    const int level = lod.GetLevelForSpacing(spacing);
+    EXPECT_LE(lod.GetLevelSpacing(level), spacing);
+    EXPECT_GT(lod.GetLevelSpacing(level - 1), spacing);
+}
+
+TEST(PointCloudLOD, Query) {
+    const geometry::PointCloud cloud = MakeCloud();
+    const geometry::PointCloudLOD lod(cloud, 5);
+
+    std::vector<Eigen::Vector3d> corners(40);
+    Rand(corners, Eigen::Vector3d(-2.5, -0.5, 0.5),
+         Eigen::Vector3d(3.5, 4.5, 2.5), 3);
+    std::vector<geometry::AxisAlignedBoundingBox> boxes;
+    for (size_t i = 0; i < corners.size(); i += 2) {
+        boxes.emplace_back(corners[i].cwiseMin(corners[i + 1]),
+                           corners[i].cwiseMax(corners[i + 1]));
+    }
+    // The whole cloud, the blob, a single point, and a box missing the cloud.
+    boxes.push_back(
+            geometry::AxisAlignedBoundingBox::CreateFromPoints(cloud.points_));
+    boxes.emplace_back(Eigen::Vector3d(0, 1, 1.2),
+                       Eigen::Vector3d(0.1, 1.1, 1.3));
+    boxes.emplace_back(cloud.points_[7], cloud.points_[7]);
+    boxes.emplace_back(Eigen::Vector3d(5, 5, 5), Eigen::Vector3d(6, 6, 6));
+
+    for (const auto &bbox : boxes) {
+        for (int level = 0; level < lod.NumLevels(); ++level) {
+            const size_t count = lod.NumPointsUpToLevel(level);
+            std::vector<size_t> expected = BruteForceQuery(
+                    cloud.points_, lod.GetIndices(), count, bbox);
+
+            // Crop keeps the storage order, i.e. that of GetPointCloud().
+            const auto cropped = lod.Crop(bbox, level);
+            ASSERT_EQ(cropped->points_.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                EXPECT_EQ(cropped->points_[i], cloud.points_[expected[i]]);
+                EXPECT_EQ(cropped->colors_[i], cloud.colors_[expected[i]]);
+            }
+
+            std::vector<size_t> found = lod.Query(bbox, level);
+            std::sort(found.begin(), found.end());
+            std::sort(expected.begin(), expected.end());
+            EXPECT_EQ(found, expected);
+        }
+    }
+    // A repeated point is found with its copy.
+    const std::vector<size_t> repeated =
+            lod.Query(boxes[boxes.size() - 2], lod.NumLevels() - 1);
+    EXPECT_EQ(std::count(repeated.begin(), repeated.end(), size_t(7)), 1);
+    EXPECT_EQ(std::count(repeated.begin(), repeated.end(),
+                         cloud.points_.size() - 13),
+              1);
+
+    const geometry::PointCloudLOD empty(geometry::PointCloud(), 3);
+    EXPECT_EQ(empty.NumPointsUpToLevel(empty.NumLevels() - 1), size_t(0));
+    EXPECT_TRUE(empty.Query(boxes.front(), 2).empty());
+}
+
+}  // namespace u3d::tests
@@ -0,0 +1,187 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/SpanningForest.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+namespace {
+
+using Edge = std::tuple<size_t, size_t, double>;
+
+std::vector<Edge> ToTuples(const std::vector<geometry::WeightedEdge> &edges) {
+    std::vector<Edge> tuples;
+    for (const auto &edge : edges) {
+        tuples.emplace_back(edge.v0_, edge.v1_, edge.weight_);
+    }
+    return tuples;
+}
+
+/// Orients \p normals along the minimum spanning forest of the kNN graph
+/// computed with Kruskal's algorithm, each tree from its lowest point.
+void ReferenceOrientNormals(const std::vector<Eigen::Vector3d> &points,
+                            std::vector<Eigen::Vector3d> &normals,
+                            size_t k) {
+    const size_t n = points.size();
+    std::vector<geometry::WeightedEdge> edges;
+    for (size_t v0 = 0; v0 < n; ++v0) {
+        std::vector<std::pair<double, size_t>> neighbors;
+        for (size_t v1 = 0; v1 < n; ++v1) {
+            neighbors.emplace_back((points[v0] - points[v1]).squaredNorm(), v1);
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        for (size_t j = 0; j < k; ++j) {
+            const size_t v1 = neighbors[j].second;
+            const Eigen::Vector3d diff = points[v0] - points[v1];
+            if (v1 == v0 ||
+                std::abs(diff.dot(normals[v0])) / diff.norm() > 1.0) {
+                continue;
+            }
+            edges.emplace_back(std::min(v0, v1), std::max(v0, v1),
+                               1.0 - std::abs(normals[v0].dot(normals[v1])));
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const auto &e0, const auto &e1) {
+        return std::tie(e0.v0_, e0.v1_) < std::tie(e1.v0_, e1.v1_);
+    });
+    edges.erase(std::unique(edges.begin(), edges.end(),
+                            [](const auto &e0, const auto &e1) {
+                                return e0.v0_ == e1.v0_ && e0.v1_ == e1.v1_;
+                            }),
+                edges.end());
+    const auto forest = geometry::KruskalMinimumSpanningForest(edges, n);
+
+    std::vector<std::vector<size_t>> adjacency(n);
+    for (const auto &edge : forest) {
+        adjacency[edge.v0_].push_back(edge.v1_);
+        adjacency[edge.v1_].push_back(edge.v0_);
+    }
+    // Collect each tree, then orient it from its first point of lowest z.
+    std::vector<bool> visited(n, false);
+    for (size_t v = 0; v < n; ++v) {
+        if (visited[v]) {
+            continue;
+        }
+        std::vector<size_t> tree = {v};
+        visited[v] = true;
+        for (size_t i = 0; i < tree.size(); ++i) {
+            for (size_t nb : adjacency[tree[i]]) {
+                if (!visited[nb]) {
+                    visited[nb] = true;
+                    tree.push_back(nb);
+                }
+            }
+        }
+        size_t root = v;
+        for (size_t u : tree) {
+            if (points[u](2) < points[root](2) ||
+                (points[u](2) == points[root](2) && u < root)) {
+                root = u;
+            }
+        }
+        std::vector<bool> oriented(n, false);
+        if (normals[root].dot(Eigen::Vector3d(0, 0, -1)) < 0) {
+            normals[root] *= -1;
+        }
+        std::vector<size_t> stack = {root};
+        oriented[root] = true;
+        while (!stack.empty()) {
+            const size_t u = stack.back();
+            stack.pop_back();
+            for (size_t nb : adjacency[u]) {
+                if (!oriented[nb]) {
+                    oriented[nb] = true;
+                    if (normals[u].dot(normals[nb]) < 0) {
+                        normals[nb] *= -1;
+                    }
+                    stack.push_back(nb);
+                }
+            }
+        }
+    }
+}
+
+}  // unnamed namespace
+
+TEST(SpanningForest, BoruvkaMatchesKruskal) {
+    // A 20 x 20 grid graph whose weights take three values, so that most
+    // edges tie, plus a separate component and an isolated vertex.
+    const size_t size = 20;
+    std::vector<geometry::WeightedEdge> edges;
+    for (size_t y = 0; y < size; ++y) {
+        for (size_t x = 0; x < size; ++x) {
+            const size_t v = y * size + x;
+            if (x + 1 < size) {
+                edges.emplace_back(v, v + 1, double((x * 7 + y) % 3));
+            }
+            if (y + 1 < size) {
+                edges.emplace_back(v + size, v, double((x + y * 5) % 3));
+            }
+        }
+    }
+    const size_t grid_vertices = size * size;
+    edges.emplace_back(grid_vertices, grid_vertices + 1, 0.5);
+    edges.emplace_back(grid_vertices + 1, grid_vertices + 2, 0.5);
+    edges.emplace_back(grid_vertices + 2, grid_vertices, 0.5);
+    const size_t n_vertices = grid_vertices + 4;
+    std::reverse(edges.begin(), edges.end());
+
+    std::vector<geometry::WeightedEdge> edges_kruskal = edges;
+    const auto kruskal =
+            geometry::KruskalMinimumSpanningForest(edges_kruskal, n_vertices);
+    const auto boruvka =
+            geometry::BoruvkaMinimumSpanningForest(edges, n_vertices);
+    EXPECT_EQ(kruskal.size(), n_vertices - 3);
+    EXPECT_EQ(ToTuples(boruvka), ToTuples(kruskal));
+    EXPECT_EQ(ToTuples(edges), ToTuples(edges_kruskal));
+
+    // The forest does not depend on the input order.
+    std::vector<geometry::WeightedEdge> rotated = edges;
+    std::rotate(rotated.begin(), rotated.begin() + 17, rotated.end());
+    EXPECT_EQ(ToTuples(geometry::BoruvkaMinimumSpanningForest(rotated,
+                                                               n_vertices)),
+              ToTuples(kruskal));
+}
+
+TEST(SpanningForest, OrientNormalsKNNGraph) {
+    // Two separate jittered grids, so that the kNN graph has two components
+    // and neighbor distances do not tie. Normals take few directions, so
+    // that many edge weights tie.
+    geometry::PointCloud cloud;
+    std::vector<Eigen::Vector3d> jitter(2 * 12 * 12);
+    Rand(jitter, Eigen::Vector3d(-0.05, -0.05, -0.05),
+         Eigen::Vector3d(0.05, 0.05, 0.05), 0);
+    const std::vector<Eigen::Vector3d> directions = {
+            {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {0, M_SQRT1_2, M_SQRT1_2}};
+    for (int g = 0; g < 2; ++g) {
+        for (int y = 0; y < 12; ++y) {
+            for (int x = 0; x < 12; ++x) {
+                const size_t i = cloud.points_.size();
+                cloud.points_.push_back(Eigen::Vector3d(x + 100 * g, y,
+                                                        0.1 * x * y) +
+                                        jitter[i]);
+                cloud.normals_.push_back(directions[(x * 3 + y * 5 + g) % 4]);
+            }
+        }
+    }
+
+    const size_t k = 6;
+    std::vector<Eigen::Vector3d> normals_ref = cloud.normals_;
+    ReferenceOrientNormals(cloud.points_, normals_ref, k);
+    cloud.OrientNormalsConsistentTangentPlane(k, 0.0, 1.0, true);
+    EXPECT_EQ(cloud.normals_, normals_ref);
+}
+
+}  // namespace u3d::tests
@@ -0,0 +1,107 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/TriangleMesh.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include <vector>
+
+#include "tests/Tests.h"
+
+namespace u3d::tests {
+
+TEST(TriangleMesh, SpatialReorder) {
+    // The sphere's vertices are generated ring by ring, far from a space
+    // filling curve order.
+    const auto sphere = geometry::TriangleMesh::CreateSphere(1.0, 40);
+    geometry::TriangleMesh mesh = *sphere;
+    mesh.ComputeVertexNormals();
+    mesh.ComputeTriangleNormals();
+    mesh.vertex_colors_.resize(mesh.vertices_.size());
+    Rand(mesh.vertex_colors_, Eigen::Vector3d(0, 0, 0),
+         Eigen::Vector3d(1, 1, 1), 0);
+    mesh.ComputeAdjacencyList();
+
+    for (auto curve : {geometry::SpaceFillingCurve::Morton,
+                       geometry::SpaceFillingCurve::Hilbert}) {
+        geometry::TriangleMesh reordered = mesh;
+        const std::vector<size_t> order = reordered.SpatialReorder(curve);
+
+        // The order is a permutation.
+        const size_t num_vertices = mesh.vertices_.size();
+        ASSERT_EQ(order.size(), num_vertices);
+        std::vector<size_t> sorted_order = order;
+        std::sort(sorted_order.begin(), sorted_order.end());
+        std::vector<size_t> all(num_vertices);
+        std::iota(all.begin(), all.end(), size_t(0));
+        EXPECT_EQ(sorted_order, all);
+        EXPECT_NE(order, all);
+
+        // Per-vertex attributes move with their vertices.
+        ASSERT_EQ(reordered.vertices_.size(), num_vertices);
+        ASSERT_EQ(reordered.vertex_normals_.size(), num_vertices);
+        ASSERT_EQ(reordered.vertex_colors_.size(), num_vertices);
+        std::vector<int> index_old_to_new(num_vertices);
+        for (size_t i = 0; i < num_vertices; ++i) {
+            EXPECT_EQ(reordered.vertices_[i], mesh.vertices_[order[i]]);
+            EXPECT_EQ(reordered.vertex_normals_[i],
+                      mesh.vertex_normals_[order[i]]);
+            EXPECT_EQ(reordered.vertex_colors_[i],
+                      mesh.vertex_colors_[order[i]]);
+            index_old_to_new[order[i]] = int(i);
+        }
+
+        // Triangles keep their order and are remapped to the new indices, so
+        // every triangle has the same corners as before.
+        ASSERT_EQ(reordered.triangles_.size(), mesh.triangles_.size());
+        for (size_t t = 0; t < mesh.triangles_.size(); ++t) {
+            for (int k = 0; k < 3; ++k) {
+                EXPECT_EQ(reordered.triangles_[t](k),
+                          index_old_to_new[mesh.triangles_[t](k)]);
+                EXPECT_EQ(reordered.vertices_[reordered.triangles_[t](k)],
+                          mesh.vertices_[mesh.triangles_[t](k)]);
+            }
+        }
+        EXPECT_EQ(reordered.triangle_normals_, mesh.triangle_normals_);
+
+        // The adjacency list is remapped, and matches the one computed from
+        // the reordered triangles.
+        ASSERT_EQ(reordered.adjacency_list_.size(), num_vertices);
+        for (size_t i = 0; i < num_vertices; ++i) {
+            std::unordered_set<int> expected;
+            for (int j : mesh.adjacency_list_[order[i]]) {
+                expected.insert(index_old_to_new[j]);
+            }
+            EXPECT_EQ(reordered.adjacency_list_[i], expected);
+        }
+        geometry::TriangleMesh recomputed = reordered;
+        recomputed.ComputeAdjacencyList();
+        EXPECT_EQ(recomputed.adjacency_list_, reordered.adjacency_list_);
+
+        // The surface is unchanged.
+        EXPECT_NEAR(reordered.GetSurfaceArea(), mesh.GetSurfaceArea(), 1e-12);
+        EXPECT_EQ(reordered.GetMinBound(), mesh.GetMinBound());
+        EXPECT_EQ(reordered.GetMaxBound(), mesh.GetMaxBound());
+        EXPECT_EQ(reordered.IsEdgeManifold(), mesh.IsEdgeManifold());
+        EXPECT_EQ(reordered.IsWatertight(), mesh.IsWatertight());
+        EXPECT_NEAR(reordered.GetVolume(), mesh.GetVolume(), 1e-12);
+    }
+
+    // Without an adjacency list, none is created.
+    geometry::TriangleMesh plain = *sphere;
+    plain.SpatialReorder();
+    EXPECT_FALSE(plain.HasAdjacencyList());
+    EXPECT_FALSE(plain.HasVertexNormals());
+    EXPECT_FALSE(plain.HasVertexColors());
+
+    geometry::TriangleMesh empty;
+    EXPECT_TRUE(empty.SpatialReorder().empty());
+}
+
+}  // namespace u3d::tests
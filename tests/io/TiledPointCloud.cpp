@@ -0,0 +1,300 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/io/TiledPointCloud.h"
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "tests/test_utility/HeightField.h"
+#include "unified3d/geometry/KDTreeSearchParam.h"
+
+namespace u3d::tests {
+
+namespace {
+
+/// Returns a path in the temporary directory that does not exist yet.
+std::string TempTileDirectory(const std::string &name) {
+    const auto path = std::filesystem::temp_directory_path() /
+                      ("u3d_tiled_point_cloud_" + name);
+    std::filesystem::remove_all(path);
+    return path.string();
+}
+
+/// Sorts the points of \p cloud by their coordinates, with their attributes.
+void SortPoints(geometry::PointCloud &cloud) {
+    std::vector<size_t> order(cloud.points_.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::lexicographical_compare(
+                cloud.points_[a].data(), cloud.points_[a].data() + 3,
+                cloud.points_[b].data(), cloud.points_[b].data() + 3);
+    });
+    geometry::PointCloud sorted;
+    for (size_t i : order) {
+        sorted.points_.push_back(cloud.points_[i]);
+        if (cloud.HasNormals()) sorted.normals_.push_back(cloud.normals_[i]);
+        if (cloud.HasColors()) sorted.colors_.push_back(cloud.colors_[i]);
+        if (cloud.HasCovariances()) {
+            sorted.covariances_.push_back(cloud.covariances_[i]);
+        }
+    }
+    cloud = sorted;
+}
+
+/// Random points with all attributes, plus points on and next to the tile
+/// faces and margin boundaries.
+geometry::PointCloud MakeCloud() {
+    geometry::PointCloud cloud;
+    cloud.points_.resize(3000);
+    Rand(cloud.points_, Eigen::Vector3d(-1.5, -0.5, 0),
+         Eigen::Vector3d(2.5, 1.5, 1), 0);
+    for (double x : {-1.0, -0.25, 0.0, 0.75, 1.0, 1.25, 2.0}) {
+        cloud.points_.emplace_back(x, 0.5, 0.5);
+        cloud.points_.emplace_back(0.5, x, 0.75);
+    }
+    const size_t n = cloud.points_.size();
+    cloud.normals_.resize(n);
+    Rand(cloud.normals_, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1),
+         1);
+    cloud.colors_.resize(n);
+    Rand(cloud.colors_, Eigen::Vector3d(0, 0, 0), Eigen::Vector3d(1, 1, 1), 2);
+    std::vector<Eigen::Vector3d> entries(2 * n);
+    Rand(entries, Eigen::Vector3d(-1, -1, -1), Eigen::Vector3d(1, 1, 1), 3);
+    for (size_t i = 0; i < n; ++i) {
+        Eigen::Matrix3d covariance;
+        covariance << entries[i], entries[n + i],
+                entries[i].cross(entries[n + i]);
+        cloud.covariances_.push_back(covariance);
+    }
+    return cloud;
+}
+
+/// Appends \p cloud in chunks of \p chunk_size points.
+void AppendInChunks(io::TiledPointCloud &tiled,
+                    const geometry::PointCloud &cloud,
+                    size_t chunk_size) {
+    for (size_t begin = 0; begin < cloud.points_.size(); begin += chunk_size) {
+        std::vector<size_t> indices(
+                std::min(chunk_size, cloud.points_.size() - begin));
+        std::iota(indices.begin(), indices.end(), begin);
+        tiled.Append(*cloud.SelectByIndex(indices));
+    }
+}
+
+/// Merges the tiles of \p tiled into one point cloud sorted by SortPoints().
+geometry::PointCloud MergeSorted(const io::TiledPointCloud &tiled) {
+    geometry::PointCloud merged = *tiled.ToPointCloud();
+    SortPoints(merged);
+    return merged;
+}
+
+}  // unnamed namespace
+
+TEST(TiledPointCloud, TileMargins) {
+    const double tile_size = 1.0;
+    const double margin = 0.25;
+    const geometry::PointCloud cloud = MakeCloud();
+    // Few buffered points, so that the tiles are spilled several times.
+    io::TiledPointCloud tiled(TempTileDirectory("margins"), tile_size, margin,
+                              500);
+    AppendInChunks(tiled, cloud, 700);
+    EXPECT_EQ(tiled.NumPoints(), cloud.points_.size());
+
+    const std::vector<Eigen::Vector3i> keys = tiled.GetTileKeys();
+    std::set<std::tuple<int, int, int>> keys_ref;
+    for (const Eigen::Vector3d &p : cloud.points_) {
+        const Eigen::Vector3i key = (p / tile_size).array().floor().cast<int>();
+        keys_ref.emplace(key(0), key(1), key(2));
+    }
+    ASSERT_EQ(keys.size(), keys_ref.size());
+    EXPECT_EQ(keys.size(), tiled.NumTiles());
+    auto key_ref = keys_ref.begin();
+    for (const Eigen::Vector3i &key : keys) {
+        EXPECT_EQ(std::make_tuple(key(0), key(1), key(2)), *key_ref++);
+    }
+    for (const Eigen::Vector3i &key : keys) {
+        // A point is in the core of the tile containing it, and in the margin
+        // of the tiles whose cube grown by the margin contains it.
+        geometry::PointCloud core_ref, margin_ref;
+        for (size_t i = 0; i < cloud.points_.size(); ++i) {
+            const Eigen::Vector3d &p = cloud.points_[i];
+            const Eigen::Vector3d lower = key.cast<double>() * tile_size;
+            const Eigen::Vector3d upper =
+                    lower + Eigen::Vector3d::Constant(tile_size);
+            const bool in_core = (p.array() >= lower.array()).all() &&
+                                 (p.array() < upper.array()).all();
+            const bool in_grown = (p.array() >= lower.array() - margin).all() &&
+                                  (p.array() < upper.array() + margin).all();
+            geometry::PointCloud *target =
+                    in_core ? &core_ref : (in_grown ? &margin_ref : nullptr);
+            if (target) {
+                target->points_.push_back(p);
+                target->normals_.push_back(cloud.normals_[i]);
+                target->colors_.push_back(cloud.colors_[i]);
+                target->covariances_.push_back(cloud.covariances_[i]);
+            }
+        }
+
+        auto core = tiled.ReadTile(key);
+        ASSERT_EQ(core->points_.size(), core_ref.points_.size());
+        SortPoints(*core);
+        SortPoints(core_ref);
+        EXPECT_EQ(core->points_, core_ref.points_);
+        EXPECT_EQ(core->normals_, core_ref.normals_);
+        EXPECT_EQ(core->colors_, core_ref.colors_);
+        EXPECT_EQ(core->covariances_, core_ref.covariances_);
+
+        // Margin points come after the core points.
+        auto with_margin = tiled.ReadTile(key, true);
+        ASSERT_EQ(with_margin->points_.size(),
+                  core_ref.points_.size() + margin_ref.points_.size());
+        std::vector<size_t> margin_indices(margin_ref.points_.size());
+        std::iota(margin_indices.begin(), margin_indices.end(),
+                  core_ref.points_.size());
+        auto margin_points = with_margin->SelectByIndex(margin_indices);
+        SortPoints(*margin_points);
+        SortPoints(margin_ref);
+        EXPECT_EQ(margin_points->points_, margin_ref.points_);
+        EXPECT_EQ(margin_points->covariances_, margin_ref.covariances_);
+    }
+
+    auto merged = tiled.ToPointCloud();
+    geometry::PointCloud sorted = cloud;
+    SortPoints(*merged);
+    SortPoints(sorted);
+    EXPECT_EQ(merged->points_, sorted.points_);
+    EXPECT_EQ(merged->covariances_, sorted.covariances_);
+
+    // Chunks must keep the attributes of the first one.
+    geometry::PointCloud no_covariances = *cloud.SelectByIndex({0, 1});
+    no_covariances.covariances_.clear();
+    EXPECT_ANY_THROW(tiled.Append(no_covariances));
+}
+
+TEST(TiledPointCloud, ProcessWithMargin) {
+    const geometry::PointCloud cloud = MakeCloud();
+    io::TiledPointCloud tiled(TempTileDirectory("process"), 1.0, 0.25, 500);
+    AppendInChunks(tiled, cloud, 1000);
+
+    // Every tile sees its margin, and points outside the core are dropped,
+    // so the output has each point exactly once.
+    size_t num_margin_points = 0;
+    auto output = tiled.Process(
+            [&](const geometry::PointCloud &tile) {
+                num_margin_points += tile.points_.size();
+                return std::make_shared<geometry::PointCloud>(tile);
+            },
+            TempTileDirectory("process_output"));
+    EXPECT_GT(num_margin_points, cloud.points_.size());
+    EXPECT_EQ(output->NumPoints(), cloud.points_.size());
+    EXPECT_EQ(output->GetTileKeys(), tiled.GetTileKeys());
+
+    auto merged = output->ToPointCloud();
+    geometry::PointCloud sorted = cloud;
+    SortPoints(*merged);
+    SortPoints(sorted);
+    EXPECT_EQ(merged->points_, sorted.points_);
+    EXPECT_EQ(merged->normals_, sorted.normals_);
+    EXPECT_EQ(merged->colors_, sorted.colors_);
+    EXPECT_EQ(merged->covariances_, sorted.covariances_);
+}
+
+TEST(TiledPointCloud, VoxelDownSample) {
+    const geometry::PointCloud cloud = MakeCloud();
+    io::TiledPointCloud tiled(TempTileDirectory("voxel"), 1.0, 0.25, 500);
+    AppendInChunks(tiled, cloud, 1000);
+
+    // The tiles are multiples of the voxels, so the whole cloud downsampled
+    // on a grid anchored at a tile corner has the same voxels. Only the order
+    // in which the points of a voxel are averaged differs.
+    const double voxel_size = 0.25;
+    auto output = tiled.VoxelDownSample(voxel_size,
+                                        TempTileDirectory("voxel_output"));
+    geometry::PointCloud expected = *std::get<0>(
+            cloud.VoxelDownSampleAndTraceCSR(voxel_size,
+                                             Eigen::Vector3d(-2, -1, 0),
+                                             Eigen::Vector3d(3, 2, 1)));
+    EXPECT_LT(expected.points_.size(), cloud.points_.size());
+    EXPECT_EQ(output->NumPoints(), expected.points_.size());
+    const geometry::PointCloud merged = MergeSorted(*output);
+    SortPoints(expected);
+    ExpectEQ(merged.points_, expected.points_, 1e-12);
+    ExpectEQ(merged.normals_, expected.normals_, 1e-12);
+    ExpectEQ(merged.colors_, expected.colors_, 1e-12);
+    ExpectEQ(merged.covariances_, expected.covariances_, 1e-12);
+
+    EXPECT_ANY_THROW(
+            tiled.VoxelDownSample(0.3, TempTileDirectory("voxel_invalid")));
+}
+
+TEST(TiledPointCloud, RemoveRadiusOutliers) {
+    const geometry::PointCloud cloud = MakeCloud();
+    io::TiledPointCloud tiled(TempTileDirectory("radius"), 1.0, 0.25, 500);
+    AppendInChunks(tiled, cloud, 1000);
+
+    // The neighbors of the points next to the tile faces are in the margin,
+    // so each point is kept or removed as in the whole cloud.
+    const size_t nb_points = 12;
+    const double search_radius = 0.2;
+    auto output = tiled.RemoveRadiusOutliers(
+            nb_points, search_radius, TempTileDirectory("radius_output"));
+    geometry::PointCloud expected =
+            *std::get<0>(cloud.RemoveRadiusOutliers(nb_points, search_radius));
+    EXPECT_GT(expected.points_.size(), size_t(0));
+    EXPECT_LT(expected.points_.size(), cloud.points_.size());
+    EXPECT_EQ(output->NumPoints(), expected.points_.size());
+    const geometry::PointCloud merged = MergeSorted(*output);
+    SortPoints(expected);
+    EXPECT_EQ(merged.points_, expected.points_);
+    EXPECT_EQ(merged.normals_, expected.normals_);
+    EXPECT_EQ(merged.colors_, expected.colors_);
+    EXPECT_EQ(merged.covariances_, expected.covariances_);
+
+    EXPECT_ANY_THROW(tiled.RemoveRadiusOutliers(
+            nb_points, 0.3, TempTileDirectory("radius_invalid")));
+}
+
+TEST(TiledPointCloud, EstimateNormals) {
+    // A surface crossing the tile faces in x, y and z. The normals point up
+    // to orient the estimated ones.
+    geometry::PointCloud cloud = SampleHeightField(20000, 4);
+    cloud.normals_.assign(cloud.points_.size(), Eigen::Vector3d::UnitZ());
+    io::TiledPointCloud tiled(TempTileDirectory("normals"), 1.0, 0.25, 5000);
+    AppendInChunks(tiled, cloud, 7000);
+
+    // The neighborhoods are found in the margin, in another order, so the
+    // normals are equal up to rounding.
+    const geometry::KDTreeSearchParamRadius radius(0.2);
+    const geometry::KDTreeSearchParamHybrid hybrid(0.25, 30);
+    for (const geometry::KDTreeSearchParam *search_param :
+         {static_cast<const geometry::KDTreeSearchParam *>(&radius),
+          static_cast<const geometry::KDTreeSearchParam *>(&hybrid)}) {
+        auto output = tiled.EstimateNormals(
+                TempTileDirectory("normals_output"), *search_param);
+        geometry::PointCloud expected = cloud;
+        expected.EstimateNormals(*search_param);
+        EXPECT_EQ(output->NumPoints(), cloud.points_.size());
+        const geometry::PointCloud merged = MergeSorted(*output);
+        SortPoints(expected);
+        EXPECT_EQ(merged.points_, expected.points_);
+        ExpectEQ(merged.normals_, expected.normals_);
+        EXPECT_NE(merged.normals_, cloud.normals_);
+    }
+
+    EXPECT_ANY_THROW(
+            tiled.EstimateNormals(TempTileDirectory("normals_invalid"),
+                                  geometry::KDTreeSearchParamRadius(0.3)));
+}
+
+}  // namespace u3d::tests
@@ -0,0 +1,320 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/pipelines/registration/Registration.h"
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <memory>
+#include <vector>
+
+#include "tests/Tests.h"
+#include "tests/test_utility/HeightField.h"
+#include "unified3d/geometry/KDTreeFlann.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/pipelines/registration/RobustKernel.h"
+
+namespace u3d::tests {
+
+namespace {
+
+using pipelines::registration::CorrespondenceSet;
+using pipelines::registration::ICPConvergenceCriteria;
+using pipelines::registration::RegistrationResult;
+using pipelines::registration::RobustKernel;
+using pipelines::registration::TransformationEstimation;
+using pipelines::registration::TransformationEstimationPointToPlane;
+using pipelines::registration::TransformationEstimationPointToPoint;
+
+/// Points and normals of a height field over [-1, 1]^2, curved differently
+/// along both axes, so that the alignment with a nearby copy is unique.
+geometry::PointCloud MakeSurface() {
+    return SampleHeightField(4000, 0, Eigen::Vector2d(2, 3), 1.0, 0.0, true);
+}
+
+/// A rigid transformation of a few degrees and centimeters.
+Eigen::Matrix4d MakeTransformation() {
+    Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+    transformation.block<3, 3>(0, 0) =
+            Eigen::AngleAxisd(0.1, Eigen::Vector3d(1, 2, 3).normalized())
+                    .toRotationMatrix();
+    transformation.block<3, 1>(0, 3) = Eigen::Vector3d(0.05, -0.03, 0.04);
+    return transformation;
+}
+
+/// Registers the target moved by the inverse of \p transformation back onto
+/// the target, so that ICP should recover \p transformation.
+RegistrationResult RegisterMovedCopy(
+        const geometry::PointCloud &target,
+        const Eigen::Matrix4d &transformation,
+        const TransformationEstimation &estimation) {
+    geometry::PointCloud source = target;
+    source.normals_.clear();
+    source.Transform(transformation.inverse());
+    return pipelines::registration::RegistrationICP(
+            source, target, 0.3, Eigen::Matrix4d::Identity(), estimation,
+            ICPConvergenceCriteria(1e-12, 1e-12, 100));
+}
+
+/// Expects \p result to be bitwise equal to \p expected, apart from the
+/// timings.
+void ExpectSameResult(const RegistrationResult &result,
+                      const RegistrationResult &expected) {
+    EXPECT_EQ(result.transformation_, expected.transformation_);
+    EXPECT_EQ(result.fitness_, expected.fitness_);
+    EXPECT_EQ(result.inlier_rmse_, expected.inlier_rmse_);
+    EXPECT_EQ(result.correspondence_set_, expected.correspondence_set_);
+    ASSERT_EQ(result.iteration_stats_.size(),
+              expected.iteration_stats_.size());
+    for (size_t i = 0; i < expected.iteration_stats_.size(); ++i) {
+        EXPECT_EQ(result.iteration_stats_[i].fitness_,
+                  expected.iteration_stats_[i].fitness_);
+        EXPECT_EQ(result.iteration_stats_[i].inlier_rmse_,
+                  expected.iteration_stats_[i].inlier_rmse_);
+    }
+}
+
+/// Runs \p num_iterations steps of \p estimation on the fixed
+/// correspondences \p corres, as ICP would if they did not change, and
+/// returns the accumulated transformation of \p source.
+Eigen::Matrix4d EstimateWithFixedCorrespondences(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres,
+        const TransformationEstimation &estimation,
+        int num_iterations) {
+    Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+    geometry::PointCloud moved = source;
+    for (int i = 0; i < num_iterations; ++i) {
+        const Eigen::Matrix4d update =
+                estimation.ComputeTransformation(moved, target, corres);
+        moved.Transform(update);
+        transformation = update * transformation;
+    }
+    return transformation;
+}
+
+}  // unnamed namespace
+
+TEST(Registration, ICPPointToPoint) {
+    const geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    const auto result = RegisterMovedCopy(
+            target, transformation, TransformationEstimationPointToPoint());
+    ExpectEQ(result.transformation_, transformation, 1e-6);
+    EXPECT_EQ(result.fitness_, 1.0);
+    EXPECT_LT(result.inlier_rmse_, 1e-6);
+    EXPECT_EQ(result.correspondence_set_.size(), target.points_.size());
+    EXPECT_FALSE(result.iteration_stats_.empty());
+}
+
+TEST(Registration, ICPPointToPlane) {
+    const geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    const auto result = RegisterMovedCopy(
+            target, transformation, TransformationEstimationPointToPlane());
+    ExpectEQ(result.transformation_, transformation, 1e-6);
+    EXPECT_EQ(result.fitness_, 1.0);
+    EXPECT_LT(result.inlier_rmse_, 1e-6);
+
+    // Without target normals, the source is left in place.
+    geometry::PointCloud no_normals = target;
+    no_normals.normals_.clear();
+    EXPECT_EQ(RegisterMovedCopy(no_normals, transformation,
+                                TransformationEstimationPointToPlane())
+                      .transformation_,
+              Eigen::Matrix4d::Identity());
+}
+
+TEST(Registration, ICPThreadCountIndependent) {
+    const geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    const TransformationEstimationPointToPoint point_to_point;
+    const TransformationEstimationPointToPlane point_to_plane;
+
+    for (const TransformationEstimation *estimation :
+         std::vector<const TransformationEstimation *>{&point_to_point,
+                                                       &point_to_plane}) {
+        const auto serial = [&] {
+            ScopedMaxNumberOfThreads serial_threads(1);
+            return RegisterMovedCopy(target, transformation, *estimation);
+        }();
+        ForEachThreadCount([&] {
+            const auto parallel =
+                    RegisterMovedCopy(target, transformation, *estimation);
+            EXPECT_EQ(parallel.transformation_, serial.transformation_);
+            EXPECT_EQ(parallel.fitness_, serial.fitness_);
+            EXPECT_EQ(parallel.inlier_rmse_, serial.inlier_rmse_);
+            EXPECT_EQ(parallel.correspondence_set_,
+                      serial.correspondence_set_);
+            EXPECT_EQ(parallel.iteration_stats_.size(),
+                      serial.iteration_stats_.size());
+        });
+    }
+}
+
+TEST(Registration, ICPWithPrebuiltKDTree) {
+    const geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    geometry::PointCloud source = target;
+    source.normals_.clear();
+    source.Transform(transformation.inverse());
+    const geometry::KDTreeFlann target_kdtree(target);
+    const ICPConvergenceCriteria criteria(1e-12, 1e-12, 100);
+
+    const TransformationEstimationPointToPoint point_to_point;
+    const TransformationEstimationPointToPlane point_to_plane;
+    for (const TransformationEstimation *estimation :
+         std::vector<const TransformationEstimation *>{&point_to_point,
+                                                       &point_to_plane}) {
+        const auto expected = pipelines::registration::RegistrationICP(
+                source, target, 0.3, Eigen::Matrix4d::Identity(), *estimation,
+                criteria);
+        // The same tree serves several registrations.
+        for (int i = 0; i < 2; ++i) {
+            ExpectSameResult(pipelines::registration::RegistrationICP(
+                                     source, target, target_kdtree, 0.3,
+                                     Eigen::Matrix4d::Identity(), *estimation,
+                                     criteria),
+                             expected);
+        }
+        ExpectEQ(expected.transformation_, transformation, 1e-6);
+    }
+
+    EXPECT_ANY_THROW(pipelines::registration::RegistrationICP(
+            source, target, target_kdtree, 0.0));
+}
+
+TEST(Registration, MultiScaleICP) {
+    const geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    geometry::PointCloud source = target;
+    source.normals_.clear();
+    source.Transform(transformation.inverse());
+    // Coarse to fine, ending with the clouds themselves.
+    const std::vector<double> voxel_sizes = {0.2, 0.08, 0.0};
+    const std::vector<ICPConvergenceCriteria> criteria(
+            3, ICPConvergenceCriteria(1e-12, 1e-12, 100));
+    const std::vector<double> distances = {0.4, 0.2, 0.1};
+
+    const TransformationEstimationPointToPoint point_to_point;
+    const TransformationEstimationPointToPlane point_to_plane;
+    for (const TransformationEstimation *estimation :
+         std::vector<const TransformationEstimation *>{&point_to_point,
+                                                       &point_to_plane}) {
+        const auto result = pipelines::registration::RegistrationMultiScaleICP(
+                source, target, voxel_sizes, criteria, distances,
+                Eigen::Matrix4d::Identity(), *estimation);
+        ExpectEQ(result.transformation_, transformation, 1e-6);
+        EXPECT_EQ(result.fitness_, 1.0);
+        EXPECT_LT(result.inlier_rmse_, 1e-6);
+        EXPECT_EQ(result.correspondence_set_.size(), source.points_.size());
+
+        // The statistics cover every scale, in order.
+        ASSERT_FALSE(result.iteration_stats_.empty());
+        EXPECT_EQ(result.iteration_stats_.front().scale_, 0);
+        EXPECT_EQ(result.iteration_stats_.back().scale_, 2);
+        for (size_t i = 1; i < result.iteration_stats_.size(); ++i) {
+            const auto &previous = result.iteration_stats_[i - 1];
+            const auto &stat = result.iteration_stats_[i];
+            EXPECT_LE(stat.scale_ - previous.scale_, 1);
+            if (stat.scale_ == previous.scale_) {
+                EXPECT_EQ(stat.iteration_, previous.iteration_ + 1);
+            } else {
+                EXPECT_EQ(stat.scale_, previous.scale_ + 1);
+                EXPECT_EQ(stat.iteration_, 0);
+            }
+        }
+
+        // A single full resolution scale is plain ICP.
+        ExpectSameResult(pipelines::registration::RegistrationMultiScaleICP(
+                                 source, target, {0.0}, {criteria[0]}, {0.3},
+                                 Eigen::Matrix4d::Identity(), *estimation),
+                         pipelines::registration::RegistrationICP(
+                                 source, target, 0.3,
+                                 Eigen::Matrix4d::Identity(), *estimation,
+                                 criteria[0]));
+    }
+}
+
+TEST(Registration, MultiScaleICPInvalidArguments) {
+    const geometry::PointCloud target = MakeSurface();
+    const geometry::PointCloud &source = target;
+    const ICPConvergenceCriteria criteria;
+    auto multi_scale = [&](const std::vector<double> &voxel_sizes,
+                           const std::vector<ICPConvergenceCriteria> &list,
+                           const std::vector<double> &distances) {
+        return pipelines::registration::RegistrationMultiScaleICP(
+                source, target, voxel_sizes, list, distances);
+    };
+
+    EXPECT_NO_THROW(
+            multi_scale({0.1, 0.0}, {criteria, criteria}, {0.3, 0.1}));
+    // Empty or mismatched sizes.
+    EXPECT_ANY_THROW(multi_scale({}, {}, {}));
+    EXPECT_ANY_THROW(multi_scale({0.1, 0.0}, {criteria}, {0.3, 0.1}));
+    EXPECT_ANY_THROW(multi_scale({0.1, 0.0}, {criteria, criteria}, {0.3}));
+    EXPECT_ANY_THROW(multi_scale({0.1}, {criteria, criteria}, {0.3, 0.1}));
+    // Increasing or negative voxel sizes.
+    EXPECT_ANY_THROW(
+            multi_scale({0.05, 0.1}, {criteria, criteria}, {0.3, 0.1}));
+    EXPECT_ANY_THROW(
+            multi_scale({0.1, -0.1}, {criteria, criteria}, {0.3, 0.1}));
+    // Non-positive correspondence distances.
+    EXPECT_ANY_THROW(multi_scale({0.1, 0.0}, {criteria, criteria}, {0.3, 0.0}));
+}
+
+TEST(Registration, RobustKernelsRejectOutliers) {
+    // The source is a moved copy of the surface, matched to its own points
+    // and, for one point in twenty, to points lifted far above the surface.
+    geometry::PointCloud target = MakeSurface();
+    const Eigen::Matrix4d transformation = MakeTransformation();
+    geometry::PointCloud source = target;
+    source.normals_.clear();
+    source.Transform(transformation.inverse());
+    const int num_points = static_cast<int>(source.points_.size());
+    CorrespondenceSet corres;
+    for (int i = 0; i < num_points; ++i) {
+        corres.emplace_back(i, i);
+    }
+    for (int i = 0; i < num_points; i += 20) {
+        const int outlier = static_cast<int>(target.points_.size());
+        target.points_.push_back(target.points_[num_points - 1 - i] +
+                                 Eigen::Vector3d(0, 0, 5));
+        target.normals_.push_back(target.normals_[num_points - 1 - i]);
+        corres.emplace_back(i, outlier);
+    }
+
+    auto error = [&](const TransformationEstimation &estimation) {
+        return (EstimateWithFixedCorrespondences(source, target, corres,
+                                                 estimation, 50) -
+                transformation)
+                .cwiseAbs()
+                .maxCoeff();
+    };
+    auto point_to_point = [](std::shared_ptr<RobustKernel> kernel) {
+        return TransformationEstimationPointToPoint(false, kernel);
+    };
+    auto point_to_plane = [](std::shared_ptr<RobustKernel> kernel) {
+        return TransformationEstimationPointToPlane(kernel);
+    };
+    using pipelines::registration::HuberLoss;
+    using pipelines::registration::L2Loss;
+    using pipelines::registration::TukeyLoss;
+
+    // Least squares is dragged towards the outliers.
+    EXPECT_GT(error(point_to_point(nullptr)), 0.1);
+    EXPECT_GT(error(point_to_point(std::make_shared<L2Loss>())), 0.1);
+    EXPECT_GT(error(point_to_plane(nullptr)), 0.1);
+    // Tukey gives the outliers, all farther than k, no weight at all.
+    EXPECT_LT(error(point_to_point(std::make_shared<TukeyLoss>(1.0))), 1e-9);
+    EXPECT_LT(error(point_to_plane(std::make_shared<TukeyLoss>(1.0))), 1e-9);
+    // Huber bounds the pull of each outlier by k.
+    EXPECT_LT(error(point_to_point(std::make_shared<HuberLoss>(0.05))), 0.02);
+    EXPECT_LT(error(point_to_plane(std::make_shared<HuberLoss>(0.05))), 0.02);
+}
+
+}  // namespace u3d::tests
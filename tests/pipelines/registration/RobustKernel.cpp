@@ -0,0 +1,81 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/pipelines/registration/RobustKernel.h"
+
+#include <limits>
+
+#include "tests/Tests.h"
+
+namespace u3d::tests {
+
+using pipelines::registration::CauchyLoss;
+using pipelines::registration::GMLoss;
+using pipelines::registration::HuberLoss;
+using pipelines::registration::L1Loss;
+using pipelines::registration::L2Loss;
+using pipelines::registration::TukeyLoss;
+
+TEST(RobustKernel, L2Loss) {
+    const L2Loss kernel;
+    for (double residual : {0.0, 0.5, -3.0, 1e6}) {
+        EXPECT_EQ(kernel.Weight(residual), 1.0);
+    }
+}
+
+TEST(RobustKernel, L1Loss) {
+    const L1Loss kernel;
+    EXPECT_DOUBLE_EQ(kernel.Weight(0.5), 2.0);
+    EXPECT_DOUBLE_EQ(kernel.Weight(-4.0), 0.25);
+    // Exact matches get a large, finite weight.
+    EXPECT_DOUBLE_EQ(kernel.Weight(0.0), 1e12);
+}
+
+TEST(RobustKernel, HuberLoss) {
+    const HuberLoss kernel(0.5);
+    EXPECT_EQ(kernel.Weight(0.0), 1.0);
+    EXPECT_EQ(kernel.Weight(0.3), 1.0);
+    EXPECT_EQ(kernel.Weight(-0.5), 1.0);
+    EXPECT_DOUBLE_EQ(kernel.Weight(2.0), 0.25);
+    EXPECT_DOUBLE_EQ(kernel.Weight(-1.0), 0.5);
+}
+
+TEST(RobustKernel, CauchyLoss) {
+    const CauchyLoss kernel(2.0);
+    EXPECT_EQ(kernel.Weight(0.0), 1.0);
+    EXPECT_DOUBLE_EQ(kernel.Weight(2.0), 0.5);
+    EXPECT_DOUBLE_EQ(kernel.Weight(-4.0), 0.2);
+}
+
+TEST(RobustKernel, GMLoss) {
+    const GMLoss kernel(1.0);
+    EXPECT_EQ(kernel.Weight(0.0), 1.0);
+    EXPECT_DOUBLE_EQ(kernel.Weight(1.0), 0.25);
+    EXPECT_DOUBLE_EQ(kernel.Weight(-3.0), 0.01);
+    // The weight at 0 is 1 / k.
+    EXPECT_DOUBLE_EQ(GMLoss(0.5).Weight(0.0), 2.0);
+}
+
+TEST(RobustKernel, TukeyLoss) {
+    const TukeyLoss kernel(2.0);
+    EXPECT_EQ(kernel.Weight(0.0), 1.0);
+    EXPECT_DOUBLE_EQ(kernel.Weight(1.0), 0.5625);
+    EXPECT_DOUBLE_EQ(kernel.Weight(-1.0), 0.5625);
+    EXPECT_EQ(kernel.Weight(2.0), 0.0);
+    EXPECT_EQ(kernel.Weight(-3.0), 0.0);
+}
+
+TEST(RobustKernel, NonPositiveScale) {
+    for (double k : {0.0, -1.0, std::numeric_limits<double>::quiet_NaN()}) {
+        EXPECT_ANY_THROW(HuberLoss{k});
+        EXPECT_ANY_THROW(CauchyLoss{k});
+        EXPECT_ANY_THROW(GMLoss{k});
+        EXPECT_ANY_THROW(TukeyLoss{k});
+    }
+    EXPECT_NO_THROW(HuberLoss{1e-6});
+}
+
+}  // namespace u3d::tests
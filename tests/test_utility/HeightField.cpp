@@ -0,0 +1,44 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "tests/test_utility/HeightField.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tests/test_utility/Rand.h"
+
+namespace u3d::tests {
+
+geometry::PointCloud SampleHeightField(size_t num_points,
+                                       int seed,
+                                       const Eigen::Vector2d &frequency,
+                                       double half_width,
+                                       double noise,
+                                       bool with_normals) {
+    std::vector<Eigen::Vector3d> samples(num_points);
+    Rand(samples, Eigen::Vector3d(-half_width, -half_width, -noise),
+         Eigen::Vector3d(half_width, half_width, noise), seed);
+    const double fx = frequency(0);
+    const double fy = frequency(1);
+    geometry::PointCloud cloud;
+    for (const Eigen::Vector3d &sample : samples) {
+        const double x = sample(0);
+        const double y = sample(1);
+        cloud.points_.emplace_back(
+                x, y,
+                0.3 * std::sin(fx * x) * std::cos(fy * y) + sample(2));
+        if (with_normals) {
+            const double dzdx = 0.3 * fx * std::cos(fx * x) * std::cos(fy * y);
+            const double dzdy = -0.3 * fy * std::sin(fx * x) * std::sin(fy * y);
+            cloud.normals_.push_back(
+                    Eigen::Vector3d(-dzdx, -dzdy, 1).normalized());
+        }
+    }
+    return cloud;
+}
+
+}  // namespace u3d::tests
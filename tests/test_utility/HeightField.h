@@ -0,0 +1,34 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::tests {
+
+/// \brief Samples the height field z = 0.3 * sin(fx * x) * cos(fy * y).
+///
+/// \param num_points Number of points, with (x, y) uniformly random in
+/// [-half_width, half_width]^2.
+/// \param seed Seed of the random samples.
+/// \param frequency The frequencies (fx, fy).
+/// \param half_width Half width of the sampled square.
+/// \param noise Uniformly random noise in [-noise, noise] added to z.
+/// \param with_normals Sets the analytic normals of the noise-free surface,
+/// pointing up.
+geometry::PointCloud SampleHeightField(
+        size_t num_points,
+        int seed,
+        const Eigen::Vector2d &frequency = Eigen::Vector2d(2, 2),
+        double half_width = 2.0,
+        double noise = 0.0,
+        bool with_normals = false);
+
+}  // namespace u3d::tests
@@ -6,6 +6,8 @@
 
 #include <unified3d/core/Dtype.h>
 
+#include <algorithm>
+
 namespace u3d::core {
 
 // clang-format off
@@ -64,4 +66,64 @@ bool Dtype::operator==(const Dtype &other) const {
 
 bool Dtype::operator!=(const Dtype &other) const { return !(*this == other); }
 
+Dtype PromoteDtypes(const Dtype &lhs, const Dtype &rhs) {
+    if (lhs == rhs) {
+        return lhs;
+    }
+    if (lhs.IsObject() || rhs.IsObject() || lhs == Undefined ||
+        rhs == Undefined) {
+        utility::LogError("Cannot promote dtypes {} and {}.", lhs.ToString(),
+                          rhs.ToString());
+    }
+    if (lhs == Float32 || rhs == Float32) {
+        return Float32;
+    }
+    if (lhs == Bool) {
+        return rhs;
+    }
+    if (rhs == Bool) {
+        return lhs;
+    }
+
+    auto int_dtype = [](int64_t byte_size) {
+        switch (byte_size) {
+            case 1:
+                return Int8;
+            case 2:
+                return Int16;
+            case 4:
+                return Int32;
+            default:
+                return Int64;
+        }
+    };
+    auto uint_dtype = [](int64_t byte_size) {
+        switch (byte_size) {
+            case 1:
+                return UInt8;
+            case 2:
+                return UInt16;
+            case 4:
+                return UInt32;
+            default:
+                return UInt64;
+        }
+    };
+    const int64_t byte_size = std::max(lhs.ByteSize(), rhs.ByteSize());
+    if (lhs.GetDtypeCode() == rhs.GetDtypeCode()) {
+        return lhs.GetDtypeCode() == Dtype::DtypeCode::Int
+                       ? int_dtype(byte_size)
+                       : uint_dtype(byte_size);
+    }
+    // Signed and unsigned: the signed dtype must be wider than the unsigned
+    // one to hold both ranges.
+    const Dtype &unsigned_dtype =
+            lhs.GetDtypeCode() == Dtype::DtypeCode::UInt ? lhs : rhs;
+    const Dtype &signed_dtype = &unsigned_dtype == &lhs ? rhs : lhs;
+    if (signed_dtype.ByteSize() > unsigned_dtype.ByteSize()) {
+        return signed_dtype;
+    }
+    return int_dtype(std::min<int64_t>(2 * unsigned_dtype.ByteSize(), 8));
+}
+
 }  // namespace u3d::core
@@ -86,6 +86,14 @@ UNIFIED3D_API extern const Dtype UInt32;
 UNIFIED3D_API extern const Dtype UInt64;
 UNIFIED3D_API extern const Dtype Bool;
 
+/// \brief Returns the dtype that mixed-dtype arithmetic between \p lhs and
+/// \p rhs is computed in.
+///
+/// Float32 wins over integers, integers win over Bool, and two integer dtypes
+/// give the narrowest integer dtype holding both value ranges, e.g. UInt8 and
+/// Int8 give Int16. UInt64 with a signed dtype gives Int64.
+UNIFIED3D_API Dtype PromoteDtypes(const Dtype &lhs, const Dtype &rhs);
+
 template <>
 inline Dtype Dtype::FromType<float>() {
     return Dtype::Float32;
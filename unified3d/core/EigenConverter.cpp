@@ -0,0 +1,149 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/core/EigenConverter.h"
+
+#include <mach/mach.h>
+
+#include <Metal/Metal.hpp>
+#include <new>
+
+#include "unified3d/core/Dispatch.h"
+#include "unified3d/core/Parallel.h"
+#include "unified3d/core/TensorCheck.h"
+#include "unified3d/metal/Device.h"
+
+namespace u3d::core::eigen_converter {
+
+template <typename EigenVector>
+static std::vector<EigenVector> TensorToEigenVector3Vector(
+        const Tensor& tensor) {
+    AssertTensorShape(tensor, {std::nullopt, 3});
+    using eigen_scalar_t = typename EigenVector::Scalar;
+    const Tensor tensor_c = tensor.Contiguous();
+    const int64_t num_vectors = tensor_c.GetLength();
+    std::vector<EigenVector> vectors(num_vectors);
+    DISPATCH_DTYPE_TO_TEMPLATE(tensor_c.GetDtype(), [&]() {
+        const scalar_t* data = tensor_c.GetSpan<scalar_t>().data();
+        parallelFor(
+                int64_t(0), num_vectors,
+                [&](int64_t i) {
+                    vectors[i] = EigenVector(
+                            static_cast<eigen_scalar_t>(data[3 * i + 0]),
+                            static_cast<eigen_scalar_t>(data[3 * i + 1]),
+                            static_cast<eigen_scalar_t>(data[3 * i + 2]));
+                },
+                executionPolicyFor(num_vectors));
+    });
+    return vectors;
+}
+
+template <typename EigenVector>
+static Tensor EigenVector3VectorToTensor(const std::vector<EigenVector>& values,
+                                         Dtype dtype,
+                                         const Device& device) {
+    const auto num_vectors = static_cast<int64_t>(values.size());
+    Tensor tensor({num_vectors, 3}, dtype, device);
+    DISPATCH_DTYPE_TO_TEMPLATE(dtype, [&]() {
+        scalar_t* data = tensor.GetSpan<scalar_t>().data();
+        parallelFor(
+                int64_t(0), num_vectors,
+                [&](int64_t i) {
+                    data[3 * i + 0] = static_cast<scalar_t>(values[i](0));
+                    data[3 * i + 1] = static_cast<scalar_t>(values[i](1));
+                    data[3 * i + 2] = static_cast<scalar_t>(values[i](2));
+                },
+                executionPolicyFor(num_vectors));
+    });
+    return tensor;
+}
+
+static size_t RoundUpToPages(size_t byte_size) {
+    return vm_page_size * ((byte_size + vm_page_size - 1) / vm_page_size);
+}
+
+void* AllocateHostPages(size_t byte_size) {
+    vm_address_t address = 0;
+    if (vm_allocate(mach_task_self(), &address, RoundUpToPages(byte_size),
+                    VM_FLAGS_ANYWHERE) != KERN_SUCCESS) {
+        throw std::bad_alloc();
+    }
+    return reinterpret_cast<void*>(address);
+}
+
+void FreeHostPages(void* data, size_t byte_size) {
+    if (data) {
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(data),
+                      RoundUpToPages(byte_size));
+    }
+}
+
+Tensor HostMemoryToTensorView(void* data,
+                              const SizeVector& shape,
+                              Dtype dtype,
+                              const std::shared_ptr<const void>& owner,
+                              bool page_allocated) {
+    const size_t byte_size = shape.NumElements() * dtype.ByteSize();
+    if (byte_size == 0) {
+        return Tensor(shape, dtype);
+    }
+
+    // Metal wraps host memory without copying only if it is page-aligned
+    // memory from vm_allocate() or mmap() spanning whole pages. Anything else,
+    // e.g. the storage of a std::vector with the default allocator, may share
+    // its pages with other heap allocations. Copying it silently would lose
+    // the writes through the tensor, so it is rejected.
+    const auto address = reinterpret_cast<uintptr_t>(data);
+    if (!page_allocated || address % vm_page_size != 0) {
+        utility::LogError(
+                "Host memory at {} cannot be wrapped without copying: it "
+                "must be page-aligned and page-allocated. Use "
+                "EigenVector3dVectorToTensorCopy() or "
+                "EigenVector3iVectorToTensorCopy() to copy it instead.",
+                data);
+    }
+
+    MTL::Buffer* buffer = metal::Device::GetInstance().mtl_device()->newBuffer(
+            data, RoundUpToPages(byte_size), MTL::ResourceStorageModeShared,
+            nullptr);
+    if (!buffer) {
+        utility::LogError("Failed to wrap {} bytes of host memory.",
+                          byte_size);
+    }
+
+    metal::Buffer data_view(buffer, 0);
+    // The blob releases the Metal wrapper and drops its reference to the
+    // owner once the last tensor sharing it is destroyed.
+    auto blob = std::make_shared<Blob>(
+            Device("CPU:0"), data_view,
+            [buffer, owner](void*) { buffer->release(); });
+    return Tensor(shape, shape_util::DefaultStrides(shape), data_view, dtype,
+                  blob);
+}
+
+std::vector<Eigen::Vector3d> TensorToEigenVector3dVector(const Tensor& tensor) {
+    return TensorToEigenVector3Vector<Eigen::Vector3d>(tensor);
+}
+
+std::vector<Eigen::Vector3i> TensorToEigenVector3iVector(const Tensor& tensor) {
+    return TensorToEigenVector3Vector<Eigen::Vector3i>(tensor);
+}
+
+Tensor EigenVector3dVectorToTensorCopy(
+        const std::vector<Eigen::Vector3d>& values,
+        Dtype dtype,
+        const Device& device) {
+    return EigenVector3VectorToTensor(values, dtype, device);
+}
+
+Tensor EigenVector3iVectorToTensorCopy(
+        const std::vector<Eigen::Vector3i>& values,
+        Dtype dtype,
+        const Device& device) {
+    return EigenVector3VectorToTensor(values, dtype, device);
+}
+
+}  // namespace u3d::core::eigen_converter
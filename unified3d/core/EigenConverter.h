@@ -0,0 +1,193 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "unified3d/core/Tensor.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::core::eigen_converter {
+
+/// Row-major Eigen matrix with a fixed (or dynamic) number of columns, matching
+/// the memory layout of a contiguous (N, Cols) tensor.
+template <typename T, int Cols>
+using EigenRowMajorMatrix =
+        Eigen::Matrix<T,
+                      Eigen::Dynamic,
+                      Cols,
+                      Cols == 1 ? Eigen::ColMajor : Eigen::RowMajor>;
+
+/// \brief Allocates whole pages of host memory with vm_allocate(), rounding
+/// \p byte_size up to a multiple of the page size.
+void* AllocateHostPages(size_t byte_size);
+
+/// \brief Frees memory returned by AllocateHostPages() for \p byte_size.
+void FreeHostPages(void* data, size_t byte_size);
+
+/// \brief STL allocator handing out whole, page-aligned pages.
+///
+/// Metal can only wrap host memory without copying if it is page-aligned,
+/// spans whole pages and comes from vm_allocate() or mmap(). Containers using
+/// this allocator meet these requirements and can be aliased by
+/// EigenVectorVectorToTensorView().
+template <typename T>
+class PageAlignedAllocator {
+public:
+    using value_type = T;
+
+    PageAlignedAllocator() = default;
+    template <typename U>
+    PageAlignedAllocator(const PageAlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(AllocateHostPages(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) { FreeHostPages(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const PageAlignedAllocator<U>&) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const PageAlignedAllocator<U>&) const {
+        return false;
+    }
+};
+
+/// \brief Creates a tensor that aliases externally owned host memory.
+///
+/// Writes through the tensor are visible in the original buffer and vice
+/// versa. \p owner is held by the tensor's blob and released when the last
+/// tensor sharing the blob is destroyed, so the memory stays valid for as
+/// long as it is referenced.
+///
+/// The memory can only be aliased if \p page_allocated is set and \p data
+/// is page-aligned. Otherwise an error is raised; the memory is never copied
+/// silently. Use EigenVector3dVectorToTensorCopy() or
+/// EigenVector3iVectorToTensorCopy() to get a tensor of other memory.
+///
+/// \param data Pointer to contiguous host memory.
+/// \param shape Shape of the tensor. The memory must hold
+/// shape.NumElements() elements of \p dtype.
+/// \param dtype Element type.
+/// \param owner Object keeping \p data alive. May be nullptr if the caller
+/// guarantees the lifetime.
+/// \param page_allocated Set to `true` if \p data was allocated by
+/// AllocateHostPages(), vm_allocate() or mmap() and the allocation spans the
+/// pages covering the data.
+Tensor HostMemoryToTensorView(void* data,
+                              const SizeVector& shape,
+                              Dtype dtype,
+                              const std::shared_ptr<const void>& owner,
+                              bool page_allocated);
+
+/// \brief (N, Rows) tensor aliasing a vector of Eigen vectors, e.g.
+/// std::vector<Eigen::Vector3f, PageAlignedAllocator<Eigen::Vector3f>>.
+///
+/// The vector must use PageAlignedAllocator, which is checked at compile
+/// time. \p owner is kept alive by the tensor, and the vector must not be
+/// resized while the tensor is in use, since reallocation invalidates the
+/// aliased storage.
+///
+/// \note PointCloud::points_, normals_ and colors_ and TriangleMesh::vertices_
+/// cannot be aliased: they hold Eigen::Vector3d, for which there is no
+/// Float64 dtype, and use the default allocator. Tensor kernels on these
+/// containers need a Float32 copy from EigenVector3dVectorToTensorCopy(), and
+/// results are written back with TensorToEigenVector3dVector().
+template <typename Scalar, int Rows, typename Allocator>
+Tensor EigenVectorVectorToTensorView(
+        std::vector<Eigen::Matrix<Scalar, Rows, 1>, Allocator>& vec,
+        const std::shared_ptr<const void>& owner) {
+    static_assert(sizeof(Eigen::Matrix<Scalar, Rows, 1>) ==
+                          sizeof(Scalar) * Rows,
+                  "Eigen vectors must be tightly packed.");
+    static_assert(std::is_same_v<Allocator,
+                                 PageAlignedAllocator<
+                                         Eigen::Matrix<Scalar, Rows, 1>>>,
+                  "Only vectors using PageAlignedAllocator can be aliased; "
+                  "use EigenVector3dVectorToTensorCopy() or "
+                  "EigenVector3iVectorToTensorCopy() to copy other vectors.");
+    return HostMemoryToTensorView(
+            vec.data(), {static_cast<int64_t>(vec.size()), Rows},
+            Dtype::FromType<Scalar>(), owner, true);
+}
+
+template <typename Scalar, int Rows, typename Allocator>
+Tensor EigenVectorVectorToTensorView(
+        const std::shared_ptr<
+                std::vector<Eigen::Matrix<Scalar, Rows, 1>, Allocator>>& vec) {
+    return EigenVectorVectorToTensorView(*vec, vec);
+}
+
+namespace internal {
+
+template <typename T, int Cols>
+void AssertEigenMappable(const Tensor& tensor) {
+    tensor.AssertTemplateDtype<T>();
+    if (tensor.NumDims() != 2 || !tensor.IsContiguous() ||
+        (Cols != Eigen::Dynamic && tensor.GetShape(1) != Cols)) {
+        utility::LogError(
+                "Expected a contiguous 2D tensor with {} columns, but got "
+                "shape {}.",
+                Cols == Eigen::Dynamic ? "any" : std::to_string(Cols),
+                tensor.GetShape().ToString());
+    }
+}
+
+}  // namespace internal
+
+/// \brief Zero-copy Eigen::Map of a contiguous 2D tensor of shape (N, Cols).
+///
+/// The map does not own the data; the tensor (or another tensor sharing its
+/// blob) must outlive it. Pass Eigen::Dynamic as Cols to accept any number of
+/// columns.
+template <typename T, int Cols>
+Eigen::Map<EigenRowMajorMatrix<T, Cols>> TensorToEigenMap(Tensor& tensor) {
+    internal::AssertEigenMappable<T, Cols>(tensor);
+    return Eigen::Map<EigenRowMajorMatrix<T, Cols>>(
+            static_cast<T*>(tensor.GetDataView().CpuAddress()),
+            tensor.GetShape(0), tensor.GetShape(1));
+}
+
+template <typename T, int Cols>
+Eigen::Map<const EigenRowMajorMatrix<T, Cols>> TensorToEigenMap(
+        const Tensor& tensor) {
+    internal::AssertEigenMappable<T, Cols>(tensor);
+    return Eigen::Map<const EigenRowMajorMatrix<T, Cols>>(
+            static_cast<const T*>(tensor.GetDataView().CpuAddress()),
+            tensor.GetShape(0), tensor.GetShape(1));
+}
+
+/// Converts an (N, 3) tensor to std::vector<Eigen::Vector3d>. The data is
+/// copied and converted to double.
+std::vector<Eigen::Vector3d> TensorToEigenVector3dVector(const Tensor& tensor);
+
+/// Converts an (N, 3) tensor to std::vector<Eigen::Vector3i>. The data is
+/// copied and converted to int.
+std::vector<Eigen::Vector3i> TensorToEigenVector3iVector(const Tensor& tensor);
+
+/// Copies a std::vector<Eigen::Vector3d> into a new (N, 3) tensor of
+/// \p dtype, e.g. PointCloud::points_ as Float32. Writes to the tensor do not
+/// reach \p values.
+Tensor EigenVector3dVectorToTensorCopy(
+        const std::vector<Eigen::Vector3d>& values,
+        Dtype dtype = core::Float32,
+        const Device& device = Device("CPU:0"));
+
+/// Copies a std::vector<Eigen::Vector3i> into a new (N, 3) tensor of
+/// \p dtype, e.g. TriangleMesh::triangles_. Writes to the tensor do not
+/// reach \p values.
+Tensor EigenVector3iVectorToTensorCopy(
+        const std::vector<Eigen::Vector3i>& values,
+        Dtype dtype = core::Int32,
+        const Device& device = Device("CPU:0"));
+
+}  // namespace u3d::core::eigen_converter
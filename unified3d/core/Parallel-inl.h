@@ -111,8 +111,9 @@ void merge(RandomIterator a,
         tempi++;
     }
 
-    // Copy sorted temp array into main array, a
-    parallelFor(0, size, [&](size_t i) { a[i] = temp[i]; });
+    // Copy sorted temp array into main array, a. This already runs on one of
+    // the sorting threads.
+    std::copy(temp, temp + size, a);
 }
 
 template <typename RandomIterator,
@@ -198,6 +199,14 @@ void parallelFor(IndexType start,
                     ? (numThreadsHint == 0u ? 8u : numThreadsHint)
                     : 1;
 
+    // Run serial loops inline rather than on a freshly spawned thread
+    if (numThreads == 1) {
+        for (auto i = start; i < end; ++i) {
+            func(i);
+        }
+        return;
+    }
+
     // Size of a slice for the range functions
     IndexType n = end - start + 1;
     auto slice = (IndexType)std::round(n / static_cast<double>(numThreads));
@@ -283,6 +292,12 @@ void parallelRangeFor(IndexType start,
                     ? (numThreadsHint == 0u ? 8u : numThreadsHint)
                     : 1;
 
+    // Run serial loops inline rather than on a freshly spawned thread
+    if (numThreads == 1) {
+        func(start, end);
+        return;
+    }
+
     // Size of a slice for the range functions
     IndexType n = end - start + 1;
     auto slice = (IndexType)std::round(n / static_cast<double>(numThreads));
@@ -418,6 +433,11 @@ Value parallelReduce(IndexType start,
                     ? (numThreadsHint == 0u ? 8u : numThreadsHint)
                     : 1;
 
+    // Run serial reductions inline rather than on a freshly spawned thread
+    if (numThreads == 1) {
+        return reduce(func(start, end, identity), identity);
+    }
+
     // Size of a slice for the range functions
     IndexType n = end - start + 1;
     auto slice = (IndexType)std::round(n / static_cast<double>(numThreads));
@@ -509,4 +529,70 @@ void parallelSort(RandomIterator begin,
                  policy);
 }
 
+template <typename Value>
+void parallelRadixSortByKey(std::vector<uint64_t>& keys,
+                            std::vector<Value>& values,
+                            unsigned int numKeyBits,
+                            ExecutionPolicy policy) {
+    constexpr unsigned int kRadixBits = 8;
+    constexpr size_t kNumBuckets = size_t(1) << kRadixBits;
+    const size_t n = keys.size();
+    if (n <= 1) {
+        return;
+    }
+
+    // Each chunk histograms and scatters its own slice of the input. Chunks
+    // are laid out in order within each bucket, which keeps the sort stable.
+    unsigned int numThreadsHint = maxNumberOfThreads();
+    const size_t numChunks =
+            (policy == ExecutionPolicy::kParallel)
+                    ? (numThreadsHint == 0u ? 8u : numThreadsHint)
+                    : 1;
+    const size_t chunkSize = (n + numChunks - 1) / numChunks;
+    std::vector<size_t> offsets(numChunks * kNumBuckets);
+    std::vector<uint64_t> keysTemp(n);
+    std::vector<Value> valuesTemp(n);
+
+    for (unsigned int shift = 0; shift < numKeyBits; shift += kRadixBits) {
+        std::fill(offsets.begin(), offsets.end(), size_t(0));
+        parallelFor(
+                size_t(0), numChunks,
+                [&](size_t c) {
+                    size_t* histogram = &offsets[c * kNumBuckets];
+                    const size_t begin = std::min(c * chunkSize, n);
+                    const size_t end = std::min(begin + chunkSize, n);
+                    for (size_t i = begin; i < end; ++i) {
+                        ++histogram[(keys[i] >> shift) & (kNumBuckets - 1)];
+                    }
+                },
+                policy);
+
+        size_t offset = 0;
+        for (size_t b = 0; b < kNumBuckets; ++b) {
+            for (size_t c = 0; c < numChunks; ++c) {
+                const size_t count = offsets[c * kNumBuckets + b];
+                offsets[c * kNumBuckets + b] = offset;
+                offset += count;
+            }
+        }
+
+        parallelFor(
+                size_t(0), numChunks,
+                [&](size_t c) {
+                    size_t* chunkOffsets = &offsets[c * kNumBuckets];
+                    const size_t begin = std::min(c * chunkSize, n);
+                    const size_t end = std::min(begin + chunkSize, n);
+                    for (size_t i = begin; i < end; ++i) {
+                        const size_t dst = chunkOffsets[(keys[i] >> shift) &
+                                                        (kNumBuckets - 1)]++;
+                        keysTemp[dst] = keys[i];
+                        valuesTemp[dst] = std::move(values[i]);
+                    }
+                },
+                policy);
+        keys.swap(keysTemp);
+        values.swap(valuesTemp);
+    }
+}
+
 }  // namespace u3d::core
\ No newline at end of file
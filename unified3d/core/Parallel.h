@@ -6,11 +6,40 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 namespace u3d::core {
 
 //! Execution policy tag.
 enum class ExecutionPolicy { kSerial, kParallel };
 
+//! Default number of work items below which a loop is run serially.
+constexpr int64_t kDefaultGrainSize = 32768;
+
+//! Grain size for loops doing substantial work per item, e.g. one
+//! nearest-neighbor search per point.
+constexpr int64_t kHeavyGrainSize = 256;
+
+//!
+//! \brief      Picks the execution policy for a loop of \p numWorkloads items.
+//!
+//! Each parallel call launches its own worker threads, which costs far more
+//! than a cheap loop body over a small range. Loops with fewer than
+//! \p grainSize items are therefore run serially on the calling thread.
+//!
+//! \param[in]  numWorkloads The number of loop iterations.
+//! \param[in]  grainSize    The minimum number of iterations worth
+//!                          parallelizing.
+//!
+//! \return     The execution policy to pass to the parallel functions.
+//!
+inline ExecutionPolicy executionPolicyFor(
+        int64_t numWorkloads, int64_t grainSize = kDefaultGrainSize) {
+    return numWorkloads < grainSize ? ExecutionPolicy::kSerial
+                                    : ExecutionPolicy::kParallel;
+}
+
 //!
 //! \brief      Fills from \p begin to \p end with \p value in parallel.
 //!
@@ -255,6 +284,28 @@ void parallelSort(RandomIterator begin,
                   CompareFunction compare,
                   ExecutionPolicy policy = ExecutionPolicy::kParallel);
 
+//!
+//! \brief      Sorts \p values by the corresponding 64-bit \p keys in parallel.
+//!
+//! This is a stable least-significant-digit radix sort, so values with equal
+//! keys keep their relative order and the result does not depend on the
+//! number of threads. Only the low \p numKeyBits bits of the keys are
+//! compared; passing the number of bits actually in use saves passes.
+//!
+//! \param[in]  keys           The sort keys, sorted in place.
+//! \param[in]  values         The values, permuted along with the keys.
+//! \param[in]  numKeyBits     The number of low key bits to sort by.
+//! \param[in]  policy         The execution policy (parallel or serial).
+//!
+//! \tparam     Value          Value type.
+//!
+template <typename Value>
+void parallelRadixSortByKey(
+        std::vector<uint64_t>& keys,
+        std::vector<Value>& values,
+        unsigned int numKeyBits = 64,
+        ExecutionPolicy policy = ExecutionPolicy::kParallel);
+
 //! Sets maximum number of threads to use.
 void setMaxNumberOfThreads(unsigned int numThreads);
 
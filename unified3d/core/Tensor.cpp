@@ -180,6 +180,7 @@ Tensor& Tensor::operator=(const Tensor& other) & {
     dtype_ = other.dtype_;
     blob_ = other.blob_;
     data_view_ = other.data_view_;
+    is_contiguous_ = other.is_contiguous_;
     return *this;
 }
 
@@ -192,6 +193,7 @@ Tensor& Tensor::operator=(Tensor&& other) & noexcept {
     dtype_ = other.dtype_;
     blob_ = other.blob_;
     data_view_ = other.data_view_;
+    is_contiguous_ = other.is_contiguous_;
     return *this;
 }
 
@@ -921,12 +923,25 @@ double Tensor::Det() const {
     return core::Det(*this);
 }
 
+/// In-place arithmetic writes into this tensor's dtype, so it is only allowed
+/// when mixing in \p value does not promote to another dtype.
+static void AssertInPlaceDtype(const Tensor& dst, const Tensor& value) {
+    const Dtype promoted = PromoteDtypes(dst.GetDtype(), value.GetDtype());
+    if (promoted != dst.GetDtype()) {
+        utility::LogError(
+                "In-place op on a {} tensor with a {} operand would compute "
+                "in {} and truncate the result. Use the out-of-place op "
+                "instead.",
+                dst.GetDtype().ToString(), value.GetDtype().ToString(),
+                promoted.ToString());
+    }
+}
+
 Tensor Tensor::Add(const Tensor& value) const {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
 
     Tensor dst_tensor(shape_util::BroadcastedShape(shape_, value.shape_),
-                      dtype_, GetDevice());
+                      PromoteDtypes(dtype_, value.dtype_), GetDevice());
     kernel::BinaryEW(*this, value, dst_tensor, kernel::BinaryEWOpCode::Add);
 
     return dst_tensor;
@@ -943,7 +958,7 @@ Tensor Tensor::Add(Scalar value) const {
 
 Tensor Tensor::Add_(const Tensor& value) {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
+    AssertInPlaceDtype(*this, value);
 
     kernel::BinaryEW(*this, value, *this, kernel::BinaryEWOpCode::Add);
 
@@ -959,10 +974,9 @@ Tensor Tensor::Add_(Scalar value) {
 
 Tensor Tensor::Sub(const Tensor& value) const {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
 
     Tensor dst_tensor(shape_util::BroadcastedShape(shape_, value.shape_),
-                      dtype_, GetDevice());
+                      PromoteDtypes(dtype_, value.dtype_), GetDevice());
     kernel::BinaryEW(*this, value, dst_tensor, kernel::BinaryEWOpCode::Sub);
 
     return dst_tensor;
@@ -979,7 +993,7 @@ Tensor Tensor::Sub(Scalar value) const {
 
 Tensor Tensor::Sub_(const Tensor& value) {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
+    AssertInPlaceDtype(*this, value);
 
     kernel::BinaryEW(*this, value, *this, kernel::BinaryEWOpCode::Sub);
 
@@ -995,10 +1009,9 @@ Tensor Tensor::Sub_(Scalar value) {
 
 Tensor Tensor::Mul(const Tensor& value) const {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
 
     Tensor dst_tensor(shape_util::BroadcastedShape(shape_, value.shape_),
-                      dtype_, GetDevice());
+                      PromoteDtypes(dtype_, value.dtype_), GetDevice());
     kernel::BinaryEW(*this, value, dst_tensor, kernel::BinaryEWOpCode::Mul);
 
     return dst_tensor;
@@ -1015,7 +1028,7 @@ Tensor Tensor::Mul(Scalar value) const {
 
 Tensor Tensor::Mul_(const Tensor& value) {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
+    AssertInPlaceDtype(*this, value);
 
     kernel::BinaryEW(*this, value, *this, kernel::BinaryEWOpCode::Mul);
 
@@ -1031,10 +1044,9 @@ Tensor Tensor::Mul_(Scalar value) {
 
 Tensor Tensor::Div(const Tensor& value) const {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
 
     Tensor dst_tensor(shape_util::BroadcastedShape(shape_, value.shape_),
-                      dtype_, GetDevice());
+                      PromoteDtypes(dtype_, value.dtype_), GetDevice());
     kernel::BinaryEW(*this, value, dst_tensor, kernel::BinaryEWOpCode::Div);
 
     return dst_tensor;
@@ -1051,7 +1063,7 @@ Tensor Tensor::Div(Scalar value) const {
 
 Tensor Tensor::Div_(const Tensor& value) {
     AssertTensorDevice(value, GetDevice());
-    AssertTensorDtype(value, GetDtype());
+    AssertInPlaceDtype(*this, value);
 
     kernel::BinaryEW(*this, value, *this, kernel::BinaryEWOpCode::Div);
     return *this;
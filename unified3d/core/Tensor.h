@@ -19,6 +19,7 @@
 #include <unified3d/core/Scalar.h>
 #include <unified3d/core/ShapeUtil.h>
 #include <unified3d/core/SizeVector.h>
+#include <unified3d/core/TensorAccessor.h>
 #include <unified3d/core/TensorCheck.h>
 #include <unified3d/core/TensorInit.h>
 #include <unified3d/core/TensorKey.h>
@@ -96,7 +97,8 @@ public:
           strides_(strides),
           data_view_(data_ptr),
           dtype_(dtype),
-          blob_(blob) {}
+          blob_(blob),
+          is_contiguous_(shape_util::DefaultStrides(shape) == strides) {}
 
     /// \brief Tensor wrapper constructor from raw host buffer.
     ///
@@ -130,6 +132,7 @@ public:
         if (strides_.empty()) {
             strides_ = shape_util::DefaultStrides(shape);
         }
+        is_contiguous_ = shape_util::DefaultStrides(shape_) == strides_;
         // Blob with no-op deleter.
         blob_ = std::make_shared<Blob>(device, data_view, [](void*) {});
     }
@@ -595,6 +598,15 @@ public:
     }
 
     /// Adds a tensor and returns the resulting tensor.
+    ///
+    /// For Add, Sub, Mul and Div (and their in-place versions), \p value may
+    /// have a different dtype. The operation is then computed in
+    /// PromoteDtypes() of both dtypes, e.g. Float32 for a UInt16 tensor and a
+    /// Float32 one, and the result has that dtype. The in-place versions
+    /// cannot change this tensor's dtype, so they throw if the promoted dtype
+    /// differs from it, e.g. for an Int32 tensor += a Float32 one. For
+    /// contiguous operands of the same shape, the conversions happen inside
+    /// the kernel without allocating cast copies.
     [[nodiscard]] Tensor Add(const Tensor& value) const;
     [[nodiscard]] Tensor Add(Scalar value) const;
     Tensor operator+(const Tensor& value) const { return Add(value); }
@@ -1006,9 +1018,7 @@ public:
 
     /// Returns True if the underlying memory buffer is contiguous. A contiguous
     /// Tensor's data_ptr_ does not need to point to the beginning of blob_.
-    [[nodiscard]] inline bool IsContiguous() const {
-        return shape_util::DefaultStrides(shape_) == strides_;
-    }
+    [[nodiscard]] inline bool IsContiguous() const { return is_contiguous_; }
 
     /// Returns a contiguous Tensor containing the same data in the same device.
     /// If self tensor is already contiguous, the same underlying memory will be
@@ -1126,6 +1136,41 @@ public:
         return data_view_;
     }
 
+    /// Returns a typed rank-N accessor to the tensor's host memory. T must
+    /// match the tensor's dtype, and may be const-qualified for read-only
+    /// access. N must match the number of dimensions. The tensor must outlive
+    /// the accessor. See TensorAccessor.
+    template <typename T, int64_t N>
+    [[nodiscard]] TensorAccessor<T, N> GetAccessor() {
+        AssertAccessorTemplate<T, N>();
+        return TensorAccessor<T, N>(static_cast<T*>(data_view_.CpuAddress()),
+                                    shape_.data(), strides_.data());
+    }
+
+    template <typename T, int64_t N>
+    [[nodiscard]] TensorAccessor<const T, N> GetAccessor() const {
+        AssertAccessorTemplate<T, N>();
+        return TensorAccessor<const T, N>(
+                static_cast<const T*>(data_view_.CpuAddress()), shape_.data(),
+                strides_.data());
+    }
+
+    /// Returns a flat typed span over the tensor's host memory. The tensor
+    /// must be contiguous and must outlive the span. See TensorSpan.
+    template <typename T>
+    [[nodiscard]] TensorSpan<T> GetSpan() {
+        AssertSpanTemplate<T>();
+        return TensorSpan<T>(static_cast<T*>(data_view_.CpuAddress()),
+                             NumElements());
+    }
+
+    template <typename T>
+    [[nodiscard]] TensorSpan<const T> GetSpan() const {
+        AssertSpanTemplate<T>();
+        return TensorSpan<const T>(
+                static_cast<const T*>(data_view_.CpuAddress()), NumElements());
+    }
+
     [[nodiscard]] inline Dtype GetDtype() const { return dtype_; }
 
     [[nodiscard]] Device GetDevice() const override;
@@ -1151,6 +1196,27 @@ public:
         }
     }
 
+    template <typename T, int64_t N>
+    void AssertAccessorTemplate() const {
+        AssertTemplateDtype<std::remove_const_t<T>>();
+        if (NumDims() != N) {
+            utility::LogError(
+                    "Cannot create an accessor of rank {} for a tensor with "
+                    "{} dimensions.",
+                    N, NumDims());
+        }
+    }
+
+    template <typename T>
+    void AssertSpanTemplate() const {
+        AssertTemplateDtype<std::remove_const_t<T>>();
+        if (!IsContiguous()) {
+            utility::LogError(
+                    "Cannot create a span for a non-contiguous tensor. Call "
+                    "Contiguous() first.");
+        }
+    }
+
     /// Save tensor to numpy's npy format.
     void Save(const std::string& file_name) const;
 
@@ -1291,6 +1357,10 @@ protected:
 
     /// Underlying memory buffer for Tensor.
     std::shared_ptr<Blob> blob_ = nullptr;
+
+    /// Cached result of IsContiguous(). Shape and strides never change after
+    /// construction, so this is computed once instead of on every op.
+    bool is_contiguous_ = true;
 };  // namespace core
 
 template <>
@@ -0,0 +1,146 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "unified3d/utility/Logging.h"
+
+/// Index checks in TensorAccessor and TensorSpan are on by default and
+/// compiled out in release (NDEBUG) builds. Define
+/// UNIFIED3D_TENSOR_ACCESSOR_CHECKS to 0 or 1 to override.
+#ifndef UNIFIED3D_TENSOR_ACCESSOR_CHECKS
+#ifdef NDEBUG
+#define UNIFIED3D_TENSOR_ACCESSOR_CHECKS 0
+#else
+#define UNIFIED3D_TENSOR_ACCESSOR_CHECKS 1
+#endif
+#endif
+
+namespace u3d::core {
+
+/// \class TensorAccessor
+///
+/// Typed, rank-N view of a Tensor's host memory. Indexing is plain stride
+/// arithmetic on a raw pointer, so element loops run without creating Tensor
+/// objects or copying data. The accessor does not own the memory; the Tensor
+/// it was created from must outlive it. Use Tensor::GetAccessor<T, N>() to
+/// create one, with a const T for read-only access.
+///
+/// ```cpp
+/// Tensor t = Tensor::Zeros({640, 480, 3}, core::Float32);
+/// auto acc = t.GetAccessor<float, 3>();
+/// for (int64_t r = 0; r < acc.Size(0); ++r) {
+///     for (int64_t c = 0; c < acc.Size(1); ++c) {
+///         acc(r, c, 0) = 1.f;
+///     }
+/// }
+/// ```
+template <typename T, int64_t N>
+class TensorAccessor {
+public:
+    static_assert(N > 0, "TensorAccessor requires rank >= 1.");
+
+    TensorAccessor(T* data, const int64_t* shape, const int64_t* strides)
+        : data_(data) {
+        for (int64_t d = 0; d < N; ++d) {
+            shape_[d] = shape[d];
+            strides_[d] = strides[d];
+        }
+    }
+
+    /// Returns a reference to the element at (indices...). The number of
+    /// indices must match the rank N.
+    template <typename... Index>
+    inline T& operator()(Index... indices) const {
+        static_assert(sizeof...(Index) == N,
+                      "Number of indices must match the accessor rank.");
+        const int64_t idx[N] = {static_cast<int64_t>(indices)...};
+        int64_t offset = 0;
+        for (int64_t d = 0; d < N; ++d) {
+            CheckIndex(d, idx[d]);
+            offset += idx[d] * strides_[d];
+        }
+        return data_[offset];
+    }
+
+    /// Size of dimension \p dim.
+    [[nodiscard]] inline int64_t Size(int64_t dim) const {
+        return shape_[dim];
+    }
+
+    /// Stride of dimension \p dim, in number of elements.
+    [[nodiscard]] inline int64_t Stride(int64_t dim) const {
+        return strides_[dim];
+    }
+
+    /// Pointer to the element at index (0, ..., 0).
+    [[nodiscard]] inline T* Data() const { return data_; }
+
+    [[nodiscard]] inline int64_t NumElements() const {
+        int64_t num_elements = 1;
+        for (int64_t d = 0; d < N; ++d) {
+            num_elements *= shape_[d];
+        }
+        return num_elements;
+    }
+
+private:
+    inline void CheckIndex(int64_t dim, int64_t index) const {
+#if UNIFIED3D_TENSOR_ACCESSOR_CHECKS
+        if (index < 0 || index >= shape_[dim]) {
+            utility::LogError(
+                    "TensorAccessor index {} is out of bounds for dimension "
+                    "{} with size {}.",
+                    index, dim, shape_[dim]);
+        }
+#else
+        (void)dim;
+        (void)index;
+#endif
+    }
+
+    T* data_;
+    std::array<int64_t, N> shape_;
+    std::array<int64_t, N> strides_;
+};
+
+/// \class TensorSpan
+///
+/// Flat, typed view of a contiguous Tensor's host memory. It can be used with
+/// range-based for loops and standard algorithms. The span does not own the
+/// memory; the Tensor it was created from must outlive it. Use
+/// Tensor::GetSpan<T>() to create one, with a const T for read-only access.
+template <typename T>
+class TensorSpan {
+public:
+    TensorSpan(T* data, int64_t size) : data_(data), size_(size) {}
+
+    inline T& operator[](int64_t index) const {
+#if UNIFIED3D_TENSOR_ACCESSOR_CHECKS
+        if (index < 0 || index >= size_) {
+            utility::LogError(
+                    "TensorSpan index {} is out of bounds for size {}.", index,
+                    size_);
+        }
+#endif
+        return data_[index];
+    }
+
+    [[nodiscard]] inline T* begin() const { return data_; }
+    [[nodiscard]] inline T* end() const { return data_ + size_; }
+    [[nodiscard]] inline T* data() const { return data_; }
+    [[nodiscard]] inline int64_t size() const { return size_; }
+    [[nodiscard]] inline bool empty() const { return size_ == 0; }
+
+private:
+    T* data_;
+    int64_t size_;
+};
+
+}  // namespace u3d::core
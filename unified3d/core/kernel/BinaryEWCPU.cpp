@@ -12,6 +12,8 @@
 #include "unified3d/core/SizeVector.h"
 #include "unified3d/core/Tensor.h"
 #include "unified3d/core/kernel/BinaryEW.h"
+#include "unified3d/core/kernel/ConvertCPU.h"
+#include "unified3d/core/kernel/UnaryEW.h"
 #include "unified3d/utility/Logging.h"
 
 namespace u3d::core::kernel {
@@ -19,12 +21,61 @@ namespace u3d::core::kernel {
 template <typename src_t, typename dst_t, typename element_func_t>
 static void LaunchBinaryEWKernel(const Indexer& indexer,
                                  const element_func_t& element_func) {
-    parallelFor(int64_t(0), indexer.NumWorkloads(),
-                [&indexer, &element_func](int64_t i) {
-                    element_func(indexer.GetInputView(0, i).CpuAddress(),
-                                 indexer.GetInputView(1, i).CpuAddress(),
-                                 indexer.GetOutputView(i).CpuAddress());
-                });
+    parallelFor(
+            int64_t(0), indexer.NumWorkloads(),
+            [&indexer, &element_func](int64_t i) {
+                element_func(indexer.GetInputView(0, i).CpuAddress(),
+                             indexer.GetInputView(1, i).CpuAddress(),
+                             indexer.GetOutputView(i).CpuAddress());
+            },
+            executionPolicyFor(indexer.NumWorkloads()));
+}
+
+/// Returns true if lhs, rhs and dst are contiguous, have exactly the same shape
+/// and satisfy \p dtype_policy. In that case the i-th workload is the i-th
+/// element of every operand, so the Indexer can be skipped entirely.
+static bool IsFlatBinaryEW(const Tensor& lhs,
+                           const Tensor& rhs,
+                           const Tensor& dst,
+                           DtypePolicy dtype_policy) {
+    if (!lhs.IsContiguous() || !rhs.IsContiguous() || !dst.IsContiguous() ||
+        lhs.GetShape() != dst.GetShape() || rhs.GetShape() != dst.GetShape() ||
+        lhs.GetDtype() != rhs.GetDtype()) {
+        return false;
+    }
+    if (dtype_policy == DtypePolicy::ALL_SAME) {
+        return dst.GetDtype() == lhs.GetDtype();
+    } else if (dtype_policy == DtypePolicy::INPUT_SAME_OUTPUT_BOOL) {
+        return dst.GetDtype() == core::Bool;
+    }
+    return false;
+}
+
+/// Runs \p element_func over lhs, rhs and dst, bypassing the Indexer when the
+/// operands are plain same-shape contiguous arrays.
+template <typename src_t, typename dst_t, typename element_func_t>
+static void LaunchBinaryEWKernel(const Tensor& lhs,
+                                 const Tensor& rhs,
+                                 Tensor& dst,
+                                 DtypePolicy dtype_policy,
+                                 const element_func_t& element_func) {
+    if (IsFlatBinaryEW(lhs, rhs, dst, dtype_policy)) {
+        const int64_t num_workloads = dst.NumElements();
+        const auto* lhs_ptr =
+                static_cast<const src_t*>(lhs.GetDataView().CpuAddress());
+        const auto* rhs_ptr =
+                static_cast<const src_t*>(rhs.GetDataView().CpuAddress());
+        auto* dst_ptr = static_cast<dst_t*>(dst.GetDataView().CpuAddress());
+        parallelFor(
+                int64_t(0), num_workloads,
+                [&](int64_t i) {
+                    element_func(lhs_ptr + i, rhs_ptr + i, dst_ptr + i);
+                },
+                executionPolicyFor(num_workloads));
+    } else {
+        Indexer indexer({lhs, rhs}, dst, dtype_policy);
+        LaunchBinaryEWKernel<src_t, dst_t>(indexer, element_func);
+    }
 }
 
 template <typename scalar_t>
@@ -126,6 +177,123 @@ static void CPUNeqElementKernel(const void* lhs, const void* rhs, void* dst) {
             *static_cast<const src_t*>(lhs) != *static_cast<const src_t*>(rhs));
 }
 
+/// Number of elements converted at a time by the cast-fused kernel.
+static constexpr int64_t kCastBlockSize = 1024;
+
+/// Arithmetic with operands of different dtypes. The op is computed in
+/// PromoteDtypes() of the operand dtypes, so that e.g. a uint16 tensor times
+/// a fractional float32 scale is not truncated, and the result is converted
+/// to dst's dtype. The operands and the result are converted block by block
+/// through stack buffers, so no full-size cast temporary is allocated.
+/// Layouts that need an Indexer fall back to converting the operands up
+/// front.
+static void BinaryEWCastCPU(const Tensor& lhs,
+                            const Tensor& rhs,
+                            Tensor& dst,
+                            BinaryEWOpCode op_code) {
+    const Dtype compute_dtype = PromoteDtypes(lhs.GetDtype(), rhs.GetDtype());
+    const Dtype dst_dtype = dst.GetDtype();
+    if (!lhs.IsContiguous() || !rhs.IsContiguous() || !dst.IsContiguous() ||
+        lhs.GetShape() != dst.GetShape() || rhs.GetShape() != dst.GetShape()) {
+        const Tensor lhs_c = lhs.To(compute_dtype);
+        const Tensor rhs_c = rhs.To(compute_dtype);
+        if (dst_dtype == compute_dtype) {
+            BinaryEWCPU(lhs_c, rhs_c, dst, op_code);
+        } else {
+            Tensor result(dst.GetShape(), compute_dtype, dst.GetDevice());
+            BinaryEWCPU(lhs_c, rhs_c, result, op_code);
+            CopyCPU(result, dst);
+        }
+        return;
+    }
+
+    DISPATCH_DTYPE_TO_TEMPLATE(compute_dtype, [&]() {
+        using compute_t = scalar_t;
+
+        // Returns elements [begin, begin + count) of t as compute_t,
+        // converting them into buffer if t has a different dtype.
+        auto load_block = [&](const Tensor& t, int64_t begin, int64_t count,
+                              compute_t* buffer) -> const compute_t* {
+            if (t.GetDtype() == compute_dtype) {
+                return static_cast<const compute_t*>(
+                               t.GetDataView().CpuAddress()) +
+                       begin;
+            }
+            DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(t.GetDtype(), [&]() {
+                ConvertRangeCPU(static_cast<const scalar_t*>(
+                                        t.GetDataView().CpuAddress()) +
+                                        begin,
+                                buffer, count);
+            });
+            return buffer;
+        };
+
+        // Writes count results to elements [begin, begin + count) of dst.
+        auto store_block = [&](const compute_t* results, int64_t begin,
+                               int64_t count) {
+            DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(dst_dtype, [&]() {
+                ConvertRangeCPU(results,
+                                static_cast<scalar_t*>(
+                                        dst.GetDataView().CpuAddress()) +
+                                        begin,
+                                count);
+            });
+        };
+
+        // The op is a typed functor rather than an element kernel pointer so
+        // that the inner loop vectorizes.
+        auto launch = [&](auto op) {
+            const int64_t num_elements = dst.NumElements();
+            const int64_t num_blocks =
+                    (num_elements + kCastBlockSize - 1) / kCastBlockSize;
+            parallelFor(
+                    int64_t(0), num_blocks,
+                    [&](int64_t block_idx) {
+                        const int64_t begin = block_idx * kCastBlockSize;
+                        const int64_t count =
+                                std::min(kCastBlockSize, num_elements - begin);
+                        compute_t lhs_buffer[kCastBlockSize];
+                        compute_t rhs_buffer[kCastBlockSize];
+                        compute_t dst_buffer[kCastBlockSize];
+                        const compute_t* lhs_block =
+                                load_block(lhs, begin, count, lhs_buffer);
+                        const compute_t* rhs_block =
+                                load_block(rhs, begin, count, rhs_buffer);
+                        for (int64_t i = 0; i < count; ++i) {
+                            dst_buffer[i] = op(lhs_block[i], rhs_block[i]);
+                        }
+                        store_block(dst_buffer, begin, count);
+                    },
+                    executionPolicyFor(num_elements));
+        };
+
+        switch (op_code) {
+            case BinaryEWOpCode::Add:
+                launch([](compute_t a, compute_t b) -> compute_t {
+                    return a + b;
+                });
+                break;
+            case BinaryEWOpCode::Sub:
+                launch([](compute_t a, compute_t b) -> compute_t {
+                    return a - b;
+                });
+                break;
+            case BinaryEWOpCode::Mul:
+                launch([](compute_t a, compute_t b) -> compute_t {
+                    return a * b;
+                });
+                break;
+            case BinaryEWOpCode::Div:
+                launch([](compute_t a, compute_t b) -> compute_t {
+                    return a / b;
+                });
+                break;
+            default:
+                utility::LogError("Unsupported op_code for cast-fused op.");
+        }
+    });
+}
+
 void BinaryEWCPU(const Tensor& lhs,
                  const Tensor& rhs,
                  Tensor& dst,
@@ -139,53 +307,51 @@ void BinaryEWCPU(const Tensor& lhs,
             // Inplace boolean op's output type is the same as the
             // input. e.g. np.logical_and(a, b, out=a), where a, b are
             // floats.
-            Indexer indexer({lhs, rhs}, dst, DtypePolicy::ALL_SAME);
-
             DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
                 switch (op_code) {
                     case BinaryEWOpCode::LogicalAnd:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPULogicalAndElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::LogicalOr:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPULogicalOrElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::LogicalXor:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPULogicalXorElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Gt:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPUGtElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Lt:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPULtElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Ge:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPUGeqElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Le:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPULeqElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Eq:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPUEqElementKernel<scalar_t, scalar_t>);
                         break;
                     case BinaryEWOpCode::Ne:
                         LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                                indexer,
+                                lhs, rhs, dst, DtypePolicy::ALL_SAME,
                                 CPUNeqElementKernel<scalar_t, scalar_t>);
                         break;
                     default:
@@ -194,49 +360,61 @@ void BinaryEWCPU(const Tensor& lhs,
             });
         } else if (dst_dtype == core::Bool) {
             // By default, output is boolean type.
-            Indexer indexer({lhs, rhs}, dst,
-                            DtypePolicy::INPUT_SAME_OUTPUT_BOOL);
-
             DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
                 switch (op_code) {
                     case BinaryEWOpCode::LogicalAnd:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer,
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
                                 CPULogicalAndElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::LogicalOr:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer,
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
                                 CPULogicalOrElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::LogicalXor:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer,
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
                                 CPULogicalXorElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Gt:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPUGtElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPUGtElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Lt:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPULtElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPULtElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Ge:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPUGeqElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPUGeqElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Le:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPULeqElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPULeqElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Eq:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPUEqElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPUEqElementKernel<scalar_t, bool>);
                         break;
                     case BinaryEWOpCode::Ne:
                         LaunchBinaryEWKernel<scalar_t, bool>(
-                                indexer, CPUNeqElementKernel<scalar_t, bool>);
+                                lhs, rhs, dst,
+                                DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                                CPUNeqElementKernel<scalar_t, bool>);
                         break;
                     default:
                         break;
@@ -249,42 +427,49 @@ void BinaryEWCPU(const Tensor& lhs,
         }
     } else if (op_code == BinaryEWOpCode::Maximum ||
                op_code == BinaryEWOpCode::Minimum) {
-        Indexer indexer({lhs, rhs}, dst, DtypePolicy::ALL_SAME);
         DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
             switch (op_code) {
                 case BinaryEWOpCode::Maximum:
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUMaxElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUMaxElementKernel<scalar_t>);
                     break;
                 case BinaryEWOpCode::Minimum:
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUMinElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUMinElementKernel<scalar_t>);
                     break;
                 default:
                     break;
             }
         });
+    } else if (src_dtype != dst_dtype || rhs.GetDtype() != dst_dtype) {
+        // Mixed-dtype arithmetic, computed in the promoted dtype.
+        BinaryEWCastCPU(lhs, rhs, dst, op_code);
     } else {
-        Indexer indexer({lhs, rhs}, dst, DtypePolicy::ALL_SAME);
         DISPATCH_DTYPE_TO_TEMPLATE(src_dtype, [&]() {
             switch (op_code) {
                 case BinaryEWOpCode::Add:
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUAddElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUAddElementKernel<scalar_t>);
                     break;
                 case BinaryEWOpCode::Sub:
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUSubElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUSubElementKernel<scalar_t>);
                     break;
                 case BinaryEWOpCode::Mul:
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUMulElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUMulElementKernel<scalar_t>);
                     break;
                 case BinaryEWOpCode::Div:
                     // The vectorized Div kernel causes a crash in the Python
                     // tests, so use scalar version instead.
                     LaunchBinaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUDivElementKernel<scalar_t>);
+                            lhs, rhs, dst, DtypePolicy::ALL_SAME,
+                            CPUDivElementKernel<scalar_t>);
                     break;
                 default:
                     break;
@@ -0,0 +1,38 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstdint>
+
+#include "unified3d/core/Parallel.h"
+
+namespace u3d::core::kernel {
+
+/// Converts \p num_elements contiguous values from src_t to dst_t. The body is
+/// a plain cast loop over typed pointers so that the compiler emits SIMD
+/// conversions, e.g. for uint8/uint16/int32 <-> float32.
+template <typename src_t, typename dst_t>
+inline void ConvertRangeCPU(const src_t* src,
+                            dst_t* dst,
+                            int64_t num_elements) {
+    for (int64_t i = 0; i < num_elements; ++i) {
+        dst[i] = static_cast<dst_t>(src[i]);
+    }
+}
+
+/// ConvertRangeCPU split into contiguous chunks across threads.
+template <typename src_t, typename dst_t>
+inline void ConvertCPU(const src_t* src, dst_t* dst, int64_t num_elements) {
+    parallelRangeFor(
+            int64_t(0), num_elements,
+            [&](int64_t begin, int64_t end) {
+                ConvertRangeCPU(src + begin, dst + begin, end - begin);
+            },
+            executionPolicyFor(num_elements));
+}
+
+}  // namespace u3d::core::kernel
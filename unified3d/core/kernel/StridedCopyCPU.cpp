@@ -0,0 +1,211 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include <cstring>
+#include <vector>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/core/Tensor.h"
+#include "unified3d/core/kernel/UnaryEW.h"
+
+namespace u3d::core::kernel {
+
+namespace {
+
+/// One dimension of a copy, with strides in number of elements.
+struct CopyDim {
+    int64_t size;
+    int64_t src_stride;
+    int64_t dst_stride;
+};
+
+/// Edge length of the square tiles used for transposing copies. 32x32
+/// elements of up to 8 bytes keep both the source and destination tile
+/// within L1.
+constexpr int64_t kTileSize = 32;
+
+}  // namespace
+
+/// Describes the copy with as few dimensions as possible. Size-1 dimensions
+/// are dropped and neighbouring dimensions that are laid out back to back in
+/// both tensors are merged, e.g. a slice of whole rows becomes a single run.
+static std::vector<CopyDim> CollapseCopyDims(const Tensor& src,
+                                             const Tensor& dst) {
+    std::vector<CopyDim> dims;
+    for (int64_t i = 0; i < dst.NumDims(); ++i) {
+        const int64_t size = dst.GetShape(i);
+        if (size == 1) {
+            continue;
+        }
+        const int64_t src_stride = src.GetStride(i);
+        const int64_t dst_stride = dst.GetStride(i);
+        if (!dims.empty() && dims.back().src_stride == src_stride * size &&
+            dims.back().dst_stride == dst_stride * size) {
+            dims.back().size *= size;
+            dims.back().src_stride = src_stride;
+            dims.back().dst_stride = dst_stride;
+        } else {
+            dims.push_back({size, src_stride, dst_stride});
+        }
+    }
+    return dims;
+}
+
+/// Converts a linear index over \p dims into element offsets in src and dst.
+static void OuterOffsets(const std::vector<CopyDim>& dims,
+                         int64_t index,
+                         int64_t& src_offset,
+                         int64_t& dst_offset) {
+    src_offset = 0;
+    dst_offset = 0;
+    for (int64_t d = static_cast<int64_t>(dims.size()) - 1; d >= 0; --d) {
+        const int64_t i = index % dims[d].size;
+        index /= dims[d].size;
+        src_offset += i * dims[d].src_stride;
+        dst_offset += i * dims[d].dst_stride;
+    }
+}
+
+static int64_t NumCopyElements(const std::vector<CopyDim>& dims) {
+    int64_t num_elements = 1;
+    for (const CopyDim& dim : dims) {
+        num_elements *= dim.size;
+    }
+    return num_elements;
+}
+
+/// Copies runs that are contiguous in both tensors with memcpy. \p dims
+/// excludes the run dimension.
+static void CopyRuns(const char* src_ptr,
+                     char* dst_ptr,
+                     const std::vector<CopyDim>& dims,
+                     int64_t run_length,
+                     int64_t element_byte_size) {
+    const int64_t num_runs = NumCopyElements(dims);
+    const int64_t run_byte_size = run_length * element_byte_size;
+    parallelFor(
+            int64_t(0), num_runs,
+            [&](int64_t run_idx) {
+                int64_t src_offset, dst_offset;
+                OuterOffsets(dims, run_idx, src_offset, dst_offset);
+                std::memcpy(dst_ptr + dst_offset * element_byte_size,
+                            src_ptr + src_offset * element_byte_size,
+                            run_byte_size);
+            },
+            executionPolicyFor(num_runs * run_length));
+}
+
+/// Tiled 2D transpose over the plane spanned by \p dst_inner (contiguous in
+/// dst) and \p src_inner (contiguous in src), repeated over the remaining
+/// \p outer_dims. Within a tile, reads and writes both stay in a few cache
+/// lines, and the typed inner loop lets the compiler vectorize the shuffle.
+template <typename scalar_t>
+static void CopyTiled(const scalar_t* src_ptr,
+                      scalar_t* dst_ptr,
+                      const std::vector<CopyDim>& outer_dims,
+                      const CopyDim& dst_inner,
+                      const CopyDim& src_inner) {
+    const int64_t num_outer = NumCopyElements(outer_dims);
+    const int64_t tiles_a = (dst_inner.size + kTileSize - 1) / kTileSize;
+    const int64_t tiles_b = (src_inner.size + kTileSize - 1) / kTileSize;
+    const int64_t num_tiles = num_outer * tiles_a * tiles_b;
+    parallelFor(
+            int64_t(0), num_tiles,
+            [&](int64_t tile_idx) {
+                const int64_t tile_a = tile_idx % tiles_a;
+                const int64_t tile_b = (tile_idx / tiles_a) % tiles_b;
+                const int64_t outer_idx = tile_idx / (tiles_a * tiles_b);
+                int64_t src_offset, dst_offset;
+                OuterOffsets(outer_dims, outer_idx, src_offset, dst_offset);
+                const scalar_t* src_tile = src_ptr + src_offset;
+                scalar_t* dst_tile = dst_ptr + dst_offset;
+
+                const int64_t a_begin = tile_a * kTileSize;
+                const int64_t a_end =
+                        std::min(a_begin + kTileSize, dst_inner.size);
+                const int64_t b_begin = tile_b * kTileSize;
+                const int64_t b_end =
+                        std::min(b_begin + kTileSize, src_inner.size);
+                for (int64_t b = b_begin; b < b_end; ++b) {
+                    const scalar_t* src_row = src_tile + b;
+                    scalar_t* dst_row = dst_tile + b * src_inner.dst_stride;
+                    for (int64_t a = a_begin; a < a_end; ++a) {
+                        dst_row[a] = src_row[a * dst_inner.src_stride];
+                    }
+                }
+            },
+            executionPolicyFor(num_outer * dst_inner.size * src_inner.size));
+}
+
+bool StridedCopyCPU(const Tensor& src, Tensor& dst) {
+    if (src.GetDtype() != dst.GetDtype() || src.GetShape() != dst.GetShape()) {
+        return false;
+    }
+
+    std::vector<CopyDim> dims = CollapseCopyDims(src, dst);
+    if (dims.empty()) {
+        dims.push_back({1, 1, 1});
+    }
+    const int64_t element_byte_size = src.GetDtype().ByteSize();
+    const auto* src_ptr =
+            static_cast<const char*>(src.GetDataView().CpuAddress());
+    auto* dst_ptr = static_cast<char*>(dst.GetDataView().CpuAddress());
+
+    // The innermost dimension is contiguous in both tensors: memcpy runs.
+    if (dims.back().src_stride == 1 && dims.back().dst_stride == 1) {
+        const int64_t run_length = dims.back().size;
+        dims.pop_back();
+        CopyRuns(src_ptr, dst_ptr, dims, run_length, element_byte_size);
+        return true;
+    }
+
+    // Transpose-like: one dimension is contiguous in dst and a different one
+    // is contiguous in src.
+    int64_t dst_inner = -1;
+    int64_t src_inner = -1;
+    for (int64_t d = 0; d < static_cast<int64_t>(dims.size()); ++d) {
+        if (dims[d].dst_stride == 1) {
+            dst_inner = d;
+        }
+        if (dims[d].src_stride == 1) {
+            src_inner = d;
+        }
+    }
+    if (dst_inner < 0 || src_inner < 0 || dst_inner == src_inner) {
+        return false;
+    }
+    std::vector<CopyDim> outer_dims;
+    for (int64_t d = 0; d < static_cast<int64_t>(dims.size()); ++d) {
+        if (d != dst_inner && d != src_inner) {
+            outer_dims.push_back(dims[d]);
+        }
+    }
+
+    auto copy_tiled = [&](auto scalar) {
+        using scalar_t = decltype(scalar);
+        CopyTiled<scalar_t>(reinterpret_cast<const scalar_t*>(src_ptr),
+                            reinterpret_cast<scalar_t*>(dst_ptr), outer_dims,
+                            dims[dst_inner], dims[src_inner]);
+    };
+    switch (element_byte_size) {
+        case 1:
+            copy_tiled(uint8_t());
+            return true;
+        case 2:
+            copy_tiled(uint16_t());
+            return true;
+        case 4:
+            copy_tiled(uint32_t());
+            return true;
+        case 8:
+            copy_tiled(uint64_t());
+            return true;
+        default:
+            return false;
+    }
+}
+
+}  // namespace u3d::core::kernel
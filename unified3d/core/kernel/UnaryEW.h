@@ -42,6 +42,12 @@ void Copy(const Tensor& src, Tensor& dst);
 
 void CopyCPU(const Tensor& src, Tensor& dst);
 
+// Same-dtype copy between same-shape tensors with arbitrary strides, e.g.
+// Contiguous() of a transposed view. Returns false without copying if the
+// layout is not handled, in which case the caller falls back to the generic
+// element-wise copy.
+bool StridedCopyCPU(const Tensor& src, Tensor& dst);
+
 void CopyGPU(const Tensor& src, Tensor& dst);
 
 }  // namespace kernel
@@ -13,6 +13,7 @@
 #include "unified3d/core/Parallel.h"
 #include "unified3d/core/SizeVector.h"
 #include "unified3d/core/Tensor.h"
+#include "unified3d/core/kernel/ConvertCPU.h"
 #include "unified3d/core/kernel/UnaryEW.h"
 #include "unified3d/utility/Logging.h"
 
@@ -21,21 +22,65 @@ namespace u3d::core::kernel {
 template <typename element_func_t>
 static void LaunchUnaryEWKernel(const Indexer& indexer,
                                 const element_func_t& element_func) {
-    parallelFor(int64_t(0), indexer.NumWorkloads(),
-                [&indexer, &element_func](int64_t i) {
-                    element_func(indexer.GetInputView(0, i).CpuAddress(),
-                                 indexer.GetOutputView(i).CpuAddress());
-                });
+    parallelFor(
+            int64_t(0), indexer.NumWorkloads(),
+            [&indexer, &element_func](int64_t i) {
+                element_func(indexer.GetInputView(0, i).CpuAddress(),
+                             indexer.GetOutputView(i).CpuAddress());
+            },
+            executionPolicyFor(indexer.NumWorkloads()));
 }
 
 template <typename src_t, typename dst_t, typename element_func_t>
 static void LaunchUnaryEWKernel(const Indexer& indexer,
                                 const element_func_t& element_func) {
-    parallelFor(int64_t(0), indexer.NumWorkloads(),
-                [&indexer, &element_func](int64_t i) {
-                    element_func(indexer.GetInputView(0, i).CpuAddress(),
-                                 indexer.GetOutputView(i).CpuAddress());
-                });
+    parallelFor(
+            int64_t(0), indexer.NumWorkloads(),
+            [&indexer, &element_func](int64_t i) {
+                element_func(indexer.GetInputView(0, i).CpuAddress(),
+                             indexer.GetOutputView(i).CpuAddress());
+            },
+            executionPolicyFor(indexer.NumWorkloads()));
+}
+
+/// Returns true if src and dst are contiguous, have exactly the same shape and
+/// satisfy \p dtype_policy. In that case the i-th workload is the i-th element
+/// of both operands, so the Indexer can be skipped entirely.
+static bool IsFlatUnaryEW(const Tensor& src,
+                          const Tensor& dst,
+                          DtypePolicy dtype_policy) {
+    if (!src.IsContiguous() || !dst.IsContiguous() ||
+        src.GetShape() != dst.GetShape()) {
+        return false;
+    }
+    if (dtype_policy == DtypePolicy::ALL_SAME) {
+        return dst.GetDtype() == src.GetDtype();
+    } else if (dtype_policy == DtypePolicy::INPUT_SAME_OUTPUT_BOOL) {
+        return dst.GetDtype() == core::Bool;
+    }
+    return true;
+}
+
+/// Runs \p element_func over src and dst, bypassing the Indexer when the
+/// operands are plain same-shape contiguous arrays.
+template <typename src_t, typename dst_t, typename element_func_t>
+static void LaunchUnaryEWKernel(const Tensor& src,
+                                Tensor& dst,
+                                DtypePolicy dtype_policy,
+                                const element_func_t& element_func) {
+    if (IsFlatUnaryEW(src, dst, dtype_policy)) {
+        const int64_t num_workloads = dst.NumElements();
+        const auto* src_ptr =
+                static_cast<const src_t*>(src.GetDataView().CpuAddress());
+        auto* dst_ptr = static_cast<dst_t*>(dst.GetDataView().CpuAddress());
+        parallelFor(
+                int64_t(0), num_workloads,
+                [&](int64_t i) { element_func(src_ptr + i, dst_ptr + i); },
+                executionPolicyFor(num_workloads));
+    } else {
+        Indexer indexer({src}, dst, dtype_policy);
+        LaunchUnaryEWKernel<src_t, dst_t>(indexer, element_func);
+    }
 }
 
 template <typename src_t,
@@ -179,28 +224,40 @@ void CopyCPU(const Tensor& src, Tensor& dst) {
             auto scalar_element = src.To(dst_dtype).Item<scalar_t>();
             auto* dst_ptr =
                     static_cast<scalar_t*>(dst.GetDataView().CpuAddress());
-            parallelFor(int64_t(0), num_elements, [&](int64_t workload_idx) {
-                dst_ptr[workload_idx] = scalar_element;
-            });
+            parallelFor(
+                    int64_t(0), num_elements,
+                    [&](int64_t workload_idx) {
+                        dst_ptr[workload_idx] = scalar_element;
+                    },
+                    executionPolicyFor(num_elements));
         });
-    } else {
+    } else if (StridedCopyCPU(src, dst)) {
+        // Same-dtype copy of a permuted or sliced view, done in memcpy runs
+        // or cache-sized tiles.
+    } else if (src.GetDtype().IsObject()) {
         Indexer indexer({src}, dst, DtypePolicy::NONE);
-        if (src.GetDtype().IsObject()) {
-            int64_t object_byte_size = src.GetDtype().ByteSize();
-            LaunchUnaryEWKernel(indexer, [&](const void* src, void* dst) {
-                CPUCopyObjectElementKernel(src, dst, object_byte_size);
-            });
-
-        } else {
-            DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
-                using src_t = scalar_t;
-                DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(dst_dtype, [&]() {
-                    using dst_t = scalar_t;
+        int64_t object_byte_size = src.GetDtype().ByteSize();
+        LaunchUnaryEWKernel(indexer, [&](const void* src, void* dst) {
+            CPUCopyObjectElementKernel(src, dst, object_byte_size);
+        });
+    } else {
+        DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
+            using src_t = scalar_t;
+            DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(dst_dtype, [&]() {
+                using dst_t = scalar_t;
+                if (IsFlatUnaryEW(src, dst, DtypePolicy::NONE)) {
+                    ConvertCPU(static_cast<const src_t*>(
+                                       src.GetDataView().CpuAddress()),
+                               static_cast<dst_t*>(
+                                       dst.GetDataView().CpuAddress()),
+                               dst.NumElements());
+                } else {
                     LaunchUnaryEWKernel<src_t, dst_t>(
-                            indexer, CPUCopyElementKernel<src_t, dst_t>);
-                });
+                            src, dst, DtypePolicy::NONE,
+                            CPUCopyElementKernel<src_t, dst_t>);
+                }
             });
-        }
+        });
     }
 }
 
@@ -219,17 +276,16 @@ void UnaryEWCPU(const Tensor& src, Tensor& dst, UnaryEWOpCode op_code) {
 
     if (op_code == UnaryEWOpCode::LogicalNot) {
         if (dst_dtype == src_dtype) {
-            Indexer indexer({src}, dst, DtypePolicy::ALL_SAME);
             DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
                 LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                        indexer,
+                        src, dst, DtypePolicy::ALL_SAME,
                         CPULogicalNotElementKernel<scalar_t, scalar_t>);
             });
         } else if (dst_dtype == core::Bool) {
-            Indexer indexer({src}, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL);
             DISPATCH_DTYPE_TO_TEMPLATE_WITH_BOOL(src_dtype, [&]() {
                 LaunchUnaryEWKernel<scalar_t, bool>(
-                        indexer, CPULogicalNotElementKernel<scalar_t, bool>);
+                        src, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                        CPULogicalNotElementKernel<scalar_t, bool>);
             });
         } else {
             utility::LogError(
@@ -240,70 +296,81 @@ void UnaryEWCPU(const Tensor& src, Tensor& dst, UnaryEWOpCode op_code) {
                op_code == UnaryEWOpCode::IsInf ||
                op_code == UnaryEWOpCode::IsFinite) {
         assert_dtype_is_float(src_dtype);
-        Indexer indexer({src}, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL);
         DISPATCH_DTYPE_TO_TEMPLATE(src_dtype, [&]() {
             if (op_code == UnaryEWOpCode::IsNan) {
                 LaunchUnaryEWKernel<scalar_t, bool>(
-                        indexer, CPUIsNanElementKernel<scalar_t>);
+                        src, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                        CPUIsNanElementKernel<scalar_t>);
             } else if (op_code == UnaryEWOpCode::IsInf) {
                 // A vectorized isinf function is not defined, so use scalar
                 // version instead.
                 LaunchUnaryEWKernel<scalar_t, bool>(
-                        indexer, CPUIsInfElementKernel<scalar_t>);
+                        src, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                        CPUIsInfElementKernel<scalar_t>);
             } else if (op_code == UnaryEWOpCode::IsFinite) {
                 // A vectorized isfinite function is not defined, so use scalar
                 // version instead.
                 LaunchUnaryEWKernel<scalar_t, bool>(
-                        indexer, CPUIsFiniteElementKernel<scalar_t>);
+                        src, dst, DtypePolicy::INPUT_SAME_OUTPUT_BOOL,
+                        CPUIsFiniteElementKernel<scalar_t>);
             }
         });
     } else {
-        Indexer indexer({src}, dst, DtypePolicy::ALL_SAME);
         DISPATCH_DTYPE_TO_TEMPLATE(src_dtype, [&]() {
             switch (op_code) {
                 case UnaryEWOpCode::Sqrt:
                     assert_dtype_is_float(src_dtype);
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUSqrtElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUSqrtElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Sin:
                     assert_dtype_is_float(src_dtype);
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUSinElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUSinElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Cos:
                     assert_dtype_is_float(src_dtype);
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUCosElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUCosElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Neg:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUNegElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUNegElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Exp:
                     assert_dtype_is_float(src_dtype);
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUExpElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUExpElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Abs:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUAbsElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUAbsElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Floor:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUFloorElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUFloorElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Ceil:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUCeilElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUCeilElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Round:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPURoundElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPURoundElementKernel<scalar_t>);
                     break;
                 case UnaryEWOpCode::Trunc:
                     LaunchUnaryEWKernel<scalar_t, scalar_t>(
-                            indexer, CPUTruncElementKernel<scalar_t>);
+                            src, dst, DtypePolicy::ALL_SAME,
+                            CPUTruncElementKernel<scalar_t>);
                     break;
                 default:
                     utility::LogError("Unimplemented op_code for UnaryEWCPU");
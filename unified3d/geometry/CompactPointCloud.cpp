@@ -0,0 +1,408 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/CompactPointCloud.h"
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::geometry {
+
+namespace {
+/// Runs \p func(begin, end) over contiguous ranges of [0, n) in parallel.
+template <typename Function>
+void ParallelRanges(size_t n, const Function &func) {
+    core::parallelRangeFor(size_t(0), n, func,
+                           core::executionPolicyFor(int64_t(n)));
+}
+
+/// Indices of the covariance entries stored in
+/// CompactPointCloud::covariances_.
+constexpr int kCovarianceRows[6] = {0, 0, 0, 1, 1, 2};
+constexpr int kCovarianceCols[6] = {0, 1, 2, 1, 2, 2};
+
+/// Normal code of a zero normal. Both components are -32768, which the
+/// octahedral encoding never produces.
+constexpr uint32_t kZeroNormalCode = 0x80008000u;
+
+float SignNotZero(float v) { return v < 0 ? -1.0f : 1.0f; }
+}  // namespace
+
+CompactPointCloud &CompactPointCloud::Clear() {
+    Resize(0, false, false, false);
+    return *this;
+}
+
+bool CompactPointCloud::IsEmpty() const { return !HasPoints(); }
+
+Eigen::Vector3d CompactPointCloud::GetMinBound() const {
+    if (!HasPoints()) {
+        return Eigen::Vector3d::Zero();
+    }
+    Eigen::Vector3d min_bound;
+    for (int c = 0; c < 3; ++c) {
+        const float *x = points_[c].data();
+        min_bound(c) = core::parallelReduce(
+                size_t(0), NumPoints(), std::numeric_limits<float>::max(),
+                [x](size_t begin, size_t end, float m) {
+                    for (size_t i = begin; i < end; ++i) {
+                        m = std::min(m, x[i]);
+                    }
+                    return m;
+                },
+                [](float a, float b) { return std::min(a, b); },
+                core::executionPolicyFor(int64_t(NumPoints())));
+    }
+    return min_bound;
+}
+
+Eigen::Vector3d CompactPointCloud::GetMaxBound() const {
+    if (!HasPoints()) {
+        return Eigen::Vector3d::Zero();
+    }
+    Eigen::Vector3d max_bound;
+    for (int c = 0; c < 3; ++c) {
+        const float *x = points_[c].data();
+        max_bound(c) = core::parallelReduce(
+                size_t(0), NumPoints(), std::numeric_limits<float>::lowest(),
+                [x](size_t begin, size_t end, float m) {
+                    for (size_t i = begin; i < end; ++i) {
+                        m = std::max(m, x[i]);
+                    }
+                    return m;
+                },
+                [](float a, float b) { return std::max(a, b); },
+                core::executionPolicyFor(int64_t(NumPoints())));
+    }
+    return max_bound;
+}
+
+Eigen::Vector3d CompactPointCloud::GetCenter() const {
+    if (!HasPoints()) {
+        return Eigen::Vector3d::Zero();
+    }
+    Eigen::Vector3d center;
+    for (int c = 0; c < 3; ++c) {
+        // Accumulate in double, float sums lose precision on large clouds.
+        const float *x = points_[c].data();
+        center(c) = core::parallelReduce(
+                size_t(0), NumPoints(), 0.0,
+                [x](size_t begin, size_t end, double sum) {
+                    for (size_t i = begin; i < end; ++i) {
+                        sum += x[i];
+                    }
+                    return sum;
+                },
+                [](double a, double b) { return a + b; },
+                core::executionPolicyFor(int64_t(NumPoints())));
+    }
+    return center / double(NumPoints());
+}
+
+AxisAlignedBoundingBox CompactPointCloud::GetAxisAlignedBoundingBox() const {
+    return AxisAlignedBoundingBox(GetMinBound(), GetMaxBound());
+}
+
+OrientedBoundingBox CompactPointCloud::GetOrientedBoundingBox(
+        bool robust) const {
+    return ToPointCloud()->GetOrientedBoundingBox(robust);
+}
+
+OrientedBoundingBox CompactPointCloud::GetMinimalOrientedBoundingBox(
+        bool robust) const {
+    return ToPointCloud()->GetMinimalOrientedBoundingBox(robust);
+}
+
+CompactPointCloud &CompactPointCloud::Transform(
+        const Eigen::Matrix4d &transformation) {
+    const Eigen::Matrix4f m = transformation.cast<float>();
+    float *x = points_[0].data();
+    float *y = points_[1].data();
+    float *z = points_[2].data();
+    ParallelRanges(NumPoints(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const float px = x[i], py = y[i], pz = z[i];
+            const float w = 1.0f / (m(3, 0) * px + m(3, 1) * py +
+                                    m(3, 2) * pz + m(3, 3));
+            x[i] = (m(0, 0) * px + m(0, 1) * py + m(0, 2) * pz + m(0, 3)) * w;
+            y[i] = (m(1, 0) * px + m(1, 1) * py + m(1, 2) * pz + m(1, 3)) * w;
+            z[i] = (m(2, 0) * px + m(2, 1) * py + m(2, 2) * pz + m(2, 3)) * w;
+        }
+    });
+
+    const Eigen::Matrix3d R = transformation.block<3, 3>(0, 0);
+    ParallelRanges(normals_.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            normals_[i] = EncodeNormal(R * DecodeNormal(normals_[i]));
+        }
+    });
+
+    const Eigen::Matrix3f Rf = R.cast<float>();
+    const size_t num_covariances = HasCovariances() ? NumPoints() : 0;
+    ParallelRanges(num_covariances, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Eigen::Matrix3f covariance;
+            for (int k = 0; k < 6; ++k) {
+                covariance(kCovarianceRows[k], kCovarianceCols[k]) =
+                        covariance(kCovarianceCols[k], kCovarianceRows[k]) =
+                                covariances_[k][i];
+            }
+            covariance = Rf * covariance * Rf.transpose();
+            for (int k = 0; k < 6; ++k) {
+                covariances_[k][i] =
+                        covariance(kCovarianceRows[k], kCovarianceCols[k]);
+            }
+        }
+    });
+    return *this;
+}
+
+CompactPointCloud &CompactPointCloud::Translate(
+        const Eigen::Vector3d &translation, bool relative) {
+    Eigen::Vector3d transform = translation;
+    if (!relative) {
+        transform -= GetCenter();
+    }
+    for (int c = 0; c < 3; ++c) {
+        float *x = points_[c].data();
+        const auto t = float(transform(c));
+        ParallelRanges(NumPoints(), [x, t](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                x[i] += t;
+            }
+        });
+    }
+    return *this;
+}
+
+CompactPointCloud &CompactPointCloud::Scale(double scale,
+                                            const Eigen::Vector3d &center) {
+    for (int c = 0; c < 3; ++c) {
+        float *x = points_[c].data();
+        const auto s = float(scale);
+        const auto t = float(center(c) - scale * center(c));
+        ParallelRanges(NumPoints(), [x, s, t](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                x[i] = x[i] * s + t;
+            }
+        });
+    }
+    return *this;
+}
+
+CompactPointCloud &CompactPointCloud::Rotate(const Eigen::Matrix3d &R,
+                                             const Eigen::Vector3d &center) {
+    Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+    transformation.block<3, 3>(0, 0) = R;
+    transformation.block<3, 1>(0, 3) = center - R * center;
+    return Transform(transformation);
+}
+
+Eigen::Matrix3d CompactPointCloud::GetCovariance(size_t i) const {
+    Eigen::Matrix3d covariance;
+    for (int k = 0; k < 6; ++k) {
+        covariance(kCovarianceRows[k], kCovarianceCols[k]) =
+                covariance(kCovarianceCols[k], kCovarianceRows[k]) =
+                        covariances_[k][i];
+    }
+    return covariance;
+}
+
+std::shared_ptr<CompactPointCloud> CompactPointCloud::SelectByIndex(
+        const std::vector<size_t> &indices, bool invert) const {
+    std::vector<size_t> selected;
+    if (invert) {
+        std::vector<bool> mask(NumPoints(), false);
+        for (size_t i : indices) {
+            mask[i] = true;
+        }
+        for (size_t i = 0; i < NumPoints(); ++i) {
+            if (!mask[i]) {
+                selected.push_back(i);
+            }
+        }
+    }
+    const std::vector<size_t> &sel = invert ? selected : indices;
+
+    auto output = std::make_shared<CompactPointCloud>();
+    output->Resize(sel.size(), HasNormals(), HasColors(), HasCovariances());
+    ParallelRanges(sel.size(), [&](size_t begin, size_t end) {
+        for (int c = 0; c < 3; ++c) {
+            for (size_t i = begin; i < end; ++i) {
+                output->points_[c][i] = points_[c][sel[i]];
+            }
+        }
+        for (size_t i = begin; i < end && HasNormals(); ++i) {
+            output->normals_[i] = normals_[sel[i]];
+        }
+        for (size_t i = begin; i < end && HasColors(); ++i) {
+            output->colors_[i] = colors_[sel[i]];
+        }
+        for (int k = 0; k < 6 && HasCovariances(); ++k) {
+            for (size_t i = begin; i < end; ++i) {
+                output->covariances_[k][i] = covariances_[k][sel[i]];
+            }
+        }
+    });
+    return output;
+}
+
+std::shared_ptr<CompactPointCloud> CompactPointCloud::Crop(
+        const AxisAlignedBoundingBox &bbox) const {
+    if (bbox.IsEmpty()) {
+        utility::LogError(
+                "AxisAlignedBoundingBox either has zeros size, or has wrong "
+                "bounds.");
+    }
+    const Eigen::Vector3f lo = bbox.min_bound_.cast<float>();
+    const Eigen::Vector3f hi = bbox.max_bound_.cast<float>();
+    const float *x = points_[0].data();
+    const float *y = points_[1].data();
+    const float *z = points_[2].data();
+    std::vector<uint8_t> inside(NumPoints());
+    ParallelRanges(NumPoints(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            inside[i] = (x[i] >= lo(0)) & (x[i] <= hi(0)) & (y[i] >= lo(1)) &
+                        (y[i] <= hi(1)) & (z[i] >= lo(2)) & (z[i] <= hi(2));
+        }
+    });
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < inside.size(); ++i) {
+        if (inside[i]) {
+            indices.push_back(i);
+        }
+    }
+    return SelectByIndex(indices);
+}
+
+std::shared_ptr<PointCloud> CompactPointCloud::ToPointCloud() const {
+    auto cloud = std::make_shared<PointCloud>();
+    const size_t n = NumPoints();
+    cloud->points_.resize(n);
+    if (HasNormals()) {
+        cloud->normals_.resize(n);
+    }
+    if (HasColors()) {
+        cloud->colors_.resize(n);
+    }
+    if (HasCovariances()) {
+        cloud->covariances_.resize(n);
+    }
+    ParallelRanges(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            cloud->points_[i] = GetPoint(i);
+            if (HasNormals()) {
+                cloud->normals_[i] = GetNormal(i);
+            }
+            if (HasColors()) {
+                cloud->colors_[i] = GetColor(i);
+            }
+            if (HasCovariances()) {
+                cloud->covariances_[i] = GetCovariance(i);
+            }
+        }
+    });
+    return cloud;
+}
+
+std::shared_ptr<CompactPointCloud> CompactPointCloud::CreateFromPointCloud(
+        const PointCloud &cloud) {
+    auto output = std::make_shared<CompactPointCloud>();
+    const size_t n = cloud.points_.size();
+    output->Resize(n, cloud.HasNormals(), cloud.HasColors(),
+                   cloud.HasCovariances());
+    ParallelRanges(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                output->points_[c][i] = float(cloud.points_[i](c));
+            }
+            if (cloud.HasNormals()) {
+                output->normals_[i] = EncodeNormal(cloud.normals_[i]);
+            }
+            if (cloud.HasColors()) {
+                output->colors_[i] = EncodeColor(cloud.colors_[i]);
+            }
+            for (int k = 0; k < 6 && cloud.HasCovariances(); ++k) {
+                output->covariances_[k][i] = float(cloud.covariances_[i](
+                        kCovarianceRows[k], kCovarianceCols[k]));
+            }
+        }
+    });
+    return output;
+}
+
+uint32_t CompactPointCloud::EncodeNormal(const Eigen::Vector3d &normal) {
+    // Project onto the octahedron |x| + |y| + |z| = 1 and unfold the lower
+    // half onto the square [-1, 1]^2.
+    const Eigen::Vector3f n = normal.cast<float>();
+    const float l1 = std::abs(n(0)) + std::abs(n(1)) + std::abs(n(2));
+    if (!(l1 > 0) || !std::isfinite(l1)) {
+        return kZeroNormalCode;
+    }
+    float u = n(0) / l1;
+    float v = n(1) / l1;
+    if (n(2) < 0) {
+        const float fu = (1 - std::abs(v)) * SignNotZero(u);
+        const float fv = (1 - std::abs(u)) * SignNotZero(v);
+        u = fu;
+        v = fv;
+    }
+    const auto qu = int16_t(std::lround(std::clamp(u, -1.0f, 1.0f) * 32767));
+    const auto qv = int16_t(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767));
+    return uint32_t(uint16_t(qu)) | uint32_t(uint16_t(qv)) << 16;
+}
+
+Eigen::Vector3d CompactPointCloud::DecodeNormal(uint32_t code) {
+    if (code == kZeroNormalCode) {
+        return Eigen::Vector3d::Zero();
+    }
+    const float u = float(int16_t(code & 0xffff)) / 32767;
+    const float v = float(int16_t(code >> 16)) / 32767;
+    Eigen::Vector3f n(u, v, 1 - std::abs(u) - std::abs(v));
+    if (n(2) < 0) {
+        n(0) = (1 - std::abs(v)) * SignNotZero(u);
+        n(1) = (1 - std::abs(u)) * SignNotZero(v);
+    }
+    return n.normalized().cast<double>();
+}
+
+uint32_t CompactPointCloud::EncodeColor(const Eigen::Vector3d &color) {
+    uint32_t code = 0;
+    for (int c = 0; c < 3; ++c) {
+        const double channel = std::clamp(color(c), 0.0, 1.0);
+        code |= uint32_t(std::lround(channel * 255)) << (8 * c);
+    }
+    return code;
+}
+
+Eigen::Vector3d CompactPointCloud::DecodeColor(uint32_t code) {
+    return Eigen::Vector3d(code & 0xff, (code >> 8) & 0xff,
+                           (code >> 16) & 0xff) /
+           255.0;
+}
+
+void CompactPointCloud::Resize(size_t n,
+                               bool normals,
+                               bool colors,
+                               bool covariances) {
+    for (auto &axis : points_) {
+        axis.resize(n);
+    }
+    normals_.resize(normals ? n : 0);
+    colors_.resize(colors ? n : 0);
+    for (auto &entry : covariances_) {
+        entry.resize(covariances ? n : 0);
+    }
+}
+
+}  // namespace u3d::geometry
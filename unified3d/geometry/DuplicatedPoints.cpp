@@ -0,0 +1,128 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/DuplicatedPoints.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::geometry {
+
+namespace {
+
+/// Sorts \p order by the key of each point, then by index, so that the first
+/// point of a group comes first, and assigns to each point the first point of
+/// its group. \p equal compares the keys of two points.
+template <typename LessFunc, typename EqualFunc>
+void GroupPoints(std::vector<size_t> &order,
+                 const LessFunc &less,
+                 const EqualFunc &equal,
+                 std::vector<size_t> &first) {
+    core::parallelSort(
+            order.begin(), order.end(),
+            [&](size_t a, size_t b) {
+                return less(a, b) || (!less(b, a) && a < b);
+            },
+            core::executionPolicyFor(order.size()));
+    size_t group = 0;
+    for (size_t j = 0; j < order.size(); j++) {
+        if (j == 0 || !equal(order[j - 1], order[j])) {
+            group = order[j];
+        }
+        first[order[j]] = group;
+    }
+}
+
+}  // namespace
+
+std::tuple<std::vector<size_t>, std::vector<size_t>> FindDuplicatedPoints(
+        const std::vector<Eigen::Vector3d> &points,
+        double epsilon /* = 0.0*/) {
+    if (epsilon < 0) {
+        utility::LogError(
+                "[FindDuplicatedPoints] epsilon must be non-negative, but got "
+                "{}.",
+                epsilon);
+    }
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::vector<size_t> first(num_points);
+    std::vector<uint8_t> comparable(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                first[i] = i;
+                comparable[i] = epsilon > 0 ? points[i].allFinite()
+                                            : !points[i].hasNaN();
+            },
+            core::executionPolicyFor(num_points));
+    std::vector<size_t> order;
+    order.reserve(num_points);
+    for (int64_t i = 0; i < num_points; i++) {
+        if (comparable[i]) {
+            order.push_back(i);
+        }
+    }
+
+    if (epsilon > 0) {
+        using Cell = Eigen::Matrix<int64_t, 3, 1>;
+        std::vector<Cell> cells(num_points);
+        core::parallelFor(
+                int64_t(0), num_points,
+                [&](int64_t i) {
+                    if (comparable[i]) {
+                        cells[i] = (points[i] / epsilon)
+                                           .array()
+                                           .floor()
+                                           .cast<int64_t>();
+                    }
+                },
+                core::executionPolicyFor(num_points));
+        GroupPoints(
+                order,
+                [&](size_t a, size_t b) {
+                    return std::lexicographical_compare(
+                            cells[a].data(), cells[a].data() + 3,
+                            cells[b].data(), cells[b].data() + 3);
+                },
+                [&](size_t a, size_t b) { return cells[a] == cells[b]; },
+                first);
+    } else {
+        GroupPoints(
+                order,
+                [&](size_t a, size_t b) {
+                    return std::lexicographical_compare(
+                            points[a].data(), points[a].data() + 3,
+                            points[b].data(), points[b].data() + 3);
+                },
+                [&](size_t a, size_t b) { return points[a] == points[b]; },
+                first);
+    }
+
+    // New indices follow the original order of the kept points.
+    std::vector<size_t> kept;
+    std::vector<size_t> old_to_new(num_points);
+    for (int64_t i = 0; i < num_points; i++) {
+        if (first[i] == size_t(i)) {
+            old_to_new[i] = kept.size();
+            kept.push_back(i);
+        }
+    }
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                if (first[i] != size_t(i)) {
+                    old_to_new[i] = old_to_new[first[i]];
+                }
+            },
+            core::executionPolicyFor(num_points));
+    return std::make_tuple(std::move(old_to_new), std::move(kept));
+}
+
+}  // namespace u3d::geometry
@@ -0,0 +1,30 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <tuple>
+#include <vector>
+
+namespace u3d::geometry {
+
+/// \brief Finds the duplicated points of \p points with a parallel sort.
+///
+/// With \p epsilon equal to zero, points are duplicates if their coordinates
+/// are identical. Otherwise, points are quantized to a grid of cell size
+/// \p epsilon and the points of a cell are duplicates. Points with a NaN
+/// coordinate, and with \p epsilon positive any non-finite point, are never
+/// duplicates.
+///
+/// \return The old-to-new index map, and the indices of the points that are
+/// kept, i.e. the first point of each group of duplicates, in increasing
+/// order. New indices follow the order of the kept points, so the i-th point
+/// is mapped to the position of the first point of its group.
+std::tuple<std::vector<size_t>, std::vector<size_t>> FindDuplicatedPoints(
+        const std::vector<Eigen::Vector3d> &points, double epsilon = 0.0);
+
+}  // namespace u3d::geometry
@@ -0,0 +1,381 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/DynamicKDTreeFlann.h"
+
+#include <algorithm>
+#include <limits>
+#include <nanoflann.hpp>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::geometry {
+
+namespace {
+
+/// Maximum number of points in a leaf of the static trees.
+constexpr size_t kLeafMaxSize = 15;
+
+/// Keeps the \p knn closest points seen so far, sorted by distance.
+class KNNResult {
+public:
+    KNNResult(int knn, int *indices, double *distance2)
+        : capacity_(knn), indices_(indices), distance2_(distance2) {}
+
+    bool addPoint(double dist, int index) {
+        int i = count_;
+        for (; i > 0 && distance2_[i - 1] > dist; --i) {
+            if (i < capacity_) {
+                distance2_[i] = distance2_[i - 1];
+                indices_[i] = indices_[i - 1];
+            }
+        }
+        if (i < capacity_) {
+            distance2_[i] = dist;
+            indices_[i] = index;
+        }
+        count_ = std::min(count_ + 1, capacity_);
+        return true;
+    }
+    [[nodiscard]] double worstDist() const {
+        return count_ < capacity_ ? std::numeric_limits<double>::max()
+                                  : distance2_[capacity_ - 1];
+    }
+    [[nodiscard]] bool full() const { return count_ == capacity_; }
+    [[nodiscard]] int size() const { return count_; }
+
+private:
+    int capacity_;
+    int count_ = 0;
+    int *indices_;
+    double *distance2_;
+};
+
+/// Collects all points closer than a squared radius.
+class RadiusResult {
+public:
+    RadiusResult(double radius2, std::vector<std::pair<double, int>> &result)
+        : radius2_(radius2), result_(result) {}
+
+    bool addPoint(double dist, int index) {
+        if (dist < radius2_) {
+            result_.emplace_back(dist, index);
+        }
+        return true;
+    }
+    [[nodiscard]] double worstDist() const { return radius2_; }
+    [[nodiscard]] bool full() const { return true; }
+
+private:
+    double radius2_;
+    std::vector<std::pair<double, int>> &result_;
+};
+
+/// Forwards the points of one tree to \p Result under their global indices,
+/// skipping removed points.
+template <typename Result>
+class LiveResult {
+public:
+    LiveResult(Result &result,
+               const std::vector<int> &indices,
+               const std::vector<uint8_t> &removed)
+        : result_(result), indices_(indices), removed_(removed) {}
+
+    bool addPoint(double dist, uint32_t local_index) {
+        const int index = indices_[local_index];
+        return removed_[index] ? true : result_.addPoint(dist, index);
+    }
+    [[nodiscard]] double worstDist() const { return result_.worstDist(); }
+    [[nodiscard]] bool full() const { return result_.full(); }
+
+private:
+    Result &result_;
+    const std::vector<int> &indices_;
+    const std::vector<uint8_t> &removed_;
+};
+
+}  // namespace
+
+/// Static tree over a subset of the points. The coordinates are copied into
+/// the tree so that each search walks contiguous memory.
+struct DynamicKDTreeFlann::Tree {
+    using Index = nanoflann::KDTreeSingleIndexAdaptor<
+            nanoflann::L2_Simple_Adaptor<double, Tree>,
+            Tree,
+            3>;
+
+    void Build() {
+        const unsigned int num_threads =
+                core::executionPolicyFor(indices_.size()) ==
+                                core::ExecutionPolicy::kSerial
+                        ? 1
+                        : core::maxNumberOfThreads();
+        index_ = std::make_unique<Index>(
+                3, *this,
+                nanoflann::KDTreeSingleIndexAdaptorParams(
+                        kLeafMaxSize,
+                        nanoflann::KDTreeSingleIndexAdaptorFlags::None,
+                        num_threads));
+    }
+
+    // Dataset interface required by nanoflann.
+    [[nodiscard]] size_t kdtree_get_point_count() const {
+        return indices_.size();
+    }
+    [[nodiscard]] double kdtree_get_pt(size_t idx, size_t dim) const {
+        return points_[idx](dim);
+    }
+    template <class BBox>
+    bool kdtree_get_bbox(BBox &) const {
+        return false;
+    }
+
+    std::vector<Eigen::Vector3d> points_;
+    /// Global index of each point.
+    std::vector<int> indices_;
+    std::unique_ptr<Index> index_;
+};
+
+DynamicKDTreeFlann::DynamicKDTreeFlann() = default;
+
+DynamicKDTreeFlann::DynamicKDTreeFlann(
+        const std::vector<Eigen::Vector3d> &points) {
+    Insert(points);
+}
+
+DynamicKDTreeFlann::~DynamicKDTreeFlann() = default;
+
+std::unique_ptr<DynamicKDTreeFlann::Tree> DynamicKDTreeFlann::BuildTree(
+        const std::vector<std::unique_ptr<Tree>> &trees,
+        const std::vector<Eigen::Vector3d> &points,
+        int first_index) const {
+    auto tree = std::make_unique<Tree>();
+    size_t num_points = points.size();
+    for (const auto &t : trees) {
+        num_points += t->indices_.size();
+    }
+    tree->points_.reserve(num_points);
+    tree->indices_.reserve(num_points);
+    for (const auto &t : trees) {
+        for (size_t i = 0; i < t->indices_.size(); ++i) {
+            if (!removed_[t->indices_[i]]) {
+                tree->points_.push_back(t->points_[i]);
+                tree->indices_.push_back(t->indices_[i]);
+            }
+        }
+    }
+    tree->points_.insert(tree->points_.end(), points.begin(), points.end());
+    for (size_t i = 0; i < points.size(); ++i) {
+        tree->indices_.push_back(first_index + static_cast<int>(i));
+    }
+    if (!tree->indices_.empty()) {
+        tree->Build();
+    }
+    return tree;
+}
+
+int DynamicKDTreeFlann::Insert(const std::vector<Eigen::Vector3d> &points) {
+    const auto first_index = static_cast<int>(removed_.size());
+    if (removed_.size() + points.size() >
+        size_t(std::numeric_limits<int>::max())) {
+        utility::LogError(
+                "[DynamicKDTreeFlann::Insert] Too many points inserted.");
+    }
+    if (points.empty()) {
+        return first_index;
+    }
+    removed_.resize(removed_.size() + points.size(), 0);
+
+    // Merge the new points with the trailing trees while those are not much
+    // larger than the merged tree, which keeps the forest at O(log n) trees
+    // whose sizes roughly double from one to the next.
+    size_t merged_size = points.size();
+    size_t num_merged = 0;
+    while (num_merged < trees_.size() &&
+           trees_[trees_.size() - num_merged - 1]->indices_.size() <=
+                   2 * merged_size) {
+        merged_size += trees_[trees_.size() - num_merged - 1]->indices_.size();
+        ++num_merged;
+    }
+    std::vector<std::unique_ptr<Tree>> merged(
+            std::make_move_iterator(trees_.end() - num_merged),
+            std::make_move_iterator(trees_.end()));
+    trees_.resize(trees_.size() - num_merged);
+
+    std::unique_ptr<Tree> tree = BuildTree(merged, points, first_index);
+    // Removed points of the merged trees have been dropped.
+    num_stored_ = num_stored_ - (merged_size - points.size()) +
+                  tree->indices_.size();
+    num_removed_ -= merged_size - tree->indices_.size();
+    if (!tree->indices_.empty()) {
+        trees_.push_back(std::move(tree));
+    }
+    std::stable_sort(trees_.begin(), trees_.end(),
+                     [](const auto &a, const auto &b) {
+                         return a->indices_.size() > b->indices_.size();
+                     });
+    return first_index;
+}
+
+bool DynamicKDTreeFlann::Remove(int index) {
+    if (index < 0 || size_t(index) >= removed_.size() || removed_[index]) {
+        return false;
+    }
+    removed_[index] = 1;
+    ++num_removed_;
+    if (2 * num_removed_ > num_stored_) {
+        Compact();
+    }
+    return true;
+}
+
+void DynamicKDTreeFlann::Remove(const std::vector<int> &indices) {
+    for (int index : indices) {
+        if (index >= 0 && size_t(index) < removed_.size() &&
+            !removed_[index]) {
+            removed_[index] = 1;
+            ++num_removed_;
+        }
+    }
+    if (2 * num_removed_ > num_stored_) {
+        Compact();
+    }
+}
+
+void DynamicKDTreeFlann::Compact() {
+    std::unique_ptr<Tree> tree = BuildTree(trees_, {}, 0);
+    trees_.clear();
+    num_stored_ = tree->indices_.size();
+    num_removed_ = 0;
+    if (!tree->indices_.empty()) {
+        trees_.push_back(std::move(tree));
+    }
+}
+
+size_t DynamicKDTreeFlann::NumPoints() const {
+    return num_stored_ - num_removed_;
+}
+
+template <typename T>
+int DynamicKDTreeFlann::Search(const T &query,
+                               const KDTreeSearchParam &param,
+                               std::vector<int> &indices,
+                               std::vector<double> &distance2) const {
+    switch (param.GetSearchType()) {
+        case KDTreeSearchParam::SearchType::Knn:
+            return SearchKNN(query, ((const KDTreeSearchParamKNN &)param).knn_,
+                             indices, distance2);
+        case KDTreeSearchParam::SearchType::Radius:
+            return SearchRadius(
+                    query, ((const KDTreeSearchParamRadius &)param).radius_,
+                    indices, distance2);
+        case KDTreeSearchParam::SearchType::Hybrid:
+            return SearchHybrid(
+                    query, ((const KDTreeSearchParamHybrid &)param).radius_,
+                    ((const KDTreeSearchParamHybrid &)param).max_nn_, indices,
+                    distance2);
+        default:
+            return -1;
+    }
+}
+
+template <typename T>
+int DynamicKDTreeFlann::SearchKNN(const T &query,
+                                  int knn,
+                                  std::vector<int> &indices,
+                                  std::vector<double> &distance2) const {
+    if (trees_.empty() || query.rows() != 3 || knn < 0) {
+        return -1;
+    }
+    indices.resize(knn);
+    distance2.resize(knn);
+    if (knn == 0) {
+        return 0;
+    }
+    // All trees share one result set, so the current k-th distance prunes
+    // the search of the following trees.
+    KNNResult result(knn, indices.data(), distance2.data());
+    for (const auto &tree : trees_) {
+        LiveResult<KNNResult> live_result(result, tree->indices_, removed_);
+        tree->index_->findNeighbors(live_result, query.data(),
+                                    nanoflann::SearchParameters(0.0));
+    }
+    const int k = result.size();
+    indices.resize(k);
+    distance2.resize(k);
+    return k;
+}
+
+template <typename T>
+int DynamicKDTreeFlann::SearchRadius(const T &query,
+                                     double radius,
+                                     std::vector<int> &indices,
+                                     std::vector<double> &distance2) const {
+    if (trees_.empty() || query.rows() != 3) {
+        return -1;
+    }
+    thread_local std::vector<std::pair<double, int>> neighbors;
+    neighbors.clear();
+    RadiusResult result(radius * radius, neighbors);
+    for (const auto &tree : trees_) {
+        LiveResult<RadiusResult> live_result(result, tree->indices_, removed_);
+        tree->index_->findNeighbors(live_result, query.data(),
+                                    nanoflann::SearchParameters(0.0));
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    const auto k = static_cast<int>(neighbors.size());
+    indices.resize(k);
+    distance2.resize(k);
+    for (int i = 0; i < k; ++i) {
+        distance2[i] = neighbors[i].first;
+        indices[i] = neighbors[i].second;
+    }
+    return k;
+}
+
+template <typename T>
+int DynamicKDTreeFlann::SearchHybrid(const T &query,
+                                     double radius,
+                                     int max_nn,
+                                     std::vector<int> &indices,
+                                     std::vector<double> &distance2) const {
+    const int k = SearchKNN(query, max_nn, indices, distance2);
+    if (k <= 0) {
+        return k;
+    }
+    const auto k_radius = static_cast<int>(std::distance(
+            distance2.begin(), std::lower_bound(distance2.begin(),
+                                                distance2.end(),
+                                                radius * radius)));
+    indices.resize(k_radius);
+    distance2.resize(k_radius);
+    return k_radius;
+}
+
+template int DynamicKDTreeFlann::Search<Eigen::Vector3d>(
+        const Eigen::Vector3d &query,
+        const KDTreeSearchParam &param,
+        std::vector<int> &indices,
+        std::vector<double> &distance2) const;
+template int DynamicKDTreeFlann::SearchKNN<Eigen::Vector3d>(
+        const Eigen::Vector3d &query,
+        int knn,
+        std::vector<int> &indices,
+        std::vector<double> &distance2) const;
+template int DynamicKDTreeFlann::SearchRadius<Eigen::Vector3d>(
+        const Eigen::Vector3d &query,
+        double radius,
+        std::vector<int> &indices,
+        std::vector<double> &distance2) const;
+template int DynamicKDTreeFlann::SearchHybrid<Eigen::Vector3d>(
+        const Eigen::Vector3d &query,
+        double radius,
+        int max_nn,
+        std::vector<int> &indices,
+        std::vector<double> &distance2) const;
+
+}  // namespace u3d::geometry
@@ -0,0 +1,115 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "unified3d/geometry/KDTreeSearchParam.h"
+
+namespace u3d::geometry {
+
+/// \class DynamicKDTreeFlann
+///
+/// \brief KDTree over 3D points that supports insertion and removal without
+/// rebuilding the whole index.
+///
+/// The points are stored in a logarithmic forest of static trees. Inserting a
+/// batch builds a tree over the new points only, and trees of similar size are
+/// merged, so each point takes part in O(log n) rebuilds over its lifetime.
+/// Removed points are only marked; they are skipped by searches and dropped
+/// when their tree is next rebuilt, and the whole forest is compacted once
+/// more than half of the stored points are removed.
+///
+/// Points are identified by the index they were given on insertion, which
+/// does not change when other points are inserted or removed. Searches may run
+/// concurrently with each other, but not with Insert() or Remove().
+class DynamicKDTreeFlann {
+public:
+    /// \brief Default Constructor.
+    DynamicKDTreeFlann();
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param points Initial points, given indices 0 to points.size() - 1.
+    DynamicKDTreeFlann(const std::vector<Eigen::Vector3d> &points);
+
+    ~DynamicKDTreeFlann();
+    DynamicKDTreeFlann(const DynamicKDTreeFlann &) = delete;
+    DynamicKDTreeFlann &operator=(const DynamicKDTreeFlann &) = delete;
+
+public:
+    /// \brief Inserts a batch of points.
+    ///
+    /// \return The index of the first inserted point. The points are given
+    /// consecutive indices.
+    int Insert(const std::vector<Eigen::Vector3d> &points);
+
+    /// \brief Removes the point with the given index.
+    ///
+    /// \return false if there is no such point or it was already removed.
+    bool Remove(int index);
+    /// \brief Removes a batch of points. Invalid indices are ignored.
+    void Remove(const std::vector<int> &indices);
+
+    /// Returns the number of points that have not been removed.
+    [[nodiscard]] size_t NumPoints() const;
+    /// Returns the number of static trees currently in the forest.
+    [[nodiscard]] size_t NumTrees() const { return trees_.size(); }
+
+    template <typename T>
+    int Search(const T &query,
+               const KDTreeSearchParam &param,
+               std::vector<int> &indices,
+               std::vector<double> &distance2) const;
+
+    template <typename T>
+    int SearchKNN(const T &query,
+                  int knn,
+                  std::vector<int> &indices,
+                  std::vector<double> &distance2) const;
+
+    template <typename T>
+    int SearchRadius(const T &query,
+                     double radius,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const;
+
+    template <typename T>
+    int SearchHybrid(const T &query,
+                     double radius,
+                     int max_nn,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const;
+
+private:
+    /// Static tree over a subset of the points, defined in the source file.
+    struct Tree;
+
+    /// Builds a tree over the points of \p trees that have not been removed,
+    /// plus \p points given indices starting at \p first_index.
+    std::unique_ptr<Tree> BuildTree(
+            const std::vector<std::unique_ptr<Tree>> &trees,
+            const std::vector<Eigen::Vector3d> &points,
+            int first_index) const;
+
+    /// Merges all trees into one without the removed points.
+    void Compact();
+
+private:
+    /// Trees ordered by decreasing size.
+    std::vector<std::unique_ptr<Tree>> trees_;
+    /// Whether the point with a given index has been removed.
+    std::vector<uint8_t> removed_;
+    /// Number of points stored in the trees, including removed ones.
+    size_t num_stored_ = 0;
+    /// Number of removed points still stored in the trees.
+    size_t num_removed_ = 0;
+};
+
+}  // namespace u3d::geometry
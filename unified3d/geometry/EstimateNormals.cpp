@@ -5,12 +5,19 @@
 //  property of any third parties.
 
 #include <Eigen/Eigenvalues>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <queue>
 #include <tuple>
 
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/PointCloud.h"
+#include "unified3d/geometry/SpanningForest.h"
 #include "unified3d/geometry/TetraMesh.h"
+#include "unified3d/utility/ConcurrentDisjointSet.h"
 #include "unified3d/utility/Eigen.h"
 #include "unified3d/utility/Logging.h"
 
@@ -131,39 +138,14 @@ Eigen::Vector3d FastEigen3x3(const Eigen::Matrix3d &covariance) {
 
     double norm = A(0, 1) * A(0, 1) + A(0, 2) * A(0, 2) + A(1, 2) * A(1, 2);
     if (norm > 0) {
-        Eigen::Vector3d eval;
+        const Eigen::Vector3d eval =
+                utility::ComputeSymmetricEigenvalues3x3(A);
         Eigen::Vector3d evec0;
         Eigen::Vector3d evec1;
         Eigen::Vector3d evec2;
 
-        double q = (A(0, 0) + A(1, 1) + A(2, 2)) / 3;
-
-        double b00 = A(0, 0) - q;
-        double b11 = A(1, 1) - q;
-        double b22 = A(2, 2) - q;
-
-        double p =
-                std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + norm * 2) / 6);
-
-        double c00 = b11 * b22 - A(1, 2) * A(1, 2);
-        double c01 = A(0, 1) * b22 - A(1, 2) * A(0, 2);
-        double c02 = A(0, 1) * A(1, 2) - b11 * A(0, 2);
-        double det = (b00 * c00 - A(0, 1) * c01 + A(0, 2) * c02) / (p * p * p);
-
-        double half_det = det * 0.5;
-        half_det = std::min(std::max(half_det, -1.0), 1.0);
-
-        double angle = std::acos(half_det) / (double)3;
-        double const two_thirds_pi = 2.09439510239319549;
-        double beta2 = std::cos(angle) * 2;
-        double beta0 = std::cos(angle + two_thirds_pi) * 2;
-        double beta1 = -(beta0 + beta2);
-
-        eval(0) = q + p * beta0;
-        eval(1) = q + p * beta1;
-        eval(2) = q + p * beta2;
-
-        if (half_det >= 0) {
+        // Start with the eigenvector of the best separated eigenvalue.
+        if (eval(2) - eval(1) >= eval(1) - eval(0)) {
             evec2 = ComputeEigenvector0(A, eval(2));
             if (eval(2) < eval(0) && eval(2) < eval(1)) {
                 A *= max_coeff;
@@ -212,71 +194,73 @@ Eigen::Vector3d ComputeNormal(const Eigen::Matrix3d &covariance,
     return solver.eigenvectors().col(0);
 }
 
-// Disjoint set data structure to find cycles in graphs
-class DisjointSet {
-public:
-    DisjointSet(size_t size) : parent_(size), size_(size) {
-        for (size_t idx = 0; idx < size; idx++) {
-            parent_[idx] = idx;
-            size_[idx] = 0;
-        }
+// Orients the normals along a spanning forest, each tree independently from
+// its lowest point, whose normal is made to point down.
+void OrientNormalsAlongForest(const std::vector<Eigen::Vector3d> &points,
+                              std::vector<Eigen::Vector3d> &normals,
+                              const std::vector<WeightedEdge> &forest) {
+    const size_t n = points.size();
+    std::vector<size_t> offsets(n + 1, 0);
+    for (const auto &edge : forest) {
+        offsets[edge.v0_ + 1]++;
+        offsets[edge.v1_ + 1]++;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<size_t> adjacency(offsets[n]);
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    utility::ConcurrentDisjointSet disjoint_set(static_cast<int>(n));
+    for (const auto &edge : forest) {
+        adjacency[fill[edge.v0_]++] = edge.v1_;
+        adjacency[fill[edge.v1_]++] = edge.v0_;
+        disjoint_set.Union(int(edge.v0_), int(edge.v1_));
     }
 
-    // find representative element for given x
-    // using path compression
-    size_t Find(size_t x) {
-        if (x != parent_[x]) {
-            parent_[x] = Find(parent_[x]);
+    // The first point of lowest z of each tree.
+    std::vector<size_t> start(n, n);
+    for (size_t v = 0; v < n; ++v) {
+        size_t &s = start[disjoint_set.Find(int(v))];
+        if (s == n || points[v](2) < points[s](2)) {
+            s = v;
         }
-        return parent_[x];
     }
-
-    // combine two sets using size of sets
-    void Union(size_t x, size_t y) {
-        x = Find(x);
-        y = Find(y);
-        if (x != y) {
-            if (size_[x] < size_[y]) {
-                size_[y] += size_[x];
-                parent_[x] = y;
-            } else {
-                size_[x] += size_[y];
-                parent_[y] = x;
-            }
+    std::vector<size_t> roots;
+    for (size_t v = 0; v < n; ++v) {
+        if (start[v] != n) {
+            roots.push_back(start[v]);
         }
     }
 
-private:
-    std::vector<size_t> parent_;
-    std::vector<size_t> size_;
-};
-
-struct WeightedEdge {
-    WeightedEdge(size_t v0, size_t v1, double weight)
-        : v0_(v0), v1_(v1), weight_(weight) {}
-    size_t v0_;
-    size_t v1_;
-    double weight_;
-};
-
-// Minimum Spanning Tree algorithm (Kruskal's algorithm)
-std::vector<WeightedEdge> Kruskal(std::vector<WeightedEdge> &edges,
-                                  size_t n_vertices) {
-    std::sort(edges.begin(), edges.end(),
-              [](WeightedEdge &e0, WeightedEdge &e1) {
-                  return e0.weight_ < e1.weight_;
-              });
-    DisjointSet disjoint_set(n_vertices);
-    std::vector<WeightedEdge> mst;
-    for (auto &edge : edges) {
-        size_t set0 = disjoint_set.Find(edge.v0_);
-        size_t set1 = disjoint_set.Find(edge.v1_);
-        if (set0 != set1) {
-            mst.push_back(edge);
-            disjoint_set.Union(set0, set1);
+    auto TestAndOrientNormal = [](const Eigen::Vector3d &n0,
+                                  Eigen::Vector3d &n1) {
+        if (n0.dot(n1) < 0) {
+            n1 *= -1;
         }
-    }
-    return mst;
+    };
+    // Trees are disjoint, so they are traversed in parallel.
+    std::vector<uint8_t> visited(n, 0);
+    const auto num_roots = static_cast<int64_t>(roots.size());
+    core::parallelFor(
+            int64_t(0), num_roots,
+            [&](int64_t r) {
+                size_t v0 = roots[r];
+                TestAndOrientNormal(Eigen::Vector3d(0, 0, -1), normals[v0]);
+                std::queue<size_t> traversal_queue;
+                traversal_queue.push(v0);
+                visited[v0] = 1;
+                while (!traversal_queue.empty()) {
+                    v0 = traversal_queue.front();
+                    traversal_queue.pop();
+                    for (size_t j = offsets[v0]; j < offsets[v0 + 1]; ++j) {
+                        const size_t v1 = adjacency[j];
+                        if (!visited[v1]) {
+                            visited[v1] = 1;
+                            traversal_queue.push(v1);
+                            TestAndOrientNormal(normals[v0], normals[v1]);
+                        }
+                    }
+                }
+            },
+            core::executionPolicyFor(num_roots, 2));
 }
 
 }  // unnamed namespace
@@ -290,27 +274,33 @@ void PointCloud::EstimateNormals(
     if (!has_normal) {
         normals_.resize(points_.size());
     }
-    std::vector<Eigen::Matrix3d> covariances;
+    std::vector<Eigen::Matrix3d> estimated_covariances;
     if (!HasCovariances()) {
-        covariances = EstimatePerPointCovariances(*this, search_param);
-    } else {
-        covariances = covariances_;
-    }
-
-    for (int i = 0; i < (int)covariances.size(); i++) {
-        auto normal = ComputeNormal(covariances[i], fast_normal_computation);
-        if (normal.norm() == 0.0) {
-            if (has_normal) {
-                normal = normals_[i];
-            } else {
-                normal = Eigen::Vector3d(0.0, 0.0, 1.0);
-            }
-        }
-        if (has_normal && normal.dot(normals_[i]) < 0.0) {
-            normal *= -1.0;
-        }
-        normals_[i] = normal;
+        estimated_covariances =
+                EstimatePerPointCovariances(*this, search_param);
     }
+    const std::vector<Eigen::Matrix3d> &covariances =
+            HasCovariances() ? covariances_ : estimated_covariances;
+
+    const auto num_points = static_cast<int64_t>(covariances.size());
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                auto normal = ComputeNormal(covariances[i],
+                                            fast_normal_computation);
+                if (normal.norm() == 0.0) {
+                    if (has_normal) {
+                        normal = normals_[i];
+                    } else {
+                        normal = Eigen::Vector3d(0.0, 0.0, 1.0);
+                    }
+                }
+                if (has_normal && normal.dot(normals_[i]) < 0.0) {
+                    normal *= -1.0;
+                }
+                normals_[i] = normal;
+            },
+            core::executionPolicyFor(num_points));
 }
 
 void PointCloud::OrientNormalsToAlignWithDirection(
@@ -357,12 +347,118 @@ void PointCloud::OrientNormalsTowardsCameraLocation(
 void PointCloud::OrientNormalsConsistentTangentPlane(
         size_t k,
         const double lambda /* = 0.0*/,
-        const double cos_alpha_tol /* = 1.0*/) {
+        const double cos_alpha_tol /* = 1.0*/,
+        bool use_knn_graph /* = false*/) {
     if (!HasNormals()) {
         utility::LogError(
                 "No normals in the PointCloud. Call EstimateNormals() first.");
     }
 
+    auto NormalWeight = [&](size_t v0, size_t v1) -> double {
+        return 1.0 - std::abs(normals_[v0].dot(normals_[v1]));
+    };
+    // The function below takes v0 and its neighbors as inputs.
+    // The function returns the quartiles of the distances between the neighbors
+    // and a plane defined by the normal vector of v0 and the point v0.
+    auto compute_q1q3 =
+            [&](size_t v0,
+                const std::vector<int> &neighbors) -> std::array<double, 2> {
+        std::vector<double> dist_plane;
+
+        for (int neighbor : neighbors) {
+            auto v1 = size_t(neighbor);
+            const auto diff = points_[v0] - points_[v1];
+            double dist = std::abs(diff.dot(normals_[v0]));
+            dist_plane.push_back(dist);
+        }
+        std::vector<double> dist_plane_ord = dist_plane;
+        std::sort(dist_plane_ord.begin(), dist_plane_ord.end());
+        // calculate quartiles
+        int q1_idx = static_cast<int>(dist_plane_ord.size() * 0.25);
+        double q1 = dist_plane_ord[q1_idx];
+
+        int q3_idx = static_cast<int>(dist_plane_ord.size() * 0.75);
+        double q3 = dist_plane_ord[q3_idx];
+
+        std::array<double, 2> q1q3{};
+        q1q3[0] = q1;
+        q1q3[1] = q3;
+
+        return q1q3;
+    };
+
+    if (use_knn_graph) {
+        // Riemannian graph made of the kNN edges in either direction, with the
+        // same tests as below.
+        KDTreeFlann kdtree(*this);
+        std::vector<int> knn_indices;
+        std::vector<double> knn_dists2;
+        kdtree.SearchKNNBatch(points_, int(k), knn_indices, knn_dists2);
+        const auto num_points = static_cast<int64_t>(points_.size());
+        core::parallelFor(
+                int64_t(0), num_points,
+                [&](int64_t v0) {
+                    int *neighbors = knn_indices.data() + v0 * k;
+                    thread_local std::vector<int> valid_neighbors;
+                    valid_neighbors.clear();
+                    std::copy_if(neighbors, neighbors + k,
+                                 std::back_inserter(valid_neighbors),
+                                 [](int v1) { return v1 >= 0; });
+                    std::array<double, 2> q1q3{};
+                    if (lambda != 0 && !valid_neighbors.empty()) {
+                        q1q3 = compute_q1q3(v0, valid_neighbors);
+                    }
+                    for (size_t j = 0; j < k; ++j) {
+                        const int v1 = neighbors[j];
+                        if (v1 < 0 || v1 == v0) {
+                            neighbors[j] = -1;
+                            continue;
+                        }
+                        const auto diff = points_[v0] - points_[v1];
+                        double normal_dist = std::abs(diff.dot(normals_[v0]));
+                        double cos_alpha =
+                                normal_dist / std::sqrt(diff.squaredNorm());
+                        if (cos_alpha > cos_alpha_tol ||
+                            (lambda != 0 &&
+                             normal_dist >
+                                     q1q3[1] + 1.5 * (q1q3[1] - q1q3[0]))) {
+                            neighbors[j] = -1;
+                        }
+                    }
+                },
+                core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+        std::vector<WeightedEdge> edges;
+        for (int64_t v0 = 0; v0 < num_points; ++v0) {
+            for (size_t j = 0; j < k; ++j) {
+                const int v1 = knn_indices[v0 * k + j];
+                if (v1 >= 0) {
+                    edges.emplace_back(std::min<size_t>(v0, v1),
+                                       std::max<size_t>(v0, v1),
+                                       NormalWeight(v0, v1));
+                }
+            }
+        }
+        // Edges found in both directions appear twice.
+        core::parallelSort(
+                edges.begin(), edges.end(),
+                [](const WeightedEdge &e0, const WeightedEdge &e1) {
+                    return std::tie(e0.v0_, e0.v1_) < std::tie(e1.v0_, e1.v1_);
+                },
+                core::executionPolicyFor(edges.size()));
+        edges.erase(std::unique(edges.begin(), edges.end(),
+                                [](const WeightedEdge &e0,
+                                   const WeightedEdge &e1) {
+                                    return e0.v0_ == e1.v0_ &&
+                                           e0.v1_ == e1.v1_;
+                                }),
+                    edges.end());
+
+        OrientNormalsAlongForest(
+                points_, normals_,
+                BoruvkaMinimumSpanningForest(edges, points_.size()));
+        return;
+    }
+
     // Create Riemannian graph (Euclidean MST + kNN)
     // Euclidean MST is subgraph of Delaunay triangulation
     std::shared_ptr<TetraMesh> delaunay_mesh;
@@ -404,45 +500,13 @@ void PointCloud::OrientNormalsConsistentTangentPlane(
         AddEdgeToDelaunayGraph(tetra[2], tetra[3]);
     }
 
-    std::vector<WeightedEdge> mst = Kruskal(delaunay_graph, points_.size());
+    std::vector<WeightedEdge> mst =
+            KruskalMinimumSpanningForest(delaunay_graph, points_.size());
 
-    auto NormalWeight = [&](size_t v0, size_t v1) -> double {
-        return 1.0 - std::abs(normals_[v0].dot(normals_[v1]));
-    };
     for (auto &edge : mst) {
         edge.weight_ = NormalWeight(edge.v0_, edge.v1_);
     }
 
-    // The function below takes v0 and its neighbors as inputs.
-    // The function returns the quartiles of the distances between the neighbors
-    // and a plane defined by the normal vector of v0 and the point v0.
-    auto compute_q1q3 =
-            [&](size_t v0,
-                const std::vector<int> &neighbors) -> std::array<double, 2> {
-        std::vector<double> dist_plane;
-
-        for (int neighbor : neighbors) {
-            auto v1 = size_t(neighbor);
-            const auto diff = points_[v0] - points_[v1];
-            double dist = std::abs(diff.dot(normals_[v0]));
-            dist_plane.push_back(dist);
-        }
-        std::vector<double> dist_plane_ord = dist_plane;
-        std::sort(dist_plane_ord.begin(), dist_plane_ord.end());
-        // calculate quartiles
-        int q1_idx = static_cast<int>(dist_plane_ord.size() * 0.25);
-        double q1 = dist_plane_ord[q1_idx];
-
-        int q3_idx = static_cast<int>(dist_plane_ord.size() * 0.75);
-        double q3 = dist_plane_ord[q3_idx];
-
-        std::array<double, 2> q1q3{};
-        q1q3[0] = q1;
-        q1q3[1] = q3;
-
-        return q1q3;
-    };
-
     // Add k nearest neighbors to Riemannian graph
     KDTreeFlann kdtree(*this);
     for (size_t v0 = 0; v0 < points_.size(); ++v0) {
@@ -491,7 +555,7 @@ void PointCloud::OrientNormalsConsistentTangentPlane(
     }
 
     // extract MST from Riemannian graph
-    mst = Kruskal(mst, points_.size());
+    mst = KruskalMinimumSpanningForest(mst, points_.size());
 
     // convert list of edges to graph
     std::vector<std::unordered_set<size_t>> mst_graph(points_.size());
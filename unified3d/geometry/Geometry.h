@@ -45,6 +45,8 @@ public:
         OrientedBoundingBox = 11,
         /// AxisAlignedBoundingBox
         AxisAlignedBoundingBox = 12,
+        /// CompactPointCloud
+        CompactPointCloud = 13,
     };
 
 public:
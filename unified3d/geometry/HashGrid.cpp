@@ -0,0 +1,238 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/HashGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::geometry {
+
+namespace {
+
+/// Cell coordinates are kept below this bound, so that they and the offsets
+/// of the cells around them fit in an int.
+constexpr double kMaxCellCoordinate = double(1 << 30);
+
+}  // unnamed namespace
+
+HashGrid::HashGrid(const std::vector<Eigen::Vector3d> &points,
+                   double cell_size)
+    : cell_size_(cell_size) {
+    if (!(cell_size > 0) || !std::isfinite(cell_size)) {
+        utility::LogError(
+                "[HashGrid] cell_size must be positive and finite, but got "
+                "{}.",
+                cell_size);
+    }
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::vector<Eigen::Vector3i> cell_indices(num_points);
+    // 1 for indexed points, 0 for non-finite ones, 2 for out-of-range ones.
+    std::vector<uint8_t> status(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                if (!points[i].allFinite()) {
+                    status[i] = 0;
+                } else {
+                    status[i] = CellIndex(points[i], cell_indices[i]) ? 1 : 2;
+                }
+            },
+            core::executionPolicyFor(num_points));
+
+    std::vector<int> order;
+    order.reserve(num_points);
+    for (int i = 0; i < num_points; ++i) {
+        if (status[i] == 2) {
+            utility::LogError(
+                    "[HashGrid] Point {} lies too far from the origin for "
+                    "cell_size {}.",
+                    i, cell_size);
+        }
+        if (status[i] == 1) {
+            order.push_back(i);
+        }
+    }
+
+    // Sort the points by cell, then by index, so the layout does not depend
+    // on the number of threads.
+    const auto num_indexed = static_cast<int64_t>(order.size());
+    core::parallelSort(
+            order.begin(), order.end(),
+            [&](int a, int b) {
+                const Eigen::Vector3i &ca = cell_indices[a];
+                const Eigen::Vector3i &cb = cell_indices[b];
+                return std::tie(ca(0), ca(1), ca(2), a) <
+                       std::tie(cb(0), cb(1), cb(2), b);
+            },
+            core::executionPolicyFor(num_indexed));
+
+    points_.resize(num_indexed);
+    indices_ = order;
+    core::parallelFor(
+            int64_t(0), num_indexed,
+            [&](int64_t i) { points_[i] = points[order[i]]; },
+            core::executionPolicyFor(num_indexed));
+
+    int begin = 0;
+    for (int i = 1; i <= num_indexed; ++i) {
+        if (i == num_indexed ||
+            cell_indices[order[i]] != cell_indices[order[begin]]) {
+            cells_.emplace(cell_indices[order[begin]],
+                           std::make_pair(begin, i));
+            begin = i;
+        }
+    }
+}
+
+bool HashGrid::CellIndex(const Eigen::Vector3d &p,
+                         Eigen::Vector3i &cell) const {
+    for (int i = 0; i < 3; ++i) {
+        const double c = std::floor(p(i) / cell_size_);
+        // Also false for NaN.
+        if (!(std::abs(c) < kMaxCellCoordinate)) {
+            return false;
+        }
+        cell(i) = static_cast<int>(c);
+    }
+    return true;
+}
+
+template <typename Visitor>
+void HashGrid::VisitCandidates(const Eigen::Vector3d &query,
+                               double radius,
+                               const Visitor &visit) const {
+    if (!query.allFinite() || !(radius > 0)) {
+        return;
+    }
+    const double reach = std::max(1.0, std::ceil(radius / cell_size_));
+    Eigen::Vector3i center;
+    if (!CellIndex(query, center)) {
+        // Too far from the indexed points to enumerate its cells.
+        for (int j = 0; j < static_cast<int>(points_.size()); ++j) {
+            if (!visit(j)) {
+                return;
+            }
+        }
+        return;
+    }
+    // Also taken for infinite radii.
+    if (std::pow(2 * reach + 1, 3) >= double(cells_.size())) {
+        for (const auto &cell : cells_) {
+            if ((cell.first - center).cwiseAbs().maxCoeff() > reach) {
+                continue;
+            }
+            for (int j = cell.second.first; j < cell.second.second; ++j) {
+                if (!visit(j)) {
+                    return;
+                }
+            }
+        }
+        return;
+    }
+    const int r = static_cast<int>(reach);
+    for (int dx = -r; dx <= r; ++dx) {
+        for (int dy = -r; dy <= r; ++dy) {
+            for (int dz = -r; dz <= r; ++dz) {
+                auto cell = cells_.find(center + Eigen::Vector3i(dx, dy, dz));
+                if (cell == cells_.end()) {
+                    continue;
+                }
+                for (int j = cell->second.first; j < cell->second.second;
+                     ++j) {
+                    if (!visit(j)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int HashGrid::SearchRadius(const Eigen::Vector3d &query,
+                           double radius,
+                           std::vector<int> &indices,
+                           std::vector<double> &distance2) const {
+    // Reused across calls so that repeated searches do not allocate.
+    thread_local std::vector<std::pair<double, int>> neighbors;
+    neighbors.clear();
+
+    const double radius2 = radius * radius;
+    VisitCandidates(query, radius, [&](int j) {
+        const double d2 = (points_[j] - query).squaredNorm();
+        if (d2 < radius2) {
+            neighbors.emplace_back(d2, indices_[j]);
+        }
+        return true;
+    });
+    std::sort(neighbors.begin(), neighbors.end());
+
+    const auto k = static_cast<int>(neighbors.size());
+    indices.resize(k);
+    distance2.resize(k);
+    for (int i = 0; i < k; ++i) {
+        distance2[i] = neighbors[i].first;
+        indices[i] = neighbors[i].second;
+    }
+    return k;
+}
+
+int HashGrid::CountRadius(const Eigen::Vector3d &query,
+                          double radius,
+                          int max_count /* = -1*/) const {
+    if (max_count == 0) {
+        return 0;
+    }
+    const double radius2 = radius * radius;
+    int count = 0;
+    VisitCandidates(query, radius, [&](int j) {
+        return !((points_[j] - query).squaredNorm() < radius2 &&
+                 ++count == max_count);
+    });
+    return count;
+}
+
+int HashGrid::SearchHybrid(const Eigen::Vector3d &query,
+                           double radius,
+                           int max_nn,
+                           std::vector<int> &indices,
+                           std::vector<double> &distance2) const {
+    if (max_nn < 0) {
+        return -1;
+    }
+    const int k = std::min(SearchRadius(query, radius, indices, distance2),
+                           max_nn);
+    indices.resize(k);
+    distance2.resize(k);
+    return k;
+}
+
+int HashGrid::Search(const Eigen::Vector3d &query,
+                     const KDTreeSearchParam &param,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const {
+    switch (param.GetSearchType()) {
+        case KDTreeSearchParam::SearchType::Radius:
+            return SearchRadius(
+                    query, ((const KDTreeSearchParamRadius &)param).radius_,
+                    indices, distance2);
+        case KDTreeSearchParam::SearchType::Hybrid:
+            return SearchHybrid(
+                    query, ((const KDTreeSearchParamHybrid &)param).radius_,
+                    ((const KDTreeSearchParamHybrid &)param).max_nn_, indices,
+                    distance2);
+        default:
+            utility::LogError("[HashGrid] KNN search is not supported.");
+            return -1;
+    }
+}
+
+}  // namespace u3d::geometry
@@ -0,0 +1,117 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "unified3d/geometry/KDTreeSearchParam.h"
+#include "unified3d/utility/Helper.h"
+
+namespace u3d::geometry {
+
+/// \enum NeighborSearchBackend
+///
+/// \brief Spatial index used by algorithms that search neighbors within a
+/// fixed radius.
+enum class NeighborSearchBackend {
+    /// KDTreeFlann. Works for any search radius and KNN searches.
+    KDTree = 0,
+    /// HashGrid with the search radius as cell size. Cheaper to build and
+    /// query when all searches use the same radius.
+    HashGrid = 1,
+};
+
+/// \class HashGrid
+///
+/// \brief Uniform voxel grid over a set of 3D points for fixed-radius
+/// neighbor search.
+///
+/// Points are bucketed into cubic cells and stored sorted by cell, so the
+/// points of a cell are contiguous. A radius query scans the cells
+/// overlapping the query sphere, i.e. the 27 cells around the query point
+/// when the radius does not exceed the cell size. Queries whose sphere
+/// overlaps more cells than the grid holds scan the non-empty cells instead.
+class HashGrid {
+public:
+    /// \brief Parameterized Constructor. The grid is built in parallel.
+    ///
+    /// Points with non-finite coordinates are not indexed, and are never
+    /// returned by the searches. Raises an error if a point lies 2^30 cells
+    /// or more away from the origin.
+    ///
+    /// \param points Points to index. They are copied into the grid.
+    /// \param cell_size Edge length of the cells, normally the search radius.
+    HashGrid(const std::vector<Eigen::Vector3d> &points, double cell_size);
+
+public:
+    /// Returns the edge length of the cells.
+    [[nodiscard]] double GetCellSize() const { return cell_size_; }
+    /// Returns the number of non-empty cells.
+    [[nodiscard]] size_t NumCells() const { return cells_.size(); }
+
+    /// \brief Searches the points closer than \p radius to \p query.
+    ///
+    /// Results are ordered by increasing distance, as for KDTreeFlann.
+    /// \return The number of neighbors found.
+    int SearchRadius(const Eigen::Vector3d &query,
+                     double radius,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const;
+
+    /// \brief Counts the points closer than \p radius to \p query, without
+    /// collecting them.
+    ///
+    /// The scan stops once \p max_count points are found, so the result is at
+    /// most \p max_count. Negative to count all points.
+    int CountRadius(const Eigen::Vector3d &query,
+                    double radius,
+                    int max_count = -1) const;
+
+    /// \brief Searches the at most \p max_nn nearest points closer than
+    /// \p radius to \p query.
+    int SearchHybrid(const Eigen::Vector3d &query,
+                     double radius,
+                     int max_nn,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const;
+
+    /// \brief Dispatches to SearchRadius() or SearchHybrid(). KNN search
+    /// parameters are not supported.
+    int Search(const Eigen::Vector3d &query,
+               const KDTreeSearchParam &param,
+               std::vector<int> &indices,
+               std::vector<double> &distance2) const;
+
+private:
+    /// Computes the cell of \p p. Returns false, leaving \p cell undefined,
+    /// if \p p is not finite or lies 2^30 cells or more away from the origin.
+    bool CellIndex(const Eigen::Vector3d &p, Eigen::Vector3i &cell) const;
+    /// Calls \p visit with the position in points_ of every point in the
+    /// cells overlapping the sphere of \p radius around \p query, until it
+    /// returns false.
+    template <typename Visitor>
+    void VisitCandidates(const Eigen::Vector3d &query,
+                         double radius,
+                         const Visitor &visit) const;
+
+private:
+    double cell_size_;
+    /// Points sorted by cell.
+    std::vector<Eigen::Vector3d> points_;
+    /// Original index of each point in points_.
+    std::vector<int> indices_;
+    /// Range [begin, end) of each non-empty cell in points_.
+    std::unordered_map<Eigen::Vector3i,
+                       std::pair<int, int>,
+                       utility::hash_eigen<Eigen::Vector3i>>
+            cells_;
+};
+
+}  // namespace u3d::geometry
@@ -13,6 +13,8 @@
 #include <tuple>
 #include <vector>
 
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/HashGrid.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/Keypoint.h"
 #include "unified3d/geometry/PointCloud.h"
@@ -34,16 +36,25 @@ bool IsLocalMaxima(int query_idx,
 
 double ComputeModelResolution(const std::vector<Eigen::Vector3d>& points,
                               const geometry::KDTreeFlann& kdtree) {
-    std::vector<int> indices(2);
-    std::vector<double> distances(2);
-    const double resolution = std::accumulate(
-            points.begin(), points.end(), 0.,
-            [&](double state, const Eigen::Vector3d& point) {
-                if (kdtree.SearchKNN(point, 2, indices, distances) >= 2) {
-                    state += std::sqrt(distances[1]);
+    // Distances are summed in order afterwards, so that the result does not
+    // depend on the number of threads.
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::vector<double> nn_distances(num_points, 0.0);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> indices(2);
+                std::vector<double> distances(2);
+                for (int64_t i = begin; i < end; i++) {
+                    if (kdtree.SearchKNN(points[i], 2, indices, distances) >=
+                        2) {
+                        nn_distances[i] = std::sqrt(distances[1]);
+                    }
                 }
-                return state;
-            });
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    const double resolution =
+            std::accumulate(nn_distances.begin(), nn_distances.end(), 0.);
 
     return resolution / static_cast<double>(points.size());
 }
@@ -57,13 +68,18 @@ std::shared_ptr<PointCloud> ComputeISSKeypoints(
         double non_max_radius /* = 0.0 */,
         double gamma_21 /* = 0.975 */,
         double gamma_32 /* = 0.975 */,
-        int min_neighbors /*= 5 */) {
+        int min_neighbors /*= 5 */,
+        NeighborSearchBackend backend /* = NeighborSearchBackend::KDTree */) {
     if (input.points_.empty()) {
         utility::LogWarning("[ComputeISSKeypoints] Input PointCloud is empty!");
         return std::make_shared<PointCloud>();
     }
     const auto& points = input.points_;
-    KDTreeFlann kdtree(input);
+    KDTreeFlann kdtree;
+    const bool use_grid = backend == NeighborSearchBackend::HashGrid;
+    if (!use_grid || salient_radius == 0.0 || non_max_radius == 0.0) {
+        kdtree.SetGeometry(input);
+    }
 
     if (salient_radius == 0.0 || non_max_radius == 0.0) {
         const double resolution = ComputeModelResolution(points, kdtree);
@@ -75,44 +91,94 @@ std::shared_ptr<PointCloud> ComputeISSKeypoints(
                 salient_radius, non_max_radius);
     }
 
-    std::vector<double> third_eigen_values(points.size());
-    for (int i = 0; i < (int)points.size(); i++) {
-        std::vector<int> indices;
-        std::vector<double> dist;
-        int nb_neighbors =
-                kdtree.SearchRadius(points[i], salient_radius, indices, dist);
-        if (nb_neighbors < min_neighbors) {
-            continue;
-        }
-
-        Eigen::Matrix3d cov = utility::ComputeCovariance(points, indices);
-        if (cov.isZero()) {
-            continue;
-        }
-
-        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(cov);
-        const double& e1c = solver.eigenvalues()[2];
-        const double& e2c = solver.eigenvalues()[1];
-        const double& e3c = solver.eigenvalues()[0];
-
-        if ((e2c / e1c) < gamma_21 && e3c / e2c < gamma_32) {
-            third_eigen_values[i] = e3c;
+    // One grid per search radius. When both radii are equal, the salient
+    // neighborhoods of the candidate keypoints are kept for the non maxima
+    // suppression instead of being searched again.
+    const bool reuse_neighbors = salient_radius == non_max_radius;
+    std::unique_ptr<HashGrid> salient_grid;
+    std::unique_ptr<HashGrid> non_max_grid;
+    if (use_grid) {
+        salient_grid = std::make_unique<HashGrid>(points, salient_radius);
+        if (!reuse_neighbors) {
+            non_max_grid = std::make_unique<HashGrid>(points, non_max_radius);
         }
     }
+    auto search_radius = [&](const HashGrid* grid, const Eigen::Vector3d& point,
+                             double radius, std::vector<int>& indices,
+                             std::vector<double>& dist) {
+        return grid ? grid->SearchRadius(point, radius, indices, dist)
+                    : kdtree.SearchRadius(point, radius, indices, dist);
+    };
+
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::vector<double> third_eigen_values(num_points);
+    std::vector<std::vector<int>> candidate_neighbors(
+            reuse_neighbors ? num_points : 0);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> indices;
+                std::vector<double> dist;
+                for (int64_t i = begin; i < end; i++) {
+                    int nb_neighbors = search_radius(salient_grid.get(),
+                                                     points[i], salient_radius,
+                                                     indices, dist);
+                    if (nb_neighbors < min_neighbors) {
+                        continue;
+                    }
+
+                    Eigen::Matrix3d cov =
+                            utility::ComputeCovariance(points, indices);
+                    if (cov.isZero()) {
+                        continue;
+                    }
+
+                    const Eigen::Vector3d eigen_values =
+                            utility::ComputeSymmetricEigenvalues3x3(cov);
+                    const double e1c = eigen_values[2];
+                    const double e2c = eigen_values[1];
+                    const double e3c = eigen_values[0];
+
+                    if ((e2c / e1c) < gamma_21 && e3c / e2c < gamma_32) {
+                        third_eigen_values[i] = e3c;
+                        if (reuse_neighbors && e3c > 0.0) {
+                            candidate_neighbors[i].swap(indices);
+                        }
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+
+    std::vector<uint8_t> is_keypoint(num_points, 0);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> nn_indices;
+                std::vector<double> dist;
+                for (int64_t i = begin; i < end; i++) {
+                    if (third_eigen_values[i] <= 0.0) {
+                        continue;
+                    }
+                    if (reuse_neighbors) {
+                        // The salient search already found enough neighbors.
+                        is_keypoint[i] = IsLocalMaxima(
+                                i, candidate_neighbors[i], third_eigen_values);
+                        continue;
+                    }
+                    int nb_neighbors =
+                            search_radius(non_max_grid.get(), points[i],
+                                          non_max_radius, nn_indices, dist);
+                    is_keypoint[i] =
+                            nb_neighbors >= min_neighbors &&
+                            IsLocalMaxima(i, nn_indices, third_eigen_values);
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
 
     std::vector<size_t> kp_indices;
-    kp_indices.reserve(points.size());
-    for (int i = 0; i < (int)points.size(); i++) {
-        if (third_eigen_values[i] > 0.0) {
-            std::vector<int> nn_indices;
-            std::vector<double> dist;
-            int nb_neighbors = kdtree.SearchRadius(points[i], non_max_radius,
-                                                   nn_indices, dist);
-
-            if (nb_neighbors >= min_neighbors &&
-                IsLocalMaxima(i, nn_indices, third_eigen_values)) {
-                kp_indices.emplace_back(i);
-            }
+    for (int64_t i = 0; i < num_points; i++) {
+        if (is_keypoint[i]) {
+            kp_indices.emplace_back(i);
         }
     }
 
@@ -6,9 +6,15 @@
 
 #include "unified3d/geometry/KDTreeFlann.h"
 
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <nanoflann.hpp>
 
+#include "unified3d/core/Dispatch.h"
+#include "unified3d/core/Parallel.h"
+#include "unified3d/core/Tensor.h"
+#include "unified3d/core/TensorCheck.h"
 #include "unified3d/geometry/HalfEdgeTriangleMesh.h"
 #include "unified3d/geometry/PointCloud.h"
 #include "unified3d/geometry/TriangleMesh.h"
@@ -16,11 +22,200 @@
 
 namespace u3d::geometry {
 
+namespace {
+
+/// Number of queries whose results are gathered together by SearchBatch.
+/// Fixed so that the output does not depend on the number of threads.
+constexpr int64_t kQueryBlockSize = 256;
+
+/// Maximum number of points in a leaf of the trees.
+constexpr size_t kLeafMaxSize = 15;
+
+/// nanoflann result set that only counts the points closer than the radius,
+/// and stops the search once max_count of them are found.
+template <typename DistanceType, typename IndexType>
+class CountResultSet {
+public:
+    CountResultSet(DistanceType radius2, size_t max_count)
+        : radius2_(radius2), max_count_(max_count) {}
+
+    bool addPoint(DistanceType dist, IndexType) {
+        if (dist < radius2_) {
+            ++count_;
+        }
+        return count_ < max_count_;
+    }
+    [[nodiscard]] DistanceType worstDist() const { return radius2_; }
+    [[nodiscard]] bool full() const { return true; }
+    [[nodiscard]] size_t count() const { return count_; }
+
+private:
+    DistanceType radius2_;
+    size_t max_count_;
+    size_t count_ = 0;
+};
+
+/// nanoflann result set that keeps the nearest point closer than the radius.
+/// The radius shrinks to the best distance found, which prunes the search.
+template <typename DistanceType, typename IndexType>
+class NearestResultSet {
+public:
+    explicit NearestResultSet(DistanceType radius2) : distance2_(radius2) {}
+
+    bool addPoint(DistanceType dist, IndexType index) {
+        if (dist < distance2_) {
+            distance2_ = dist;
+            index_ = static_cast<int>(index);
+        }
+        return true;
+    }
+    [[nodiscard]] DistanceType worstDist() const { return distance2_; }
+    [[nodiscard]] bool full() const { return true; }
+    [[nodiscard]] int index() const { return index_; }
+
+private:
+    DistanceType distance2_;
+    int index_ = -1;
+};
+
+/// Converts the max_count argument of CountRadius(), negative for no limit.
+size_t MaxCount(int max_count) {
+    return max_count < 0 ? std::numeric_limits<size_t>::max()
+                         : static_cast<size_t>(max_count);
+}
+
+}  // namespace
+
+/// nanoflann dataset adaptor and tree over tightly packed xyz points. Double
+/// precision trees index the caller's points in place, float trees keep a
+/// converted copy.
+template <typename Scalar>
+struct KDTreeFlann::Index3D {
+    using Tree = nanoflann::KDTreeSingleIndexAdaptor<
+            nanoflann::L2_Simple_Adaptor<Scalar, Index3D<Scalar>>,
+            Index3D<Scalar>,
+            3>;
+    using IndexType = typename Tree::IndexType;
+
+    Index3D(const double *points, size_t num_points) : size_(num_points) {
+        if constexpr (std::is_same_v<Scalar, double>) {
+            points_ = points;
+        } else {
+            storage_.resize(3 * num_points);
+            core::parallelFor(
+                    size_t(0), storage_.size(),
+                    [&](size_t i) {
+                        storage_[i] = static_cast<Scalar>(points[i]);
+                    },
+                    core::executionPolicyFor(storage_.size()));
+            points_ = storage_.data();
+        }
+        // The tree is built by the constructor.
+        const unsigned int num_threads =
+                core::executionPolicyFor(num_points) ==
+                                core::ExecutionPolicy::kSerial
+                        ? 1
+                        : core::maxNumberOfThreads();
+        tree_ = std::make_unique<Tree>(
+                3, *this,
+                nanoflann::KDTreeSingleIndexAdaptorParams(
+                        kLeafMaxSize,
+                        nanoflann::KDTreeSingleIndexAdaptorFlags::None,
+                        num_threads));
+    }
+
+    // Dataset interface required by nanoflann.
+    [[nodiscard]] size_t kdtree_get_point_count() const { return size_; }
+    [[nodiscard]] Scalar kdtree_get_pt(size_t idx, size_t dim) const {
+        return points_[3 * idx + dim];
+    }
+    template <class BBox>
+    bool kdtree_get_bbox(BBox &) const {
+        return false;
+    }
+
+    int SearchKNN(const double *query,
+                  int knn,
+                  std::vector<int> &indices,
+                  std::vector<double> &distance2) const {
+        const Scalar query_s[3] = {static_cast<Scalar>(query[0]),
+                                   static_cast<Scalar>(query[1]),
+                                   static_cast<Scalar>(query[2])};
+        thread_local std::vector<IndexType> indices_tree;
+        thread_local std::vector<Scalar> distance2_tree;
+        indices_tree.resize(knn);
+        distance2_tree.resize(knn);
+        const auto k = static_cast<int>(tree_->knnSearch(
+                query_s, knn, indices_tree.data(), distance2_tree.data()));
+        indices.assign(indices_tree.begin(), indices_tree.begin() + k);
+        distance2.assign(distance2_tree.begin(), distance2_tree.begin() + k);
+        return k;
+    }
+
+    int SearchRadius(const double *query,
+                     double radius,
+                     std::vector<int> &indices,
+                     std::vector<double> &distance2) const {
+        const Scalar query_s[3] = {static_cast<Scalar>(query[0]),
+                                   static_cast<Scalar>(query[1]),
+                                   static_cast<Scalar>(query[2])};
+        thread_local std::vector<nanoflann::ResultItem<IndexType, Scalar>>
+                indices_dists;
+        indices_dists.clear();
+        const auto k = static_cast<int>(tree_->radiusSearch(
+                query_s, static_cast<Scalar>(radius * radius), indices_dists,
+                nanoflann::SearchParameters(0.0)));
+        indices.resize(k);
+        distance2.resize(k);
+        for (int i = 0; i < k; ++i) {
+            indices[i] = static_cast<int>(indices_dists[i].first);
+            distance2[i] = indices_dists[i].second;
+        }
+        return k;
+    }
+
+    int CountRadius(const double *query, double radius, int max_count) const {
+        const Scalar query_s[3] = {static_cast<Scalar>(query[0]),
+                                   static_cast<Scalar>(query[1]),
+                                   static_cast<Scalar>(query[2])};
+        CountResultSet<Scalar, IndexType> result(
+                static_cast<Scalar>(radius * radius), MaxCount(max_count));
+        tree_->findNeighbors(result, query_s);
+        return static_cast<int>(result.count());
+    }
+
+    int SearchNearest(const double *query,
+                      double radius,
+                      int &index,
+                      double &distance2) const {
+        const Scalar query_s[3] = {static_cast<Scalar>(query[0]),
+                                   static_cast<Scalar>(query[1]),
+                                   static_cast<Scalar>(query[2])};
+        NearestResultSet<Scalar, IndexType> result(
+                static_cast<Scalar>(radius * radius));
+        tree_->findNeighbors(result, query_s);
+        if (result.index() < 0) {
+            return 0;
+        }
+        index = result.index();
+        distance2 = result.worstDist();
+        return 1;
+    }
+
+    const Scalar *points_ = nullptr;
+    size_t size_ = 0;
+    std::vector<Scalar> storage_;
+    std::unique_ptr<Tree> tree_;
+};
+
 KDTreeFlann::KDTreeFlann() = default;
 
 KDTreeFlann::KDTreeFlann(const Eigen::MatrixXd &data) { SetMatrixData(data); }
 
-KDTreeFlann::KDTreeFlann(const Geometry &geometry) { SetGeometry(geometry); }
+KDTreeFlann::KDTreeFlann(const Geometry &geometry,
+                         Precision precision /* = Precision::Float64*/) {
+    SetGeometry(geometry, precision);
+}
 
 KDTreeFlann::~KDTreeFlann() = default;
 
@@ -29,19 +224,22 @@ bool KDTreeFlann::SetMatrixData(const Eigen::MatrixXd &data) {
             data.data(), data.rows(), data.cols()));
 }
 
-bool KDTreeFlann::SetGeometry(const Geometry &geometry) {
+bool KDTreeFlann::SetGeometry(
+        const Geometry &geometry,
+        Precision precision /* = Precision::Float64*/) {
     switch (geometry.GetGeometryType()) {
         case Geometry::GeometryType::PointCloud:
-            return SetRawData(Eigen::Map<const Eigen::MatrixXd>(
+            return SetPoints3D(
                     (const double *)((const PointCloud &)geometry)
                             .points_.data(),
-                    3, ((const PointCloud &)geometry).points_.size()));
+                    ((const PointCloud &)geometry).points_.size(), precision);
         case Geometry::GeometryType::TriangleMesh:
         case Geometry::GeometryType::HalfEdgeTriangleMesh:
-            return SetRawData(Eigen::Map<const Eigen::MatrixXd>(
+            return SetPoints3D(
                     (const double *)((const TriangleMesh &)geometry)
                             .vertices_.data(),
-                    3, ((const TriangleMesh &)geometry).vertices_.size()));
+                    ((const TriangleMesh &)geometry).vertices_.size(),
+                    precision);
         case Geometry::GeometryType::Image:
         case Geometry::GeometryType::Unspecified:
         default:
@@ -82,13 +280,20 @@ int KDTreeFlann::SearchKNN(const T &query,
     // This is optimized code for heavily repeated search.
     // Other flann::Index::knnSearch() implementations lose performance due to
     // memory allocation/deallocation.
-    if (data_.empty() || dataset_size_ <= 0 ||
-        size_t(query.rows()) != dimension_ || knn < 0) {
+    if (dataset_size_ == 0 || size_t(query.rows()) != dimension_ || knn < 0) {
         return -1;
     }
+    if (index3d_f64_) {
+        return index3d_f64_->SearchKNN(query.data(), knn, indices, distance2);
+    }
+    if (index3d_f32_) {
+        return index3d_f32_->SearchKNN(query.data(), knn, indices, distance2);
+    }
     indices.resize(knn);
     distance2.resize(knn);
-    std::vector<Eigen::Index> indices_eigen(knn);
+    // Reused across calls so that repeated searches do not allocate.
+    thread_local std::vector<Eigen::Index> indices_eigen;
+    indices_eigen.resize(knn);
     int k = nanoflann_index_->index_->knnSearch(
             query.data(), knn, indices_eigen.data(), distance2.data());
     indices.resize(k);
@@ -106,10 +311,17 @@ int KDTreeFlann::SearchRadius(const T &query,
     // Since max_nn is not given, we let flann to do its own memory management.
     // Other flann::Index::radiusSearch() implementations lose performance due
     // to memory management and CPU caching.
-    if (data_.empty() || dataset_size_ <= 0 ||
-        size_t(query.rows()) != dimension_) {
+    if (dataset_size_ == 0 || size_t(query.rows()) != dimension_) {
         return -1;
     }
+    if (index3d_f64_) {
+        return index3d_f64_->SearchRadius(query.data(), radius, indices,
+                                          distance2);
+    }
+    if (index3d_f32_) {
+        return index3d_f32_->SearchRadius(query.data(), radius, indices,
+                                          distance2);
+    }
     std::vector<nanoflann::ResultItem<Eigen::Index, double>> indices_dists;
     int k = nanoflann_index_->index_->radiusSearch(
             query.data(), radius * radius, indices_dists,
@@ -123,6 +335,54 @@ int KDTreeFlann::SearchRadius(const T &query,
     return k;
 }
 
+template <typename T>
+int KDTreeFlann::CountRadius(const T &query,
+                             double radius,
+                             int max_count /* = -1*/) const {
+    if (dataset_size_ == 0 || size_t(query.rows()) != dimension_) {
+        return -1;
+    }
+    if (max_count == 0) {
+        return 0;
+    }
+    if (index3d_f64_) {
+        return index3d_f64_->CountRadius(query.data(), radius, max_count);
+    }
+    if (index3d_f32_) {
+        return index3d_f32_->CountRadius(query.data(), radius, max_count);
+    }
+    CountResultSet<double, Eigen::Index> result(radius * radius,
+                                                MaxCount(max_count));
+    nanoflann_index_->index_->findNeighbors(result, query.data());
+    return static_cast<int>(result.count());
+}
+
+template <typename T>
+int KDTreeFlann::SearchNearest(const T &query,
+                               double radius,
+                               int &index,
+                               double &distance2) const {
+    if (dataset_size_ == 0 || size_t(query.rows()) != dimension_) {
+        return -1;
+    }
+    if (index3d_f64_) {
+        return index3d_f64_->SearchNearest(query.data(), radius, index,
+                                           distance2);
+    }
+    if (index3d_f32_) {
+        return index3d_f32_->SearchNearest(query.data(), radius, index,
+                                           distance2);
+    }
+    NearestResultSet<double, Eigen::Index> result(radius * radius);
+    nanoflann_index_->index_->findNeighbors(result, query.data());
+    if (result.index() < 0) {
+        return 0;
+    }
+    index = result.index();
+    distance2 = result.worstDist();
+    return 1;
+}
+
 template <typename T>
 int KDTreeFlann::SearchHybrid(const T &query,
                               double radius,
@@ -133,12 +393,25 @@ int KDTreeFlann::SearchHybrid(const T &query,
     // It is also the recommended setting for search.
     // Other flann::Index::radiusSearch() implementations lose performance due
     // to memory allocation/deallocation.
-    if (data_.empty() || dataset_size_ <= 0 ||
-        size_t(query.rows()) != dimension_ || max_nn < 0) {
+    if (dataset_size_ == 0 || size_t(query.rows()) != dimension_ ||
+        max_nn < 0) {
         return -1;
     }
+    if (index3d_f64_ || index3d_f32_) {
+        int k = index3d_f64_ ? index3d_f64_->SearchKNN(query.data(), max_nn,
+                                                       indices, distance2)
+                             : index3d_f32_->SearchKNN(query.data(), max_nn,
+                                                       indices, distance2);
+        k = std::distance(distance2.begin(),
+                          std::lower_bound(distance2.begin(), distance2.end(),
+                                           radius * radius));
+        indices.resize(k);
+        distance2.resize(k);
+        return k;
+    }
     distance2.resize(max_nn);
-    std::vector<Eigen::Index> indices_eigen(max_nn);
+    thread_local std::vector<Eigen::Index> indices_eigen;
+    indices_eigen.resize(max_nn);
     int k = nanoflann_index_->index_->knnSearch(
             query.data(), max_nn, indices_eigen.data(), distance2.data());
     k = std::distance(distance2.begin(),
@@ -150,7 +423,225 @@ int KDTreeFlann::SearchHybrid(const T &query,
     return k;
 }
 
+/// Lowers \p first_failed to \p query_idx, so that batch searches report
+/// the first failed query whatever the thread count.
+static void RecordFailedQuery(std::atomic<int64_t> &first_failed,
+                              int64_t query_idx) {
+    int64_t current = first_failed.load();
+    while (query_idx < current &&
+           !first_failed.compare_exchange_weak(current, query_idx)) {
+    }
+}
+
+/// Raises an error if a query of a batch search failed, i.e. a single-query
+/// search returned -1.
+static void CheckFailedQuery(const std::atomic<int64_t> &first_failed,
+                             int64_t num_queries) {
+    const int64_t query_idx = first_failed.load();
+    if (query_idx < num_queries) {
+        utility::LogError(
+                "[KDTreeFlann] Search failed for query {}: the tree is empty, "
+                "or the query dimension or search parameters are invalid.",
+                query_idx);
+    }
+}
+
+template <typename Query, typename QueryFunc>
+KDTreeSearchResult KDTreeFlann::SearchBatch(
+        int64_t num_queries,
+        const QueryFunc &get_query,
+        const KDTreeSearchParam &param) const {
+    // Each block of queries gathers its neighbors into its own buffers, which
+    // are then concatenated in block order.
+    struct Block {
+        std::vector<int64_t> counts;
+        std::vector<int> indices;
+        std::vector<double> distance2;
+    };
+    const int64_t num_blocks =
+            (num_queries + kQueryBlockSize - 1) / kQueryBlockSize;
+    std::vector<Block> blocks(num_blocks);
+    std::atomic<int64_t> first_failed(num_queries);
+    core::parallelFor(
+            int64_t(0), num_blocks,
+            [&](int64_t block_idx) {
+                Block &block = blocks[block_idx];
+                const int64_t begin = block_idx * kQueryBlockSize;
+                const int64_t end =
+                        std::min(begin + kQueryBlockSize, num_queries);
+                block.counts.resize(end - begin);
+                Query query;
+                std::vector<int> indices;
+                std::vector<double> distance2;
+                for (int64_t i = begin; i < end; ++i) {
+                    get_query(i, query);
+                    const int k = Search(query, param, indices, distance2);
+                    if (k < 0) {
+                        RecordFailedQuery(first_failed, i);
+                        break;
+                    }
+                    block.counts[i - begin] = k;
+                    block.indices.insert(block.indices.end(), indices.begin(),
+                                         indices.begin() + k);
+                    block.distance2.insert(block.distance2.end(),
+                                           distance2.begin(),
+                                           distance2.begin() + k);
+                }
+            },
+            core::executionPolicyFor(num_queries, core::kHeavyGrainSize));
+    CheckFailedQuery(first_failed, num_queries);
+
+    KDTreeSearchResult result;
+    result.offsets_.resize(num_queries + 1);
+    std::vector<int64_t> block_offsets(num_blocks, 0);
+    int64_t offset = 0;
+    for (int64_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+        block_offsets[block_idx] = offset;
+        const int64_t begin = block_idx * kQueryBlockSize;
+        for (size_t j = 0; j < blocks[block_idx].counts.size(); ++j) {
+            result.offsets_[begin + j] = offset;
+            offset += blocks[block_idx].counts[j];
+        }
+    }
+    result.offsets_[num_queries] = offset;
+    result.indices_.resize(offset);
+    result.distance2_.resize(offset);
+    core::parallelFor(
+            int64_t(0), num_blocks,
+            [&](int64_t block_idx) {
+                const Block &block = blocks[block_idx];
+                std::copy(block.indices.begin(), block.indices.end(),
+                          result.indices_.begin() + block_offsets[block_idx]);
+                std::copy(block.distance2.begin(), block.distance2.end(),
+                          result.distance2_.begin() +
+                                  block_offsets[block_idx]);
+            },
+            core::executionPolicyFor(offset));
+    return result;
+}
+
+template <typename Query, typename QueryFunc>
+void KDTreeFlann::SearchKNNBatch(int64_t num_queries,
+                                 const QueryFunc &get_query,
+                                 int knn,
+                                 std::vector<int> &indices,
+                                 std::vector<double> &distance2) const {
+    if (knn < 0) {
+        utility::LogError("knn must be non-negative, but got {}.", knn);
+    }
+    indices.assign(num_queries * knn, -1);
+    distance2.assign(num_queries * knn,
+                     std::numeric_limits<double>::infinity());
+    std::atomic<int64_t> first_failed(num_queries);
+    core::parallelRangeFor(
+            int64_t(0), num_queries,
+            [&](int64_t begin, int64_t end) {
+                Query query;
+                std::vector<int> query_indices;
+                std::vector<double> query_distance2;
+                for (int64_t i = begin; i < end; ++i) {
+                    get_query(i, query);
+                    const int k = SearchKNN(query, knn, query_indices,
+                                            query_distance2);
+                    if (k < 0) {
+                        RecordFailedQuery(first_failed, i);
+                        break;
+                    }
+                    std::copy_n(query_indices.begin(), k,
+                                indices.begin() + i * knn);
+                    std::copy_n(query_distance2.begin(), k,
+                                distance2.begin() + i * knn);
+                }
+            },
+            core::executionPolicyFor(num_queries, core::kHeavyGrainSize));
+    CheckFailedQuery(first_failed, num_queries);
+}
+
+KDTreeSearchResult KDTreeFlann::SearchBatch(
+        const Eigen::MatrixXd &queries, const KDTreeSearchParam &param) const {
+    return SearchBatch<Eigen::VectorXd>(
+            queries.cols(),
+            [&](int64_t i, Eigen::VectorXd &query) { query = queries.col(i); },
+            param);
+}
+
+KDTreeSearchResult KDTreeFlann::SearchBatch(
+        const std::vector<Eigen::Vector3d> &queries,
+        const KDTreeSearchParam &param) const {
+    return SearchBatch<Eigen::Vector3d>(
+            static_cast<int64_t>(queries.size()),
+            [&](int64_t i, Eigen::Vector3d &query) { query = queries[i]; },
+            param);
+}
+
+KDTreeSearchResult KDTreeFlann::SearchBatch(
+        const core::Tensor &queries, const KDTreeSearchParam &param) const {
+    core::AssertTensorDevice(queries, core::Device("CPU:0"));
+    core::AssertTensorShape(queries,
+                            {std::nullopt, static_cast<int64_t>(dimension_)});
+    const core::Tensor queries_c = queries.Contiguous();
+    const auto dimension = static_cast<int64_t>(dimension_);
+    KDTreeSearchResult result;
+    DISPATCH_DTYPE_TO_TEMPLATE(queries_c.GetDtype(), [&]() {
+        const scalar_t *data = queries_c.GetSpan<scalar_t>().data();
+        result = SearchBatch<Eigen::VectorXd>(
+                queries_c.GetLength(),
+                [&](int64_t i, Eigen::VectorXd &query) {
+                    query = Eigen::Map<const Eigen::Matrix<scalar_t, -1, 1>>(
+                                    data + i * dimension, dimension)
+                                    .template cast<double>();
+                },
+                param);
+    });
+    return result;
+}
+
+void KDTreeFlann::SearchKNNBatch(const Eigen::MatrixXd &queries,
+                                 int knn,
+                                 std::vector<int> &indices,
+                                 std::vector<double> &distance2) const {
+    SearchKNNBatch<Eigen::VectorXd>(
+            queries.cols(),
+            [&](int64_t i, Eigen::VectorXd &query) { query = queries.col(i); },
+            knn, indices, distance2);
+}
+
+void KDTreeFlann::SearchKNNBatch(const std::vector<Eigen::Vector3d> &queries,
+                                 int knn,
+                                 std::vector<int> &indices,
+                                 std::vector<double> &distance2) const {
+    SearchKNNBatch<Eigen::Vector3d>(
+            static_cast<int64_t>(queries.size()),
+            [&](int64_t i, Eigen::Vector3d &query) { query = queries[i]; },
+            knn, indices, distance2);
+}
+
+bool KDTreeFlann::SetPoints3D(const double *points,
+                              size_t num_points,
+                              Precision precision) {
+    data_.clear();
+    data_interface_.reset();
+    nanoflann_index_.reset();
+    index3d_f64_.reset();
+    index3d_f32_.reset();
+    dimension_ = 3;
+    dataset_size_ = num_points;
+    if (dataset_size_ == 0) {
+        utility::LogWarning(
+                "[KDTreeFlann::SetPoints3D] Failed due to no data.");
+        return false;
+    }
+    if (precision == Precision::Float32) {
+        index3d_f32_ = std::make_unique<Index3D<float>>(points, num_points);
+    } else {
+        index3d_f64_ = std::make_unique<Index3D<double>>(points, num_points);
+    }
+    return true;
+}
+
 bool KDTreeFlann::SetRawData(const Eigen::Map<const Eigen::MatrixXd> &data) {
+    index3d_f64_.reset();
+    index3d_f32_.reset();
     dimension_ = data.rows();
     dataset_size_ = data.cols();
     if (dimension_ == 0 || dataset_size_ == 0) {
@@ -160,7 +651,8 @@ bool KDTreeFlann::SetRawData(const Eigen::Map<const Eigen::MatrixXd> &data) {
     data_.resize(dataset_size_ * dimension_);
     memcpy(data_.data(), data.data(),
            dataset_size_ * dimension_ * sizeof(double));
-    data_interface_ = std::make_unique<Eigen::Map<const Eigen::MatrixXd>>(data);
+    data_interface_ = std::make_unique<Eigen::Map<const Eigen::MatrixXd>>(
+            data_.data(), dimension_, dataset_size_);
     nanoflann_index_ = std::make_unique<KDTree_t>(
             dimension_, std::cref(*data_interface_), 15);
     nanoflann_index_->index_->buildIndex();
@@ -188,6 +680,13 @@ template int KDTreeFlann::SearchHybrid<Eigen::Vector3d>(
         int max_nn,
         std::vector<int> &indices,
         std::vector<double> &distance2) const;
+template int KDTreeFlann::CountRadius<Eigen::Vector3d>(
+        const Eigen::Vector3d &query, double radius, int max_count) const;
+template int KDTreeFlann::SearchNearest<Eigen::Vector3d>(
+        const Eigen::Vector3d &query,
+        double radius,
+        int &index,
+        double &distance2) const;
 
 template int KDTreeFlann::Search<Eigen::VectorXd>(
         const Eigen::VectorXd &query,
@@ -210,5 +709,12 @@ template int KDTreeFlann::SearchHybrid<Eigen::VectorXd>(
         int max_nn,
         std::vector<int> &indices,
         std::vector<double> &distance2) const;
+template int KDTreeFlann::CountRadius<Eigen::VectorXd>(
+        const Eigen::VectorXd &query, double radius, int max_count) const;
+template int KDTreeFlann::SearchNearest<Eigen::VectorXd>(
+        const Eigen::VectorXd &query,
+        double radius,
+        int &index,
+        double &distance2) const;
 
 }  // namespace u3d::geometry
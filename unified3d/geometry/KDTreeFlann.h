@@ -19,14 +19,55 @@ struct metric_L2;
 template <class MatrixType, int DIM, class Distance, bool row_major>
 struct KDTreeEigenMatrixAdaptor;
 }  // namespace nanoflann
+namespace u3d::core {
+class Tensor;
+}  // namespace u3d::core
 /// @endcond
 
 namespace u3d::geometry {
 
+/// \struct KDTreeSearchResult
+///
+/// \brief Neighbors of a batch of queries in compressed row form.
+///
+/// The neighbors of query i are indices_[offsets_[i]] to
+/// indices_[offsets_[i + 1] - 1], ordered by increasing distance, and
+/// distance2_ holds the matching squared distances.
+struct KDTreeSearchResult {
+    /// Number of queries in the batch.
+    [[nodiscard]] size_t NumQueries() const {
+        return offsets_.empty() ? 0 : offsets_.size() - 1;
+    }
+    /// Number of neighbors found for query \p i.
+    [[nodiscard]] int64_t NumNeighbors(size_t i) const {
+        return offsets_[i + 1] - offsets_[i];
+    }
+
+    /// Row offsets, of size NumQueries() + 1.
+    std::vector<int64_t> offsets_;
+    /// Neighbor indices of all queries, concatenated.
+    std::vector<int> indices_;
+    /// Squared neighbor distances of all queries, concatenated.
+    std::vector<double> distance2_;
+};
+
 /// \class KDTreeFlann
 ///
 /// \brief KDTree with FLANN for nearest neighbor search.
 class KDTreeFlann {
+public:
+    /// \enum Precision
+    ///
+    /// \brief Storage precision of trees built from 3D geometry.
+    enum class Precision {
+        /// Indexes the geometry's points in place, without a copy. The
+        /// geometry must outlive the tree and keep its points unchanged.
+        Float64 = 0,
+        /// Indexes a float32 copy of the points, half the size of the
+        /// original, with faster distance evaluations.
+        Float32 = 1,
+    };
+
 public:
     /// \brief Default Constructor.
     KDTreeFlann();
@@ -36,8 +77,12 @@ public:
     KDTreeFlann(const Eigen::MatrixXd &data);
     /// \brief Parameterized Constructor.
     ///
+    /// See SetGeometry() for the lifetime requirements on \p geometry.
+    ///
     /// \param geometry Provides geometry from which KDTree is constructed.
-    KDTreeFlann(const Geometry &geometry);
+    /// \param precision Storage precision of the tree.
+    KDTreeFlann(const Geometry &geometry,
+                Precision precision = Precision::Float64);
 
     ~KDTreeFlann();
     KDTreeFlann(const KDTreeFlann &) = delete;
@@ -50,8 +95,20 @@ public:
     bool SetMatrixData(const Eigen::MatrixXd &data);
     /// Sets the data for the KDTree from geometry.
     ///
+    /// Point clouds and triangle meshes are indexed by a tree specialized for
+    /// 3D points, built in parallel.
+    ///
+    /// \warning With Precision::Float64 the tree does not copy the points: it
+    /// refers to the points of \p geometry directly. The geometry must outlive
+    /// the tree, and after its points are modified, added or removed, the
+    /// tree must be rebuilt with SetGeometry() before it is searched again.
+    /// Precision::Float32 trees keep their own copy and have no such
+    /// requirement.
+    ///
     /// \param geometry Geometry for KDTree Construction.
-    bool SetGeometry(const Geometry &geometry);
+    /// \param precision Storage precision of the tree.
+    bool SetGeometry(const Geometry &geometry,
+                     Precision precision = Precision::Float64);
 
     template <typename T>
     int Search(const T &query,
@@ -78,7 +135,75 @@ public:
                      std::vector<int> &indices,
                      std::vector<double> &distance2) const;
 
+    /// \brief Counts the points closer than \p radius to \p query, without
+    /// collecting them.
+    ///
+    /// \param max_count The search stops once this many points are found, so
+    /// the result is at most \p max_count. Negative to count all points.
+    /// \return The number of points found, or -1 on invalid input.
+    template <typename T>
+    int CountRadius(const T &query, double radius, int max_count = -1) const;
+
+    /// \brief Searches the nearest point closer than \p radius to \p query.
+    ///
+    /// Unlike SearchKNN(), the radius bounds the search from the start, so
+    /// far queries are rejected quickly.
+    /// \return 1 if a point was found, 0 if none is closer than \p radius, or
+    /// -1 on invalid input.
+    template <typename T>
+    int SearchNearest(const T &query,
+                      double radius,
+                      int &index,
+                      double &distance2) const;
+
+    /// \brief Searches the neighbors of many queries in parallel.
+    ///
+    /// Raises an error if the search of a query fails, i.e. if Search() would
+    /// return -1 for it.
+    /// \param queries Query points, one per column.
+    /// \param param Search parameters, as for Search().
+    KDTreeSearchResult SearchBatch(const Eigen::MatrixXd &queries,
+                                   const KDTreeSearchParam &param) const;
+    KDTreeSearchResult SearchBatch(const std::vector<Eigen::Vector3d> &queries,
+                                   const KDTreeSearchParam &param) const;
+    /// \param queries CPU tensor of shape (N, dimension), any dtype.
+    KDTreeSearchResult SearchBatch(const core::Tensor &queries,
+                                   const KDTreeSearchParam &param) const;
+
+    /// \brief KNN search of many queries in parallel, with fixed-width
+    /// results.
+    ///
+    /// \p indices and \p distance2 are resized to N * knn, row i holding the
+    /// neighbors of query i. If the tree has fewer than knn points, rows are
+    /// padded with index -1 and infinite distance. Raises an error if the
+    /// search of a query fails, e.g. on an empty tree.
+    void SearchKNNBatch(const Eigen::MatrixXd &queries,
+                        int knn,
+                        std::vector<int> &indices,
+                        std::vector<double> &distance2) const;
+    void SearchKNNBatch(const std::vector<Eigen::Vector3d> &queries,
+                        int knn,
+                        std::vector<int> &indices,
+                        std::vector<double> &distance2) const;
+
 private:
+    template <typename Query, typename QueryFunc>
+    KDTreeSearchResult SearchBatch(int64_t num_queries,
+                                   const QueryFunc &get_query,
+                                   const KDTreeSearchParam &param) const;
+
+    template <typename Query, typename QueryFunc>
+    void SearchKNNBatch(int64_t num_queries,
+                        const QueryFunc &get_query,
+                        int knn,
+                        std::vector<int> &indices,
+                        std::vector<double> &distance2) const;
+
+    /// \brief Builds the 3D tree over \p num_points tightly packed xyz points.
+    bool SetPoints3D(const double *points,
+                     size_t num_points,
+                     Precision precision);
+
     /// \brief Sets the KDTree data from the data provided by the other methods.
     ///
     /// Internal method that sets all the members of KDTree by data provided by
@@ -86,6 +211,11 @@ private:
     bool SetRawData(const Eigen::Map<const Eigen::MatrixXd> &data);
 
 protected:
+    /// Tree over 3D points with a compile-time dimension, defined in the
+    /// source file.
+    template <typename Scalar>
+    struct Index3D;
+
     using KDTree_t = nanoflann::KDTreeEigenMatrixAdaptor<
             Eigen::Map<const Eigen::MatrixXd>,
             -1,
@@ -95,6 +225,8 @@ protected:
     std::vector<double> data_;
     std::unique_ptr<Eigen::Map<const Eigen::MatrixXd>> data_interface_;
     std::unique_ptr<KDTree_t> nanoflann_index_;
+    std::unique_ptr<Index3D<double>> index3d_f64_;
+    std::unique_ptr<Index3D<float>> index3d_f32_;
     size_t dimension_ = 0;
     size_t dataset_size_ = 0;
 };
@@ -8,6 +8,8 @@
 
 #include <memory>
 
+#include "unified3d/geometry/HashGrid.h"
+
 namespace u3d::geometry {
 
 class PointCloud;
@@ -19,6 +21,9 @@ namespace keypoint {
 /// Zhong ,"Intrinsic Shape Signatures: A Shape Descriptor for 3D Object
 /// Recognition", 2009. The implementation is inspired by the PCL one.
 ///
+/// The saliency and non maxima suppression passes run in parallel. When both
+/// radii are equal, the neighborhoods are only searched once.
+///
 /// \param input The input PointCloud where to compute the ISS Keypoints.
 /// \param salient_radius The radius of the spherical neighborhood used to
 /// detect the keypoints
@@ -31,13 +36,17 @@ namespace keypoint {
 /// second eigenvalue
 /// \param min_neighbors Minimum number of neighbors that has to be found to
 /// consider a keypoint.
+/// \param backend Spatial index used for the radius searches. The model
+/// resolution is always estimated with a KDTree.
 /// \authors Ignacio Vizzo and Cyrill Stachniss, University of Bonn.
-std::shared_ptr<PointCloud> ComputeISSKeypoints(const PointCloud &input,
-                                                double salient_radius = 0.0,
-                                                double non_max_radius = 0.0,
-                                                double gamma_21 = 0.975,
-                                                double gamma_32 = 0.975,
-                                                int min_neighbors = 5);
+std::shared_ptr<PointCloud> ComputeISSKeypoints(
+        const PointCloud &input,
+        double salient_radius = 0.0,
+        double non_max_radius = 0.0,
+        double gamma_21 = 0.975,
+        double gamma_32 = 0.975,
+        int min_neighbors = 5,
+        NeighborSearchBackend backend = NeighborSearchBackend::KDTree);
 
 }  // namespace keypoint
 }  // namespace u3d::geometry
@@ -8,13 +8,20 @@
 
 #include <Eigen/Dense>
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <limits>
 #include <numeric>
+#include <tuple>
 
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/DuplicatedPoints.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/Qhull.h"
 #include "unified3d/geometry/TriangleMesh.h"
 #include "unified3d/utility/Eigen.h"
+#include "unified3d/utility/Helper.h"
 #include "unified3d/utility/Logging.h"
 #include "unified3d/utility/ProgressBar.h"
 #include "unified3d/utility/Random.h"
@@ -119,60 +126,320 @@ PointCloud PointCloud::operator+(const PointCloud &cloud) const {
     return (PointCloud(*this) += cloud);
 }
 
+namespace {
+
+/// Number of points between two checks of the early exit of the distance
+/// metrics. Fixed so that the results do not depend on the number of threads.
+constexpr int64_t kDistanceBlockSize = 256;
+
+/// Raises \p value to \p x if it is smaller.
+void AtomicMax(std::atomic<double> &value, double x) {
+    double current = value.load(std::memory_order_relaxed);
+    while (current < x && !value.compare_exchange_weak(
+                                  current, x, std::memory_order_relaxed)) {
+    }
+}
+
+/// Adds \p x to \p value and returns the new value.
+double AtomicAdd(std::atomic<double> &value, double x) {
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, current + x,
+                                        std::memory_order_relaxed)) {
+    }
+    return current + x;
+}
+
+/// Computes the mean distance from \p points to their nearest neighbor in
+/// \p tree, in blocks of points run in parallel. The weighted block sums are
+/// added to \p lower_bound, which is shared with the other direction of the
+/// Chamfer distance, and each search is bounded by what is left before
+/// \p max_distance. Returns false as soon as the bound is exceeded.
+bool ComputeMeanDistance(const std::vector<Eigen::Vector3d> &points,
+                         const KDTreeFlann &tree,
+                         double max_distance,
+                         std::atomic<double> &lower_bound,
+                         double &mean) {
+    const auto num_points = static_cast<int64_t>(points.size());
+    const int64_t num_blocks =
+            (num_points + kDistanceBlockSize - 1) / kDistanceBlockSize;
+    const double weight = 1.0 / static_cast<double>(num_points);
+    std::vector<double> block_sums(num_blocks, 0.0);
+    std::atomic<bool> exceeded(false);
+    core::parallelRangeFor(
+            int64_t(0), num_blocks,
+            [&](int64_t begin, int64_t end) {
+                for (int64_t b = begin; b < end; b++) {
+                    if (exceeded.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const int64_t first = b * kDistanceBlockSize;
+                    const int64_t last =
+                            std::min(first + kDistanceBlockSize, num_points);
+                    const double budget =
+                            max_distance -
+                            lower_bound.load(std::memory_order_relaxed);
+                    double sum = 0.0;
+                    for (int64_t i = first; i < last; i++) {
+                        // A point alone must not use up the remaining budget.
+                        const double radius = (budget - sum * weight) / weight;
+                        int index;
+                        double distance2;
+                        if (radius < 0 ||
+                            tree.SearchNearest(points[i], radius, index,
+                                               distance2) <= 0) {
+                            exceeded.store(true, std::memory_order_relaxed);
+                            return;
+                        }
+                        sum += std::sqrt(distance2);
+                    }
+                    block_sums[b] = sum;
+                    if (AtomicAdd(lower_bound, sum * weight) > max_distance) {
+                        exceeded.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    if (exceeded.load()) {
+        return false;
+    }
+    mean = std::accumulate(block_sums.begin(), block_sums.end(), 0.0) * weight;
+    return true;
+}
+
+/// Raises \p max_distance to the directed Hausdorff distance from \p points to
+/// the points of \p tree, in blocks of points run in parallel. A point with a
+/// neighbor closer than the current maximum cannot raise it, and a search that
+/// stops at the first such neighbor rules it out. Returns false as soon as a
+/// point at least \p bound away is found.
+bool ComputeDirectedHausdorffDistance(
+        const std::vector<Eigen::Vector3d> &points,
+        const KDTreeFlann &tree,
+        double bound,
+        std::atomic<double> &max_distance) {
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::atomic<bool> exceeded(false);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                for (int64_t first = begin; first < end;
+                     first += kDistanceBlockSize) {
+                    if (exceeded.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    const int64_t last =
+                            std::min(first + kDistanceBlockSize, end);
+                    for (int64_t i = first; i < last; i++) {
+                        const double current = max_distance.load(
+                                std::memory_order_relaxed);
+                        if (current > 0 &&
+                            tree.CountRadius(points[i], current, 1) > 0) {
+                            continue;
+                        }
+                        int index;
+                        double distance2;
+                        if (tree.SearchNearest(points[i], bound, index,
+                                               distance2) <= 0) {
+                            exceeded.store(true, std::memory_order_relaxed);
+                            return;
+                        }
+                        AtomicMax(max_distance, std::sqrt(distance2));
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    return !exceeded.load();
+}
+
+}  // namespace
+
 std::vector<double> PointCloud::ComputePointCloudDistance(
         const PointCloud &target) {
     std::vector<double> distances(points_.size());
     KDTreeFlann kdtree;
     kdtree.SetGeometry(target);
 
-    for (int i = 0; i < (int)points_.size(); i++) {
-        std::vector<int> indices(1);
-        std::vector<double> dists(1);
-        if (kdtree.SearchKNN(points_[i], 1, indices, dists) == 0) {
-            utility::LogDebug(
-                    "[ComputePointCloudToPointCloudDistance] Found a point "
-                    "without neighbors.");
-            distances[i] = 0.0;
-        } else {
-            distances[i] = std::sqrt(dists[0]);
+    const auto num_points = static_cast<int64_t>(points_.size());
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                int index;
+                double distance2;
+                if (kdtree.SearchNearest(
+                            points_[i],
+                            std::numeric_limits<double>::infinity(), index,
+                            distance2) <= 0) {
+                    utility::LogDebug(
+                            "[ComputePointCloudToPointCloudDistance] Found a "
+                            "point without neighbors.");
+                    distances[i] = 0.0;
+                } else {
+                    distances[i] = std::sqrt(distance2);
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    return distances;
+}
+
+double PointCloud::ComputeChamferDistance(
+        const PointCloud &target,
+        double max_distance /* = infinity */) const {
+    if (!HasPoints() || !target.HasPoints()) {
+        utility::LogError(
+                "[ComputeChamferDistance] Both point clouds must have "
+                "points.");
+    }
+    const KDTreeFlann source_tree(*this);
+    const KDTreeFlann target_tree(target);
+    std::atomic<double> lower_bound(0.0);
+    double source_mean = 0.0;
+    double target_mean = 0.0;
+    if (!ComputeMeanDistance(points_, target_tree, max_distance, lower_bound,
+                             source_mean) ||
+        !ComputeMeanDistance(target.points_, source_tree, max_distance,
+                             lower_bound, target_mean)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return source_mean + target_mean;
+}
+
+double PointCloud::ComputeHausdorffDistance(
+        const PointCloud &target,
+        double max_distance /* = infinity */) const {
+    if (!HasPoints() || !target.HasPoints()) {
+        utility::LogError(
+                "[ComputeHausdorffDistance] Both point clouds must have "
+                "points.");
+    }
+    const KDTreeFlann source_tree(*this);
+    const KDTreeFlann target_tree(target);
+    // Shared by both directions, as only the largest distance matters.
+    std::atomic<double> distance(0.0);
+    if (!ComputeDirectedHausdorffDistance(points_, target_tree, max_distance,
+                                          distance) ||
+        !ComputeDirectedHausdorffDistance(target.points_, source_tree,
+                                          max_distance, distance)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return distance.load();
+}
+
+std::vector<double> PointCloud::ComputeDistancePercentiles(
+        const PointCloud &target,
+        const std::vector<double> &percentiles,
+        double max_distance /* = infinity */) const {
+    if (!HasPoints() || !target.HasPoints()) {
+        utility::LogError(
+                "[ComputeDistancePercentiles] Both point clouds must have "
+                "points.");
+    }
+    for (double percentile : percentiles) {
+        if (!(percentile >= 0 && percentile <= 100)) {
+            utility::LogError(
+                    "[ComputeDistancePercentiles] Percentiles must be in "
+                    "[0, 100], but got {}.",
+                    percentile);
         }
     }
-    return distances;
+    const double infinity = std::numeric_limits<double>::infinity();
+    if (percentiles.empty()) {
+        return {};
+    }
+
+    // The 1-based rank of a percentile among the sorted distances.
+    const auto num_points = static_cast<int64_t>(points_.size());
+    auto rank = [num_points](double percentile) {
+        return std::max(int64_t(1),
+                        static_cast<int64_t>(std::ceil(
+                                percentile / 100.0 * num_points)));
+    };
+    // All the percentiles are infinity once more points than this are beyond
+    // max_distance.
+    const int64_t max_num_beyond =
+            num_points -
+            rank(*std::min_element(percentiles.begin(), percentiles.end()));
+
+    const KDTreeFlann kdtree(target);
+    std::vector<double> distances(num_points);
+    std::atomic<int64_t> num_beyond(0);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                for (int64_t first = begin; first < end;
+                     first += kDistanceBlockSize) {
+                    if (num_beyond.load(std::memory_order_relaxed) >
+                        max_num_beyond) {
+                        return;
+                    }
+                    const int64_t last =
+                            std::min(first + kDistanceBlockSize, end);
+                    int64_t block_num_beyond = 0;
+                    for (int64_t i = first; i < last; i++) {
+                        int index;
+                        double distance2;
+                        if (kdtree.SearchNearest(points_[i], max_distance,
+                                                 index, distance2) > 0) {
+                            distances[i] = std::sqrt(distance2);
+                        } else {
+                            distances[i] = infinity;
+                            block_num_beyond++;
+                        }
+                    }
+                    num_beyond.fetch_add(block_num_beyond,
+                                         std::memory_order_relaxed);
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    if (num_beyond.load() > max_num_beyond) {
+        return std::vector<double>(percentiles.size(), infinity);
+    }
+
+    core::parallelSort(distances.begin(), distances.end(),
+                       core::executionPolicyFor(num_points));
+    std::vector<double> values;
+    values.reserve(percentiles.size());
+    for (double percentile : percentiles) {
+        values.push_back(distances[rank(percentile) - 1]);
+    }
+    return values;
 }
 
-PointCloud &PointCloud::RemoveDuplicatedPoints() {
+PointCloud &PointCloud::RemoveDuplicatedPoints(double epsilon /* = 0.0*/) {
+    RemoveDuplicatedPointsAndTrace(epsilon);
+    return *this;
+}
+
+std::vector<size_t> PointCloud::RemoveDuplicatedPointsAndTrace(
+        double epsilon /* = 0.0*/) {
     const bool has_normals = HasNormals();
     const bool has_colors = HasColors();
     const bool has_covariances = HasCovariances();
     const size_t old_points_num = points_.size();
-    size_t k = 0;
 
-    typedef std::tuple<double, double, double> Coordinate3;
-    std::unordered_map<Coordinate3, size_t, utility::hash_tuple<Coordinate3>>
-            point_to_old_index;
-
-    for (size_t i = 0; i < old_points_num; i++) {
-        Coordinate3 coord =
-                std::make_tuple(points_[i](0), points_[i](1), points_[i](2));
-        if (point_to_old_index.find(coord) == point_to_old_index.end()) {
-            point_to_old_index[coord] = i;
-            points_[k] = points_[i];
-            if (has_normals) normals_[k] = normals_[i];
-            if (has_covariances) covariances_[k] = covariances_[i];
-            if (has_colors) colors_[k] = colors_[i];
-            k++;
+    std::vector<size_t> index_old_to_new, kept;
+    std::tie(index_old_to_new, kept) = FindDuplicatedPoints(points_, epsilon);
+    if (kept.size() < old_points_num) {
+        points_ = utility::GatherByIndex(points_, kept);
+        if (has_normals) normals_ = utility::GatherByIndex(normals_, kept);
+        if (has_covariances) {
+            covariances_ = utility::GatherByIndex(covariances_, kept);
         }
+        if (has_colors) colors_ = utility::GatherByIndex(colors_, kept);
     }
 
-    points_.resize(k);
-    if (has_normals) normals_.resize(k);
-    if (has_covariances) covariances_.resize(k);
-    if (has_colors) colors_.resize(k);
-
     utility::LogDebug("[RemoveDuplicatedPoints] {:d} points have been removed.",
-                      (int)(old_points_num - k));
+                      (int)(old_points_num - kept.size()));
 
-    return *this;
+    return index_old_to_new;
+}
+
+std::vector<size_t> PointCloud::SpatialReorder(SpaceFillingCurve curve) {
+    std::vector<size_t> order = ComputeSpaceFillingCurveOrder(points_, curve);
+    ApplyPermutation(points_, order);
+    ApplyPermutation(normals_, order);
+    ApplyPermutation(colors_, order);
+    ApplyPermutation(covariances_, order);
+    return order;
 }
 
 PointCloud &PointCloud::RemoveNonFinitePoints(bool remove_nan,
@@ -238,118 +505,210 @@ std::shared_ptr<PointCloud> PointCloud::SelectByIndex(
     return output;
 }
 
-// helper classes for VoxelDownSample and VoxelDownSampleAndTrace
+// helpers for VoxelDownSample and VoxelDownSampleAndTrace
 namespace {
-class AccumulatedPoint {
-public:
-    void AddPoint(const PointCloud &cloud, int index) {
-        point_ += cloud.points_[index];
-        if (cloud.HasNormals()) {
-            if (!std::isnan(cloud.normals_[index](0)) &&
-                !std::isnan(cloud.normals_[index](1)) &&
-                !std::isnan(cloud.normals_[index](2))) {
-                normal_ += cloud.normals_[index];
-            }
-        }
-        if (cloud.HasColors()) {
-            color_ += cloud.colors_[index];
-        }
-        if (cloud.HasCovariances()) {
-            covariance_ += cloud.covariances_[index];
+/// Points grouped by voxel in compressed sparse row layout. The points of the
+/// v-th voxel are indices[offsets[v]] to indices[offsets[v + 1] - 1], in
+/// increasing order, and voxels are ordered by their (x, y, z) voxel index.
+struct VoxelGroups {
+    std::vector<int64_t> offsets;
+    std::vector<int> indices;
+};
+
+Eigen::Vector3i ComputeVoxelIndex(const Eigen::Vector3d &point,
+                                  const Eigen::Vector3d &voxel_min_bound,
+                                  double voxel_size) {
+    Eigen::Vector3d ref_coord = (point - voxel_min_bound) / voxel_size;
+    return Eigen::Vector3i(int(floor(ref_coord(0))), int(floor(ref_coord(1))),
+                           int(floor(ref_coord(2))));
+}
+
+/// Groups the points by voxel. The voxel indices are packed into 64-bit keys
+/// and radix sorted, so that the points of each voxel become contiguous
+/// without hashing. Every step runs in parallel and the result does not
+/// depend on the number of threads.
+VoxelGroups GroupPointsByVoxel(const std::vector<Eigen::Vector3d> &points,
+                               const Eigen::Vector3d &voxel_min_bound,
+                               double voxel_size) {
+    const auto num_points = static_cast<int64_t>(points.size());
+    const auto policy = core::executionPolicyFor(num_points);
+    std::vector<Eigen::Vector3i> voxel_indices(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                voxel_indices[i] = ComputeVoxelIndex(
+                        points[i], voxel_min_bound, voxel_size);
+            },
+            policy);
+
+    // Voxel indices can be negative when the points exceed the given bounds,
+    // so keys are packed relative to the smallest voxel index on each axis.
+    using Range = std::pair<Eigen::Vector3i, Eigen::Vector3i>;
+    const Range empty(Eigen::Vector3i::Constant(INT_MAX),
+                      Eigen::Vector3i::Constant(INT_MIN));
+    const Range range = core::parallelReduce(
+            int64_t(0), num_points, empty,
+            [&](int64_t begin, int64_t end, Range r) {
+                for (int64_t i = begin; i < end; ++i) {
+                    r.first = r.first.cwiseMin(voxel_indices[i]);
+                    r.second = r.second.cwiseMax(voxel_indices[i]);
+                }
+                return r;
+            },
+            [](const Range &a, const Range &b) {
+                return Range(a.first.cwiseMin(b.first),
+                             a.second.cwiseMax(b.second));
+            },
+            policy);
+    unsigned int bits[3] = {0, 0, 0};
+    for (int c = 0; num_points > 0 && c < 3; ++c) {
+        const auto span = uint64_t(int64_t(range.second(c)) - range.first(c));
+        while (bits[c] < 64 && (span >> bits[c]) != 0) {
+            ++bits[c];
         }
-        num_of_points_++;
     }
-
-    [[nodiscard]] Eigen::Vector3d GetAveragePoint() const {
-        return point_ / double(num_of_points_);
+    const unsigned int num_key_bits = bits[0] + bits[1] + bits[2];
+
+    VoxelGroups groups;
+    groups.indices.resize(num_points);
+    std::iota(groups.indices.begin(), groups.indices.end(), 0);
+    std::vector<uint64_t> keys;
+    if (num_key_bits <= 64) {
+        keys.resize(num_points);
+        core::parallelFor(
+                int64_t(0), num_points,
+                [&](int64_t i) {
+                    const Eigen::Vector3i &v = voxel_indices[i];
+                    const auto x = uint64_t(int64_t(v(0)) - range.first(0));
+                    const auto y = uint64_t(int64_t(v(1)) - range.first(1));
+                    const auto z = uint64_t(int64_t(v(2)) - range.first(2));
+                    keys[i] = (x << (bits[1] + bits[2])) | (y << bits[2]) | z;
+                },
+                policy);
+        core::parallelRadixSortByKey(keys, groups.indices, num_key_bits,
+                                     policy);
+    } else {
+        // The index ranges are too wide for a single key.
+        core::parallelSort(
+                groups.indices.begin(), groups.indices.end(),
+                [&](int a, int b) {
+                    const Eigen::Vector3i &va = voxel_indices[a];
+                    const Eigen::Vector3i &vb = voxel_indices[b];
+                    return std::tie(va(0), va(1), va(2), a) <
+                           std::tie(vb(0), vb(1), vb(2), b);
+                },
+                policy);
     }
 
-    [[nodiscard]] Eigen::Vector3d GetAverageNormal() const {
-        // Call NormalizeNormals() afterwards if necessary
-        return normal_ / double(num_of_points_);
+    std::vector<uint8_t> is_voxel_begin(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                if (i == 0) {
+                    is_voxel_begin[i] = 1;
+                } else if (!keys.empty()) {
+                    is_voxel_begin[i] = keys[i] != keys[i - 1];
+                } else {
+                    is_voxel_begin[i] =
+                            voxel_indices[groups.indices[i]] !=
+                            voxel_indices[groups.indices[i - 1]];
+                }
+            },
+            policy);
+    for (int64_t i = 0; i < num_points; ++i) {
+        if (is_voxel_begin[i]) {
+            groups.offsets.push_back(i);
+        }
     }
+    groups.offsets.push_back(num_points);
+    return groups;
+}
 
-    [[nodiscard]] Eigen::Vector3d GetAverageColor() const {
-        return color_ / double(num_of_points_);
+/// Averages the attributes of the points of each voxel. With
+/// \p approximate_class the colors hold class labels, and the most frequent
+/// label of each voxel is kept instead, ties going to the smallest label.
+std::shared_ptr<PointCloud> ReduceVoxels(const PointCloud &cloud,
+                                         const VoxelGroups &groups,
+                                         bool approximate_class) {
+    auto output = std::make_shared<PointCloud>();
+    const auto num_voxels = static_cast<int64_t>(groups.offsets.size()) - 1;
+    const bool has_normals = cloud.HasNormals();
+    const bool has_colors = cloud.HasColors();
+    const bool has_covariances = cloud.HasCovariances();
+    output->points_.resize(num_voxels);
+    if (has_normals) {
+        output->normals_.resize(num_voxels);
     }
-
-    [[nodiscard]] Eigen::Matrix3d GetAverageCovariance() const {
-        return covariance_ / double(num_of_points_);
+    if (has_colors) {
+        output->colors_.resize(num_voxels);
     }
-
-public:
-    int num_of_points_ = 0;
-    Eigen::Vector3d point_ = Eigen::Vector3d::Zero();
-    Eigen::Vector3d normal_ = Eigen::Vector3d::Zero();
-    Eigen::Vector3d color_ = Eigen::Vector3d::Zero();
-    Eigen::Matrix3d covariance_ = Eigen::Matrix3d::Zero();
-};
-
-class point_cubic_id {
-public:
-    size_t point_id;
-    int cubic_id;
-};
-
-class AccumulatedPointForTrace : public AccumulatedPoint {
-public:
-    void AddPoint(const PointCloud &cloud,
-                  size_t index,
-                  int cubic_index,
-                  bool approximate_class) {
-        point_ += cloud.points_[index];
-        if (cloud.HasNormals()) {
-            if (!std::isnan(cloud.normals_[index](0)) &&
-                !std::isnan(cloud.normals_[index](1)) &&
-                !std::isnan(cloud.normals_[index](2))) {
-                normal_ += cloud.normals_[index];
-            }
-        }
-        if (cloud.HasColors()) {
-            if (approximate_class) {
-                auto got = classes.find(int(cloud.colors_[index][0]));
-                if (got == classes.end())
-                    classes[int(cloud.colors_[index][0])] = 1;
-                else
-                    classes[int(cloud.colors_[index][0])] += 1;
-            } else {
-                color_ += cloud.colors_[index];
-            }
-        }
-        if (cloud.HasCovariances()) {
-            covariance_ += cloud.covariances_[index];
-        }
-        point_cubic_id new_id{};
-        new_id.point_id = index;
-        new_id.cubic_id = cubic_index;
-        original_id.push_back(new_id);
-        num_of_points_++;
-    }
-
-    Eigen::Vector3d GetMaxClass() {
-        int max_class = -1;
-        int max_count = -1;
-        for (auto &classe : classes) {
-            if (classe.second > max_count) {
-                max_count = classe.second;
-                max_class = classe.first;
-            }
-        }
-        return Eigen::Vector3d(max_class, max_class, max_class);
+    if (has_covariances) {
+        output->covariances_.resize(num_voxels);
     }
-
-    std::vector<point_cubic_id> GetOriginalID() { return original_id; }
-
-private:
-    // original point cloud id in higher resolution + its cubic id
-    std::vector<point_cubic_id> original_id;
-    std::unordered_map<int, int> classes;
-};
+    core::parallelFor(
+            int64_t(0), num_voxels,
+            [&](int64_t v) {
+                const int *begin = groups.indices.data() + groups.offsets[v];
+                const int *end = groups.indices.data() + groups.offsets[v + 1];
+                const auto num_of_points = double(end - begin);
+
+                Eigen::Vector3d point = Eigen::Vector3d::Zero();
+                for (const int *i = begin; i != end; ++i) {
+                    point += cloud.points_[*i];
+                }
+                output->points_[v] = point / num_of_points;
+                if (has_normals) {
+                    // Call NormalizeNormals() afterwards if necessary
+                    Eigen::Vector3d normal = Eigen::Vector3d::Zero();
+                    for (const int *i = begin; i != end; ++i) {
+                        if (!cloud.normals_[*i].hasNaN()) {
+                            normal += cloud.normals_[*i];
+                        }
+                    }
+                    output->normals_[v] = normal / num_of_points;
+                }
+                if (has_colors && approximate_class) {
+                    thread_local std::vector<int> classes;
+                    classes.clear();
+                    for (const int *i = begin; i != end; ++i) {
+                        classes.push_back(int(cloud.colors_[*i](0)));
+                    }
+                    std::sort(classes.begin(), classes.end());
+                    int max_class = -1;
+                    size_t max_count = 0;
+                    for (size_t j = 0, k; j < classes.size(); j = k) {
+                        for (k = j + 1;
+                             k < classes.size() && classes[k] == classes[j];
+                             ++k) {
+                        }
+                        if (k - j > max_count) {
+                            max_count = k - j;
+                            max_class = classes[j];
+                        }
+                    }
+                    output->colors_[v] = Eigen::Vector3d::Constant(max_class);
+                } else if (has_colors) {
+                    Eigen::Vector3d color = Eigen::Vector3d::Zero();
+                    for (const int *i = begin; i != end; ++i) {
+                        color += cloud.colors_[*i];
+                    }
+                    output->colors_[v] = color / num_of_points;
+                }
+                if (has_covariances) {
+                    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+                    for (const int *i = begin; i != end; ++i) {
+                        covariance += cloud.covariances_[*i];
+                    }
+                    output->covariances_[v] = covariance / num_of_points;
+                }
+            },
+            core::executionPolicyFor(num_voxels));
+    return output;
+}
 }  // namespace
 
 std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
         double voxel_size) const {
-    auto output = std::make_shared<PointCloud>();
     if (voxel_size <= 0.0) {
         utility::LogError("voxel_size <= 0.");
     }
@@ -361,34 +720,9 @@ std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
         (voxel_max_bound - voxel_min_bound).maxCoeff()) {
         utility::LogError("voxel_size is too small.");
     }
-    std::unordered_map<Eigen::Vector3i, AccumulatedPoint,
-                       utility::hash_eigen<Eigen::Vector3i>>
-            voxelindex_to_accpoint;
-
-    Eigen::Vector3d ref_coord;
-    Eigen::Vector3i voxel_index;
-    for (int i = 0; i < (int)points_.size(); i++) {
-        ref_coord = (points_[i] - voxel_min_bound) / voxel_size;
-        voxel_index << int(floor(ref_coord(0))), int(floor(ref_coord(1))),
-                int(floor(ref_coord(2)));
-        voxelindex_to_accpoint[voxel_index].AddPoint(*this, i);
-    }
-    bool has_normals = HasNormals();
-    bool has_colors = HasColors();
-    bool has_covariances = HasCovariances();
-    for (const auto &accpoint : voxelindex_to_accpoint) {
-        output->points_.push_back(accpoint.second.GetAveragePoint());
-        if (has_normals) {
-            output->normals_.push_back(accpoint.second.GetAverageNormal());
-        }
-        if (has_colors) {
-            output->colors_.push_back(accpoint.second.GetAverageColor());
-        }
-        if (has_covariances) {
-            output->covariances_.emplace_back(
-                    accpoint.second.GetAverageCovariance());
-        }
-    }
+    const VoxelGroups groups =
+            GroupPointsByVoxel(points_, voxel_min_bound, voxel_size);
+    auto output = ReduceVoxels(*this, groups, false);
     utility::LogDebug(
             "Pointcloud down sampled from {:d} points to {:d} points.",
             (int)points_.size(), (int)output->points_.size());
@@ -397,13 +731,12 @@ std::shared_ptr<PointCloud> PointCloud::VoxelDownSample(
 
 std::tuple<std::shared_ptr<PointCloud>,
            Eigen::MatrixXi,
-           std::vector<std::vector<int>>>
-PointCloud::VoxelDownSampleAndTrace(double voxel_size,
-                                    const Eigen::Vector3d &min_bound,
-                                    const Eigen::Vector3d &max_bound,
-                                    bool approximate_class) const {
-    auto output = std::make_shared<PointCloud>();
-    Eigen::MatrixXi cubic_id;
+           std::vector<int64_t>,
+           std::vector<int>>
+PointCloud::VoxelDownSampleAndTraceCSR(double voxel_size,
+                                       const Eigen::Vector3d &min_bound,
+                                       const Eigen::Vector3d &max_bound,
+                                       bool approximate_class) const {
     if (voxel_size <= 0.0) {
         utility::LogError("voxel_size <= 0.");
     }
@@ -415,60 +748,59 @@ PointCloud::VoxelDownSampleAndTrace(double voxel_size,
         (voxel_max_bound - voxel_min_bound).maxCoeff()) {
         utility::LogError("voxel_size is too small.");
     }
-    std::unordered_map<Eigen::Vector3i, AccumulatedPointForTrace,
-                       utility::hash_eigen<Eigen::Vector3i>>
-            voxelindex_to_accpoint;
-    int cid_temp[3] = {1, 2, 4};
-    for (size_t i = 0; i < points_.size(); i++) {
-        auto ref_coord = (points_[i] - voxel_min_bound) / voxel_size;
-        auto voxel_index = Eigen::Vector3i(int(floor(ref_coord(0))),
-                                           int(floor(ref_coord(1))),
-                                           int(floor(ref_coord(2))));
-        int cid = 0;
-        for (int c = 0; c < 3; c++) {
-            if ((ref_coord(c) - voxel_index(c)) >= 0.5) {
-                cid += cid_temp[c];
-            }
-        }
-        voxelindex_to_accpoint[voxel_index].AddPoint(*this, i, cid,
-                                                     approximate_class);
-    }
-    bool has_normals = HasNormals();
-    bool has_colors = HasColors();
-    bool has_covariances = HasCovariances();
-    int cnt = 0;
-    cubic_id.resize(voxelindex_to_accpoint.size(), 8);
+    VoxelGroups groups =
+            GroupPointsByVoxel(points_, voxel_min_bound, voxel_size);
+    auto output = ReduceVoxels(*this, groups, approximate_class);
+
+    // Each point falls into one of the 8 octants of its voxel. If several
+    // points share an octant, the one with the largest index is recorded.
+    const auto num_voxels = static_cast<int64_t>(groups.offsets.size()) - 1;
+    Eigen::MatrixXi cubic_id(num_voxels, 8);
     cubic_id.setConstant(-1);
-    std::vector<std::vector<int>> original_indices(
-            voxelindex_to_accpoint.size());
-    for (auto accpoint : voxelindex_to_accpoint) {
-        output->points_.push_back(accpoint.second.GetAveragePoint());
-        if (has_normals) {
-            output->normals_.push_back(accpoint.second.GetAverageNormal());
-        }
-        if (has_colors) {
-            if (approximate_class) {
-                output->colors_.push_back(accpoint.second.GetMaxClass());
-            } else {
-                output->colors_.push_back(accpoint.second.GetAverageColor());
-            }
-        }
-        if (has_covariances) {
-            output->covariances_.emplace_back(
-                    accpoint.second.GetAverageCovariance());
-        }
-        auto original_id = accpoint.second.GetOriginalID();
-        for (auto &i : original_id) {
-            size_t pid = i.point_id;
-            int cid = i.cubic_id;
-            cubic_id(cnt, cid) = int(pid);
-            original_indices[cnt].push_back(int(pid));
-        }
-        cnt++;
-    }
+    const int cid_temp[3] = {1, 2, 4};
+    core::parallelFor(
+            int64_t(0), num_voxels,
+            [&](int64_t v) {
+                for (int64_t j = groups.offsets[v]; j < groups.offsets[v + 1];
+                     ++j) {
+                    const int pid = groups.indices[j];
+                    Eigen::Vector3d ref_coord =
+                            (points_[pid] - voxel_min_bound) / voxel_size;
+                    int cid = 0;
+                    for (int c = 0; c < 3; c++) {
+                        if ((ref_coord(c) - floor(ref_coord(c))) >= 0.5) {
+                            cid += cid_temp[c];
+                        }
+                    }
+                    cubic_id(v, cid) = pid;
+                }
+            },
+            core::executionPolicyFor(num_voxels));
     utility::LogDebug(
             "Pointcloud down sampled from {:d} points to {:d} points.",
             (int)points_.size(), (int)output->points_.size());
+    return std::make_tuple(output, std::move(cubic_id),
+                           std::move(groups.offsets),
+                           std::move(groups.indices));
+}
+
+std::tuple<std::shared_ptr<PointCloud>,
+           Eigen::MatrixXi,
+           std::vector<std::vector<int>>>
+PointCloud::VoxelDownSampleAndTrace(double voxel_size,
+                                    const Eigen::Vector3d &min_bound,
+                                    const Eigen::Vector3d &max_bound,
+                                    bool approximate_class) const {
+    auto [output, cubic_id, offsets, indices] = VoxelDownSampleAndTraceCSR(
+            voxel_size, min_bound, max_bound, approximate_class);
+    std::vector<std::vector<int>> original_indices(offsets.size() - 1);
+    core::parallelFor(
+            size_t(0), original_indices.size(),
+            [&](size_t v) {
+                original_indices[v].assign(indices.begin() + offsets[v],
+                                           indices.begin() + offsets[v + 1]);
+            },
+            core::executionPolicyFor(int64_t(original_indices.size())));
     return std::make_tuple(output, cubic_id, original_indices);
 }
 
@@ -503,35 +835,129 @@ std::shared_ptr<PointCloud> PointCloud::RandomDownSample(
 }
 
 std::shared_ptr<PointCloud> PointCloud::FarthestPointDownSample(
-        size_t num_samples) const {
+        size_t num_samples,
+        size_t start_index,
+        bool use_spatial_buckets) const {
     if (num_samples == 0) {
         return std::make_shared<PointCloud>();
-    } else if (num_samples == points_.size()) {
-        return std::make_shared<PointCloud>(*this);
     } else if (num_samples > points_.size()) {
         utility::LogError(
                 "Illegal number of samples: {}, must <= point size: {}",
                 num_samples, points_.size());
+    } else if (start_index >= points_.size()) {
+        utility::LogError("Illegal start index: {}, must < point size: {}",
+                          start_index, points_.size());
+    } else if (num_samples == points_.size()) {
+        return std::make_shared<PointCloud>(*this);
     }
-    // We can also keep track of the non-selected indices with unordered_set,
-    // but since typically num_samples << num_points, it may not be worth it.
-    std::vector<size_t> selected_indices;
-    selected_indices.reserve(num_samples);
+    // The points are processed in buckets of consecutive points, stored in
+    // structure-of-arrays layout. A bucket is skipped when its bounding box
+    // is at least as far from the new sample as its farthest point is from
+    // the previous samples, since none of its distances can decrease then.
+    // Buckets in index order are rarely skipped, so they are made larger to
+    // amortize the per-bucket work.
+    const size_t bucket_size = use_spatial_buckets ? 512 : 8192;
     const size_t num_points = points_.size();
+    const size_t num_buckets = (num_points + bucket_size - 1) / bucket_size;
+    std::vector<size_t> order;
+    if (use_spatial_buckets) {
+        order = ComputeSpaceFillingCurveOrder(points_);
+    } else {
+        order.resize(num_points);
+        std::iota(order.begin(), order.end(), size_t(0));
+    }
+    std::vector<double> xs(num_points), ys(num_points), zs(num_points);
+    std::vector<Eigen::Vector3d> bucket_min_bounds(num_buckets);
+    std::vector<Eigen::Vector3d> bucket_max_bounds(num_buckets);
+    core::parallelFor(
+            size_t(0), num_buckets,
+            [&](size_t b) {
+                const size_t begin = b * bucket_size;
+                const size_t end = std::min(begin + bucket_size, num_points);
+                Eigen::Vector3d min_bound = points_[order[begin]];
+                Eigen::Vector3d max_bound = min_bound;
+                for (size_t j = begin; j < end; j++) {
+                    const Eigen::Vector3d &point = points_[order[j]];
+                    xs[j] = point(0);
+                    ys[j] = point(1);
+                    zs[j] = point(2);
+                    min_bound = min_bound.cwiseMin(point);
+                    max_bound = max_bound.cwiseMax(point);
+                }
+                bucket_min_bounds[b] = min_bound;
+                bucket_max_bounds[b] = max_bound;
+            },
+            core::executionPolicyFor(int64_t(num_points)));
+
+    // Squared distance to the closest sample, and for each bucket the largest
+    // one and the point reaching it. Ties go to the smallest point index.
+    using Farthest = std::pair<double, size_t>;
+    auto farther = [](const Farthest &a, const Farthest &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
     std::vector<double> distances(num_points,
                                   std::numeric_limits<double>::infinity());
-    size_t farthest_index = 0;
+    std::vector<Farthest> bucket_farthest(
+            num_buckets,
+            Farthest(std::numeric_limits<double>::infinity(), 0));
+
+    auto update_bucket = [&](size_t b, const Eigen::Vector3d &s) {
+        const Eigen::Vector3d gap = (bucket_min_bounds[b] - s)
+                                            .cwiseMax(s - bucket_max_bounds[b])
+                                            .cwiseMax(0.0);
+        if (gap(0) * gap(0) + gap(1) * gap(1) + gap(2) * gap(2) >=
+            bucket_farthest[b].first) {
+            return;
+        }
+        const size_t begin = b * bucket_size;
+        const size_t end = std::min(begin + bucket_size, num_points);
+        // Local copies, the compiler cannot tell that s does not alias the
+        // distances.
+        const double sx = s(0), sy = s(1), sz = s(2);
+        double max_dist = -1;
+        size_t farthest_j = begin;
+        for (size_t j = begin; j < end; j++) {
+            const double dx = xs[j] - sx;
+            const double dy = ys[j] - sy;
+            const double dz = zs[j] - sz;
+            const double dist =
+                    std::min(distances[j], dx * dx + dy * dy + dz * dz);
+            distances[j] = dist;
+            if (dist > max_dist) {
+                max_dist = dist;
+                farthest_j = j;
+            } else if (dist == max_dist && order[j] < order[farthest_j]) {
+                farthest_j = j;
+            }
+        }
+        bucket_farthest[b] = Farthest(max_dist, order[farthest_j]);
+    };
+
+    std::vector<size_t> selected_indices;
+    selected_indices.reserve(num_samples);
+    size_t farthest_index = start_index;
     for (size_t i = 0; i < num_samples; i++) {
         selected_indices.push_back(farthest_index);
-        const Eigen::Vector3d &selected = points_[farthest_index];
-        double max_dist = 0;
-        for (size_t j = 0; j < num_points; j++) {
-            double dist = (points_[j] - selected).squaredNorm();
-            distances[j] = std::min(distances[j], dist);
-            if (distances[j] > max_dist) {
-                max_dist = distances[j];
-                farthest_index = j;
-            }
+        const Eigen::Vector3d selected = points_[farthest_index];
+        const Farthest farthest = core::parallelReduce(
+                size_t(0), num_buckets,
+                Farthest(0, std::numeric_limits<size_t>::max()),
+                [&](size_t begin, size_t end, Farthest result) {
+                    for (size_t b = begin; b < end; b++) {
+                        update_bucket(b, selected);
+                        if (farther(bucket_farthest[b], result)) {
+                            result = bucket_farthest[b];
+                        }
+                    }
+                    return result;
+                },
+                [&](const Farthest &a, const Farthest &b) {
+                    return farther(a, b) ? a : b;
+                },
+                core::executionPolicyFor(int64_t(num_points)));
+        // Keep the previous index when all points coincide with samples.
+        if (farthest.first > 0) {
+            farthest_index = farthest.second;
         }
     }
     return SelectByIndex(selected_indices);
@@ -559,25 +985,40 @@ std::shared_ptr<PointCloud> PointCloud::Crop(const OrientedBoundingBox &bbox,
 }
 
 std::tuple<std::shared_ptr<PointCloud>, std::vector<size_t>>
-PointCloud::RemoveRadiusOutliers(size_t nb_points,
-                                 double search_radius,
-                                 bool print_progress /* = false */) const {
+PointCloud::RemoveRadiusOutliers(
+        size_t nb_points,
+        double search_radius,
+        bool print_progress /* = false */,
+        NeighborSearchBackend backend) const {
     if (nb_points < 1 || search_radius <= 0) {
         utility::LogError(
                 "Illegal input parameters, the number of points and radius "
                 "must be positive.");
     }
     KDTreeFlann kdtree;
-    kdtree.SetGeometry(*this);
-    std::vector<bool> mask = std::vector<bool>(points_.size());
-
-    for (int i = 0; i < int(points_.size()); i++) {
-        std::vector<int> tmp_indices;
-        std::vector<double> dist;
-        size_t nb_neighbors = kdtree.SearchRadius(points_[i], search_radius,
-                                                  tmp_indices, dist);
-        mask[i] = (nb_neighbors > nb_points);
+    std::unique_ptr<HashGrid> grid;
+    if (backend == NeighborSearchBackend::HashGrid) {
+        grid = std::make_unique<HashGrid>(points_, search_radius);
+    } else {
+        kdtree.SetGeometry(*this);
     }
+    // Only whether a point has more than nb_points neighbors matters, so the
+    // searches count the neighbors and stop as soon as there are enough.
+    const int max_count = static_cast<int>(
+            std::min(nb_points, static_cast<size_t>(INT_MAX - 1)) + 1);
+    const auto num_points = static_cast<int64_t>(points_.size());
+    std::vector<uint8_t> mask(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                const int nb_neighbors =
+                        grid ? grid->CountRadius(points_[i], search_radius,
+                                                 max_count)
+                             : kdtree.CountRadius(points_[i], search_radius,
+                                                  max_count);
+                mask[i] = nb_neighbors == max_count;
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
     std::vector<size_t> indices;
     for (size_t i = 0; i < mask.size(); i++) {
         if (mask[i]) {
@@ -602,23 +1043,34 @@ PointCloud::RemoveStatisticalOutliers(size_t nb_neighbors,
     }
     KDTreeFlann kdtree;
     kdtree.SetGeometry(*this);
-    std::vector<double> avg_distances = std::vector<double>(points_.size());
+    const auto num_points = static_cast<int64_t>(points_.size());
+    std::vector<double> avg_distances(num_points);
     std::vector<size_t> indices;
-    size_t valid_distances = 0;
-
-    for (int i = 0; i < int(points_.size()); i++) {
-        std::vector<int> tmp_indices;
-        std::vector<double> dist;
-        kdtree.SearchKNN(points_[i], int(nb_neighbors), tmp_indices, dist);
-        double mean = -1.0;
-        if (!dist.empty()) {
-            valid_distances++;
-            std::for_each(dist.begin(), dist.end(),
-                          [](double &d) { d = std::sqrt(d); });
-            mean = std::accumulate(dist.begin(), dist.end(), 0.0) / dist.size();
-        }
-        avg_distances[i] = mean;
-    }
+    // The neighbor buffers are reused within a thread's range, and the mean
+    // distance is accumulated in place, so the searches do not allocate.
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> tmp_indices;
+                std::vector<double> dist;
+                for (int64_t i = begin; i < end; i++) {
+                    kdtree.SearchKNN(points_[i], int(nb_neighbors),
+                                     tmp_indices, dist);
+                    double mean = -1.0;
+                    if (!dist.empty()) {
+                        double sum = 0.0;
+                        for (double d2 : dist) {
+                            sum += std::sqrt(d2);
+                        }
+                        mean = sum / dist.size();
+                    }
+                    avg_distances[i] = mean;
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+    const auto valid_distances = static_cast<size_t>(
+            std::count_if(avg_distances.begin(), avg_distances.end(),
+                          [](double mean) { return mean >= 0; }));
     if (valid_distances == 0) {
         return std::make_tuple(std::make_shared<PointCloud>(),
                                std::vector<size_t>());
@@ -654,20 +1106,31 @@ std::vector<Eigen::Matrix3d> PointCloud::EstimatePerPointCovariances(
     KDTreeFlann kdtree;
     kdtree.SetGeometry(input);
 
-    for (int i = 0; i < (int)points.size(); i++) {
-        std::vector<int> indices;
-        std::vector<double> distance2;
-        if (kdtree.Search(points[i], search_param, indices, distance2) >= 3) {
-            auto covariance = utility::ComputeCovariance(points, indices);
-            if (input.HasCovariances() && covariance.isIdentity(1e-4)) {
-                covariances[i] = input.covariances_[i];
-            } else {
-                covariances[i] = covariance;
-            }
-        } else {
-            covariances[i] = Eigen::Matrix3d::Identity();
-        }
-    }
+    // Each point is independent, so the result does not depend on the number
+    // of threads. The neighbor buffers are reused within a thread's range.
+    const auto num_points = static_cast<int64_t>(points.size());
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> indices;
+                std::vector<double> distance2;
+                for (int64_t i = begin; i < end; i++) {
+                    if (kdtree.Search(points[i], search_param, indices,
+                                      distance2) >= 3) {
+                        auto covariance =
+                                utility::ComputeCovariance(points, indices);
+                        if (input.HasCovariances() &&
+                            covariance.isIdentity(1e-4)) {
+                            covariances[i] = input.covariances_[i];
+                        } else {
+                            covariances[i] = covariance;
+                        }
+                    } else {
+                        covariances[i] = Eigen::Matrix3d::Identity();
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
     return covariances;
 }
 void PointCloud::EstimateCovariances(
@@ -693,10 +1156,14 @@ std::vector<double> PointCloud::ComputeMahalanobisDistance() const {
     std::tie(mean, covariance) = ComputeMeanAndCovariance();
     Eigen::Matrix3d cov_inv = covariance.inverse();
 
-    for (int i = 0; i < (int)points_.size(); i++) {
-        Eigen::Vector3d p = points_[i] - mean;
-        mahalanobis[i] = std::sqrt(p.transpose() * cov_inv * p);
-    }
+    const auto num_points = static_cast<int64_t>(points_.size());
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                Eigen::Vector3d p = points_[i] - mean;
+                mahalanobis[i] = std::sqrt(p.transpose() * cov_inv * p);
+            },
+            core::executionPolicyFor(num_points));
     return mahalanobis;
 }
 
@@ -708,18 +1175,25 @@ std::vector<double> PointCloud::ComputeNearestNeighborDistance() const {
     std::vector<double> nn_dis(points_.size());
     KDTreeFlann kdtree(*this);
 
-    for (int i = 0; i < (int)points_.size(); i++) {
-        std::vector<int> indices(2);
-        std::vector<double> dists(2);
-        if (kdtree.SearchKNN(points_[i], 2, indices, dists) <= 1) {
-            utility::LogDebug(
-                    "[ComputePointCloudNearestNeighborDistance] Found a point "
-                    "without neighbors.");
-            nn_dis[i] = 0.0;
-        } else {
-            nn_dis[i] = std::sqrt(dists[1]);
-        }
-    }
+    // The neighbor buffers are reused within a thread's range.
+    const auto num_points = static_cast<int64_t>(points_.size());
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<int> indices;
+                std::vector<double> dists;
+                for (int64_t i = begin; i < end; i++) {
+                    if (kdtree.SearchKNN(points_[i], 2, indices, dists) <= 1) {
+                        utility::LogDebug(
+                                "[ComputePointCloudNearestNeighborDistance] "
+                                "Found a point without neighbors.");
+                        nn_dis[i] = 0.0;
+                    } else {
+                        nn_dis[i] = std::sqrt(dists[1]);
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
     return nn_dis;
 }
 
@@ -7,12 +7,15 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <limits>
 #include <memory>
 #include <tuple>
 #include <vector>
 
 #include "unified3d/geometry/Geometry3D.h"
+#include "unified3d/geometry/HashGrid.h"
 #include "unified3d/geometry/KDTreeSearchParam.h"
+#include "unified3d/geometry/SpaceFillingCurve.h"
 
 namespace u3d {
 
@@ -114,7 +117,31 @@ public:
     /// with the non-finite point such as normals, covariances and color
     /// entries. It doesn't re-computes these attributes after removing
     /// duplicated points.
-    PointCloud &RemoveDuplicatedPoints();
+    ///
+    /// Duplicates are found with a parallel sort, see FindDuplicatedPoints().
+    /// The first point of each group of duplicates is kept, with its
+    /// attributes, and the kept points stay in their original order.
+    ///
+    /// \param epsilon If positive, points in the same cell of a grid of this
+    /// cell size are duplicates.
+    PointCloud &RemoveDuplicatedPoints(double epsilon = 0.0);
+
+    /// \brief Removes duplicated points as RemoveDuplicatedPoints(), and
+    /// returns the index of the point that replaces each original point.
+    std::vector<size_t> RemoveDuplicatedPointsAndTrace(double epsilon = 0.0);
+
+    /// \brief Sorts the points along a space filling curve, so that points
+    /// close in space are close in memory. Normals, colors and covariances are
+    /// permuted along with the points.
+    ///
+    /// Neighbor searches and the algorithms built on them run faster on a
+    /// reordered point cloud thanks to better cache locality.
+    ///
+    /// \param curve The space filling curve to sort along.
+    /// \return The permutation: the i-th point after reordering was the
+    /// order[i]-th point before.
+    std::vector<size_t> SpatialReorder(
+            SpaceFillingCurve curve = SpaceFillingCurve::Hilbert);
 
     /// \brief Selects points from \p input pointcloud, with indices in \p
     /// indices, and returns a new point-cloud with selected points.
@@ -127,6 +154,9 @@ public:
     /// \brief Downsample input pointcloud with a voxel, and return a new
     /// point-cloud. Normals, covariances and colors are averaged if they exist.
     ///
+    /// The points are grouped by sorting their voxel keys in parallel, and the
+    /// output points are ordered by voxel index.
+    ///
     /// \param voxel_size Defines the resolution of the voxel grid,
     /// smaller value leads to denser output point cloud.
     [[nodiscard]] std::shared_ptr<PointCloud> VoxelDownSample(
@@ -148,6 +178,24 @@ public:
                             const Eigen::Vector3d &max_bound,
                             bool approximate_class = false) const;
 
+    /// \brief Same as VoxelDownSampleAndTrace(), but returns the original
+    /// indices in compressed sparse row layout.
+    ///
+    /// The original indices of the i-th output point are
+    /// `indices[offsets[i]]` to `indices[offsets[i + 1] - 1]`, in increasing
+    /// order. This avoids one allocation per voxel on large point clouds.
+    ///
+    /// \return The downsampled point cloud, the cubic ids, the offsets and the
+    /// indices.
+    [[nodiscard]] std::tuple<std::shared_ptr<PointCloud>,
+                             Eigen::MatrixXi,
+                             std::vector<int64_t>,
+                             std::vector<int>>
+    VoxelDownSampleAndTraceCSR(double voxel_size,
+                               const Eigen::Vector3d &min_bound,
+                               const Eigen::Vector3d &max_bound,
+                               bool approximate_class = false) const;
+
     /// \brief Function to downsample input pointcloud into output pointcloud
     /// uniformly.
     ///
@@ -176,9 +224,19 @@ public:
     /// The sample is performed by selecting the farthest point from previous
     /// selected points iteratively.
     ///
+    /// Each iteration updates the distances to the selected points and finds
+    /// the farthest point in a single parallel pass. Points are processed in
+    /// buckets, and buckets whose distances cannot decrease are skipped.
+    ///
     /// \param num_samples Number of points to be sampled.
+    /// \param start_index Index of the first selected point.
+    /// \param use_spatial_buckets Group the points into buckets along a
+    /// space filling curve instead of by index, so that far away buckets are
+    /// skipped more often. The result is the same.
     [[nodiscard]] std::shared_ptr<PointCloud> FarthestPointDownSample(
-            size_t num_samples) const;
+            size_t num_samples,
+            size_t start_index = 0,
+            bool use_spatial_buckets = false) const;
 
     /// \brief Function to crop pointcloud into output pointcloud
     ///
@@ -203,17 +261,25 @@ public:
     /// \brief Function to remove points that have less than \p nb_points in a
     /// sphere of a given radius.
     ///
+    /// Points are tested in parallel with counting searches that stop after
+    /// \p nb_points + 1 neighbors, the point itself included.
+    ///
     /// \param nb_points Number of points within the radius.
     /// \param search_radius Radius of the sphere.
     /// \param print_progress Whether to print the progress bar.
+    /// \param backend Spatial index used to find the points in the sphere.
     [[nodiscard]] std::tuple<std::shared_ptr<PointCloud>, std::vector<size_t>>
     RemoveRadiusOutliers(size_t nb_points,
                          double search_radius,
-                         bool print_progress = false) const;
+                         bool print_progress = false,
+                         NeighborSearchBackend backend =
+                                 NeighborSearchBackend::KDTree) const;
 
     /// \brief Function to remove points that are further away from their
     /// \p nb_neighbor neighbors in average.
     ///
+    /// The neighbor searches run in parallel.
+    ///
     /// \param nb_neighbors Number of neighbors around the target point.
     /// \param std_ratio Standard deviation ratio.
     [[nodiscard]] std::tuple<std::shared_ptr<PointCloud>, std::vector<size_t>>
@@ -262,9 +328,15 @@ public:
     /// \param lambda penalty constant on the distance of a point from the
     /// tangent plane \param cos_alpha_tol treshold that defines the amplitude
     /// of the cone spanned by the reference normal
+    /// \param use_knn_graph If true, the graph is made of the k nearest
+    /// neighbor edges only, without the Delaunay tetrahedralization, and its
+    /// minimum spanning forest is computed in parallel with Boruvka's
+    /// algorithm. Each connected component is then oriented independently
+    /// from its lowest point. This scales to much larger point clouds.
     void OrientNormalsConsistentTangentPlane(size_t k,
                                              double lambda = 0.0,
-                                             double cos_alpha_tol = 1.0);
+                                             double cos_alpha_tol = 1.0,
+                                             bool use_knn_graph = false);
 
     /// \brief Function to compute the point to point distances between point
     /// clouds.
@@ -275,6 +347,50 @@ public:
     /// \param target The target point cloud.
     std::vector<double> ComputePointCloudDistance(const PointCloud &target);
 
+    /// \brief Computes the symmetric Chamfer distance between point clouds.
+    ///
+    /// This is the mean distance from the points of this point cloud to
+    /// \p target, plus the mean distance from the points of \p target to this
+    /// point cloud. Both point clouds must have points.
+    ///
+    /// \param target The target point cloud.
+    /// \param max_distance The computation stops early and returns infinity
+    /// once the distance is known to exceed this bound.
+    [[nodiscard]] double ComputeChamferDistance(
+            const PointCloud &target,
+            double max_distance =
+                    std::numeric_limits<double>::infinity()) const;
+
+    /// \brief Computes the Hausdorff distance between point clouds.
+    ///
+    /// This is the largest distance from a point of either point cloud to the
+    /// other one. Points closer to the other point cloud than the largest
+    /// distance found so far are skipped after a search that stops at the
+    /// first neighbor. Both point clouds must have points.
+    ///
+    /// \param target The target point cloud.
+    /// \param max_distance The computation stops early and returns infinity
+    /// once a point at least this far from the other point cloud is found.
+    [[nodiscard]] double ComputeHausdorffDistance(
+            const PointCloud &target,
+            double max_distance =
+                    std::numeric_limits<double>::infinity()) const;
+
+    /// \brief Computes percentiles of the distances from the points of this
+    /// point cloud to \p target, with the nearest-rank method.
+    ///
+    /// \param target The target point cloud. Both point clouds must have
+    /// points.
+    /// \param percentiles Percentiles to compute, in [0, 100].
+    /// \param max_distance Distances of at least this bound are not computed,
+    /// and the percentiles that fall among them are infinity. The computation
+    /// stops early once all the requested percentiles do.
+    [[nodiscard]] std::vector<double> ComputeDistancePercentiles(
+            const PointCloud &target,
+            const std::vector<double> &percentiles,
+            double max_distance =
+                    std::numeric_limits<double>::infinity()) const;
+
     /// \brief Static function to compute the covariance matrix for each point
     /// of a point cloud. Doesn't change the input PointCloud, just outputs the
     /// covariance matrices.
@@ -339,12 +455,22 @@ public:
     /// Returns a list of point labels, -1 indicates noise according to
     /// the algorithm.
     ///
+    /// Neighbor searches and cluster merging run in parallel. Clusters are
+    /// numbered by their first core point, and border points join the
+    /// neighboring cluster with the smallest label, so the labels do not
+    /// depend on the number of threads.
+    ///
     /// \param eps Density parameter that is used to find neighbouring points.
     /// \param min_points Minimum number of points to form a cluster.
     /// \param print_progress If `true` the progress is visualized in the
     /// console.
+    /// \param backend Spatial index used to find the neighbors within \p eps.
     [[nodiscard]] std::vector<int> ClusterDBSCAN(
-            double eps, size_t min_points, bool print_progress = false) const;
+            double eps,
+            size_t min_points,
+            bool print_progress = false,
+            NeighborSearchBackend backend =
+                    NeighborSearchBackend::KDTree) const;
 
     /// \brief Segment PointCloud plane using the RANSAC algorithm.
     ///
@@ -354,18 +480,32 @@ public:
     /// each iteration.
     /// \param num_iterations Maximum number of iterations.
     /// \param probability Expected probability of finding the optimal plane.
+    /// \param preemptive_block_size If positive, score the hypotheses
+    /// preemptively: all of them are scored on a first block of this many
+    /// random points, the better half is kept and scored on the next block,
+    /// and so on until one is left. This bounds the cost to about
+    /// 2 * num_iterations * preemptive_block_size distance evaluations, and
+    /// \p probability is not used.
     /// \return Returns the plane model ax + by + cz + d = 0 and the indices of
     /// the plane inliers.
+    ///
+    /// Hypotheses are evaluated in parallel. Without preemption the result is
+    /// the same as with a serial evaluation.
     [[nodiscard]] std::tuple<Eigen::Vector4d, std::vector<size_t>> SegmentPlane(
             double distance_threshold = 0.01,
             int ransac_n = 3,
             int num_iterations = 100,
-            double probability = 0.99999999) const;
+            double probability = 0.99999999,
+            size_t preemptive_block_size = 0) const;
 
     /// \brief Robustly detect planar patches in the point cloud using.
     /// Araújo and Oliveira, “A robust statistics approach for plane
     /// detection in unorganized point clouds,” Pattern Recognition, 2020.
     ///
+    /// The octree subtrees are searched for planes in parallel, and the
+    /// detected planes grow concurrently, one neighbor layer at a time, with
+    /// contested points going to the least noisy plane.
+    ///
     /// \param normal_variance_threshold_deg Planes having point normals with
     /// high variance are rejected. The default value is 60 deg. Larger values
     /// would allow more noisy planes to be detected. \param coplanarity_deg The
@@ -390,6 +530,9 @@ public:
     /// vector. The extent in the z direction is non-zero so that the
     /// OrientedBoundingBox contains the points that contribute to the plane
     /// detection.
+    /// \param backend Spatial index used to find the point neighbors.
+    /// NeighborSearchBackend::HashGrid requires radius or hybrid
+    /// \p search_param.
     [[nodiscard]] std::vector<std::shared_ptr<OrientedBoundingBox>>
     DetectPlanarPatches(double normal_variance_threshold_deg = 60,
                         double coplanarity_deg = 75,
@@ -397,7 +540,9 @@ public:
                         double min_plane_edge_length = 0.0,
                         size_t min_num_points = 0,
                         const geometry::KDTreeSearchParam &search_param =
-                                geometry::KDTreeSearchParamKNN()) const;
+                                geometry::KDTreeSearchParamKNN(),
+                        NeighborSearchBackend backend =
+                                NeighborSearchBackend::KDTree) const;
 
     /// \brief Factory function to create a pointcloud from a depth image and a
     /// camera model.
@@ -5,85 +5,121 @@
 //  property of any third parties.
 
 #include <Eigen/Dense>
-#include <unordered_set>
+#include <mutex>
 
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/HashGrid.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/PointCloud.h"
+#include "unified3d/utility/ConcurrentDisjointSet.h"
 #include "unified3d/utility/Logging.h"
 #include "unified3d/utility/ProgressBar.h"
 
 namespace u3d::geometry {
 
-std::vector<int> PointCloud::ClusterDBSCAN(double eps,
-                                           size_t min_points,
-                                           bool print_progress) const {
-    KDTreeFlann kdtree(*this);
+std::vector<int> PointCloud::ClusterDBSCAN(
+        double eps,
+        size_t min_points,
+        bool print_progress,
+        NeighborSearchBackend backend) const {
+    KDTreeFlann kdtree;
+    std::unique_ptr<HashGrid> grid;
+    if (backend == NeighborSearchBackend::HashGrid) {
+        grid = std::make_unique<HashGrid>(points_, eps);
+    } else {
+        kdtree.SetGeometry(*this);
+    }
 
     // Precompute all neighbors.
     utility::LogDebug("Precompute neighbors.");
     utility::ProgressBar progress_bar(points_.size(), "Precompute neighbors.",
                                       print_progress);
-    std::vector<std::vector<int>> nbs(points_.size());
-
-    for (int idx = 0; idx < int(points_.size()); ++idx) {
-        std::vector<double> dists2;
-        kdtree.SearchRadius(points_[idx], eps, nbs[idx], dists2);
-
-        { ++progress_bar; }
-    }
+    std::mutex progress_mutex;
+    const int num_points = int(points_.size());
+    std::vector<std::vector<int>> nbs(num_points);
+    core::parallelRangeFor(
+            0, num_points,
+            [&](int begin, int end) {
+                std::vector<double> dists2;
+                for (int idx = begin; idx < end; ++idx) {
+                    if (grid) {
+                        grid->SearchRadius(points_[idx], eps, nbs[idx],
+                                           dists2);
+                    } else {
+                        kdtree.SearchRadius(points_[idx], eps, nbs[idx],
+                                            dists2);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                progress_bar.SetCurrentCount(progress_bar.GetCurrentCount() +
+                                             (end - begin));
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
     utility::LogDebug("Done Precompute neighbors.");
 
-    // Set all labels to undefined (-2).
+    // Merge core points that are neighbors. The representative of a cluster
+    // is its smallest core point, independently of the thread schedule.
     utility::LogDebug("Compute Clusters");
     progress_bar.Reset(points_.size(), "Clustering", print_progress);
-    std::vector<int> labels(points_.size(), -2);
+    std::vector<uint8_t> is_core(num_points);
+    core::parallelFor(
+            0, num_points,
+            [&](int idx) { is_core[idx] = nbs[idx].size() >= min_points; },
+            core::executionPolicyFor(num_points));
+    utility::ConcurrentDisjointSet disjoint_set(num_points);
+    core::parallelFor(
+            0, num_points,
+            [&](int idx) {
+                if (!is_core[idx]) {
+                    return;
+                }
+                for (int nb : nbs[idx]) {
+                    if (nb > idx && is_core[nb]) {
+                        disjoint_set.Union(idx, nb);
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+
+    // Number the clusters by their smallest core point. This gives the same
+    // labels as growing the clusters one at a time in index order.
+    std::vector<int> roots(num_points, -1);
+    core::parallelFor(
+            0, num_points,
+            [&](int idx) {
+                if (is_core[idx]) {
+                    roots[idx] = disjoint_set.Find(idx);
+                }
+            },
+            core::executionPolicyFor(num_points));
+    std::vector<int> root_labels(num_points, -1);
     int cluster_label = 0;
-    for (size_t idx = 0; idx < points_.size(); ++idx) {
-        // Label is not undefined.
-        if (labels[idx] != -2) {
-            continue;
+    for (int idx = 0; idx < num_points; ++idx) {
+        if (roots[idx] == idx) {
+            root_labels[idx] = cluster_label++;
         }
+    }
 
-        // Check density.
-        if (nbs[idx].size() < min_points) {
-            labels[idx] = -1;
-            continue;
-        }
-
-        std::unordered_set<int> nbs_next(nbs[idx].begin(), nbs[idx].end());
-        std::unordered_set<int> nbs_visited;
-        nbs_visited.insert(int(idx));
-
-        labels[idx] = cluster_label;
-        ++progress_bar;
-        while (!nbs_next.empty()) {
-            int nb = *nbs_next.begin();
-            nbs_next.erase(nbs_next.begin());
-            nbs_visited.insert(nb);
-
-            // Noise label.
-            if (labels[nb] == -1) {
-                labels[nb] = cluster_label;
-                ++progress_bar;
-            }
-            // Not undefined label.
-            if (labels[nb] != -2) {
-                continue;
-            }
-            labels[nb] = cluster_label;
-            ++progress_bar;
-
-            if (nbs[nb].size() >= min_points) {
-                for (int qnb : nbs[nb]) {
-                    if (nbs_visited.count(qnb) == 0) {
-                        nbs_next.insert(qnb);
+    // Core points take the label of their cluster. Border points join the
+    // neighboring cluster with the smallest label, the others are noise (-1).
+    std::vector<int> labels(num_points, -1);
+    core::parallelFor(
+            0, num_points,
+            [&](int idx) {
+                if (is_core[idx]) {
+                    labels[idx] = root_labels[roots[idx]];
+                    return;
+                }
+                for (int nb : nbs[idx]) {
+                    if (is_core[nb] &&
+                        (labels[idx] == -1 ||
+                         root_labels[roots[nb]] < labels[idx])) {
+                        labels[idx] = root_labels[roots[nb]];
                     }
                 }
-            }
-        }
-
-        cluster_label++;
-    }
+            },
+            core::executionPolicyFor(num_points));
+    progress_bar.SetCurrentCount(points_.size());
 
     utility::LogDebug("Done Compute Clusters: {:d}", cluster_label);
     return labels;
@@ -0,0 +1,353 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/PointCloudLOD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/SpaceFillingCurve.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::geometry {
+
+namespace {
+
+/// Returns values[order[0]], values[order[1]], ... Empty vectors, i.e.
+/// absent attributes, stay empty.
+template <typename T>
+std::vector<T> Gather(const std::vector<T> &values,
+                      const std::vector<size_t> &order,
+                      size_t count) {
+    if (values.empty()) {
+        return {};
+    }
+    const auto n = static_cast<int64_t>(count);
+    std::vector<T> gathered(n);
+    core::parallelFor(
+            int64_t(0), n, [&](int64_t i) { gathered[i] = values[order[i]]; },
+            core::executionPolicyFor(n));
+    return gathered;
+}
+
+/// Returns the first \p count values. Empty vectors stay empty.
+template <typename T>
+std::vector<T> Prefix(const std::vector<T> &values, size_t count) {
+    if (values.empty()) {
+        return {};
+    }
+    return std::vector<T>(values.begin(), values.begin() + count);
+}
+
+}  // unnamed namespace
+
+PointCloudLOD::PointCloudLOD(const PointCloud &cloud, int max_depth)
+    : depth_(max_depth) {
+    if (max_depth < 0 || max_depth > kSpaceFillingCurveBits) {
+        utility::LogError(
+                "[PointCloudLOD] max_depth must be in [0, {}], but got {}.",
+                kSpaceFillingCurveBits, max_depth);
+    }
+    const auto num_points = static_cast<int64_t>(cloud.points_.size());
+    const auto policy = core::executionPolicyFor(num_points);
+    if (num_points > 0) {
+        const AxisAlignedBoundingBox bbox =
+                AxisAlignedBoundingBox::CreateFromPoints(cloud.points_);
+        origin_ = bbox.GetMinBound();
+        if (bbox.GetMaxExtent() > 0) {
+            size_ = bbox.GetMaxExtent();
+        }
+    }
+
+    // Finest cell of each point and its Morton code.
+    const int max_cell = (1 << depth_) - 1;
+    const double scale = std::ldexp(1.0, depth_) / size_;
+    std::vector<Eigen::Vector3i> cells(num_points);
+    std::vector<uint64_t> codes(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                const Eigen::Vector3d p = (cloud.points_[i] - origin_) * scale;
+                cells[i] = Eigen::Vector3i(std::clamp(int(p(0)), 0, max_cell),
+                                           std::clamp(int(p(1)), 0, max_cell),
+                                           std::clamp(int(p(2)), 0, max_cell));
+                codes[i] = ComputeMortonCode(cells[i]);
+            },
+            policy);
+    std::vector<size_t> order(num_points);
+    std::iota(order.begin(), order.end(), size_t(0));
+    core::parallelRadixSortByKey(codes, order, 3 * depth_, policy);
+
+    // First position of each finest cell in Morton order. The cells of the
+    // coarser levels start at a subset of these positions.
+    std::vector<uint8_t> mask(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                mask[i] = i == 0 || codes[i] != codes[i - 1];
+            },
+            policy);
+    std::vector<int64_t> fine_starts;
+    for (int64_t i = 0; i < num_points; ++i) {
+        if (mask[i]) {
+            fine_starts.push_back(i);
+        }
+    }
+    const auto num_fine_cells = static_cast<int64_t>(fine_starts.size());
+
+    // Level at which each point, in Morton order, enters the hierarchy. The
+    // points never picked belong to the last level.
+    const auto last_level = static_cast<uint8_t>(depth_ + 1);
+    std::vector<uint8_t> levels(num_points, last_level);
+    std::vector<int64_t> starts;
+    for (int level = 0; level <= depth_; ++level) {
+        const int shift = 3 * (depth_ - level);
+        mask.resize(num_fine_cells);
+        core::parallelFor(
+                int64_t(0), num_fine_cells,
+                [&](int64_t j) {
+                    mask[j] = j == 0 ||
+                              codes[fine_starts[j]] >> shift !=
+                                      codes[fine_starts[j - 1]] >> shift;
+                },
+                core::executionPolicyFor(num_fine_cells));
+        starts.clear();
+        for (int64_t j = 0; j < num_fine_cells; ++j) {
+            if (mask[j]) {
+                starts.push_back(fine_starts[j]);
+            }
+        }
+
+        const auto num_cells = static_cast<int64_t>(starts.size());
+        const double cell_size = GetLevelSpacing(level);
+        core::parallelFor(
+                int64_t(0), num_cells,
+                [&](int64_t c) {
+                    const int64_t begin = starts[c];
+                    const int64_t end =
+                            c + 1 < num_cells ? starts[c + 1] : num_points;
+                    // Cells holding a point of a coarser level are covered.
+                    for (int64_t i = begin; i < end; ++i) {
+                        if (levels[i] < level) {
+                            return;
+                        }
+                    }
+                    const Eigen::Vector3i &fine_cell = cells[order[begin]];
+                    const Eigen::Vector3d center =
+                            origin_ +
+                            (Eigen::Vector3d(fine_cell(0) >> (depth_ - level),
+                                             fine_cell(1) >> (depth_ - level),
+                                             fine_cell(2) >> (depth_ - level)) +
+                             Eigen::Vector3d::Constant(0.5)) *
+                                    cell_size;
+                    int64_t best = begin;
+                    double best_distance2 =
+                            std::numeric_limits<double>::infinity();
+                    for (int64_t i = begin; i < end; ++i) {
+                        const double distance2 =
+                                (cloud.points_[order[i]] - center)
+                                        .squaredNorm();
+                        if (distance2 < best_distance2) {
+                            best_distance2 = distance2;
+                            best = i;
+                        }
+                    }
+                    levels[best] = static_cast<uint8_t>(level);
+                },
+                core::executionPolicyFor(num_cells, core::kHeavyGrainSize));
+    }
+
+    // Store the points level by level, keeping the Morton order within each
+    // level.
+    std::vector<size_t> positions(num_points);
+    std::iota(positions.begin(), positions.end(), size_t(0));
+    core::parallelSort(
+            positions.begin(), positions.end(),
+            [&](size_t a, size_t b) {
+                return levels[a] != levels[b] ? levels[a] < levels[b] : a < b;
+            },
+            policy);
+    level_offsets_.resize(NumLevels() + 1);
+    for (int level = 0; level <= NumLevels(); ++level) {
+        level_offsets_[level] = static_cast<size_t>(
+                std::partition_point(positions.begin(), positions.end(),
+                                     [&](size_t i) {
+                                         return levels[i] < level;
+                                     }) -
+                positions.begin());
+    }
+
+    indices_ = Gather(order, positions, num_points);
+    codes_ = Gather(codes, positions, num_points);
+    cloud_.points_ = Gather(cloud.points_, indices_, num_points);
+    if (cloud.HasNormals()) {
+        cloud_.normals_ = Gather(cloud.normals_, indices_, num_points);
+    }
+    if (cloud.HasColors()) {
+        cloud_.colors_ = Gather(cloud.colors_, indices_, num_points);
+    }
+    if (cloud.HasCovariances()) {
+        cloud_.covariances_ = Gather(cloud.covariances_, indices_, num_points);
+    }
+}
+
+size_t PointCloudLOD::NumPointsUpToLevel(int level) const {
+    CheckLevel(level);
+    return level_offsets_[level + 1];
+}
+
+double PointCloudLOD::GetLevelSpacing(int level) const {
+    CheckLevel(level);
+    return level > depth_ ? 0.0 : std::ldexp(size_, -level);
+}
+
+double PointCloudLOD::GetLevelError(int level) const {
+    return std::sqrt(3.0) * GetLevelSpacing(level);
+}
+
+int PointCloudLOD::GetLevelForError(double max_error) const {
+    for (int level = 0; level <= depth_; ++level) {
+        if (GetLevelError(level) <= max_error) {
+            return level;
+        }
+    }
+    return depth_ + 1;
+}
+
+int PointCloudLOD::GetLevelForSpacing(double spacing) const {
+    return GetLevelForError(std::sqrt(3.0) * spacing);
+}
+
+std::shared_ptr<PointCloud> PointCloudLOD::GetPointCloud(int level) const {
+    const size_t count = NumPointsUpToLevel(level);
+    auto output = std::make_shared<PointCloud>();
+    output->points_ = Prefix(cloud_.points_, count);
+    output->normals_ = Prefix(cloud_.normals_, count);
+    output->colors_ = Prefix(cloud_.colors_, count);
+    output->covariances_ = Prefix(cloud_.covariances_, count);
+    return output;
+}
+
+std::vector<size_t> PointCloudLOD::Query(const AxisAlignedBoundingBox &bbox,
+                                         int level) const {
+    std::vector<size_t> positions = QueryPositions(bbox, level);
+    for (size_t &position : positions) {
+        position = indices_[position];
+    }
+    return positions;
+}
+
+std::shared_ptr<PointCloud> PointCloudLOD::Crop(
+        const AxisAlignedBoundingBox &bbox, int level) const {
+    const std::vector<size_t> positions = QueryPositions(bbox, level);
+    auto output = std::make_shared<PointCloud>();
+    output->points_ = Gather(cloud_.points_, positions, positions.size());
+    output->normals_ = Gather(cloud_.normals_, positions, positions.size());
+    output->colors_ = Gather(cloud_.colors_, positions, positions.size());
+    output->covariances_ =
+            Gather(cloud_.covariances_, positions, positions.size());
+    return output;
+}
+
+std::vector<size_t> PointCloudLOD::QueryPositions(
+        const AxisAlignedBoundingBox &bbox, int level) const {
+    CheckLevel(level);
+    // Levels are searched independently and concatenated in order, so the
+    // positions come out sorted.
+    std::vector<std::vector<size_t>> found(level + 1);
+    core::parallelFor(
+            0, level + 1,
+            [&](int l) {
+                SearchCell(bbox, Eigen::Vector3i::Zero(), 0,
+                           std::min(l, depth_), level_offsets_[l],
+                           level_offsets_[l + 1], found[l]);
+            },
+            core::executionPolicyFor(
+                    static_cast<int64_t>(level_offsets_[level + 1])));
+
+    std::vector<size_t> positions;
+    for (const auto &level_positions : found) {
+        positions.insert(positions.end(), level_positions.begin(),
+                         level_positions.end());
+    }
+    return positions;
+}
+
+void PointCloudLOD::SearchCell(const AxisAlignedBoundingBox &bbox,
+                               const Eigen::Vector3i &cell,
+                               int depth,
+                               int max_depth,
+                               size_t begin,
+                               size_t end,
+                               std::vector<size_t> &positions) const {
+    if (begin == end) {
+        return;
+    }
+    // Points are binned with a rounding error, so the cell is grown by a
+    // tolerance before being compared with the box.
+    const double tolerance =
+            1e-9 * (size_ + origin_.cwiseAbs().maxCoeff());
+    const double cell_size = std::ldexp(size_, -depth);
+    const Eigen::Vector3d min_bound = origin_ + cell.cast<double>() * cell_size;
+    const Eigen::Vector3d max_bound =
+            min_bound + Eigen::Vector3d::Constant(cell_size);
+    const Eigen::Vector3d &box_min = bbox.min_bound_;
+    const Eigen::Vector3d &box_max = bbox.max_bound_;
+    if ((max_bound.array() + tolerance < box_min.array()).any() ||
+        (min_bound.array() - tolerance > box_max.array()).any()) {
+        return;
+    }
+    if ((min_bound.array() - tolerance >= box_min.array()).all() &&
+        (max_bound.array() + tolerance <= box_max.array()).all()) {
+        for (size_t i = begin; i < end; ++i) {
+            positions.push_back(i);
+        }
+        return;
+    }
+    if (depth == max_depth) {
+        for (size_t i = begin; i < end; ++i) {
+            const Eigen::Vector3d &p = cloud_.points_[i];
+            if ((p.array() >= box_min.array()).all() &&
+                (p.array() <= box_max.array()).all()) {
+                positions.push_back(i);
+            }
+        }
+        return;
+    }
+
+    // Children in Morton order, each covering a contiguous range of codes.
+    const int shift = depth_ - depth - 1;
+    for (int c = 0; c < 8; ++c) {
+        const Eigen::Vector3i child =
+                2 * cell + Eigen::Vector3i((c >> 2) & 1, (c >> 1) & 1, c & 1);
+        const uint64_t code_begin = ComputeMortonCode(child * (1 << shift));
+        const uint64_t code_end = code_begin + (uint64_t(1) << (3 * shift));
+        const auto child_begin = static_cast<size_t>(
+                std::lower_bound(codes_.begin() + begin, codes_.begin() + end,
+                                 code_begin) -
+                codes_.begin());
+        const auto child_end = static_cast<size_t>(
+                std::lower_bound(codes_.begin() + child_begin,
+                                 codes_.begin() + end, code_end) -
+                codes_.begin());
+        SearchCell(bbox, child, depth + 1, max_depth, child_begin, child_end,
+                   positions);
+    }
+}
+
+void PointCloudLOD::CheckLevel(int level) const {
+    if (level < 0 || level >= NumLevels()) {
+        utility::LogError(
+                "[PointCloudLOD] level must be in [0, {}), but got {}.",
+                NumLevels(), level);
+    }
+}
+
+}  // namespace u3d::geometry
@@ -0,0 +1,116 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "unified3d/geometry/PointCloud.h"
+
+namespace u3d::geometry {
+
+class AxisAlignedBoundingBox;
+
+/// \class PointCloudLOD
+///
+/// \brief Multi-resolution level-of-detail hierarchy over a point cloud.
+///
+/// The bounding cube of the cloud is divided into nested voxel grids, level
+/// l having 2^l cells per axis. Each level adds one representative point, the
+/// closest to the cell center, to every occupied cell that does not contain
+/// a point of a coarser level yet. Levels 0 to l together thus hold exactly
+/// one point per occupied cell of level l, and every point of the cloud lies
+/// within one level-l cell diagonal of them. The points left over after the
+/// finest grid form a last level, so that all levels together are the full
+/// cloud.
+///
+/// Points are stored level by level, in Morton order within a level, so the
+/// points up to a level are a prefix of the storage and a coarse version of
+/// the cloud comes without any search. Box queries descend the octree of
+/// each level and only visit the cells overlapping the box. The hierarchy is
+/// built in parallel.
+class PointCloudLOD {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param cloud Point cloud to build the hierarchy from. Its points,
+    /// normals, colors and covariances are copied.
+    /// \param max_depth Level of the finest voxel grid, at most 21.
+    explicit PointCloudLOD(const PointCloud &cloud, int max_depth = 12);
+
+public:
+    /// Returns the number of levels, i.e. max_depth + 2.
+    [[nodiscard]] int NumLevels() const { return depth_ + 2; }
+    /// Returns the number of points of the levels up to \p level.
+    [[nodiscard]] size_t NumPointsUpToLevel(int level) const;
+    /// Returns the edge length of the cells of \p level, 0 for the last one.
+    [[nodiscard]] double GetLevelSpacing(int level) const;
+    /// Returns the largest distance from a point of the cloud to the points
+    /// of the levels up to \p level, i.e. the diagonal of its cells.
+    [[nodiscard]] double GetLevelError(int level) const;
+
+    /// \brief Returns the coarsest level whose error is at most
+    /// \p max_error.
+    [[nodiscard]] int GetLevelForError(double max_error) const;
+    /// \brief Returns the coarsest level whose spacing is at most
+    /// \p spacing, e.g. the size of a pixel for rendering.
+    [[nodiscard]] int GetLevelForSpacing(double spacing) const;
+
+    /// \brief Returns the original indices of the points in level order.
+    ///
+    /// The first NumPointsUpToLevel(l) entries are the points of levels 0 to
+    /// l, so a cloud can be refined progressively by reading further.
+    [[nodiscard]] const std::vector<size_t> &GetIndices() const {
+        return indices_;
+    }
+
+    /// \brief Returns the points of the levels up to \p level.
+    [[nodiscard]] std::shared_ptr<PointCloud> GetPointCloud(int level) const;
+
+    /// \brief Returns the original indices of the points of the levels up to
+    /// \p level that lie within \p bbox, bounds included.
+    [[nodiscard]] std::vector<size_t> Query(const AxisAlignedBoundingBox &bbox,
+                                            int level) const;
+
+    /// \brief Returns the points of the levels up to \p level that lie
+    /// within \p bbox, bounds included.
+    [[nodiscard]] std::shared_ptr<PointCloud> Crop(
+            const AxisAlignedBoundingBox &bbox, int level) const;
+
+private:
+    /// Returns the storage positions of the points found by Query().
+    [[nodiscard]] std::vector<size_t> QueryPositions(
+            const AxisAlignedBoundingBox &bbox, int level) const;
+    /// Collects the points of one level in the storage range [begin, end)
+    /// that lie in \p bbox, descending from the cell \p cell of \p depth.
+    void SearchCell(const AxisAlignedBoundingBox &bbox,
+                    const Eigen::Vector3i &cell,
+                    int depth,
+                    int max_depth,
+                    size_t begin,
+                    size_t end,
+                    std::vector<size_t> &positions) const;
+    void CheckLevel(int level) const;
+
+private:
+    int depth_;
+    Eigen::Vector3d origin_ = Eigen::Vector3d::Zero();
+    double size_ = 1.0;
+    /// Points in level order.
+    PointCloud cloud_;
+    /// Original index of each point of cloud_.
+    std::vector<size_t> indices_;
+    /// Morton code of the finest cell of each point of cloud_.
+    std::vector<uint64_t> codes_;
+    /// The points of level l are cloud_ entries level_offsets_[l] to
+    /// level_offsets_[l + 1] - 1.
+    std::vector<size_t> level_offsets_;
+};
+
+}  // namespace u3d::geometry
@@ -6,17 +6,19 @@
 
 #include <Eigen/Dense>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <numeric>
-#include <queue>
-#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 #include "libqhullcpp/PointCoordinates.h"
 #include "libqhullcpp/Qhull.h"
 #include "libqhullcpp/QhullVertex.h"
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/HashGrid.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/KDTreeSearchParam.h"
 #include "unified3d/geometry/PointCloud.h"
@@ -190,10 +192,10 @@ private:
 
 /// \brief Calculate the median of a buffer of data
 ///
-/// \param buffer Container of scalar data to find median of. A copy is made
-/// so that buffer may be sorted.
+/// \param buffer Container of scalar data to find median of. It is partially
+/// sorted in place.
 /// \return Median of buffer data.
-double GetMedian(std::vector<double> buffer) {
+double GetMedian(std::vector<double>& buffer) {
     const size_t N = buffer.size();
     std::nth_element(buffer.begin(), buffer.begin() + N / 2,
                      buffer.begin() + N);
@@ -202,29 +204,27 @@ double GetMedian(std::vector<double> buffer) {
 
 /// \brief Calculate the Median Absolute Deviation statistic
 ///
-/// \param buffer Container of scalar data to find MAD of.
+/// \param buffer Container of scalar data to find MAD of. It is overwritten
+/// with the absolute deviations.
 /// \param median Precomputed median of buffer.
 /// \return MAD = median(| X_i - median(X) |)
-double GetMAD(const std::vector<double>& buffer, double median) {
-    const size_t N = buffer.size();
-    std::vector<double> shifted(N);
-    for (size_t i = 0; i < N; i++) {
-        shifted[i] = std::abs(buffer[i] - median);
+double GetMAD(std::vector<double>& buffer, double median) {
+    for (double& x : buffer) {
+        x = std::abs(x - median);
     }
-    std::nth_element(shifted.begin(), shifted.begin() + N / 2,
-                     shifted.begin() + N);
     static constexpr double k = 1.4826;  // assumes normally distributed data
-    return k * shifted[N / 2];
+    return k * GetMedian(buffer);
 }
 
 /// \brief Calculate spread of data as interval around median
 ///
 /// I = [min, max] = [median(X) - α·MAD, median(X) + α·MAD]
 ///
-/// \param buffer Container of scalar data to find spread of.
+/// \param buffer Container of scalar data to find spread of. Its content is
+/// overwritten.
 /// \param min Alpha MADs below median.
 /// \param max Alpha MADs above median.
-void GetMinMaxRScore(const std::vector<double>& buffer,
+void GetMinMaxRScore(std::vector<double>& buffer,
                      double& min,
                      double& max,
                      double alpha) {
@@ -572,19 +572,22 @@ private:
     bool RobustPlanarityTest() {
         // Calculate statistics to robustly test planarity.
         const size_t N = indices_.size();
-        // Stores point-to-plane distance of each associated point.
+        // Similarity of estimated plane normal to point normal.
+        auto normal_similarity = [&](size_t idx) {
+            return std::abs(patch_->normal_.dot(point_cloud_->normals_[idx]));
+        };
+        // Distance from estimated plane to point.
+        auto point_distance = [&](size_t idx) {
+            return std::abs(patch_->normal_.dot(point_cloud_->points_[idx]) +
+                            patch_->dist_from_origin_);
+        };
+        // The buffers are reordered by the statistics, so the outlier test
+        // below evaluates the scores again.
         std::vector<double> point_distances(N, 0);
-        // Stores dot product (similarity) of each point normal to plane normal.
         std::vector<double> normal_similarities(N, 0);
         for (size_t i = 0; i < N; i++) {
-            const Eigen::Vector3d& normal = point_cloud_->normals_[indices_[i]];
-            const Eigen::Vector3d& position =
-                    point_cloud_->points_[indices_[i]];
-            // similarity of estimated plane normal to point normal
-            normal_similarities[i] = std::abs(patch_->normal_.dot(normal));
-            // distance from estimated plane to point
-            point_distances[i] = std::abs(patch_->normal_.dot(position) +
-                                          patch_->dist_from_origin_);
+            normal_similarities[i] = normal_similarity(indices_[i]);
+            point_distances[i] = point_distance(indices_[i]);
         }
 
         double tmp;
@@ -603,23 +606,18 @@ private:
         if (!IsDistanceValid()) return false;
 
         // Detect outliers, fail if too many
-        std::unordered_map<size_t, bool> outliers;
-        outliers.reserve(N);
-        size_t num_outliers = 0;
-        for (size_t i = 0; i < N; i++) {
-            const bool is_outlier = normal_similarities[i] < min_normal_diff_ ||
-                                    point_distances[i] > max_point_dist_;
-            outliers[indices_[i]] = is_outlier;
-            num_outliers += static_cast<int>(is_outlier);
-        }
+        auto is_outlier = [&](size_t idx) {
+            return normal_similarity(idx) < min_normal_diff_ ||
+                   point_distance(idx) > max_point_dist_;
+        };
+        const auto num_outliers = static_cast<size_t>(
+                std::count_if(indices_.begin(), indices_.end(), is_outlier));
         if (num_outliers > N * outlier_ratio_thr_) return false;
 
         // Remove outliers
         if (num_outliers > 0) {
             indices_.erase(std::remove_if(indices_.begin(), indices_.end(),
-                                          [&outliers](const size_t& idx) {
-                                              return outliers[idx];
-                                          }),
+                                          is_outlier),
                            indices_.end());
         }
 
@@ -756,49 +754,176 @@ bool SplitAndDetectPlanesRecursive(
     return node_has_plane || child_has_plane;
 }
 
+/// \brief Partition the top of the octree and collect the subtrees in which
+/// planes are searched.
+///
+/// Planes are only detected below level 2, so the subtrees rooted at level 3
+/// are independent of each other and may be split concurrently. They are
+/// collected in the order SplitAndDetectPlanesRecursive() visits them.
+///
+/// \param node  BVH/Octree node to partition
+/// \param min_num_points  Minimum number of points allowable in a node
+/// \param subtrees  Roots of the subtrees to search for planes
+void CollectPlaneSubtrees(const BoundaryVolumeHierarchyPtr& node,
+                          size_t min_num_points,
+                          std::vector<BoundaryVolumeHierarchyPtr>& subtrees) {
+    if (node->indices_.size() < min_num_points) return;
+    if (node->level_ > 2) {
+        subtrees.push_back(node);
+        return;
+    }
+
+    node->Partition();
+    for (const auto& child : node->children_) {
+        if (child != nullptr) {
+            CollectPlaneSubtrees(child, min_num_points, subtrees);
+        }
+    }
+}
+
+/// \brief Partition point cloud in parallel to find potential planes
+///
+/// Produces the same planes, in the same order, as a call to
+/// SplitAndDetectPlanesRecursive() on the root. Each subtree writes its
+/// planes to its own list and the lists are concatenated in order, while
+/// the points, and thus the entries of plane_points, of two subtrees are
+/// disjoint.
+void SplitAndDetectPlanes(const BoundaryVolumeHierarchyPtr& root,
+                          size_t min_num_points,
+                          double normal_similarity,
+                          double coplanarity,
+                          double outlier_ratio,
+                          double plane_edge_length,
+                          std::vector<PlaneDetectorPtr>& planes,
+                          std::vector<PlaneDetectorPtr>& plane_points) {
+    std::vector<BoundaryVolumeHierarchyPtr> subtrees;
+    CollectPlaneSubtrees(root, min_num_points, subtrees);
+
+    const auto num_subtrees = static_cast<int64_t>(subtrees.size());
+    std::vector<std::vector<PlaneDetectorPtr>> subtree_planes(num_subtrees);
+    core::parallelFor(
+            int64_t(0), num_subtrees,
+            [&](int64_t i) {
+                SplitAndDetectPlanesRecursive(
+                        subtrees[i], min_num_points, normal_similarity,
+                        coplanarity, outlier_ratio, plane_edge_length,
+                        subtree_planes[i], plane_points);
+            },
+            core::executionPolicyFor(
+                    static_cast<int64_t>(root->indices_.size()),
+                    core::kHeavyGrainSize));
+
+    for (auto& subtree : subtree_planes) {
+        planes.insert(planes.end(), subtree.begin(), subtree.end());
+    }
+}
+
 /// \brief Using unused neighboring points, consider if planes can be expanded.
 ///
+/// All unstable planes grow at once, one breadth-first layer per round, each
+/// from its own frontier. When several planes reach the same unclaimed point
+/// in a round, the least noisy one claims it, so the result does not depend
+/// on the number of threads.
+///
 /// \param planes  Collection of planes to consider
 /// \param plane_points  Vector indicating if a given point cloud point is
 /// claimed \param neighbors  Neighboring points of each point cloud point
 void Grow(std::vector<PlaneDetectorPtr>& planes,
           std::vector<PlaneDetectorPtr>& plane_points,
           const std::vector<std::vector<int>>& neighbors) {
-    // Sort so that least noisy planes grow first
+    // Sort so that least noisy planes take precedence
     std::sort(planes.begin(), planes.end(),
               [](const PlaneDetectorPtr& a, const PlaneDetectorPtr& b) {
                   return a->min_normal_diff_ > b->min_normal_diff_;
               });
 
-    std::queue<size_t> queue;
-    for (auto&& plane : planes) {
-        if (plane->stable_) continue;
-
-        // Consider each neighbor of each point associated with this plane
-        for (const size_t& idx : plane->indices_) {
-            queue.push(idx);
-        }
+    const auto num_planes = static_cast<int64_t>(planes.size());
+    const auto num_points = static_cast<int64_t>(plane_points.size());
+
+    // Rank of the least noisy plane proposing each point in the current
+    // round, num_planes if none.
+    std::unique_ptr<std::atomic<int64_t>[]> claims(
+            new std::atomic<int64_t>[num_points]);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                claims[i].store(num_planes, std::memory_order_relaxed);
+            },
+            core::executionPolicyFor(num_points));
+
+    // Consider each neighbor of each point associated with an unstable plane
+    std::vector<std::vector<size_t>> frontiers(num_planes);
+    std::vector<std::vector<size_t>> candidates(num_planes);
+    size_t frontier_size = 0;
+    for (int64_t p = 0; p < num_planes; ++p) {
+        if (planes[p]->stable_) continue;
+        frontiers[p] = planes[p]->indices_;
+        frontier_size += frontiers[p].size();
+    }
 
-        while (!queue.empty()) {
-            const size_t idx = queue.front();
-            queue.pop();
-            for (const int& nbr : neighbors[idx]) {
-                // Skip if this neighboring point has been claimed, or,
-                // if this plane has already visited.
-                if (plane_points[nbr] != nullptr || plane->HasVisited(nbr))
-                    continue;
-                if (plane->IsInlier(nbr)) {
-                    // Add this point to the plane and claim ownership
-                    plane->AddPoint(nbr);
-                    plane_points[nbr] = plane;
-                    // Since the nbr point has been added to the plane,
-                    // be sure to consider *its* neighbors, too.
-                    queue.push(nbr);
-                } else {
-                    // Nothing to be done with this neighbor point
-                    plane->MarkVisited(nbr);
-                }
+    while (frontier_size > 0) {
+        const core::ExecutionPolicy policy = core::executionPolicyFor(
+                static_cast<int64_t>(frontier_size), core::kHeavyGrainSize);
+
+        // Collect the inlier neighbors of the frontier and propose them.
+        core::parallelFor(
+                int64_t(0), num_planes,
+                [&](int64_t p) {
+                    PlaneDetector& plane = *planes[p];
+                    std::vector<size_t>& candidate = candidates[p];
+                    candidate.clear();
+                    for (const size_t& idx : frontiers[p]) {
+                        for (const int& nbr : neighbors[idx]) {
+                            // Skip if this neighboring point has been
+                            // claimed, or, if this plane has already visited.
+                            if (plane_points[nbr] != nullptr ||
+                                plane.HasVisited(nbr))
+                                continue;
+                            if (plane.IsInlier(nbr)) {
+                                candidate.push_back(nbr);
+                            } else {
+                                // Nothing to be done with this neighbor point
+                                plane.MarkVisited(nbr);
+                            }
+                        }
+                    }
+                    std::sort(candidate.begin(), candidate.end());
+                    candidate.erase(
+                            std::unique(candidate.begin(), candidate.end()),
+                            candidate.end());
+                    for (const size_t& idx : candidate) {
+                        int64_t claim =
+                                claims[idx].load(std::memory_order_relaxed);
+                        while (p < claim &&
+                               !claims[idx].compare_exchange_weak(
+                                       claim, p, std::memory_order_relaxed)) {
+                        }
+                    }
+                },
+                policy);
+
+        // Add the points won by each plane and claim ownership. Since they
+        // have been added, their neighbors are considered next round.
+        core::parallelFor(
+                int64_t(0), num_planes,
+                [&](int64_t p) {
+                    frontiers[p].clear();
+                    for (const size_t& idx : candidates[p]) {
+                        if (claims[idx].load(std::memory_order_relaxed) == p) {
+                            planes[p]->AddPoint(idx);
+                            plane_points[idx] = planes[p];
+                            frontiers[p].push_back(idx);
+                        }
+                    }
+                },
+                policy);
+
+        frontier_size = 0;
+        for (int64_t p = 0; p < num_planes; ++p) {
+            for (const size_t& idx : candidates[p]) {
+                claims[idx].store(num_planes, std::memory_order_relaxed);
             }
+            frontier_size += frontiers[p].size();
         }
     }
 }
@@ -819,17 +944,24 @@ void Merge(std::vector<PlaneDetectorPtr>& planes,
     }
 
     std::vector<bool> graph(n * n, false);
-    std::vector<bool> disconnected_planes(n * n, false);
-    for (size_t i = 0; i < n; i++) {
-        for (size_t j = i + 1; j < n; j++) {
-            const Eigen::Vector3d& ni = planes[i]->patch_->normal_;
-            const Eigen::Vector3d& nj = planes[j]->patch_->normal_;
-            const double normal_thr = std::min(planes[i]->min_normal_diff_,
-                                               planes[j]->min_normal_diff_);
-            disconnected_planes[i * n + j] = std::abs(ni.dot(nj)) < normal_thr;
-            disconnected_planes[j * n + i] = disconnected_planes[i * n + j];
-        }
-    }
+    // Bytes rather than bits so that rows can be filled concurrently.
+    std::vector<uint8_t> disconnected_planes(n * n, 0);
+    core::parallelFor(
+            size_t(0), n,
+            [&](size_t i) {
+                const Eigen::Vector3d& ni = planes[i]->patch_->normal_;
+                for (size_t j = 0; j < n; j++) {
+                    if (j == i) continue;
+                    const Eigen::Vector3d& nj = planes[j]->patch_->normal_;
+                    const double normal_thr =
+                            std::min(planes[i]->min_normal_diff_,
+                                     planes[j]->min_normal_diff_);
+                    disconnected_planes[i * n + j] =
+                            std::abs(ni.dot(nj)) < normal_thr;
+                }
+            },
+            core::executionPolicyFor(static_cast<int64_t>(n),
+                                     core::kHeavyGrainSize));
 
     for (auto&& plane : planes) {
         const size_t i = plane->index_;
@@ -910,19 +1042,25 @@ void Merge(std::vector<PlaneDetectorPtr>& planes,
 
 /// \brief Determines if planes are stable, if not then cause them to update.
 bool Update(std::vector<PlaneDetectorPtr>& planes) {
-    bool changed = false;
-    for (auto&& plane : planes) {
-        const bool more_than_half_points_are_new =
-                3 * plane->num_new_points_ > plane->indices_.size();
-        if (more_than_half_points_are_new) {
-            plane->Update();
-            plane->stable_ = false;
-            changed = true;
-        } else {
-            plane->stable_ = true;
-        }
-    }
-    return changed;
+    const auto num_planes = static_cast<int64_t>(planes.size());
+    std::vector<uint8_t> changed(num_planes, 0);
+    core::parallelFor(
+            int64_t(0), num_planes,
+            [&](int64_t i) {
+                PlaneDetector& plane = *planes[i];
+                const bool more_than_half_points_are_new =
+                        3 * plane.num_new_points_ > plane.indices_.size();
+                if (more_than_half_points_are_new) {
+                    plane.Update();
+                    plane.stable_ = false;
+                    changed[i] = 1;
+                } else {
+                    plane.stable_ = true;
+                }
+            },
+            core::executionPolicyFor(num_planes, core::kHeavyGrainSize));
+    return std::any_of(changed.begin(), changed.end(),
+                       [](uint8_t c) { return c != 0; });
 }
 
 /// \brief Finds the bounds of each plane and forms planar patches.
@@ -939,11 +1077,22 @@ void ExtractPatchesFromPlanes(
             Eigen::Vector3d(0.3010, 0.7450, 0.9330),
             Eigen::Vector3d(0.6350, 0.0780, 0.1840)};
 
-    for (size_t i = 0; i < planes.size(); i++) {
-        if (!planes[i]->IsFalsePositive()) {
-            // create a patch by delimiting the plane using its perimeter points
-            auto obox = planes[i]->DelimitPlane();
-            obox->color_ = colors[i % NUM_COLORS];
+    const auto num_planes = static_cast<int64_t>(planes.size());
+    std::vector<std::shared_ptr<OrientedBoundingBox>> boxes(num_planes);
+    core::parallelFor(
+            int64_t(0), num_planes,
+            [&](int64_t i) {
+                if (!planes[i]->IsFalsePositive()) {
+                    // create a patch by delimiting the plane using its
+                    // perimeter points
+                    boxes[i] = planes[i]->DelimitPlane();
+                    boxes[i]->color_ = colors[i % NUM_COLORS];
+                }
+            },
+            core::executionPolicyFor(num_planes, core::kHeavyGrainSize));
+
+    for (auto& obox : boxes) {
+        if (obox != nullptr) {
             patches.push_back(obox);
         }
     }
@@ -958,7 +1107,8 @@ PointCloud::DetectPlanarPatches(
         double outlier_ratio,
         double min_plane_edge_length,
         size_t min_num_points,
-        const geometry::KDTreeSearchParam& search_param) const {
+        const geometry::KDTreeSearchParam& search_param,
+        NeighborSearchBackend backend) const {
     if (!HasNormals()) {
         utility::LogError(
                 "DetectPlanarPatches requires pre-computed normal vectors.");
@@ -978,15 +1128,41 @@ PointCloud::DetectPlanarPatches(
 
     // identify the neighbors of each point in point cloud
     geometry::KDTreeFlann kdtree;
-    kdtree.SetGeometry(*this);
-    std::vector<std::vector<int>> neighbors;
-    neighbors.resize(points_.size());
-
-    for (int i = 0; i < static_cast<int>(points_.size()); i++) {
-        std::vector<int> indices;
-        std::vector<double> distance2;
-        kdtree.Search(points_[i], search_param, neighbors[i], distance2);
+    std::unique_ptr<HashGrid> grid;
+    if (backend == NeighborSearchBackend::HashGrid) {
+        double radius = 0.0;
+        if (search_param.GetSearchType() ==
+            KDTreeSearchParam::SearchType::Radius) {
+            radius = ((const KDTreeSearchParamRadius&)search_param).radius_;
+        } else if (search_param.GetSearchType() ==
+                   KDTreeSearchParam::SearchType::Hybrid) {
+            radius = ((const KDTreeSearchParamHybrid&)search_param).radius_;
+        } else {
+            utility::LogError(
+                    "DetectPlanarPatches with the HashGrid backend requires a "
+                    "radius or hybrid search_param.");
+        }
+        grid = std::make_unique<HashGrid>(points_, radius);
+    } else {
+        kdtree.SetGeometry(*this);
     }
+    const auto num_points = static_cast<int64_t>(points_.size());
+    std::vector<std::vector<int>> neighbors(num_points);
+    core::parallelRangeFor(
+            int64_t(0), num_points,
+            [&](int64_t begin, int64_t end) {
+                std::vector<double> distance2;
+                for (int64_t i = begin; i < end; ++i) {
+                    if (grid) {
+                        grid->Search(points_[i], search_param, neighbors[i],
+                                     distance2);
+                    } else {
+                        kdtree.Search(points_[i], search_param, neighbors[i],
+                                      distance2);
+                    }
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
 
     const double normal_similarity_rad = normal_similarity_deg * M_PI / 180.0;
     const double coplanarity_rad = coplanarity_deg * M_PI / 180.0;
@@ -996,10 +1172,9 @@ PointCloud::DetectPlanarPatches(
             this, min_bound, max_bound);
     std::vector<PlaneDetectorPtr> planes;
     std::vector<PlaneDetectorPtr> plane_points(points_.size(), nullptr);
-    SplitAndDetectPlanesRecursive(root, min_num_points,
-                                  std::cos(normal_similarity_rad),
-                                  std::cos(coplanarity_rad), outlier_ratio,
-                                  min_plane_edge_length, planes, plane_points);
+    SplitAndDetectPlanes(root, min_num_points, std::cos(normal_similarity_rad),
+                         std::cos(coplanarity_rad), outlier_ratio,
+                         min_plane_edge_length, planes, plane_points);
 
     // iteratively grow and merge planes until each is stable
     bool changed;
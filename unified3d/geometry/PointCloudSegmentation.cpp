@@ -11,6 +11,7 @@
 #include <numeric>
 #include <unordered_set>
 
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/PointCloud.h"
 #include "unified3d/geometry/TriangleMesh.h"
 #include "unified3d/utility/Logging.h"
@@ -63,36 +64,73 @@ public:
     double inlier_rmse_;
 };
 
-// Calculates the number of inliers given a list of points and a plane model,
-// and the total squared point-to-plane distance.
-// These numbers are then used to evaluate how well the plane model fits the
-// given points.
-RANSACResult EvaluateRANSACBasedOnDistance(
-        const std::vector<Eigen::Vector3d> &points,
-        const Eigen::Vector4d &plane_model,
-        std::vector<size_t> &inliers,
-        double distance_threshold) {
-    RANSACResult result;
+/// Point coordinates in structure-of-arrays layout, so that the plane
+/// distances of many points are evaluated by vectorized loops.
+struct PointsSoA {
+    PointsSoA(const std::vector<Eigen::Vector3d> &points,
+              const std::vector<size_t> &order)
+        : x_(order.size()), y_(order.size()), z_(order.size()) {
+        const auto n = int64_t(order.size());
+        core::parallelFor(
+                int64_t(0), n,
+                [&](int64_t i) {
+                    x_[i] = points[order[i]](0);
+                    y_[i] = points[order[i]](1);
+                    z_[i] = points[order[i]](2);
+                },
+                core::executionPolicyFor(n));
+    }
 
-    double error = 0;
-    for (size_t idx = 0; idx < points.size(); ++idx) {
-        Eigen::Vector4d point(points[idx](0), points[idx](1), points[idx](2),
-                              1);
-        double distance = std::abs(plane_model.dot(point));
+    std::vector<double> x_, y_, z_;
+};
 
-        if (distance < distance_threshold) {
-            error += distance * distance;
-            inliers.emplace_back(idx);
+// Calculates the number of inliers among the points [begin, end) given a
+// plane model, and the total squared point-to-plane distance.
+// These numbers are then used to evaluate how well the plane model fits the
+// given points.
+RANSACResult EvaluateRANSACBasedOnDistance(const PointsSoA &points,
+                                           size_t begin,
+                                           size_t end,
+                                           const Eigen::Vector4d &plane_model,
+                                           double distance_threshold) {
+    // Independent accumulators per lane let the compiler vectorize the loop
+    // without reordering floating point sums.
+    constexpr size_t kLanes = 4;
+    const double a = plane_model(0), b = plane_model(1), c = plane_model(2),
+                 d = plane_model(3);
+    const double *x = points.x_.data();
+    const double *y = points.y_.data();
+    const double *z = points.z_.data();
+    double inlier_num[kLanes] = {0, 0, 0, 0};
+    double error[kLanes] = {0, 0, 0, 0};
+    size_t idx = begin;
+    for (; idx + kLanes <= end; idx += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            const double distance = std::abs(a * x[idx + l] + b * y[idx + l] +
+                                             c * z[idx + l] + d);
+            const double inlier = distance < distance_threshold ? 1.0 : 0.0;
+            inlier_num[l] += inlier;
+            error[l] += inlier * distance * distance;
         }
     }
+    for (; idx < end; ++idx) {
+        const double distance =
+                std::abs(a * x[idx] + b * y[idx] + c * z[idx] + d);
+        const double inlier = distance < distance_threshold ? 1.0 : 0.0;
+        inlier_num[0] += inlier;
+        error[0] += inlier * distance * distance;
+    }
 
-    size_t inlier_num = inliers.size();
-    if (inlier_num == 0) {
+    RANSACResult result;
+    const double total_inlier_num =
+            (inlier_num[0] + inlier_num[1]) + (inlier_num[2] + inlier_num[3]);
+    const double total_error = (error[0] + error[1]) + (error[2] + error[3]);
+    if (total_inlier_num == 0) {
         result.fitness_ = 0;
         result.inlier_rmse_ = 0;
     } else {
-        result.fitness_ = (double)inlier_num / (double)points.size();
-        result.inlier_rmse_ = std::sqrt(error / (double)inlier_num);
+        result.fitness_ = total_inlier_num / double(end - begin);
+        result.inlier_rmse_ = std::sqrt(total_error / total_inlier_num);
     }
     return result;
 }
@@ -149,7 +187,8 @@ std::tuple<Eigen::Vector4d, std::vector<size_t>> PointCloud::SegmentPlane(
         const double distance_threshold /* = 0.01 */,
         const int ransac_n /* = 3 */,
         const int num_iterations /* = 100 */,
-        const double probability /* = 0.99999999 */) const {
+        const double probability /* = 0.99999999 */,
+        const size_t preemptive_block_size /* = 0 */) const {
     if (probability <= 0 || probability > 1) {
         utility::LogError("Probability must be > 0 and <= 1.0");
     }
@@ -160,13 +199,6 @@ std::tuple<Eigen::Vector4d, std::vector<size_t>> PointCloud::SegmentPlane(
     Eigen::Vector4d best_plane_model = Eigen::Vector4d(0, 0, 0, 0);
 
     size_t num_points = points_.size();
-    RandomSampler<size_t> sampler(num_points);
-    // Pre-generate all random samples before entering the parallel region
-    std::vector<std::vector<size_t>> all_sampled_indices;
-    all_sampled_indices.reserve(num_iterations);
-    for (int i = 0; i < num_iterations; i++) {
-        all_sampled_indices.push_back(sampler(ransac_n));
-    }
 
     // Return if ransac_n is less than the required plane model parameters.
     if (ransac_n < 3) {
@@ -181,65 +213,173 @@ std::tuple<Eigen::Vector4d, std::vector<size_t>> PointCloud::SegmentPlane(
                                std::vector<size_t>{});
     }
 
-    // Use size_t here to avoid large integer which acceed max of int.
-    size_t break_iteration = std::numeric_limits<size_t>::max();
-    int iteration_count = 0;
-
-    for (int itr = 0; itr < num_iterations; itr++) {
-        if ((size_t)iteration_count > break_iteration) {
-            continue;
-        }
-
-        // Access the pre-generated sampled indices
-        std::vector<size_t> inliers = all_sampled_indices[itr];
+    RandomSampler<size_t> sampler(num_points);
+    // Pre-generate all random samples before entering the parallel region
+    std::vector<std::vector<size_t>> all_sampled_indices;
+    all_sampled_indices.reserve(num_iterations);
+    for (int i = 0; i < num_iterations; i++) {
+        all_sampled_indices.push_back(sampler(ransac_n));
+    }
 
-        // Fit model to num_model_parameters randomly selected points among the
-        // inliers.
-        Eigen::Vector4d plane_model;
+    // Fit model to num_model_parameters randomly selected points among the
+    // inliers.
+    auto fit_plane_model = [&](int itr) {
+        const std::vector<size_t> &inliers = all_sampled_indices[itr];
         if (ransac_n == 3) {
-            plane_model = TriangleMesh::ComputeTrianglePlane(
-                    points_[inliers[0]], points_[inliers[1]],
-                    points_[inliers[2]]);
-        } else {
-            plane_model = GetPlaneFromPoints(points_, inliers);
+            return TriangleMesh::ComputeTrianglePlane(points_[inliers[0]],
+                                                      points_[inliers[1]],
+                                                      points_[inliers[2]]);
         }
+        return GetPlaneFromPoints(points_, inliers);
+    };
+
+    // In preemptive mode the points are visited in random order, so that each
+    // block is a random subset.
+    std::vector<size_t> order(num_points);
+    std::iota(order.begin(), order.end(), size_t(0));
+    if (preemptive_block_size > 0) {
+        std::lock_guard<std::mutex> lock(*utility::random::GetMutex());
+        std::shuffle(order.begin(), order.end(),
+                     *utility::random::GetEngine());
+    }
+    const PointsSoA points(points_, order);
 
-        if (plane_model.isZero(0)) {
-            continue;
+    int iteration_count = 0;
+    if (preemptive_block_size > 0) {
+        // Score all hypotheses on a first block of points, keep the better
+        // half and score it on the next block, and so on until one is left.
+        // See Nister, "Preemptive RANSAC for live structure and motion
+        // estimation", ICCV 2003.
+        std::vector<Eigen::Vector4d> models(num_iterations);
+        core::parallelFor(
+                0, num_iterations,
+                [&](int itr) { models[itr] = fit_plane_model(itr); },
+                core::executionPolicyFor(num_iterations));
+        std::vector<int> survivors;
+        for (int itr = 0; itr < num_iterations; itr++) {
+            if (!models[itr].isZero(0)) {
+                survivors.push_back(itr);
+            }
         }
-
-        inliers.clear();
-        auto this_result = EvaluateRANSACBasedOnDistance(
-                points_, plane_model, inliers, distance_threshold);
-        {
-            if (this_result.fitness_ > result.fitness_ ||
-                (this_result.fitness_ == result.fitness_ &&
-                 this_result.inlier_rmse_ < result.inlier_rmse_)) {
-                result = this_result;
-                best_plane_model = plane_model;
-                if (result.fitness_ < 1.0) {
-                    break_iteration = std::min(
-                            log(1 - probability) /
-                                    log(1 - pow(result.fitness_, ransac_n)),
-                            (double)num_iterations);
-                } else {
-                    // Set break_iteration to 0 to force to break the loop.
-                    break_iteration = 0;
+        iteration_count = int(survivors.size());
+
+        // Inlier count and squared error of each hypothesis so far.
+        std::vector<std::pair<double, double>> scores(num_iterations);
+        size_t num_scored = 0;
+        while (!survivors.empty() && num_scored < num_points) {
+            const size_t begin = num_scored;
+            const size_t end =
+                    std::min(num_points, begin + preemptive_block_size);
+            core::parallelFor(
+                    size_t(0), survivors.size(),
+                    [&](size_t i) {
+                        const int itr = survivors[i];
+                        auto block_result = EvaluateRANSACBasedOnDistance(
+                                points, begin, end, models[itr],
+                                distance_threshold);
+                        const double inlier_num =
+                                block_result.fitness_ * double(end - begin);
+                        scores[itr].first += inlier_num;
+                        scores[itr].second += inlier_num *
+                                              block_result.inlier_rmse_ *
+                                              block_result.inlier_rmse_;
+                    },
+                    core::executionPolicyFor(
+                            int64_t(survivors.size() * (end - begin))));
+            num_scored = end;
+            std::stable_sort(survivors.begin(), survivors.end(),
+                             [&](int a, int b) {
+                                 return scores[a].first > scores[b].first ||
+                                        (scores[a].first == scores[b].first &&
+                                         scores[a].second < scores[b].second);
+                             });
+            if (survivors.size() == 1) {
+                break;
+            }
+            survivors.resize((survivors.size() + 1) / 2);
+        }
+        if (!survivors.empty()) {
+            const auto &score = scores[survivors[0]];
+            best_plane_model = models[survivors[0]];
+            result.fitness_ = score.first / double(num_scored);
+            result.inlier_rmse_ =
+                    score.first > 0 ? std::sqrt(score.second / score.first)
+                                    : 0;
+        }
+    } else {
+        // Hypotheses are evaluated in parallel in batches, then merged in
+        // iteration order. This gives the same result as evaluating them one
+        // by one, the adaptive stopping criterion included.
+        constexpr int kBatchSize = 16;
+        std::vector<Eigen::Vector4d> models(kBatchSize);
+        std::vector<RANSACResult> results(kBatchSize);
+        // Use size_t here to avoid large integer which acceed max of int.
+        size_t break_iteration = std::numeric_limits<size_t>::max();
+        for (int batch_begin = 0; batch_begin < num_iterations &&
+                                  (size_t)iteration_count <= break_iteration;
+             batch_begin += kBatchSize) {
+            const int batch_end =
+                    std::min(batch_begin + kBatchSize, num_iterations);
+            core::parallelFor(
+                    batch_begin, batch_end,
+                    [&](int itr) {
+                        Eigen::Vector4d &plane_model =
+                                models[itr - batch_begin];
+                        plane_model = fit_plane_model(itr);
+                        if (!plane_model.isZero(0)) {
+                            results[itr - batch_begin] =
+                                    EvaluateRANSACBasedOnDistance(
+                                            points, 0, num_points, plane_model,
+                                            distance_threshold);
+                        }
+                    },
+                    core::executionPolicyFor(int64_t(num_points) *
+                                             (batch_end - batch_begin)));
+
+            for (int itr = batch_begin; itr < batch_end; itr++) {
+                if ((size_t)iteration_count > break_iteration) {
+                    break;
+                }
+                const Eigen::Vector4d &plane_model = models[itr - batch_begin];
+                if (plane_model.isZero(0)) {
+                    continue;
                 }
+                const RANSACResult &this_result = results[itr - batch_begin];
+                if (this_result.fitness_ > result.fitness_ ||
+                    (this_result.fitness_ == result.fitness_ &&
+                     this_result.inlier_rmse_ < result.inlier_rmse_)) {
+                    result = this_result;
+                    best_plane_model = plane_model;
+                    if (result.fitness_ < 1.0) {
+                        break_iteration = std::min(
+                                log(1 - probability) /
+                                        log(1 - pow(result.fitness_, ransac_n)),
+                                (double)num_iterations);
+                    } else {
+                        // Set break_iteration to 0 to force to break the loop.
+                        break_iteration = 0;
+                    }
+                }
+                iteration_count++;
             }
-            iteration_count++;
         }
     }
 
     // Find the final inliers using best_plane_model.
     std::vector<size_t> final_inliers;
     if (!best_plane_model.isZero(0)) {
-        for (size_t idx = 0; idx < points_.size(); ++idx) {
-            Eigen::Vector4d point(points_[idx](0), points_[idx](1),
-                                  points_[idx](2), 1);
-            double distance = std::abs(best_plane_model.dot(point));
-
-            if (distance < distance_threshold) {
+        std::vector<uint8_t> is_inlier(num_points);
+        core::parallelFor(
+                size_t(0), num_points,
+                [&](size_t idx) {
+                    Eigen::Vector4d point(points_[idx](0), points_[idx](1),
+                                          points_[idx](2), 1);
+                    is_inlier[idx] = std::abs(best_plane_model.dot(point)) <
+                                     distance_threshold;
+                },
+                core::executionPolicyFor(int64_t(num_points)));
+        for (size_t idx = 0; idx < num_points; ++idx) {
+            if (is_inlier[idx]) {
                 final_inliers.emplace_back(idx);
             }
         }
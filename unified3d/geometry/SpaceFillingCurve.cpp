@@ -0,0 +1,104 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/SpaceFillingCurve.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/BoundingVolume.h"
+
+namespace u3d::geometry {
+
+namespace {
+/// Spreads the low 21 bits of \p v so that there are two zero bits between
+/// consecutive bits.
+uint64_t SpreadBits(uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffff;
+    v = (v | v << 16) & 0x1f0000ff0000ff;
+    v = (v | v << 8) & 0x100f00f00f00f00f;
+    v = (v | v << 4) & 0x10c30c30c30c30c3;
+    v = (v | v << 2) & 0x1249249249249249;
+    return v;
+}
+}  // namespace
+
+uint64_t ComputeMortonCode(const Eigen::Vector3i &cell) {
+    return SpreadBits(uint64_t(cell(0))) << 2 |
+           SpreadBits(uint64_t(cell(1))) << 1 | SpreadBits(uint64_t(cell(2)));
+}
+
+uint64_t ComputeHilbertCode(const Eigen::Vector3i &cell) {
+    // J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004.
+    // The coordinates are transformed in place into the transposed Hilbert
+    // index, whose bits are then interleaved as for the Morton code.
+    uint32_t x[3] = {uint32_t(cell(0)), uint32_t(cell(1)), uint32_t(cell(2))};
+    const uint32_t m = 1u << (kSpaceFillingCurveBits - 1);
+    for (uint32_t q = m; q > 1; q >>= 1) {
+        const uint32_t p = q - 1;
+        for (auto &xi : x) {
+            if (xi & q) {
+                x[0] ^= p;
+            } else {
+                const uint32_t t = (x[0] ^ xi) & p;
+                x[0] ^= t;
+                xi ^= t;
+            }
+        }
+    }
+    x[1] ^= x[0];
+    x[2] ^= x[1];
+    uint32_t t = 0;
+    for (uint32_t q = m; q > 1; q >>= 1) {
+        if (x[2] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (auto &xi : x) {
+        xi ^= t;
+    }
+    return ComputeMortonCode(Eigen::Vector3i(int(x[0]), int(x[1]), int(x[2])));
+}
+
+std::vector<size_t> ComputeSpaceFillingCurveOrder(
+        const std::vector<Eigen::Vector3d> &points, SpaceFillingCurve curve) {
+    const auto num_points = static_cast<int64_t>(points.size());
+    std::vector<size_t> order(num_points);
+    std::iota(order.begin(), order.end(), size_t(0));
+    if (num_points <= 1) {
+        return order;
+    }
+
+    const AxisAlignedBoundingBox bbox =
+            AxisAlignedBoundingBox::CreateFromPoints(points);
+    const Eigen::Vector3d min_bound = bbox.GetMinBound();
+    const double extent = bbox.GetMaxExtent();
+    const int max_cell = (1 << kSpaceFillingCurveBits) - 1;
+    const double scale = extent > 0 ? max_cell / extent : 0;
+
+    const auto policy = core::executionPolicyFor(num_points);
+    std::vector<uint64_t> codes(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                const Eigen::Vector3d p = (points[i] - min_bound) * scale;
+                const Eigen::Vector3i cell(
+                        std::clamp(int(p(0)), 0, max_cell),
+                        std::clamp(int(p(1)), 0, max_cell),
+                        std::clamp(int(p(2)), 0, max_cell));
+                codes[i] = curve == SpaceFillingCurve::Morton
+                                   ? ComputeMortonCode(cell)
+                                   : ComputeHilbertCode(cell);
+            },
+            policy);
+    core::parallelRadixSortByKey(codes, order, 3 * kSpaceFillingCurveBits,
+                                 policy);
+    return order;
+}
+
+}  // namespace u3d::geometry
@@ -0,0 +1,60 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <vector>
+
+#include "unified3d/utility/Helper.h"
+
+namespace u3d::geometry {
+
+/// \enum SpaceFillingCurve
+///
+/// \brief Curve along which points are ordered by SpatialReorder().
+enum class SpaceFillingCurve {
+    /// Z-order curve. Cheapest to compute.
+    Morton = 0,
+    /// Hilbert curve. Consecutive cells are always adjacent, which gives
+    /// slightly better locality than the Morton order.
+    Hilbert = 1,
+};
+
+/// Number of bits per axis of the grid on which curve codes are computed.
+constexpr int kSpaceFillingCurveBits = 21;
+
+/// \brief Returns the Morton code of a cell of the 2^21 x 2^21 x 2^21 grid.
+uint64_t ComputeMortonCode(const Eigen::Vector3i &cell);
+
+/// \brief Returns the Hilbert code of a cell of the 2^21 x 2^21 x 2^21 grid.
+uint64_t ComputeHilbertCode(const Eigen::Vector3i &cell);
+
+/// \brief Computes the order of \p points along a space filling curve.
+///
+/// The bounding box of the points is divided into a 2^21 x 2^21 x 2^21 grid
+/// and the points are sorted by the curve code of their cell, ties keeping
+/// their original order. Codes are computed and sorted in parallel.
+///
+/// \return The permutation, i.e. the i-th point along the curve is
+/// points[order[i]].
+std::vector<size_t> ComputeSpaceFillingCurveOrder(
+        const std::vector<Eigen::Vector3d> &points,
+        SpaceFillingCurve curve = SpaceFillingCurve::Hilbert);
+
+/// \brief Reorders \p values so that the i-th value becomes values[order[i]].
+/// Empty vectors, i.e. absent attributes, are left untouched.
+template <typename T>
+void ApplyPermutation(std::vector<T> &values,
+                      const std::vector<size_t> &order) {
+    if (values.empty()) {
+        return;
+    }
+    values = utility::GatherByIndex(values, order);
+}
+
+}  // namespace u3d::geometry
@@ -0,0 +1,163 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/geometry/SpanningForest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <tuple>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/utility/ConcurrentDisjointSet.h"
+
+namespace u3d::geometry {
+
+namespace {
+
+// Disjoint set data structure to find cycles in graphs
+class DisjointSet {
+public:
+    DisjointSet(size_t size) : parent_(size), size_(size) {
+        for (size_t idx = 0; idx < size; idx++) {
+            parent_[idx] = idx;
+            size_[idx] = 0;
+        }
+    }
+
+    // find representative element for given x
+    // using path compression
+    size_t Find(size_t x) {
+        if (x != parent_[x]) {
+            parent_[x] = Find(parent_[x]);
+        }
+        return parent_[x];
+    }
+
+    // combine two sets using size of sets
+    void Union(size_t x, size_t y) {
+        x = Find(x);
+        y = Find(y);
+        if (x != y) {
+            if (size_[x] < size_[y]) {
+                size_[y] += size_[x];
+                parent_[x] = y;
+            } else {
+                size_[x] += size_[y];
+                parent_[y] = x;
+            }
+        }
+    }
+
+private:
+    std::vector<size_t> parent_;
+    std::vector<size_t> size_;
+};
+
+/// Ranks edges by weight, then by vertices.
+bool EdgeRankLess(const WeightedEdge &e0, const WeightedEdge &e1) {
+    return std::tie(e0.weight_, e0.v0_, e0.v1_) <
+           std::tie(e1.weight_, e1.v0_, e1.v1_);
+}
+
+}  // namespace
+
+std::vector<WeightedEdge> KruskalMinimumSpanningForest(
+        std::vector<WeightedEdge> &edges, size_t n_vertices) {
+    std::sort(edges.begin(), edges.end(), EdgeRankLess);
+    DisjointSet disjoint_set(n_vertices);
+    std::vector<WeightedEdge> mst;
+    for (auto &edge : edges) {
+        size_t set0 = disjoint_set.Find(edge.v0_);
+        size_t set1 = disjoint_set.Find(edge.v1_);
+        if (set0 != set1) {
+            mst.push_back(edge);
+            disjoint_set.Union(set0, set1);
+        }
+    }
+    return mst;
+}
+
+std::vector<WeightedEdge> BoruvkaMinimumSpanningForest(
+        std::vector<WeightedEdge> &edges, size_t n_vertices) {
+    core::parallelSort(edges.begin(), edges.end(), EdgeRankLess,
+                       core::executionPolicyFor(edges.size()));
+
+    const auto num_vertices = static_cast<int64_t>(n_vertices);
+    const auto num_edges = static_cast<int64_t>(edges.size());
+    const auto vertex_policy = core::executionPolicyFor(num_vertices);
+    const auto edge_policy = core::executionPolicyFor(num_edges);
+    constexpr int64_t kNoEdge = std::numeric_limits<int64_t>::max();
+    utility::ConcurrentDisjointSet disjoint_set(static_cast<int>(n_vertices));
+    std::vector<int> component(n_vertices);
+    std::unique_ptr<std::atomic<int64_t>[]> cheapest(
+            new std::atomic<int64_t>[n_vertices]);
+    std::vector<uint8_t> in_mst(num_edges, 0);
+    std::atomic<bool> merged(true);
+    while (merged.exchange(false)) {
+        core::parallelFor(
+                int64_t(0), num_vertices,
+                [&](int64_t v) {
+                    component[v] = disjoint_set.Find(int(v));
+                    cheapest[v].store(kNoEdge, std::memory_order_relaxed);
+                },
+                vertex_policy);
+        // Cheapest edge leaving each component, i.e. the one of lowest rank.
+        auto SetCheapest = [&](int c, int64_t e) {
+            int64_t current = cheapest[c].load(std::memory_order_relaxed);
+            while (e < current && !cheapest[c].compare_exchange_weak(
+                                          current, e,
+                                          std::memory_order_relaxed)) {
+            }
+        };
+        core::parallelFor(
+                int64_t(0), num_edges,
+                [&](int64_t e) {
+                    const int c0 = component[edges[e].v0_];
+                    const int c1 = component[edges[e].v1_];
+                    if (c0 != c1) {
+                        SetCheapest(c0, e);
+                        SetCheapest(c1, e);
+                    }
+                },
+                edge_policy);
+        // Add the cheapest edges to the tree and merge their components. An
+        // edge that is the cheapest of both its components is added by the
+        // component with the smaller index.
+        core::parallelFor(
+                int64_t(0), num_vertices,
+                [&](int64_t c) {
+                    const int64_t e =
+                            cheapest[c].load(std::memory_order_relaxed);
+                    if (component[c] != c || e == kNoEdge) {
+                        return;
+                    }
+                    const int c0 = component[edges[e].v0_];
+                    const int c1 = component[edges[e].v1_];
+                    const int other = c0 == c ? c1 : c0;
+                    if (other < c &&
+                        cheapest[other].load(std::memory_order_relaxed) == e) {
+                        return;
+                    }
+                    in_mst[e] = 1;
+                    disjoint_set.Union(int(edges[e].v0_), int(edges[e].v1_));
+                    merged.store(true, std::memory_order_relaxed);
+                },
+                vertex_policy);
+    }
+
+    std::vector<WeightedEdge> mst;
+    for (int64_t e = 0; e < num_edges; e++) {
+        if (in_mst[e]) {
+            mst.push_back(edges[e]);
+        }
+    }
+    return mst;
+}
+
+}  // namespace u3d::geometry
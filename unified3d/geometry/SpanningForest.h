@@ -0,0 +1,50 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace u3d::geometry {
+
+/// \struct WeightedEdge
+///
+/// \brief Undirected edge between the vertices v0_ and v1_ of a graph.
+struct WeightedEdge {
+    WeightedEdge() : WeightedEdge(0, 0, 0.0) {}
+    WeightedEdge(size_t v0, size_t v1, double weight)
+        : v0_(v0), v1_(v1), weight_(weight) {}
+    size_t v0_;
+    size_t v1_;
+    double weight_;
+};
+
+/// \brief Computes the minimum spanning forest of a graph with Kruskal's
+/// algorithm.
+///
+/// Edges are ranked by weight, then by v0_ and v1_, so that the forest is
+/// unique even when weights tie.
+///
+/// \param edges Edges of the graph, sorted by rank on return.
+/// \param n_vertices Number of vertices of the graph.
+/// \return The edges of the forest, by increasing rank.
+std::vector<WeightedEdge> KruskalMinimumSpanningForest(
+        std::vector<WeightedEdge> &edges, size_t n_vertices);
+
+/// \brief Computes the minimum spanning forest of a graph with Boruvka's
+/// algorithm, run in parallel.
+///
+/// Edges are ranked as in KruskalMinimumSpanningForest(), so both return the
+/// same forest, independently of the number of threads.
+///
+/// \param edges Edges of the graph, sorted by rank on return.
+/// \param n_vertices Number of vertices of the graph.
+/// \return The edges of the forest, by increasing rank.
+std::vector<WeightedEdge> BoruvkaMinimumSpanningForest(
+        std::vector<WeightedEdge> &edges, size_t n_vertices);
+
+}  // namespace u3d::geometry
@@ -11,9 +11,12 @@
 #include <numeric>
 #include <tuple>
 
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/DuplicatedPoints.h"
 #include "unified3d/geometry/PointCloud.h"
 #include "unified3d/geometry/TriangleMesh.h"
+#include "unified3d/utility/Helper.h"
 #include "unified3d/utility/Logging.h"
 
 namespace u3d::geometry {
@@ -43,34 +46,33 @@ TetraMesh TetraMesh::operator+(const TetraMesh &mesh) const {
     return (TetraMesh(*this) += mesh);
 }
 
-TetraMesh &TetraMesh::RemoveDuplicatedVertices() {
+TetraMesh &TetraMesh::RemoveDuplicatedVertices(double epsilon /* = 0.0*/) {
     typedef decltype(tetras_)::value_type::Scalar Index;
-    typedef std::tuple<double, double, double> Coordinate3;
-    std::unordered_map<Coordinate3, size_t, utility::hash_tuple<Coordinate3>>
-            point_to_old_index;
-    std::vector<Index> index_old_to_new(vertices_.size());
+    bool has_vert_normal = HasVertexNormals();
+    bool has_vert_color = HasVertexColors();
     size_t old_vertex_num = vertices_.size();
-    size_t k = 0;                                  // new index
-    for (size_t i = 0; i < old_vertex_num; i++) {  // old index
-        Coordinate3 coord = std::make_tuple(vertices_[i](0), vertices_[i](1),
-                                            vertices_[i](2));
-        if (point_to_old_index.find(coord) == point_to_old_index.end()) {
-            point_to_old_index[coord] = i;
-            vertices_[k] = vertices_[i];
-            index_old_to_new[i] = (Index)k;
-            k++;
-        } else {
-            index_old_to_new[i] = index_old_to_new[point_to_old_index[coord]];
-        }
-    }
-    vertices_.resize(k);
+    std::vector<size_t> index_old_to_new, kept;
+    std::tie(index_old_to_new, kept) =
+            FindDuplicatedPoints(vertices_, epsilon);
+    const size_t k = kept.size();
     if (k < old_vertex_num) {
-        for (auto &tetra : tetras_) {
-            tetra(0) = index_old_to_new[tetra(0)];
-            tetra(1) = index_old_to_new[tetra(1)];
-            tetra(2) = index_old_to_new[tetra(2)];
-            tetra(3) = index_old_to_new[tetra(3)];
+        vertices_ = utility::GatherByIndex(vertices_, kept);
+        if (has_vert_normal) {
+            vertex_normals_ = utility::GatherByIndex(vertex_normals_, kept);
+        }
+        if (has_vert_color) {
+            vertex_colors_ = utility::GatherByIndex(vertex_colors_, kept);
         }
+        const auto num_tetras = static_cast<int64_t>(tetras_.size());
+        core::parallelFor(
+                int64_t(0), num_tetras,
+                [&](int64_t i) {
+                    auto &tetra = tetras_[i];
+                    for (int j = 0; j < 4; j++) {
+                        tetra(j) = (Index)index_old_to_new[tetra(j)];
+                    }
+                },
+                core::executionPolicyFor(num_tetras));
     }
     utility::LogDebug(
             "[RemoveDuplicatedVertices] {:d} vertices have been removed.",
@@ -49,7 +49,10 @@ public:
 
     /// \brief Function that removes duplicated verties, i.e., vertices that
     /// have identical coordinates.
-    TetraMesh &RemoveDuplicatedVertices();
+    ///
+    /// \param epsilon If positive, vertices in the same cell of a grid of this
+    /// cell size are welded, as in TriangleMesh::RemoveDuplicatedVertices().
+    TetraMesh &RemoveDuplicatedVertices(double epsilon = 0.0);
 
     /// \brief Function that removes duplicated tetrahedra, i.e., removes
     /// tetrahedra that reference the same four vertices, independent of their
@@ -11,11 +11,14 @@
 #include <queue>
 #include <tuple>
 
+#include "unified3d/core/Parallel.h"
 #include "unified3d/geometry/BoundingVolume.h"
+#include "unified3d/geometry/DuplicatedPoints.h"
 #include "unified3d/geometry/IntersectionTest.h"
 #include "unified3d/geometry/KDTreeFlann.h"
 #include "unified3d/geometry/PointCloud.h"
 #include "unified3d/geometry/Qhull.h"
+#include "unified3d/utility/Helper.h"
 #include "unified3d/utility/Logging.h"
 #include "unified3d/utility/Random.h"
 
@@ -640,38 +643,33 @@ std::shared_ptr<PointCloud> TriangleMesh::SamplePointsPoissonDisk(
     return pcl;
 }
 
-TriangleMesh &TriangleMesh::RemoveDuplicatedVertices() {
-    typedef std::tuple<double, double, double> Coordinate3;
-    std::unordered_map<Coordinate3, size_t, utility::hash_tuple<Coordinate3>>
-            point_to_old_index;
-    std::vector<int> index_old_to_new(vertices_.size());
+TriangleMesh &TriangleMesh::RemoveDuplicatedVertices(
+        double epsilon /* = 0.0*/) {
     bool has_vert_normal = HasVertexNormals();
     bool has_vert_color = HasVertexColors();
     size_t old_vertex_num = vertices_.size();
-    size_t k = 0;                                  // new index
-    for (size_t i = 0; i < old_vertex_num; i++) {  // old index
-        Coordinate3 coord = std::make_tuple(vertices_[i](0), vertices_[i](1),
-                                            vertices_[i](2));
-        if (point_to_old_index.find(coord) == point_to_old_index.end()) {
-            point_to_old_index[coord] = i;
-            vertices_[k] = vertices_[i];
-            if (has_vert_normal) vertex_normals_[k] = vertex_normals_[i];
-            if (has_vert_color) vertex_colors_[k] = vertex_colors_[i];
-            index_old_to_new[i] = (int)k;
-            k++;
-        } else {
-            index_old_to_new[i] = index_old_to_new[point_to_old_index[coord]];
-        }
-    }
-    vertices_.resize(k);
-    if (has_vert_normal) vertex_normals_.resize(k);
-    if (has_vert_color) vertex_colors_.resize(k);
+    std::vector<size_t> index_old_to_new, kept;
+    std::tie(index_old_to_new, kept) =
+            FindDuplicatedPoints(vertices_, epsilon);
+    const size_t k = kept.size();
     if (k < old_vertex_num) {
-        for (auto &triangle : triangles_) {
-            triangle(0) = index_old_to_new[triangle(0)];
-            triangle(1) = index_old_to_new[triangle(1)];
-            triangle(2) = index_old_to_new[triangle(2)];
+        vertices_ = utility::GatherByIndex(vertices_, kept);
+        if (has_vert_normal) {
+            vertex_normals_ = utility::GatherByIndex(vertex_normals_, kept);
         }
+        if (has_vert_color) {
+            vertex_colors_ = utility::GatherByIndex(vertex_colors_, kept);
+        }
+        const auto num_triangles = static_cast<int64_t>(triangles_.size());
+        core::parallelFor(
+                int64_t(0), num_triangles,
+                [&](int64_t i) {
+                    auto &triangle = triangles_[i];
+                    triangle(0) = (int)index_old_to_new[triangle(0)];
+                    triangle(1) = (int)index_old_to_new[triangle(1)];
+                    triangle(2) = (int)index_old_to_new[triangle(2)];
+                },
+                core::executionPolicyFor(num_triangles));
         if (HasAdjacencyList()) {
             ComputeAdjacencyList();
         }
@@ -778,6 +776,43 @@ TriangleMesh &TriangleMesh::RemoveUnreferencedVertices() {
     return *this;
 }
 
+std::vector<size_t> TriangleMesh::SpatialReorder(SpaceFillingCurve curve) {
+    std::vector<size_t> order = ComputeSpaceFillingCurveOrder(vertices_, curve);
+    ApplyPermutation(vertices_, order);
+    ApplyPermutation(vertex_normals_, order);
+    ApplyPermutation(vertex_colors_, order);
+
+    const auto num_vertices = static_cast<int64_t>(order.size());
+    std::vector<int> index_old_to_new(num_vertices);
+    core::parallelFor(
+            int64_t(0), num_vertices,
+            [&](int64_t i) { index_old_to_new[order[i]] = int(i); },
+            core::executionPolicyFor(num_vertices));
+    const auto num_triangles = static_cast<int64_t>(triangles_.size());
+    core::parallelFor(
+            int64_t(0), num_triangles,
+            [&](int64_t i) {
+                Eigen::Vector3i &triangle = triangles_[i];
+                triangle(0) = index_old_to_new[triangle(0)];
+                triangle(1) = index_old_to_new[triangle(1)];
+                triangle(2) = index_old_to_new[triangle(2)];
+            },
+            core::executionPolicyFor(num_triangles));
+    if (HasAdjacencyList()) {
+        std::vector<std::unordered_set<int>> adjacency_list(num_vertices);
+        core::parallelFor(
+                int64_t(0), num_vertices,
+                [&](int64_t i) {
+                    for (int j : adjacency_list_[order[i]]) {
+                        adjacency_list[i].insert(index_old_to_new[j]);
+                    }
+                },
+                core::executionPolicyFor(num_vertices, core::kHeavyGrainSize));
+        adjacency_list_.swap(adjacency_list);
+    }
+    return order;
+}
+
 TriangleMesh &TriangleMesh::RemoveDegenerateTriangles() {
     if (HasTriangleUvs()) {
         utility::LogWarning(
@@ -16,6 +16,7 @@
 
 #include "unified3d/geometry/Image.h"
 #include "unified3d/geometry/MeshBase.h"
+#include "unified3d/geometry/SpaceFillingCurve.h"
 #include "unified3d/utility/Helper.h"
 
 namespace u3d {
@@ -117,7 +118,13 @@ public:
 
     /// \brief Function that removes duplicated verties, i.e., vertices that
     /// have identical coordinates.
-    TriangleMesh &RemoveDuplicatedVertices();
+    ///
+    /// Duplicates are found with a parallel sort, see FindDuplicatedPoints(),
+    /// and triangles are remapped to the first vertex of each group.
+    ///
+    /// \param epsilon If positive, vertices in the same cell of a grid of this
+    /// cell size are welded.
+    TriangleMesh &RemoveDuplicatedVertices(double epsilon = 0.0);
 
     /// \brief Function that removes duplicated triangles, i.e., removes
     /// triangles that reference the same three vertices and have the same
@@ -128,6 +135,19 @@ public:
     /// not referenced in any triangle of the mesh.
     TriangleMesh &RemoveUnreferencedVertices();
 
+    /// \brief Sorts the vertices along a space filling curve, so that vertices
+    /// close in space are close in memory.
+    ///
+    /// Vertex normals and colors are permuted along with the vertices, and the
+    /// triangles and the adjacency list are remapped to the new indices. The
+    /// order of the triangles is unchanged.
+    ///
+    /// \param curve The space filling curve to sort along.
+    /// \return The permutation: the i-th vertex after reordering was the
+    /// order[i]-th vertex before.
+    std::vector<size_t> SpatialReorder(
+            SpaceFillingCurve curve = SpaceFillingCurve::Hilbert);
+
     /// \brief Function that removes degenerate triangles, i.e., triangles that
     /// reference a single vertex multiple times in a single triangle.
     ///
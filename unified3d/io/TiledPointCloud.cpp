@@ -0,0 +1,480 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/io/TiledPointCloud.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <tuple>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/utility/FileSystem.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::io {
+
+namespace {
+
+/// Appends \p data to the file at \p path.
+void AppendToFile(const std::string &path, const std::vector<double> &data) {
+    if (data.empty()) {
+        return;
+    }
+    utility::filesystem::CFile file;
+    if (!file.Open(path, "ab")) {
+        utility::LogError("[TiledPointCloud] Failed to open {}: {}", path,
+                          file.GetError());
+    }
+    if (fwrite(data.data(), sizeof(double), data.size(), file.GetFILE()) !=
+        data.size()) {
+        utility::LogError("[TiledPointCloud] Failed to write {}.", path);
+    }
+}
+
+}  // unnamed namespace
+
+TiledPointCloud::TiledPointCloud(const std::string &directory,
+                                 double tile_size,
+                                 double margin,
+                                 size_t max_buffered_points)
+    : directory_(directory),
+      tile_size_(tile_size),
+      margin_(margin),
+      max_buffered_points_(max_buffered_points) {
+    if (tile_size <= 0) {
+        utility::LogError(
+                "[TiledPointCloud] tile_size must be positive, but got {}.",
+                tile_size);
+    }
+    if (margin < 0 || margin > tile_size) {
+        utility::LogError(
+                "[TiledPointCloud] margin must be in [0, tile_size], but got "
+                "{}.",
+                margin);
+    }
+    if (utility::filesystem::DirectoryExists(directory)) {
+        if (!utility::filesystem::DirectoryIsEmpty(directory)) {
+            utility::LogError("[TiledPointCloud] Directory {} is not empty.",
+                              directory);
+        }
+    } else {
+        if (!utility::filesystem::MakeDirectoryHierarchy(directory)) {
+            utility::LogError(
+                    "[TiledPointCloud] Failed to create directory {}.",
+                    directory);
+        }
+        created_directory_ = true;
+    }
+}
+
+TiledPointCloud::~TiledPointCloud() {
+    for (const auto &tile : tiles_) {
+        utility::filesystem::RemoveFile(GetTilePath(tile.first, false));
+        utility::filesystem::RemoveFile(GetTilePath(tile.first, true));
+    }
+    if (created_directory_ &&
+        utility::filesystem::DirectoryExists(directory_) &&
+        utility::filesystem::DirectoryIsEmpty(directory_)) {
+        utility::filesystem::DeleteDirectory(directory_);
+    }
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::CreateFromFiles(
+        const std::vector<std::string> &filenames,
+        const std::string &directory,
+        double tile_size,
+        double margin,
+        const ReadPointCloudOption &params) {
+    auto tiled = std::make_shared<TiledPointCloud>(directory, tile_size,
+                                                   margin);
+    for (const std::string &filename : filenames) {
+        geometry::PointCloud chunk;
+        if (!ReadPointCloud(filename, chunk, params)) {
+            utility::LogError("[TiledPointCloud] Failed to read {}.",
+                              filename);
+        }
+        tiled->Append(chunk);
+    }
+    tiled->Flush();
+    return tiled;
+}
+
+size_t TiledPointCloud::NumTiles() const {
+    return std::count_if(tiles_.begin(), tiles_.end(), [](const auto &tile) {
+        return tile.second.num_core > 0;
+    });
+}
+
+std::vector<Eigen::Vector3i> TiledPointCloud::GetTileKeys() const {
+    std::vector<Eigen::Vector3i> keys;
+    keys.reserve(tiles_.size());
+    for (const auto &tile : tiles_) {
+        if (tile.second.num_core > 0) {
+            keys.push_back(tile.first);
+        }
+    }
+    std::sort(keys.begin(), keys.end(),
+              [](const Eigen::Vector3i &a, const Eigen::Vector3i &b) {
+                  return std::tie(a(0), a(1), a(2)) <
+                         std::tie(b(0), b(1), b(2));
+              });
+    return keys;
+}
+
+Eigen::Vector3i TiledPointCloud::GetTileKey(
+        const Eigen::Vector3d &point) const {
+    return Eigen::Vector3i(static_cast<int>(std::floor(point(0) / tile_size_)),
+                           static_cast<int>(std::floor(point(1) / tile_size_)),
+                           static_cast<int>(std::floor(point(2) / tile_size_)));
+}
+
+void TiledPointCloud::Append(const geometry::PointCloud &chunk) {
+    if (!chunk.HasPoints()) {
+        return;
+    }
+    if (!has_attributes_) {
+        has_normals_ = chunk.HasNormals();
+        has_colors_ = chunk.HasColors();
+        has_covariances_ = chunk.HasCovariances();
+        has_attributes_ = true;
+    } else if (chunk.HasNormals() != has_normals_ ||
+               chunk.HasColors() != has_colors_ ||
+               chunk.HasCovariances() != has_covariances_) {
+        utility::LogError(
+                "[TiledPointCloud] Appended points must have the same "
+                "attributes as the previous ones.");
+    }
+
+    const auto num_points = static_cast<int64_t>(chunk.points_.size());
+    std::vector<Eigen::Vector3i> keys(num_points);
+    core::parallelFor(
+            int64_t(0), num_points,
+            [&](int64_t i) {
+                if (chunk.points_[i].allFinite()) {
+                    keys[i] = GetTileKey(chunk.points_[i]);
+                }
+            },
+            core::executionPolicyFor(num_points));
+
+    size_t num_skipped = 0;
+    for (int64_t i = 0; i < num_points; ++i) {
+        const Eigen::Vector3d &p = chunk.points_[i];
+        if (!p.allFinite()) {
+            ++num_skipped;
+            continue;
+        }
+        const Eigen::Vector3i &key = keys[i];
+        PackRecord(chunk, i, buffers_[key].core);
+        ++tiles_[key].num_core;
+        ++num_points_;
+        ++num_buffered_;
+
+        // Neighboring tiles whose cube grown by the margin contains p.
+        Eigen::Vector3i lo = Eigen::Vector3i::Zero();
+        Eigen::Vector3i hi = Eigen::Vector3i::Zero();
+        for (int a = 0; a < 3 && margin_ > 0; ++a) {
+            lo(a) = p(a) - key(a) * tile_size_ < margin_ ? -1 : 0;
+            hi(a) = (key(a) + 1) * tile_size_ - p(a) <= margin_ ? 1 : 0;
+        }
+        for (int dx = lo(0); dx <= hi(0); ++dx) {
+            for (int dy = lo(1); dy <= hi(1); ++dy) {
+                for (int dz = lo(2); dz <= hi(2); ++dz) {
+                    if (dx == 0 && dy == 0 && dz == 0) {
+                        continue;
+                    }
+                    const Eigen::Vector3i neighbor =
+                            key + Eigen::Vector3i(dx, dy, dz);
+                    PackRecord(chunk, i, buffers_[neighbor].margin);
+                    ++tiles_[neighbor].num_margin;
+                    ++num_buffered_;
+                }
+            }
+        }
+        if (num_buffered_ >= max_buffered_points_) {
+            Flush();
+        }
+    }
+    if (num_skipped > 0) {
+        utility::LogWarning(
+                "[TiledPointCloud] Skipped {:d} points with non-finite "
+                "coordinates.",
+                num_skipped);
+    }
+}
+
+void TiledPointCloud::Flush() const {
+    if (num_buffered_ == 0) {
+        return;
+    }
+    for (const auto &buffer : buffers_) {
+        AppendToFile(GetTilePath(buffer.first, false), buffer.second.core);
+        AppendToFile(GetTilePath(buffer.first, true), buffer.second.margin);
+    }
+    buffers_.clear();
+    num_buffered_ = 0;
+}
+
+std::shared_ptr<geometry::PointCloud> TiledPointCloud::ReadTile(
+        const Eigen::Vector3i &key, bool with_margin) const {
+    Flush();
+    return LoadTile(key, with_margin);
+}
+
+void TiledPointCloud::ForEachTile(
+        const std::function<void(const Eigen::Vector3i &,
+                                 const geometry::PointCloud &)> &visitor)
+        const {
+    Flush();
+    const std::vector<Eigen::Vector3i> keys = GetTileKeys();
+    for (const Eigen::Vector3i &key : keys) {
+        visitor(key, *LoadTile(key, false));
+    }
+}
+
+std::shared_ptr<geometry::PointCloud> TiledPointCloud::ToPointCloud() const {
+    auto cloud = std::make_shared<geometry::PointCloud>();
+    cloud->points_.reserve(num_points_);
+    ForEachTile([&](const Eigen::Vector3i &, const geometry::PointCloud &tile) {
+        *cloud += tile;
+    });
+    return cloud;
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::Process(
+        const TileOperation &op,
+        const std::string &directory,
+        bool with_margin) const {
+    return ProcessTiles(
+            [&](const Eigen::Vector3i &, const geometry::PointCloud &tile) {
+                return op(tile);
+            },
+            directory, with_margin);
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::VoxelDownSample(
+        double voxel_size, const std::string &directory) const {
+    if (voxel_size <= 0.0) {
+        utility::LogError("voxel_size <= 0.");
+    }
+    const double ratio = tile_size_ / voxel_size;
+    if (std::abs(ratio - std::round(ratio)) > 1e-6 * ratio) {
+        utility::LogError(
+                "[TiledPointCloud] tile_size {} is not a multiple of "
+                "voxel_size {}.",
+                tile_size_, voxel_size);
+    }
+    // The voxels of a tile are those of a grid anchored at its lower corner,
+    // so they cover the tile exactly and only its core points are needed.
+    return ProcessTiles(
+            [&](const Eigen::Vector3i &key, const geometry::PointCloud &tile) {
+                const Eigen::Vector3d min_bound = key.cast<double>() *
+                                                  tile_size_;
+                const Eigen::Vector3d max_bound =
+                        min_bound + Eigen::Vector3d::Constant(tile_size_);
+                return std::get<0>(tile.VoxelDownSampleAndTraceCSR(
+                        voxel_size, min_bound, max_bound));
+            },
+            directory, false);
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::RemoveRadiusOutliers(
+        size_t nb_points,
+        double search_radius,
+        const std::string &directory) const {
+    if (search_radius > margin_) {
+        utility::LogError(
+                "[TiledPointCloud] search_radius {} exceeds the margin {}.",
+                search_radius, margin_);
+    }
+    return Process(
+            [&](const geometry::PointCloud &tile) {
+                return std::get<0>(
+                        tile.RemoveRadiusOutliers(nb_points, search_radius));
+            },
+            directory, true);
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::EstimateNormals(
+        const std::string &directory,
+        const geometry::KDTreeSearchParam &search_param,
+        bool fast_normal_computation) const {
+    double radius = 0.0;
+    if (search_param.GetSearchType() ==
+        geometry::KDTreeSearchParam::SearchType::Radius) {
+        radius = ((const geometry::KDTreeSearchParamRadius &)search_param)
+                         .radius_;
+    } else if (search_param.GetSearchType() ==
+               geometry::KDTreeSearchParam::SearchType::Hybrid) {
+        radius = ((const geometry::KDTreeSearchParamHybrid &)search_param)
+                         .radius_;
+    }
+    if (radius > margin_) {
+        utility::LogError(
+                "[TiledPointCloud] The search radius {} exceeds the margin "
+                "{}.",
+                radius, margin_);
+    }
+    return Process(
+            [&](const geometry::PointCloud &tile) {
+                auto result = std::make_shared<geometry::PointCloud>(tile);
+                result->EstimateNormals(search_param, fast_normal_computation);
+                return result;
+            },
+            directory, true);
+}
+
+std::shared_ptr<TiledPointCloud> TiledPointCloud::ProcessTiles(
+        const KeyedTileOperation &op,
+        const std::string &directory,
+        bool with_margin) const {
+    auto output = std::make_shared<TiledPointCloud>(
+            directory, tile_size_, margin_, max_buffered_points_);
+    Flush();
+    const std::vector<Eigen::Vector3i> keys = GetTileKeys();
+    if (keys.empty()) {
+        return output;
+    }
+
+    // Read the next tile while the current one is processed. The operations
+    // are parallel themselves, so tiles are processed one at a time, which
+    // also bounds the memory use to about two tiles.
+    auto load = [this, &keys, with_margin](size_t t) {
+        return LoadTile(keys[t], with_margin);
+    };
+    std::future<std::shared_ptr<geometry::PointCloud>> next =
+            std::async(std::launch::async, load, 0);
+    for (size_t t = 0; t < keys.size(); ++t) {
+        std::shared_ptr<geometry::PointCloud> tile = next.get();
+        if (t + 1 < keys.size()) {
+            next = std::async(std::launch::async, load, t + 1);
+        }
+        std::shared_ptr<geometry::PointCloud> result = op(keys[t], *tile);
+        tile.reset();
+        if (with_margin) {
+            // Keep the points of the core only, so that each point of the
+            // output comes from exactly one tile.
+            const auto num_points =
+                    static_cast<int64_t>(result->points_.size());
+            std::vector<uint8_t> in_core(num_points);
+            core::parallelFor(
+                    int64_t(0), num_points,
+                    [&](int64_t i) {
+                        in_core[i] = GetTileKey(result->points_[i]) == keys[t];
+                    },
+                    core::executionPolicyFor(num_points));
+            std::vector<size_t> indices;
+            for (int64_t i = 0; i < num_points; ++i) {
+                if (in_core[i]) {
+                    indices.push_back(i);
+                }
+            }
+            if (indices.size() < result->points_.size()) {
+                result = result->SelectByIndex(indices);
+            }
+        }
+        output->Append(*result);
+    }
+    output->Flush();
+    return output;
+}
+
+std::shared_ptr<geometry::PointCloud> TiledPointCloud::LoadTile(
+        const Eigen::Vector3i &key, bool with_margin) const {
+    auto cloud = std::make_shared<geometry::PointCloud>();
+    auto tile = tiles_.find(key);
+    if (tile == tiles_.end()) {
+        return cloud;
+    }
+    ReadRecords(GetTilePath(key, false), tile->second.num_core, *cloud);
+    if (with_margin) {
+        ReadRecords(GetTilePath(key, true), tile->second.num_margin, *cloud);
+    }
+    return cloud;
+}
+
+std::string TiledPointCloud::GetTilePath(const Eigen::Vector3i &key,
+                                         bool margin) const {
+    return utility::filesystem::JoinPath(
+            directory_, fmt::format("tile_{}_{}_{}{}.bin", key(0), key(1),
+                                    key(2), margin ? "_margin" : ""));
+}
+
+size_t TiledPointCloud::RecordSize() const {
+    return 3 + (has_normals_ ? 3 : 0) + (has_colors_ ? 3 : 0) +
+           (has_covariances_ ? 9 : 0);
+}
+
+void TiledPointCloud::PackRecord(const geometry::PointCloud &chunk,
+                                 size_t i,
+                                 std::vector<double> &buffer) const {
+    const Eigen::Vector3d &p = chunk.points_[i];
+    buffer.insert(buffer.end(), {p(0), p(1), p(2)});
+    if (has_normals_) {
+        const Eigen::Vector3d &n = chunk.normals_[i];
+        buffer.insert(buffer.end(), {n(0), n(1), n(2)});
+    }
+    if (has_colors_) {
+        const Eigen::Vector3d &c = chunk.colors_[i];
+        buffer.insert(buffer.end(), {c(0), c(1), c(2)});
+    }
+    if (has_covariances_) {
+        const Eigen::Matrix3d &covariance = chunk.covariances_[i];
+        buffer.insert(buffer.end(), covariance.data(), covariance.data() + 9);
+    }
+}
+
+void TiledPointCloud::ReadRecords(const std::string &path,
+                                  size_t num_records,
+                                  geometry::PointCloud &cloud) const {
+    if (num_records == 0) {
+        return;
+    }
+    const size_t record_size = RecordSize();
+    std::vector<double> data(num_records * record_size);
+    utility::filesystem::CFile file;
+    if (!file.Open(path, "rb")) {
+        utility::LogError("[TiledPointCloud] Failed to open {}: {}", path,
+                          file.GetError());
+    }
+    if (file.ReadData(data.data(), data.size()) != data.size()) {
+        utility::LogError("[TiledPointCloud] {} is truncated.", path);
+    }
+
+    const size_t offset = cloud.points_.size();
+    cloud.points_.resize(offset + num_records);
+    if (has_normals_) {
+        cloud.normals_.resize(offset + num_records);
+    }
+    if (has_colors_) {
+        cloud.colors_.resize(offset + num_records);
+    }
+    if (has_covariances_) {
+        cloud.covariances_.resize(offset + num_records);
+    }
+    core::parallelFor(
+            size_t(0), num_records,
+            [&](size_t i) {
+                const double *record = data.data() + i * record_size;
+                cloud.points_[offset + i] = Eigen::Vector3d(record);
+                record += 3;
+                if (has_normals_) {
+                    cloud.normals_[offset + i] = Eigen::Vector3d(record);
+                    record += 3;
+                }
+                if (has_colors_) {
+                    cloud.colors_[offset + i] = Eigen::Vector3d(record);
+                    record += 3;
+                }
+                if (has_covariances_) {
+                    cloud.covariances_[offset + i] =
+                            Eigen::Map<const Eigen::Matrix3d>(record);
+                }
+            },
+            core::executionPolicyFor(static_cast<int64_t>(num_records)));
+}
+
+}  // namespace u3d::io
@@ -0,0 +1,224 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "unified3d/geometry/KDTreeSearchParam.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/io/PointCloudIO.h"
+#include "unified3d/utility/Helper.h"
+
+namespace u3d::io {
+
+/// \class TiledPointCloud
+///
+/// \brief Out-of-core point cloud split into cubic tiles stored on disk.
+///
+/// Space is divided into cubes of edge tile_size anchored at the origin. Each
+/// point belongs to the core of exactly one tile. It is also copied into the
+/// margin of the neighboring tiles whose cube, grown by \p margin on every
+/// side, contains it. Appended points are buffered in memory and spilled to
+/// one binary file per tile and per core or margin, so memory use is bounded
+/// by \p max_buffered_points and does not depend on the size of the cloud.
+///
+/// Operations stream the tiles one at a time, with the next tile read from
+/// disk while the current one is processed, and write their results into a
+/// new TiledPointCloud with the same tiling. An operation sees the core of a
+/// tile together with its margin and only the resulting points that fall in
+/// the core are kept. As long as the neighborhood an operation looks at does
+/// not reach further than the margin, each point is then processed exactly
+/// as if the whole cloud were in memory, and results along tile seams are
+/// neither duplicated nor lost.
+///
+/// Points, normals, colors and covariances are stored. The tile files are
+/// removed when the object is destroyed.
+class TiledPointCloud {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param directory Directory to spill the tiles to. It is created if it
+    /// does not exist and must be empty otherwise.
+    /// \param tile_size Edge length of the tiles.
+    /// \param margin Width of the margin around each tile, at most tile_size.
+    /// \param max_buffered_points Number of appended points kept in memory
+    /// before they are written to disk.
+    TiledPointCloud(const std::string &directory,
+                    double tile_size,
+                    double margin,
+                    size_t max_buffered_points = size_t(1) << 22);
+    ~TiledPointCloud();
+    TiledPointCloud(const TiledPointCloud &) = delete;
+    TiledPointCloud &operator=(const TiledPointCloud &) = delete;
+
+    /// \brief Operation applied to each tile. It receives the points of a
+    /// tile, with or without its margin, and returns the processed points.
+    using TileOperation = std::function<std::shared_ptr<geometry::PointCloud>(
+            const geometry::PointCloud &)>;
+
+    /// \brief Factory function to create a tiled point cloud from point cloud
+    /// files, which are read one at a time.
+    ///
+    /// \param filenames Files to read.
+    /// \param directory Directory to spill the tiles to.
+    /// \param tile_size Edge length of the tiles.
+    /// \param margin Width of the margin around each tile.
+    /// \param params Options to read the files with.
+    static std::shared_ptr<TiledPointCloud> CreateFromFiles(
+            const std::vector<std::string> &filenames,
+            const std::string &directory,
+            double tile_size,
+            double margin,
+            const ReadPointCloudOption &params = {});
+
+public:
+    /// Returns the edge length of the tiles.
+    [[nodiscard]] double GetTileSize() const { return tile_size_; }
+    /// Returns the width of the margin around each tile.
+    [[nodiscard]] double GetMargin() const { return margin_; }
+    /// Returns the number of points, margin copies excluded.
+    [[nodiscard]] size_t NumPoints() const { return num_points_; }
+    /// Returns the number of tiles with points in their core.
+    [[nodiscard]] size_t NumTiles() const;
+    /// Returns the keys of the non-empty tiles in lexicographic order.
+    [[nodiscard]] std::vector<Eigen::Vector3i> GetTileKeys() const;
+    /// Returns the key of the tile whose core contains \p point.
+    [[nodiscard]] Eigen::Vector3i GetTileKey(
+            const Eigen::Vector3d &point) const;
+
+    /// \brief Appends points to the tiles.
+    ///
+    /// Points with non-finite coordinates are skipped. All chunks must have
+    /// the same attributes as the first non-empty one.
+    void Append(const geometry::PointCloud &chunk);
+
+    /// \brief Writes the buffered points to disk.
+    ///
+    /// Called by the functions reading the tiles, so there is normally no
+    /// need to call it explicitly.
+    void Flush() const;
+
+    /// \brief Reads the points of a tile.
+    ///
+    /// \param key Key of the tile.
+    /// \param with_margin Set to `true` to also read the margin points, which
+    /// come after the core points.
+    [[nodiscard]] std::shared_ptr<geometry::PointCloud> ReadTile(
+            const Eigen::Vector3i &key, bool with_margin = false) const;
+
+    /// \brief Streams the tile cores through \p visitor in the order of
+    /// GetTileKeys().
+    void ForEachTile(const std::function<void(const Eigen::Vector3i &,
+                                              const geometry::PointCloud &)>
+                             &visitor) const;
+
+    /// \brief Merges the tile cores into one point cloud held in memory.
+    [[nodiscard]] std::shared_ptr<geometry::PointCloud> ToPointCloud() const;
+
+    /// \brief Applies an operation to each tile and returns the results as a
+    /// new tiled point cloud.
+    ///
+    /// \param op Operation to apply.
+    /// \param directory Directory to spill the resulting tiles to.
+    /// \param with_margin Set to `true` to pass the margin points to \p op as
+    /// well. The resulting points outside of the tile core are then dropped.
+    std::shared_ptr<TiledPointCloud> Process(const TileOperation &op,
+                                             const std::string &directory,
+                                             bool with_margin = true) const;
+
+    /// \brief Tiled version of PointCloud::VoxelDownSample().
+    ///
+    /// The voxel grid is anchored at the origin, and tile_size must be a
+    /// multiple of \p voxel_size so that no voxel straddles two tiles.
+    std::shared_ptr<TiledPointCloud> VoxelDownSample(
+            double voxel_size, const std::string &directory) const;
+
+    /// \brief Tiled version of PointCloud::RemoveRadiusOutliers().
+    ///
+    /// \p search_radius may not exceed the margin.
+    std::shared_ptr<TiledPointCloud> RemoveRadiusOutliers(
+            size_t nb_points,
+            double search_radius,
+            const std::string &directory) const;
+
+    /// \brief Tiled version of PointCloud::EstimateNormals().
+    ///
+    /// The search radius of radius and hybrid searches may not exceed the
+    /// margin. With KNN searches, the margin should be wide enough to hold
+    /// the neighbors of the points close to the tile faces.
+    std::shared_ptr<TiledPointCloud> EstimateNormals(
+            const std::string &directory,
+            const geometry::KDTreeSearchParam &search_param =
+                    geometry::KDTreeSearchParamKNN(),
+            bool fast_normal_computation = true) const;
+
+private:
+    /// Number of core and margin points appended to a tile.
+    struct TileInfo {
+        size_t num_core = 0;
+        size_t num_margin = 0;
+    };
+
+    /// Points of a tile appended since the last flush, as packed records.
+    struct TileBuffer {
+        std::vector<double> core;
+        std::vector<double> margin;
+    };
+
+    /// Operation applied to each tile, given the key of the tile as well.
+    using KeyedTileOperation =
+            std::function<std::shared_ptr<geometry::PointCloud>(
+                    const Eigen::Vector3i &, const geometry::PointCloud &)>;
+
+    std::shared_ptr<TiledPointCloud> ProcessTiles(
+            const KeyedTileOperation &op,
+            const std::string &directory,
+            bool with_margin) const;
+    /// Reads a tile without flushing the buffers first.
+    [[nodiscard]] std::shared_ptr<geometry::PointCloud> LoadTile(
+            const Eigen::Vector3i &key, bool with_margin) const;
+    [[nodiscard]] std::string GetTilePath(const Eigen::Vector3i &key,
+                                          bool margin) const;
+    [[nodiscard]] size_t RecordSize() const;
+    void PackRecord(const geometry::PointCloud &chunk,
+                    size_t i,
+                    std::vector<double> &buffer) const;
+    void ReadRecords(const std::string &path,
+                     size_t num_records,
+                     geometry::PointCloud &cloud) const;
+
+private:
+    std::string directory_;
+    bool created_directory_ = false;
+    double tile_size_;
+    double margin_;
+    size_t max_buffered_points_;
+    size_t num_points_ = 0;
+    /// Attributes are set by the first non-empty chunk.
+    bool has_attributes_ = false;
+    bool has_normals_ = false;
+    bool has_colors_ = false;
+    bool has_covariances_ = false;
+    std::unordered_map<Eigen::Vector3i,
+                       TileInfo,
+                       utility::hash_eigen<Eigen::Vector3i>>
+            tiles_;
+    /// Buffering is invisible from the outside, so the const functions that
+    /// read the tiles may flush.
+    mutable std::unordered_map<Eigen::Vector3i,
+                               TileBuffer,
+                               utility::hash_eigen<Eigen::Vector3i>>
+            buffers_;
+    mutable size_t num_buffered_ = 0;
+};
+
+}  // namespace u3d::io
@@ -169,10 +169,40 @@ size_t Allocator::SetMemoryLimit(size_t limit, bool relaxed) {
     return limit;
 }
 
+Buffer Allocator::MallocSmall() {
+    if (small_blocks_.empty()) {
+        auto thread_pool = NewScopedMemoryPool();
+        size_t res_opt = MTL::ResourceStorageModeShared;
+        res_opt |= MTL::ResourceHazardTrackingModeTracked;
+        MTL::Buffer* page = device_->newBuffer(vm_page_size, res_opt);
+        if (!page) {
+            return Buffer{nullptr};
+        }
+        // Pages are kept for the lifetime of the allocator
+        small_pages_.insert(page);
+        for (size_t offset = vm_page_size; offset >= kSmallBlockSize;) {
+            offset -= kSmallBlockSize;
+            small_blocks_.emplace_back(page, offset);
+        }
+    }
+
+    Buffer block = small_blocks_.back();
+    small_blocks_.pop_back();
+    active_memory_ += kSmallBlockSize;
+    peak_memory_ = std::max(peak_memory_, active_memory_);
+    return block;
+}
+
 Buffer Allocator::Malloc(size_t size, bool allow_swap /* = false */) {
     // Metal doesn't like empty buffers
     size = std::max<size_t>(size, 4);
 
+    // Serve tiny requests from the small block pool
+    if (size <= kSmallBlockSize) {
+        std::unique_lock lk(mutex_);
+        return MallocSmall();
+    }
+
     // Align up memory
     if (size > vm_page_size) {
         size = vm_page_size * ((size + vm_page_size - 1) / vm_page_size);
@@ -220,6 +250,11 @@ Buffer Allocator::Malloc(size_t size, bool allow_swap /* = false */) {
 void Allocator::Free(Buffer& buffer) {
     auto buf = buffer.Ptr();
     std::unique_lock lk(mutex_);
+    if (small_pages_.count(buf)) {
+        active_memory_ -= kSmallBlockSize;
+        small_blocks_.push_back(buffer);
+        return;
+    }
     active_memory_ -= buf->length();
     if (GetCacheMemory() < max_pool_size_) {
         buffer_cache_.RecycleToCache(buf);
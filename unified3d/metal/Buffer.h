@@ -7,6 +7,8 @@
 #pragma once
 
 #include <map>
+#include <unordered_set>
+#include <vector>
 
 namespace MTL {
 class Buffer;
@@ -94,9 +96,18 @@ private:
     MTL::Device* device_;
     Allocator();
 
+    // Tiny allocations (e.g. scalars and 3-vectors) are carved out of shared
+    // pages instead of getting a Metal buffer each.
+    static constexpr size_t kSmallBlockSize = 256;
+    Buffer MallocSmall();
+
     // Caching allocator
     BufferCache buffer_cache_;
 
+    // Small block pool: free blocks and the pages they were carved from
+    std::vector<Buffer> small_blocks_;
+    std::unordered_set<const MTL::Buffer*> small_pages_;
+
     // Allocation stats
     size_t block_limit_;
     size_t gc_limit_;
@@ -0,0 +1,226 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/pipelines/registration/Registration.h"
+
+#include <cmath>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/KDTreeFlann.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/utility/Logging.h"
+#include "unified3d/utility/Timer.h"
+
+namespace u3d::pipelines::registration {
+
+namespace {
+
+/// Searches the nearest target point of each point of the transformed
+/// source within \p max_correspondence_distance, in parallel. The
+/// correspondences are gathered in source order afterwards, so the result
+/// does not depend on the number of threads.
+RegistrationResult GetRegistrationResultAndCorrespondences(
+        const geometry::PointCloud &source,
+        const geometry::KDTreeFlann &target_kdtree,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &transformation) {
+    RegistrationResult result(transformation);
+    const int num_points = (int)source.points_.size();
+    std::vector<int> target_indices(num_points, -1);
+    std::vector<double> distances2(num_points, 0.0);
+    core::parallelFor(
+            0, num_points,
+            [&](int i) {
+                int index;
+                double distance2;
+                if (target_kdtree.SearchNearest(source.points_[i],
+                                                max_correspondence_distance,
+                                                index, distance2) > 0) {
+                    target_indices[i] = index;
+                    distances2[i] = distance2;
+                }
+            },
+            core::executionPolicyFor(num_points, core::kHeavyGrainSize));
+
+    double error2 = 0.0;
+    for (int i = 0; i < num_points; i++) {
+        if (target_indices[i] >= 0) {
+            result.correspondence_set_.emplace_back(i, target_indices[i]);
+            error2 += distances2[i];
+        }
+    }
+    if (!result.correspondence_set_.empty()) {
+        const auto num_corres = (double)result.correspondence_set_.size();
+        result.fitness_ = num_corres / (double)num_points;
+        result.inlier_rmse_ = std::sqrt(error2 / num_corres);
+    }
+    return result;
+}
+
+void CheckMaxCorrespondenceDistance(double max_correspondence_distance) {
+    if (max_correspondence_distance <= 0.0) {
+        utility::LogError(
+                "Invalid max_correspondence_distance {}, must be positive.",
+                max_correspondence_distance);
+    }
+}
+
+}  // unnamed namespace
+
+RegistrationResult EvaluateRegistration(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &transformation /* = Identity()*/) {
+    CheckMaxCorrespondenceDistance(max_correspondence_distance);
+    geometry::KDTreeFlann kdtree(target);
+    geometry::PointCloud pcd = source;
+    if (!transformation.isIdentity()) {
+        pcd.Transform(transformation);
+    }
+    return GetRegistrationResultAndCorrespondences(
+            pcd, kdtree, max_correspondence_distance, transformation);
+}
+
+RegistrationResult RegistrationICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &init /* = Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/,
+        const ICPConvergenceCriteria &criteria
+        /* = ICPConvergenceCriteria()*/) {
+    CheckMaxCorrespondenceDistance(max_correspondence_distance);
+    geometry::KDTreeFlann kdtree(target);
+    return RegistrationICP(source, target, kdtree, max_correspondence_distance,
+                           init, estimation, criteria);
+}
+
+RegistrationResult RegistrationICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &target_kdtree,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &init /* = Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/,
+        const ICPConvergenceCriteria &criteria
+        /* = ICPConvergenceCriteria()*/) {
+    CheckMaxCorrespondenceDistance(max_correspondence_distance);
+
+    Eigen::Matrix4d transformation = init;
+    geometry::PointCloud pcd = source;
+    if (!init.isIdentity()) {
+        pcd.Transform(init);
+    }
+    RegistrationResult result = GetRegistrationResultAndCorrespondences(
+            pcd, target_kdtree, max_correspondence_distance, transformation);
+    std::vector<ICPIterationStat> iteration_stats;
+    utility::Timer timer;
+    for (int i = 0; i < criteria.max_iteration_; i++) {
+        ICPIterationStat stat;
+        stat.iteration_ = i;
+
+        timer.Start();
+        const Eigen::Matrix4d update = estimation.ComputeTransformation(
+                pcd, target, result.correspondence_set_);
+        transformation = update * transformation;
+        pcd.Transform(update);
+        timer.Stop();
+        stat.estimation_time_ms_ = timer.GetDurationInMillisecond();
+
+        timer.Start();
+        RegistrationResult backup = std::move(result);
+        result = GetRegistrationResultAndCorrespondences(
+                pcd, target_kdtree, max_correspondence_distance,
+                transformation);
+        timer.Stop();
+        stat.correspondence_time_ms_ = timer.GetDurationInMillisecond();
+
+        stat.fitness_ = result.fitness_;
+        stat.inlier_rmse_ = result.inlier_rmse_;
+        iteration_stats.push_back(stat);
+        utility::LogDebug(
+                "ICP Iteration #{:d}: Fitness {:.4f}, RMSE {:.4f}, "
+                "estimation {:.3f} ms, correspondences {:.3f} ms",
+                i, stat.fitness_, stat.inlier_rmse_, stat.estimation_time_ms_,
+                stat.correspondence_time_ms_);
+        if (std::abs(backup.fitness_ - result.fitness_) <
+                    criteria.relative_fitness_ &&
+            std::abs(backup.inlier_rmse_ - result.inlier_rmse_) <
+                    criteria.relative_rmse_) {
+            break;
+        }
+    }
+    result.iteration_stats_ = std::move(iteration_stats);
+    return result;
+}
+
+RegistrationResult RegistrationMultiScaleICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<double> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria_list,
+        const std::vector<double> &max_correspondence_distances,
+        const Eigen::Matrix4d &init /* = Identity()*/,
+        const TransformationEstimation &estimation
+        /* = TransformationEstimationPointToPoint(false)*/) {
+    const size_t num_scales = voxel_sizes.size();
+    if (num_scales == 0 || criteria_list.size() != num_scales ||
+        max_correspondence_distances.size() != num_scales) {
+        utility::LogError(
+                "voxel_sizes, criteria_list and max_correspondence_distances "
+                "must be non-empty and of the same size, but got {}, {} and "
+                "{}.",
+                num_scales, criteria_list.size(),
+                max_correspondence_distances.size());
+    }
+    for (size_t s = 0; s < num_scales; s++) {
+        if (voxel_sizes[s] < 0.0 ||
+            (s > 0 && voxel_sizes[s] > voxel_sizes[s - 1])) {
+            utility::LogError(
+                    "voxel_sizes must be non-negative and in decreasing "
+                    "order.");
+        }
+        CheckMaxCorrespondenceDistance(max_correspondence_distances[s]);
+    }
+
+    RegistrationResult result(init);
+    std::vector<ICPIterationStat> iteration_stats;
+    for (size_t s = 0; s < num_scales; s++) {
+        std::shared_ptr<geometry::PointCloud> source_down;
+        std::shared_ptr<geometry::PointCloud> target_down;
+        if (voxel_sizes[s] > 0.0) {
+            source_down = source.VoxelDownSample(voxel_sizes[s]);
+            target_down = target.VoxelDownSample(voxel_sizes[s]);
+            if (target_down->HasNormals()) {
+                target_down->NormalizeNormals();
+            }
+        }
+        const geometry::PointCloud &source_s =
+                source_down ? *source_down : source;
+        const geometry::PointCloud &target_s =
+                target_down ? *target_down : target;
+
+        result = RegistrationICP(source_s, target_s,
+                                 max_correspondence_distances[s],
+                                 result.transformation_, estimation,
+                                 criteria_list[s]);
+        utility::LogDebug(
+                "Multi-scale ICP scale #{:d} (voxel size {}): Fitness {:.4f}, "
+                "RMSE {:.4f}",
+                s, voxel_sizes[s], result.fitness_, result.inlier_rmse_);
+        for (ICPIterationStat stat : result.iteration_stats_) {
+            stat.scale_ = (int)s;
+            iteration_stats.push_back(stat);
+        }
+    }
+    result.iteration_stats_ = std::move(iteration_stats);
+    return result;
+}
+
+}  // namespace u3d::pipelines::registration
@@ -0,0 +1,161 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <vector>
+
+#include "unified3d/pipelines/registration/TransformationEstimation.h"
+
+namespace u3d::geometry {
+class KDTreeFlann;
+class PointCloud;
+}  // namespace u3d::geometry
+
+namespace u3d::pipelines::registration {
+
+/// \class ICPConvergenceCriteria
+///
+/// \brief Convergence criteria of ICP.
+///
+/// ICP stops once the changes of both the fitness and the inlier RMSE
+/// between two iterations are below their thresholds, or after
+/// max_iteration_ iterations.
+class ICPConvergenceCriteria {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param relative_fitness Threshold on the change of the fitness.
+    /// \param relative_rmse Threshold on the change of the inlier RMSE.
+    /// \param max_iteration Maximum number of iterations.
+    ICPConvergenceCriteria(double relative_fitness = 1e-6,
+                           double relative_rmse = 1e-6,
+                           int max_iteration = 30)
+        : relative_fitness_(relative_fitness),
+          relative_rmse_(relative_rmse),
+          max_iteration_(max_iteration) {}
+
+public:
+    double relative_fitness_;
+    double relative_rmse_;
+    int max_iteration_;
+};
+
+/// \struct ICPIterationStat
+///
+/// \brief Quality and timing of one ICP iteration.
+struct ICPIterationStat {
+    /// Index of the scale for multi-scale ICP, 0 otherwise.
+    int scale_ = 0;
+    /// Index of the iteration within its scale.
+    int iteration_ = 0;
+    /// Fitness and inlier RMSE after the iteration.
+    double fitness_ = 0.0;
+    double inlier_rmse_ = 0.0;
+    /// Time spent estimating the transformation update.
+    double estimation_time_ms_ = 0.0;
+    /// Time spent searching the correspondences for the updated pose.
+    double correspondence_time_ms_ = 0.0;
+};
+
+/// \class RegistrationResult
+///
+/// \brief Result of a registration.
+class RegistrationResult {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param transformation The estimated transformation matrix.
+    RegistrationResult(const Eigen::Matrix4d &transformation =
+                               Eigen::Matrix4d::Identity())
+        : transformation_(transformation) {}
+
+public:
+    /// The estimated transformation matrix.
+    Eigen::Matrix4d transformation_;
+    /// Correspondences between the transformed source and the target.
+    CorrespondenceSet correspondence_set_;
+    /// RMSE of the inlier correspondence distances.
+    double inlier_rmse_ = 0.0;
+    /// Number of inlier correspondences divided by the number of source
+    /// points.
+    double fitness_ = 0.0;
+    /// Statistics of the iterations, empty for EvaluateRegistration().
+    std::vector<ICPIterationStat> iteration_stats_;
+};
+
+/// \brief Evaluates the inlier correspondences of \p source transformed by
+/// \p transformation with \p target.
+///
+/// \param max_correspondence_distance Maximum correspondence points-pair
+/// distance.
+RegistrationResult EvaluateRegistration(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &transformation = Eigen::Matrix4d::Identity());
+
+/// \brief Aligns \p source to \p target with the Iterative Closest Point
+/// algorithm.
+///
+/// The nearest neighbors of the source points are searched in parallel and
+/// the transformation update is accumulated in parallel by \p estimation.
+///
+/// \param max_correspondence_distance Maximum correspondence points-pair
+/// distance.
+/// \param init Initial transformation estimation.
+/// \param estimation Estimation method.
+/// \param criteria Convergence criteria.
+RegistrationResult RegistrationICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &init = Eigen::Matrix4d::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(false),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// \brief Same as above, with a KDTree of \p target built by the caller.
+///
+/// Meant for scan-to-map alignment, where many scans are registered against
+/// the same map and the tree is built only once. \p target_kdtree must index
+/// the points of \p target.
+RegistrationResult RegistrationICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const geometry::KDTreeFlann &target_kdtree,
+        double max_correspondence_distance,
+        const Eigen::Matrix4d &init = Eigen::Matrix4d::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(false),
+        const ICPConvergenceCriteria &criteria = ICPConvergenceCriteria());
+
+/// \brief Aligns \p source to \p target with ICP on a pyramid of voxel
+/// downsampled clouds, from the coarsest scale to the finest.
+///
+/// Each scale starts from the transformation found by the previous one. The
+/// result is the one of the last scale, and its iteration statistics cover
+/// all scales.
+///
+/// \param voxel_sizes Voxel size of each scale, in decreasing order. A
+/// voxel size of 0 uses the clouds without downsampling.
+/// \param criteria_list Convergence criteria of each scale.
+/// \param max_correspondence_distances Maximum correspondence points-pair
+/// distance of each scale.
+/// \param init Initial transformation estimation.
+/// \param estimation Estimation method.
+RegistrationResult RegistrationMultiScaleICP(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const std::vector<double> &voxel_sizes,
+        const std::vector<ICPConvergenceCriteria> &criteria_list,
+        const std::vector<double> &max_correspondence_distances,
+        const Eigen::Matrix4d &init = Eigen::Matrix4d::Identity(),
+        const TransformationEstimation &estimation =
+                TransformationEstimationPointToPoint(false));
+
+}  // namespace u3d::pipelines::registration
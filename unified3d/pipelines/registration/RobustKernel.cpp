@@ -0,0 +1,65 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/pipelines/registration/RobustKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::pipelines::registration {
+
+namespace {
+
+void CheckScale(const char *name, double k) {
+    if (!(k > 0.0)) {
+        utility::LogError("[{}] k must be positive, but got {}.", name, k);
+    }
+}
+
+}  // unnamed namespace
+
+double L2Loss::Weight(double /*residual*/) const { return 1.0; }
+
+double L1Loss::Weight(double residual) const {
+    // Bounded so that exact matches do not get an infinite weight.
+    return 1.0 / std::max(std::abs(residual), 1e-12);
+}
+
+HuberLoss::HuberLoss(double k) : k_(k) { CheckScale("HuberLoss", k); }
+
+double HuberLoss::Weight(double residual) const {
+    const double e = std::abs(residual);
+    return e <= k_ ? 1.0 : k_ / e;
+}
+
+CauchyLoss::CauchyLoss(double k) : k_(k) { CheckScale("CauchyLoss", k); }
+
+double CauchyLoss::Weight(double residual) const {
+    const double e = residual / k_;
+    return 1.0 / (1.0 + e * e);
+}
+
+GMLoss::GMLoss(double k) : k_(k) { CheckScale("GMLoss", k); }
+
+double GMLoss::Weight(double residual) const {
+    const double d = k_ + residual * residual;
+    return k_ / (d * d);
+}
+
+TukeyLoss::TukeyLoss(double k) : k_(k) { CheckScale("TukeyLoss", k); }
+
+double TukeyLoss::Weight(double residual) const {
+    const double e = std::abs(residual);
+    if (e > k_) {
+        return 0.0;
+    }
+    const double s = 1.0 - (e / k_) * (e / k_);
+    return s * s;
+}
+
+}  // namespace u3d::pipelines::registration
@@ -0,0 +1,101 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+namespace u3d::pipelines::registration {
+
+/// \class RobustKernel
+///
+/// \brief Base class of the M-estimators used to down-weight outliers in
+/// iteratively reweighted least squares.
+///
+/// Weight() is called concurrently from several threads, so kernels must not
+/// modify any state while evaluating it.
+class RobustKernel {
+public:
+    virtual ~RobustKernel() = default;
+
+    /// \brief Returns the weight of a residual, the derivative of the loss
+    /// divided by the residual.
+    ///
+    /// \param residual Signed or absolute residual.
+    [[nodiscard]] virtual double Weight(double residual) const = 0;
+};
+
+/// \class L2Loss
+///
+/// \brief Plain least squares, every residual has weight 1.
+class L2Loss : public RobustKernel {
+public:
+    [[nodiscard]] double Weight(double residual) const override;
+};
+
+/// \class L1Loss
+///
+/// \brief Absolute loss, weight 1 / |residual|.
+class L1Loss : public RobustKernel {
+public:
+    [[nodiscard]] double Weight(double residual) const override;
+};
+
+/// \class HuberLoss
+///
+/// \brief Quadratic below \p k and linear above.
+class HuberLoss : public RobustKernel {
+public:
+    /// \param k Scale parameter, in the unit of the residuals.
+    explicit HuberLoss(double k);
+
+    [[nodiscard]] double Weight(double residual) const override;
+
+public:
+    double k_;
+};
+
+/// \class CauchyLoss
+///
+/// \brief Cauchy (Lorentzian) loss, weight 1 / (1 + (residual / k)^2).
+class CauchyLoss : public RobustKernel {
+public:
+    /// \param k Scale parameter, in the unit of the residuals.
+    explicit CauchyLoss(double k);
+
+    [[nodiscard]] double Weight(double residual) const override;
+
+public:
+    double k_;
+};
+
+/// \class GMLoss
+///
+/// \brief Geman-McClure loss, weight k / (k + residual^2)^2.
+class GMLoss : public RobustKernel {
+public:
+    /// \param k Scale parameter, in the squared unit of the residuals.
+    explicit GMLoss(double k);
+
+    [[nodiscard]] double Weight(double residual) const override;
+
+public:
+    double k_;
+};
+
+/// \class TukeyLoss
+///
+/// \brief Tukey biweight loss, residuals beyond \p k get weight 0.
+class TukeyLoss : public RobustKernel {
+public:
+    /// \param k Scale parameter, in the unit of the residuals.
+    explicit TukeyLoss(double k);
+
+    [[nodiscard]] double Weight(double residual) const override;
+
+public:
+    double k_;
+};
+
+}  // namespace u3d::pipelines::registration
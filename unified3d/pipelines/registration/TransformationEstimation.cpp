@@ -0,0 +1,203 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#include "unified3d/pipelines/registration/TransformationEstimation.h"
+
+#include <Eigen/Geometry>
+#include <Eigen/SVD>
+#include <algorithm>
+#include <cmath>
+
+#include "unified3d/core/Parallel.h"
+#include "unified3d/geometry/PointCloud.h"
+#include "unified3d/utility/Logging.h"
+
+namespace u3d::pipelines::registration {
+
+namespace {
+
+/// Number of correspondences summed into one partial sum. Fixed so that the
+/// results do not depend on the number of threads.
+constexpr int kReductionBlockSize = 1024;
+
+/// Sums \p term over the correspondences, in parallel over fixed-size
+/// blocks whose partial sums are added in order.
+template <typename T, typename Term>
+T BlockSum(int num_corres, const T &zero, const Term &term) {
+    const int num_blocks =
+            (num_corres + kReductionBlockSize - 1) / kReductionBlockSize;
+    std::vector<T, Eigen::aligned_allocator<T>> partial_sums(num_blocks, zero);
+    core::parallelFor(
+            0, num_blocks,
+            [&](int b) {
+                const int end =
+                        std::min(num_corres, (b + 1) * kReductionBlockSize);
+                for (int i = b * kReductionBlockSize; i < end; i++) {
+                    partial_sums[b] += term(i);
+                }
+            },
+            core::executionPolicyFor(num_blocks, 4));
+    T sum = zero;
+    for (const T &partial_sum : partial_sums) {
+        sum += partial_sum;
+    }
+    return sum;
+}
+
+double KernelWeight(const std::shared_ptr<RobustKernel> &kernel,
+                    double residual) {
+    return kernel ? kernel->Weight(residual) : 1.0;
+}
+
+}  // unnamed namespace
+
+TransformationEstimationPointToPoint::TransformationEstimationPointToPoint(
+        bool with_scaling /* = false*/,
+        std::shared_ptr<RobustKernel> kernel /* = nullptr*/)
+    : with_scaling_(with_scaling), kernel_(std::move(kernel)) {}
+
+double TransformationEstimationPointToPoint::ComputeRMSE(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty()) {
+        return 0.0;
+    }
+    const double err = BlockSum((int)corres.size(), 0.0, [&](int i) {
+        return (source.points_[corres[i](0)] - target.points_[corres[i](1)])
+                .squaredNorm();
+    });
+    return std::sqrt(err / (double)corres.size());
+}
+
+Eigen::Matrix4d TransformationEstimationPointToPoint::ComputeTransformation(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty()) {
+        return Eigen::Matrix4d::Identity();
+    }
+    const int num_corres = (int)corres.size();
+    std::vector<double> weights(num_corres);
+    core::parallelFor(
+            0, num_corres,
+            [&](int i) {
+                weights[i] = KernelWeight(
+                        kernel_, (source.points_[corres[i](0)] -
+                                  target.points_[corres[i](1)])
+                                         .norm());
+            },
+            core::executionPolicyFor(num_corres));
+
+    // Weighted means first, then the covariance of the centered points, which
+    // is more accurate than subtracting the product of the means.
+    typedef Eigen::Matrix<double, 7, 1> Vector7d;
+    const Vector7d moments =
+            BlockSum(num_corres, Vector7d::Zero().eval(), [&](int i) {
+                Vector7d m;
+                m << weights[i] * source.points_[corres[i](0)],
+                        weights[i] * target.points_[corres[i](1)], weights[i];
+                return m;
+            });
+    const double weight_sum = moments(6);
+    if (weight_sum <= 0.0) {
+        utility::LogWarning(
+                "[TransformationEstimationPointToPoint] All correspondences "
+                "have zero weight.");
+        return Eigen::Matrix4d::Identity();
+    }
+    const Eigen::Vector3d source_mean = moments.head<3>() / weight_sum;
+    const Eigen::Vector3d target_mean = moments.segment<3>(3) / weight_sum;
+
+    typedef Eigen::Matrix<double, 3, 4> Matrix34d;
+    const Matrix34d second_moments =
+            BlockSum(num_corres, Matrix34d::Zero().eval(), [&](int i) {
+                const Eigen::Vector3d s =
+                        source.points_[corres[i](0)] - source_mean;
+                const Eigen::Vector3d t =
+                        target.points_[corres[i](1)] - target_mean;
+                Matrix34d m;
+                m.leftCols<3>() = weights[i] * t * s.transpose();
+                m.col(3) << weights[i] * s.squaredNorm(), 0.0, 0.0;
+                return m;
+            });
+    const Eigen::Matrix3d covariance =
+            second_moments.leftCols<3>() / weight_sum;
+    const double source_variance = second_moments(0, 3) / weight_sum;
+
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(
+            covariance, Eigen::ComputeFullU | Eigen::ComputeFullV);
+    Eigen::Vector3d s = Eigen::Vector3d::Ones();
+    if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0) {
+        s(2) = -1.0;
+    }
+    const Eigen::Matrix3d R =
+            svd.matrixU() * s.asDiagonal() * svd.matrixV().transpose();
+    double scale = 1.0;
+    if (with_scaling_ && source_variance > 0.0) {
+        scale = svd.singularValues().dot(s) / source_variance;
+    }
+
+    Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+    transformation.block<3, 3>(0, 0) = scale * R;
+    transformation.block<3, 1>(0, 3) = target_mean - scale * R * source_mean;
+    return transformation;
+}
+
+TransformationEstimationPointToPlane::TransformationEstimationPointToPlane(
+        std::shared_ptr<RobustKernel> kernel /* = nullptr*/)
+    : kernel_(std::move(kernel)) {}
+
+double TransformationEstimationPointToPlane::ComputeRMSE(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty() || !target.HasNormals()) {
+        return 0.0;
+    }
+    const double err = BlockSum((int)corres.size(), 0.0, [&](int i) {
+        const double r = (source.points_[corres[i](0)] -
+                          target.points_[corres[i](1)])
+                                 .dot(target.normals_[corres[i](1)]);
+        return r * r;
+    });
+    return std::sqrt(err / (double)corres.size());
+}
+
+Eigen::Matrix4d TransformationEstimationPointToPlane::ComputeTransformation(
+        const geometry::PointCloud &source,
+        const geometry::PointCloud &target,
+        const CorrespondenceSet &corres) const {
+    if (corres.empty() || !target.HasNormals()) {
+        return Eigen::Matrix4d::Identity();
+    }
+
+    auto compute_jacobian_and_residual = [&](int i, Eigen::Vector6d &J_r,
+                                             double &r, double &w) {
+        const Eigen::Vector3d &vs = source.points_[corres[i](0)];
+        const Eigen::Vector3d &vt = target.points_[corres[i](1)];
+        const Eigen::Vector3d &nt = target.normals_[corres[i](1)];
+        r = (vs - vt).dot(nt);
+        w = KernelWeight(kernel_, r);
+        J_r.block<3, 1>(0, 0) = vs.cross(nt);
+        J_r.block<3, 1>(3, 0) = nt;
+    };
+
+    Eigen::Matrix6d JTJ;
+    Eigen::Vector6d JTr;
+    double r2;
+    std::tie(JTJ, JTr, r2) =
+            utility::ComputeJTJandJTr<Eigen::Matrix6d, Eigen::Vector6d>(
+                    compute_jacobian_and_residual, (int)corres.size(), false);
+
+    bool is_success;
+    Eigen::Matrix4d extrinsic;
+    std::tie(is_success, extrinsic) =
+            utility::SolveJacobianSystemAndObtainExtrinsicMatrix(JTJ, JTr);
+    return is_success ? extrinsic : Eigen::Matrix4d::Identity();
+}
+
+}  // namespace u3d::pipelines::registration
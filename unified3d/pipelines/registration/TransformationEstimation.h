@@ -0,0 +1,111 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "unified3d/pipelines/registration/RobustKernel.h"
+#include "unified3d/utility/Eigen.h"
+
+namespace u3d::geometry {
+class PointCloud;
+}  // namespace u3d::geometry
+
+namespace u3d::pipelines::registration {
+
+/// Pairs of (source index, target index).
+typedef std::vector<Eigen::Vector2i> CorrespondenceSet;
+
+/// \class TransformationEstimation
+///
+/// \brief Base class that estimates a transformation between two point
+/// clouds from their correspondences.
+class TransformationEstimation {
+public:
+    virtual ~TransformationEstimation() = default;
+
+public:
+    /// \brief Returns the RMSE of the residuals minimized by the estimation.
+    [[nodiscard]] virtual double ComputeRMSE(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const = 0;
+    /// \brief Returns the transformation that moves \p source onto
+    /// \p target.
+    [[nodiscard]] virtual Eigen::Matrix4d ComputeTransformation(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const = 0;
+};
+
+/// \class TransformationEstimationPointToPoint
+///
+/// \brief Minimizes the distances between corresponding points in closed
+/// form, with the weighted Umeyama method.
+///
+/// The sums are accumulated in parallel over fixed-size blocks of
+/// correspondences, so the result does not depend on the number of threads.
+class TransformationEstimationPointToPoint : public TransformationEstimation {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param with_scaling Set to `true` to estimate a similarity with a
+    /// uniform scale instead of a rigid transformation.
+    /// \param kernel Robust kernel weighting the point distances, plain least
+    /// squares if null.
+    explicit TransformationEstimationPointToPoint(
+            bool with_scaling = false,
+            std::shared_ptr<RobustKernel> kernel = nullptr);
+
+public:
+    [[nodiscard]] double ComputeRMSE(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const override;
+    [[nodiscard]] Eigen::Matrix4d ComputeTransformation(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const override;
+
+public:
+    bool with_scaling_;
+    std::shared_ptr<RobustKernel> kernel_;
+};
+
+/// \class TransformationEstimationPointToPlane
+///
+/// \brief Minimizes the distances from the source points to the tangent
+/// planes of their target points, with one Gauss-Newton step.
+///
+/// The target must have normals. The normal equations are accumulated in
+/// parallel by utility::ComputeJTJandJTr().
+class TransformationEstimationPointToPlane : public TransformationEstimation {
+public:
+    /// \brief Parameterized Constructor.
+    ///
+    /// \param kernel Robust kernel weighting the point-to-plane distances,
+    /// plain least squares if null.
+    explicit TransformationEstimationPointToPlane(
+            std::shared_ptr<RobustKernel> kernel = nullptr);
+
+public:
+    [[nodiscard]] double ComputeRMSE(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const override;
+    [[nodiscard]] Eigen::Matrix4d ComputeTransformation(
+            const geometry::PointCloud &source,
+            const geometry::PointCloud &target,
+            const CorrespondenceSet &corres) const override;
+
+public:
+    std::shared_ptr<RobustKernel> kernel_;
+};
+
+}  // namespace u3d::pipelines::registration
@@ -0,0 +1,73 @@
+//  Copyright (c) 2024 Feng Yang
+//
+//  I am making my contributions/submissions to this project solely in my
+//  personal capacity and am not conveying any rights to any intellectual
+//  property of any third parties.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace u3d::utility {
+
+/// \class ConcurrentDisjointSet
+///
+/// \brief Lock-free union-find over the integers [0, size).
+///
+/// Find() and Union() may be called concurrently from any number of threads.
+/// Union() always links the root with the larger index below the one with the
+/// smaller index, so once all unions are done the representative of each set
+/// is its smallest element, whatever the order in which the unions ran. Find()
+/// shortens paths by halving with compare-and-swap.
+class ConcurrentDisjointSet {
+public:
+    explicit ConcurrentDisjointSet(int size)
+        : parent_(new std::atomic<int>[size]) {
+        for (int i = 0; i < size; ++i) {
+            parent_[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns the representative of the set containing \p x.
+    int Find(int x) {
+        int parent = parent_[x].load(std::memory_order_relaxed);
+        while (parent != x) {
+            const int grandparent =
+                    parent_[parent].load(std::memory_order_relaxed);
+            if (grandparent != parent) {
+                parent_[x].compare_exchange_weak(parent, grandparent,
+                                                 std::memory_order_relaxed);
+            }
+            x = grandparent;
+            parent = parent_[x].load(std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /// Merges the sets containing \p x and \p y.
+    void Union(int x, int y) {
+        while (true) {
+            x = Find(x);
+            y = Find(y);
+            if (x == y) {
+                return;
+            }
+            if (x < y) {
+                std::swap(x, y);
+            }
+            // Another thread may have linked x in the meantime, then retry.
+            int expected = x;
+            if (parent_[x].compare_exchange_strong(expected, y,
+                                                   std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<int>[]> parent_;
+};
+
+}  // namespace u3d::utility
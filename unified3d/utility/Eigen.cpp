@@ -8,7 +8,10 @@
 
 #include <Eigen/Geometry>
 #include <Eigen/Sparse>
+#include <algorithm>
+#include <cmath>
 
+#include <unified3d/core/Parallel.h>
 #include <unified3d/utility/Logging.h>
 
 namespace u3d::utility {
@@ -140,45 +143,74 @@ SolveJacobianSystemAndObtainExtrinsicMatrixArray(const Eigen::MatrixXd &JTJ,
     }
 }
 
-template <typename MatType, typename VecType>
-std::tuple<MatType, VecType, double> ComputeJTJandJTr(
-        std::function<void(int, VecType &, double &, double &)> f,
-        int iteration_num,
-        bool verbose /*=true*/) {
+namespace {
+
+/// Number of rows accumulated into one partial sum of ComputeJTJandJTr().
+/// Fixed so that the result does not depend on the number of threads.
+constexpr int kJTJBlockSize = 1024;
+
+/// Accumulates the rows of each block into its own JTJ, JTr and sum of r^2
+/// in parallel, then sums the blocks in order.
+template <typename MatType, typename VecType, typename AccumulateFunction>
+std::tuple<MatType, VecType, double> ReduceJTJandJTr(
+        int iteration_num, const AccumulateFunction &accumulate) {
+    const int num_blocks =
+            std::max(0, (iteration_num + kJTJBlockSize - 1) / kJTJBlockSize);
+    std::vector<MatType, Eigen::aligned_allocator<MatType>> JTJ_blocks(
+            num_blocks);
+    std::vector<VecType, Eigen::aligned_allocator<VecType>> JTr_blocks(
+            num_blocks);
+    std::vector<double> r2_sum_blocks(num_blocks, 0.0);
+    core::parallelFor(
+            0, num_blocks,
+            [&](int b) {
+                JTJ_blocks[b].setZero();
+                JTr_blocks[b].setZero();
+                accumulate(b * kJTJBlockSize,
+                           std::min(iteration_num, (b + 1) * kJTJBlockSize),
+                           JTJ_blocks[b], JTr_blocks[b], r2_sum_blocks[b]);
+            },
+            core::executionPolicyFor(num_blocks, 4));
+
     MatType JTJ;
     VecType JTr;
     double r2_sum = 0.0;
     JTJ.setZero();
     JTr.setZero();
-
-    {
-        MatType JTJ_private;
-        VecType JTr_private;
-        double r2_sum_private = 0.0;
-        JTJ_private.setZero();
-        JTr_private.setZero();
-        VecType J_r;
-        J_r.setZero();
-        double r = 0.0;
-        double w = 0.0;
-
-        for (int i = 0; i < iteration_num; i++) {
-            f(i, J_r, r, w);
-            JTJ_private.noalias() += J_r * w * J_r.transpose();
-            JTr_private.noalias() += J_r * w * r;
-            r2_sum_private += r * r;
-        }
-        {
-            JTJ += JTJ_private;
-            JTr += JTr_private;
-            r2_sum += r2_sum_private;
-        }
+    for (int b = 0; b < num_blocks; b++) {
+        JTJ += JTJ_blocks[b];
+        JTr += JTr_blocks[b];
+        r2_sum += r2_sum_blocks[b];
     }
+    return std::make_tuple(std::move(JTJ), std::move(JTr), r2_sum);
+}
+
+}  // unnamed namespace
+
+template <typename MatType, typename VecType>
+std::tuple<MatType, VecType, double> ComputeJTJandJTr(
+        std::function<void(int, VecType &, double &, double &)> f,
+        int iteration_num,
+        bool verbose /*=true*/) {
+    auto result = ReduceJTJandJTr<MatType, VecType>(
+            iteration_num, [&](int begin, int end, MatType &JTJ_private,
+                               VecType &JTr_private, double &r2_sum_private) {
+                VecType J_r;
+                J_r.setZero();
+                double r = 0.0;
+                double w = 0.0;
+                for (int i = begin; i < end; i++) {
+                    f(i, J_r, r, w);
+                    JTJ_private.noalias() += J_r * w * J_r.transpose();
+                    JTr_private.noalias() += J_r * w * r;
+                    r2_sum_private += r * r;
+                }
+            });
     if (verbose) {
         LogDebug("Residual : {:.2e} (# of elements : {:d})",
-                 r2_sum / (double)iteration_num, iteration_num);
+                 std::get<2>(result) / (double)iteration_num, iteration_num);
     }
-    return std::make_tuple(std::move(JTJ), std::move(JTr), r2_sum);
+    return result;
 }
 
 template <typename MatType, typename VecType>
@@ -190,39 +222,27 @@ std::tuple<MatType, VecType, double> ComputeJTJandJTr(
                      std::vector<double> &)> f,
         int iteration_num,
         bool verbose /*=true*/) {
-    MatType JTJ;
-    VecType JTr;
-    double r2_sum = 0.0;
-    JTJ.setZero();
-    JTr.setZero();
-    {
-        MatType JTJ_private;
-        VecType JTr_private;
-        double r2_sum_private = 0.0;
-        JTJ_private.setZero();
-        JTr_private.setZero();
-        std::vector<double> r;
-        std::vector<double> w;
-        std::vector<VecType, Eigen::aligned_allocator<VecType>> J_r;
-        for (int i = 0; i < iteration_num; i++) {
-            f(i, J_r, r, w);
-            for (int j = 0; j < (int)r.size(); j++) {
-                JTJ_private.noalias() += J_r[j] * w[j] * J_r[j].transpose();
-                JTr_private.noalias() += J_r[j] * w[j] * r[j];
-                r2_sum_private += r[j] * r[j];
-            }
-        }
-        {
-            JTJ += JTJ_private;
-            JTr += JTr_private;
-            r2_sum += r2_sum_private;
-        }
-    }
+    auto result = ReduceJTJandJTr<MatType, VecType>(
+            iteration_num, [&](int begin, int end, MatType &JTJ_private,
+                               VecType &JTr_private, double &r2_sum_private) {
+                std::vector<double> r;
+                std::vector<double> w;
+                std::vector<VecType, Eigen::aligned_allocator<VecType>> J_r;
+                for (int i = begin; i < end; i++) {
+                    f(i, J_r, r, w);
+                    for (int j = 0; j < (int)r.size(); j++) {
+                        JTJ_private.noalias() +=
+                                J_r[j] * w[j] * J_r[j].transpose();
+                        JTr_private.noalias() += J_r[j] * w[j] * r[j];
+                        r2_sum_private += r[j] * r[j];
+                    }
+                }
+            });
     if (verbose) {
         LogDebug("Residual : {:.2e} (# of elements : {:d})",
-                 r2_sum / (double)iteration_num, iteration_num);
+                 std::get<2>(result) / (double)iteration_num, iteration_num);
     }
-    return std::make_tuple(std::move(JTJ), std::move(JTr), r2_sum);
+    return result;
 }
 
 // clang-format off
@@ -404,6 +424,45 @@ template std::tuple<Eigen::Vector3d, Eigen::Matrix3d> ComputeMeanAndCovariance(
 template std::tuple<Eigen::Vector3d, Eigen::Matrix3d> ComputeMeanAndCovariance(
         const double *const points, const std::vector<int> &indices);
 
+Eigen::Vector3d ComputeSymmetricEigenvalues3x3(const Eigen::Matrix3d &A) {
+    // Scale to avoid overflow and underflow, as in the normal estimation.
+    const double max_coeff = A.cwiseAbs().maxCoeff();
+    if (max_coeff == 0) {
+        return Eigen::Vector3d::Zero();
+    }
+    const Eigen::Matrix3d B = A / max_coeff;
+
+    Eigen::Vector3d eval;
+    const double norm =
+            B(0, 1) * B(0, 1) + B(0, 2) * B(0, 2) + B(1, 2) * B(1, 2);
+    if (norm > 0) {
+        const double q = (B(0, 0) + B(1, 1) + B(2, 2)) / 3;
+        const double b00 = B(0, 0) - q;
+        const double b11 = B(1, 1) - q;
+        const double b22 = B(2, 2) - q;
+        const double p =
+                std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + norm * 2) / 6);
+        const double c00 = b11 * b22 - B(1, 2) * B(1, 2);
+        const double c01 = B(0, 1) * b22 - B(1, 2) * B(0, 2);
+        const double c02 = B(0, 1) * B(1, 2) - b11 * B(0, 2);
+        const double det =
+                (b00 * c00 - B(0, 1) * c01 + B(0, 2) * c02) / (p * p * p);
+        const double half_det = std::min(std::max(det * 0.5, -1.0), 1.0);
+
+        const double angle = std::acos(half_det) / 3;
+        const double two_thirds_pi = 2.09439510239319549;
+        const double beta2 = std::cos(angle) * 2;
+        const double beta0 = std::cos(angle + two_thirds_pi) * 2;
+        const double beta1 = -(beta0 + beta2);
+        eval << q + p * beta0, q + p * beta1, q + p * beta2;
+    } else {
+        // The matrix is diagonal.
+        eval = B.diagonal();
+        std::sort(eval.data(), eval.data() + 3);
+    }
+    return eval * max_coeff;
+}
+
 Eigen::Matrix3d SkewMatrix(const Eigen::Vector3d &vec) {
     Eigen::Matrix3d skew;
     // clang-format off
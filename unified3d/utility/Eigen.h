@@ -77,8 +77,14 @@ SolveJacobianSystemAndObtainExtrinsicMatrixArray(const Eigen::MatrixXd &JTJ,
 /// Function to compute JTJ and Jtr
 /// Input: function pointer f and total number of rows of Jacobian matrix
 /// Output: JTJ, JTr, sum of r^2
-/// Note: f takes index of row, and outputs corresponding residual and row
-/// vector.
+/// Note: f takes index of row, and outputs corresponding row vector,
+/// residual and weight. Rows are accumulated in parallel, in fixed-size
+/// blocks summed in order, so the result does not depend on the number of
+/// threads.
+/// Warning: f is called concurrently from several threads and in no
+/// particular order of rows. It must be thread-safe, and must not modify
+/// state shared between rows, such as captured counters or buffers, without
+/// synchronization.
 template <typename MatType, typename VecType>
 std::tuple<MatType, VecType, double> ComputeJTJandJTr(
         std::function<void(int, VecType &, double &, double &)> f,
@@ -88,8 +94,10 @@ std::tuple<MatType, VecType, double> ComputeJTJandJTr(
 /// Function to compute JTJ and Jtr
 /// Input: function pointer f and total number of rows of Jacobian matrix
 /// Output: JTJ, JTr, sum of r^2
-/// Note: f takes index of row, and outputs corresponding residual and row
-/// vector.
+/// Note: f takes index of row, and outputs corresponding row vectors,
+/// residuals and weights. Accumulated in parallel as above, so f has the
+/// same thread-safety requirements: it is called concurrently and out of
+/// order.
 template <typename MatType, typename VecType>
 std::tuple<MatType, VecType, double> ComputeJTJandJTr(
         std::function<
@@ -111,6 +119,14 @@ Eigen::Vector3uint8 ColorToUint8(const Eigen::Vector3d &color);
 Eigen::Vector3d ColorToDouble(uint8_t r, uint8_t g, uint8_t b);
 Eigen::Vector3d ColorToDouble(const Eigen::Vector3uint8 &rgb);
 
+/// \brief Computes the eigenvalues of a symmetric 3x3 matrix in closed form,
+/// in increasing order.
+///
+/// Uses the trigonometric solution of
+/// https://www.geometrictools.com/Documentation/RobustEigenSymmetric3x3.pdf
+/// and is shared by the fast normal estimation and ISS keypoint detection.
+Eigen::Vector3d ComputeSymmetricEigenvalues3x3(const Eigen::Matrix3d &A);
+
 /// Function to compute the covariance matrix of a set of points.
 template <typename IdxType>
 Eigen::Matrix3d ComputeCovariance(const std::vector<Eigen::Vector3d> &points,
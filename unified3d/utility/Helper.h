@@ -7,6 +7,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <memory>
@@ -16,6 +17,8 @@
 #include <tuple>
 #include <vector>
 
+#include "unified3d/core/Parallel.h"
+
 namespace u3d::utility {
 
 /// hash_tuple defines a general hash function for std::tuple
@@ -174,4 +177,21 @@ inline int DivUp(int x, int y) {
 /// Returns current time stamp.
 std::string GetCurrentTimeStamp();
 
+/// \brief Returns the values selected by \p indices, i.e. the i-th returned
+/// value is values[indices[i]]. The values are copied in parallel.
+///
+/// \p indices may select a subset of the values, repeat them or permute them,
+/// but must all be smaller than values.size().
+template <typename T>
+std::vector<T> GatherByIndex(const std::vector<T> &values,
+                             const std::vector<size_t> &indices) {
+    std::vector<T> gathered(indices.size());
+    const auto n = static_cast<int64_t>(indices.size());
+    core::parallelFor(
+            int64_t(0), n,
+            [&](int64_t i) { gathered[i] = values[indices[i]]; },
+            core::executionPolicyFor(n));
+    return gathered;
+}
+
 }  // namespace u3d::utility